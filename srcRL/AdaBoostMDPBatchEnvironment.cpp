@@ -0,0 +1,226 @@
+/*
+ *  AdaBoostMDPBatchEnvironment.cpp
+ *  RLTools
+ *
+ *  Many MDDAG episodes stepped together on flat arrays.
+ *
+ */
+
+#include "AdaBoostMDPBatchEnvironment.h"
+
+using namespace std;
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace MultiBoost {
+
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	AdaBoostMDPBatchEnvironment::AdaBoostMDPBatchEnvironment( DataReader* datareader, int batchSize )
+	: _data( datareader ), _batchSize( batchSize ), _numEpisodes( 0 ), _numRunning( 0 ),
+	  _classificationReward( 0.0 ), _skipReward( 0.0 ), _jumpReward( 0.0 ), _successReward( 0.0 ), _succRewardMode( RT_HAMMING )
+	{
+		_numClasses = _data->getClassNumber();
+		_numIterations = _data->getIterationNumber();
+		_sumAlpha = _data->getSumOfAlphas();
+
+		// the same state as AdaBoostMDPClassifierContinous::getState
+		_stateDimension = ( _numClasses == 2 ) ? 1 : _numClasses;
+
+		_instances.resize( _batchSize );
+		_iterations.resize( _batchSize );
+		_votes.resize( _batchSize * _numClasses );
+		_classifierUsed.resize( _batchSize * _numIterations );
+		_classifierNumber.resize( _batchSize );
+		_done.resize( _batchSize );
+
+		_margins.resize( _batchSize * _stateDimension );
+		_rewards.resize( _batchSize );
+
+		_voteBuffer.resize( _numClasses );
+	}
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	void AdaBoostMDPBatchEnvironment::setRewards( const AdaBoostMDPClassifierContinous* environment )
+	{
+		_classificationReward = environment->getClassificationReward();
+		_skipReward = environment->getSkipReward();
+		_jumpReward = environment->getJumpReward();
+		_successReward = environment->getSuccessReward();
+		_succRewardMode = environment->getSuccessRewardMode();
+	}
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	void AdaBoostMDPBatchEnvironment::reset( const int* instances, int numEpisodes )
+	{
+		if ( numEpisodes > _batchSize )
+		{
+			cerr << "ERROR: " << numEpisodes << " episodes do not fit in a batch of " << _batchSize << "!" << endl;
+			exit(1);
+		}
+
+		_numEpisodes = numEpisodes;
+		_numRunning = numEpisodes;
+
+		copy( instances, instances + numEpisodes, _instances.begin() );
+		fill( _iterations.begin(), _iterations.begin() + numEpisodes, 0 );
+		fill( _votes.begin(), _votes.begin() + numEpisodes * _numClasses, 0.0 );
+		fill( _classifierUsed.begin(), _classifierUsed.begin() + numEpisodes * _numIterations, 0 );
+		fill( _classifierNumber.begin(), _classifierNumber.begin() + numEpisodes, 0 );
+		fill( _rewards.begin(), _rewards.begin() + numEpisodes, 0.0 );
+
+		// with no weak classifier there is nothing to do
+		fill( _done.begin(), _done.begin() + numEpisodes, (char)( _numIterations == 0 ) );
+		if ( _numIterations == 0 ) _numRunning = 0;
+
+		fill( _margins.begin(), _margins.begin() + numEpisodes * _stateDimension, 0.5 );
+	}
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	void AdaBoostMDPBatchEnvironment::addWeakHypothesis( int b, int k )
+	{
+		AlphaReal* votes = &_votes[ b * _numClasses ];
+		const float* outputs = _data->getWeakHypothesesOutputs( _instances[b] );
+
+		if ( outputs )
+		{
+			outputs += k * _numClasses;
+			for( int l = 0; l < _numClasses; ++l )
+				votes[l] += outputs[l];
+		}
+		else
+		{
+			copy( votes, votes + _numClasses, _voteBuffer.begin() );
+			_data->classifyKthWeakLearner( k, _instances[b], _voteBuffer );
+			copy( _voteBuffer.begin(), _voteBuffer.end(), votes );
+		}
+	}
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	void AdaBoostMDPBatchEnvironment::updateMargins( int b )
+	{
+		const AlphaReal* votes = &_votes[ b * _numClasses ];
+		double* margins = &_margins[ b * _stateDimension ];
+
+		for( int i = 0; i < _stateDimension; ++i )
+			margins[i] = ((votes[i] / _sumAlpha) + 1) / 2.0; // rescale between [0,1]
+	}
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	bool AdaBoostMDPBatchEnvironment::classifyCorrectly( int b )
+	{
+		copy( _votes.begin() + b * _numClasses, _votes.begin() + (b + 1) * _numClasses, _voteBuffer.begin() );
+		return _data->currentClassifyingResult( _instances[b], _voteBuffer );
+	}
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	double AdaBoostMDPBatchEnvironment::getSuccessReward( int b )
+	{
+		if ( _succRewardMode == RT_HAMMING )
+		{
+			return classifyCorrectly( b ) ? _successReward : 0.0;
+		}
+		else if ( _succRewardMode == RT_EXP )
+		{
+			if ( _classifierNumber[b] == 0 ) return 0.0;
+
+			copy( _votes.begin() + b * _numClasses, _votes.begin() + (b + 1) * _numClasses, _voteBuffer.begin() );
+			return 1 / _data->getExponentialLoss( _instances[b], _voteBuffer );
+		}
+
+		cout << "Unknown succes reward type!!! Maybe it is not implemented! " << endl;
+		exit(-1);
+	}
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	int AdaBoostMDPBatchEnvironment::step( const int* modes )
+	{
+		for( int b = 0; b < _numEpisodes; ++b )
+		{
+			if ( _done[b] )
+			{
+				_rewards[b] = 0.0;
+				continue;
+			}
+
+			int& currentClassifier = _iterations[b];
+			const int mode = modes[b];
+
+			if ( mode == 0 ) // skip
+			{
+				currentClassifier++;
+			}
+			else if ( mode == 1 ) // classify
+			{
+				addWeakHypothesis( b, currentClassifier );
+				updateMargins( b );
+				_classifierUsed[ b * _numIterations + currentClassifier ] = 1;
+				_classifierNumber[b]++;
+				currentClassifier++;
+			}
+			else if ( mode == 2 ) // jump to end
+			{
+				currentClassifier = _numIterations;
+			}
+
+			// the rewards of AdaBoostMDPClassifierContinous::getReward
+			if ( currentClassifier < _numIterations )
+			{
+				if ( mode == 0 )
+					_rewards[b] = _skipReward;
+				else if ( mode == 1 )
+					_rewards[b] = _classificationReward;
+				else
+					_rewards[b] = _jumpReward;
+			}
+			else
+			{
+				_rewards[b] = getSuccessReward( b );
+				_done[b] = 1;
+				_numRunning--;
+			}
+		}
+
+		return _numRunning;
+	}
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	void AdaBoostMDPBatchEnvironment::getGreedyModes( MDDAGGreedyPolicy* policy, int* modes )
+	{
+		// the finished episodes have no valid state, so only the running ones are passed to the policy
+		_runningEpisodes.clear();
+		_runningIterations.clear();
+		_runningMargins.clear();
+
+		for( int b = 0; b < _numEpisodes; ++b )
+		{
+			if ( _done[b] ) continue;
+
+			_runningEpisodes.push_back( b );
+			_runningIterations.push_back( _iterations[b] );
+			_runningMargins.insert( _runningMargins.end(), _margins.begin() + b * _stateDimension, _margins.begin() + (b + 1) * _stateDimension );
+		}
+
+		const int numRunning = _runningEpisodes.size();
+		if ( numRunning == 0 ) return;
+
+		_runningModes.resize( numRunning );
+		policy->getGreedyModes( numRunning, &_runningIterations[0], &_runningMargins[0], &_runningModes[0] );
+
+		for( int r = 0; r < numRunning; ++r )
+			modes[ _runningEpisodes[r] ] = _runningModes[r];
+	}
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	void AdaBoostMDPBatchEnvironment::runGreedyEpisodes( MDDAGGreedyPolicy* policy )
+	{
+		vector<int> modes( _numEpisodes, 0 );
+		while ( _numRunning > 0 )
+		{
+			getGreedyModes( policy, &modes[0] );
+			step( &modes[0] );
+		}
+	}
+
+} // end of namespace MultiBoost
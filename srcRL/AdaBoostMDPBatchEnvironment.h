@@ -0,0 +1,114 @@
+/*
+ *  AdaBoostMDPBatchEnvironment.h
+ *  RLTools
+ *
+ *  Many MDDAG episodes stepped together on flat arrays.
+ *
+ */
+
+#ifndef __ADABOOST_MDP_BATCH_ENVIRONMENT_H
+#define __ADABOOST_MDP_BATCH_ENVIRONMENT_H
+
+//////////////////////////////////////////////////////////////////////
+// general includes
+//////////////////////////////////////////////////////////////////////
+#include "AdaBoostMDPClassifierAdv.h"
+#include "AdaBoostMDPClassifierContinous.h"
+#include "AdaBoostMDPPolicyClassifier.h"
+
+#include <vector>
+
+using namespace std;
+
+namespace MultiBoost {
+
+	////////////////////////////////////////////////////////////////////////////////////////////////
+	////////////////////////////////////////////////////////////////////////////////////////////////
+	////////////////////////////////////////////////////////////////////////////////////////////////
+	// The same MDP as AdaBoostMDPClassifierContinous, but for a batch of examples of the current
+	// data set of the DataReader. Every episode of the batch is a row of the arrays below, step()
+	// applies one action mode (see CAdaBoostAction) to every running episode and fills the next
+	// states and the rewards. The weak classifiers are read from the precomputed outputs of the
+	// DataReader if they are available.
+	class AdaBoostMDPBatchEnvironment
+	{
+	protected:
+		DataReader*				_data;
+		int						_batchSize;
+		int						_numEpisodes; // the rows in use, at most _batchSize
+		int						_numRunning;
+		int						_numClasses;
+		int						_numIterations;
+		int						_stateDimension;
+		double					_sumAlpha;
+
+		// rewards
+		double					_classificationReward;
+		double					_skipReward;
+		double					_jumpReward;
+		double					_successReward;
+		SuccesRewardModes		_succRewardMode;
+
+		// the episodes
+		vector<int>				_instances;
+		vector<int>				_iterations; // the next weak classifier
+		vector<AlphaReal>		_votes; // _votes[b * _numClasses + l]
+		vector<char>			_classifierUsed; // _classifierUsed[b * _numIterations + k]
+		vector<int>				_classifierNumber;
+		vector<char>			_done;
+
+		// the states and the rewards of the last step
+		vector<double>			_margins; // _margins[b * _stateDimension + i], rescaled between [0,1]
+		vector<double>			_rewards;
+
+		vector<AlphaReal>		_voteBuffer; // one row of _votes for the DataReader
+
+		// buffers of getGreedyModes, the running episodes only
+		vector<int>				_runningEpisodes;
+		vector<int>				_runningIterations;
+		vector<double>			_runningMargins;
+		vector<int>				_runningModes;
+
+		void addWeakHypothesis( int b, int k );
+		void updateMargins( int b );
+		double getSuccessReward( int b );
+
+	public:
+		AdaBoostMDPBatchEnvironment( DataReader* datareader, int batchSize );
+
+		// the rewards of the environment used in the training
+		void setRewards( const AdaBoostMDPClassifierContinous* environment );
+
+		// starts an episode for each of the given examples, numEpisodes <= getBatchSize()
+		void reset( const int* instances, int numEpisodes );
+
+		// applies modes[b] to every running episode b and returns the number of the still running ones,
+		// the episodes that are already done get zero reward
+		int step( const int* modes );
+
+		// asks the policy for the greedy modes of the running episodes
+		void getGreedyModes( MDDAGGreedyPolicy* policy, int* modes );
+
+		// steps the batch with the greedy policy until every episode is done
+		void runGreedyEpisodes( MDDAGGreedyPolicy* policy );
+
+		int getBatchSize() const { return _batchSize; }
+		int getEpisodeNumber() const { return _numEpisodes; }
+		int getRunningNumber() const { return _numRunning; }
+		int getStateDimension() const { return _stateDimension; }
+		int getNumClasses() const { return _numClasses; }
+
+		const double* getMargins() const { return &_margins[0]; }
+		const int* getIterations() const { return &_iterations[0]; }
+		const double* getRewards() const { return &_rewards[0]; }
+		const AlphaReal* getVotes() const { return &_votes[0]; }
+		const char* getDone() const { return &_done[0]; }
+		const char* getClassifierUsed() const { return &_classifierUsed[0]; }
+		const int* getUsedClassifierNumbers() const { return &_classifierNumber[0]; }
+
+		bool classifyCorrectly( int b );
+	};
+
+} // end of namespace MultiBoost
+
+#endif // __ADABOOST_MDP_BATCH_ENVIRONMENT_H
@@ -13,6 +13,10 @@
 
 #include <math.h> // for exp
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 using namespace std;
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -31,7 +35,8 @@ namespace MultiBoost {
 			properties->setDiscreteStateSize(i,2);
 		}
 		
-		_exampleResult = NULL;
+		// the vote buffer is reset in place at every episode
+		_exampleResult = new ExampleResults( 0, _classNum );
 		
 		// open result file
 		string tmpFname = _args.getValue<string>("traintestmdp", 4);			
@@ -102,9 +107,8 @@ namespace MultiBoost {
 		_currentClassifier = 0;
 		_classifierNumber = 0;				
 		
-		if (_exampleResult==NULL) delete _exampleResult;
-		_exampleResult = new ExampleResults(_currentRandomInstance,_classNum);		
-		
+		vector<AlphaReal>& currVotesVector = _exampleResult->getVotesVector();
+		fill( currVotesVector.begin(), currVotesVector.end(), 0.0 );
 	}
 	// -----------------------------------------------------------------------
 	// -----------------------------------------------------------------------		
@@ -150,8 +154,11 @@ namespace MultiBoost {
 	} 
 	// -----------------------------------------------------------------------
 	// -----------------------------------------------------------------------
-	DataReader::DataReader(const nor_utils::Args& args, int verbose) : _verbose(verbose), _args(args)
+	DataReader::DataReader(const nor_utils::Args& args, int verbose) : _verbose(verbose), _args(args), _isPrecomputed(false)
 	{				
+		_pCurrentOutputs = &_trainOutputs;
+		_pCurrentVotes = &_trainVotes;
+		
 		string mdpTrainFileName = _args.getValue<string>("traintestmdp", 0);				
 		string testFileName = _args.getValue<string>("traintestmdp", 1);				
 		string shypFileName = _args.getValue<string>("traintestmdp", 3);
@@ -196,33 +203,16 @@ namespace MultiBoost {
 			_sumAlphas += currBLearner->getAlpha();
 		}
 		
+		if ( _args.hasArgument("precompute") )
+			precomputeWeakHypothesesOutputs();
 	}
 	// -----------------------------------------------------------------------
 	// -----------------------------------------------------------------------
 	
 	void DataReader::loadInputData(const string& dataFileName, const string& testDataFileName, const string& shypFileName)
 	{
-		// open file
-		ifstream inFile(shypFileName.c_str());
-		if (!inFile.is_open())
-		{
-			cerr << "ERROR: Cannot open strong hypothesis file <" << shypFileName << ">!" << endl;
-			exit(1);
-		}
-		
-		// Declares the stream tokenizer
-		nor_utils::StreamTokenizer st(inFile, "<>\n\r\t");
-		
-		// Move until it finds the multiboost tag
-		if ( !UnSerialization::seekSimpleTag(st, "multiboost") )
-		{
-			// no multiboost tag found: this is not the correct file!
-			cerr << "ERROR: Not a valid MultiBoost Strong Hypothesis file!!" << endl;
-			exit(1);
-		}
-		
-		// Move until it finds the algo tag
-		string basicLearnerName = UnSerialization::seekAndParseEnclosedValue<string>(st, "algo");
+		// the name of the weak learner, from a text or a binary strong hypothesis file
+		string basicLearnerName = UnSerialization::getWeakLearnerName(shypFileName);
 		
 		// Check if the weak learner exists
 		if ( !BaseLearner::RegisteredLearners().hasLearner(basicLearnerName) )
@@ -252,12 +242,81 @@ namespace MultiBoost {
 	}				
 	// -----------------------------------------------------------------------
 	// -----------------------------------------------------------------------
+	void DataReader::precomputeWeakHypothesesOutputs()
+	{
+		if (_verbose > 0)
+			cout << "Precomputing the outputs of the weak hypotheses..." << flush;
+		
+		precomputeOutputs( _pTrainData, _trainOutputs );
+		precomputeOutputs( _pTestData, _testOutputs );
+		_isPrecomputed = true;
+		
+		if (_verbose > 0)
+			cout << "Done." << endl << flush;
+	}
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	void DataReader::precomputeOutputs( InputData* pData, vector<float>& outputs )
+	{
+		const int numClasses = pData->getNumClasses();
+		const int numExamples = pData->getNumExamples();
+		const int numWeakHyps = _weakHypotheses.size();
+		
+		// one contiguous row per example, so that an episode only touches a single row
+		outputs.resize( (size_t)numExamples * _numIterations * numClasses );
+		fill( outputs.begin(), outputs.end(), 0.0f );
+		
+		// the learners which can classify all the examples at once (e.g. the sparse stumps
+		// walking their column) are filled here, the others example by example below
+		vector<char> isClassifiedAll( numWeakHyps, 0 );
+		vector<AlphaReal> votes, phis;
+		for( int j = 0; j < numWeakHyps; ++j )
+		{
+			BaseLearner* currWeakHyp = _weakHypotheses[j];
+			if ( !currWeakHyp->classifyAll( pData, votes, phis ) )
+				continue;
+			
+			isClassifiedAll[j] = 1;
+			float alpha = currWeakHyp->getAlpha();
+			
+			for( int i = 0; i < numExamples; ++i )
+			{
+				float* row = &outputs[ (size_t)i * _numIterations * numClasses ];
+				for (int l = 0; l < numClasses; ++l)
+					row[j * numClasses + l] = alpha * (votes[l] * phis[i]);
+			}
+		}
+		
+#pragma omp parallel for schedule(dynamic,64)
+		for( int i = 0; i < numExamples; ++i )
+		{
+			float* row = &outputs[ (size_t)i * _numIterations * numClasses ];
+			for( int j = 0; j < numWeakHyps; ++j )
+			{
+				if ( isClassifiedAll[j] ) continue;
+				
+				BaseLearner* currWeakHyp = _weakHypotheses[j];
+				float alpha = currWeakHyp->getAlpha();
+				
+				for (int l = 0; l < numClasses; ++l)
+					row[j * numClasses + l] = alpha * currWeakHyp->classify(pData, i, l);
+			}
+		}
+	}
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
 	double DataReader::classifyKthWeakLearner( const int wHypInd, const int instance, ExampleResults* exampleResult )		
 	{		
 		if (_verbose>3) {
 			//cout << "Classifiying: " << wHypInd << endl;
 		}
 		
+		return classifyKthWeakLearner( wHypInd, instance, exampleResult->getVotesVector() );
+	}
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	double DataReader::classifyKthWeakLearner( const int wHypInd, const int instance, vector<AlphaReal>& currVotesVector )
+	{
 		if ( wHypInd >= _numIterations ) return -1.0; // indicating error						
 		
 		const int numClasses = _pCurrentData->getNumClasses();
@@ -265,8 +324,14 @@ namespace MultiBoost {
 		BaseLearner* currWeakHyp = _weakHypotheses[wHypInd];
 		float alpha = currWeakHyp->getAlpha();
 		
-		// a reference for clarity and speed
-		vector<AlphaReal>& currVotesVector = exampleResult->getVotesVector();
+		if ( _isPrecomputed )
+		{
+			const float* outputs = &(*_pCurrentOutputs)[ ((size_t)instance * _numIterations + wHypInd) * numClasses ];
+			for (int l = 0; l < numClasses; ++l)
+				currVotesVector[l] += outputs[l];
+			
+			return alpha;
+		}
 		
 		// for every class
 		for (int l = 0; l < numClasses; ++l)
@@ -277,6 +342,12 @@ namespace MultiBoost {
 	// -----------------------------------------------------------------------
 	// -----------------------------------------------------------------------
 	bool DataReader::currentClassifyingResult( const int currentIstance, ExampleResults* exampleResult )
+	{
+		return currentClassifyingResult( currentIstance, exampleResult->getVotesVector() );
+	}
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	bool DataReader::currentClassifyingResult( const int currentIstance, const vector<AlphaReal>& currVotesVector )
 	{
 		vector<Label>::const_iterator lIt;
 		
@@ -287,8 +358,6 @@ namespace MultiBoost {
 		// the vote of the winning positive class
 		float minPosClass = numeric_limits<float>::max();
 		
-		vector<AlphaReal>& currVotesVector = exampleResult->getVotesVector();
-		
 		for ( lIt = labels.begin(); lIt != labels.end(); ++lIt )
 		{
 			// get the negative winner class
@@ -314,6 +383,12 @@ namespace MultiBoost {
 	// -----------------------------------------------------------------------
 	// -----------------------------------------------------------------------
 	double DataReader::getExponentialLoss( const int currentIstance, ExampleResults* exampleResult )
+	{
+		return getExponentialLoss( currentIstance, exampleResult->getVotesVector() );
+	}
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	double DataReader::getExponentialLoss( const int currentIstance, const vector<AlphaReal>& currVotesVector )
 	{
 		double exploss = 0.0;
 		
@@ -322,8 +397,6 @@ namespace MultiBoost {
 		const int numClasses = _pCurrentData->getNumClasses();
 		const vector<Label>& labels = _pCurrentData->getLabels(currentIstance);
 		vector<double> yfx(numClasses);
-				
-		vector<AlphaReal>& currVotesVector = exampleResult->getVotesVector();
 		
 		//cout << "Instance: " << currentIstance << " ";
 		//cout <<  "Size: " << currVotesVector.size() << " Data: ";
@@ -359,66 +432,103 @@ namespace MultiBoost {
 	// -----------------------------------------------------------------------
 	double DataReader::getAccuracyOnCurrentDataSet()
 	{
-		double acc=0.0;
 		const int numClasses = _pCurrentData->getNumClasses();
 		const int numExamples = _pCurrentData->getNumExamples();
+		const vector<AlphaReal>& votes = getEnsembleVotesOnCurrentDataSet();
 		
 		int correct=0;
-		int incorrect=0;
 		
-		for( int i = 1; i < numExamples; i++ )
+#pragma omp parallel for reduction(+:correct)
+		for( int i = 0; i < numExamples; i++ )
 		{			
-			ExampleResults* tmpResult = new ExampleResults( i, numClasses );			
-			vector<AlphaReal>& currVotesVector = tmpResult->getVotesVector();
-			
-			for( int j=0; j<_weakHypotheses.size(); j++ )
-			{
-				
-				BaseLearner* currWeakHyp = _weakHypotheses[j];
-				float alpha = currWeakHyp->getAlpha();
-				
-				// for every class
-				for (int l = 0; l < numClasses; ++l)
-					currVotesVector[l] += alpha * currWeakHyp->classify(_pCurrentData, i, l);
-				
-			}
-			
+			const AlphaReal* currVotes = &votes[ (size_t)i * numClasses ];
 			
 			vector<Label>::const_iterator lIt;
 			
 			const vector<Label>& labels = _pCurrentData->getLabels(i);
 			
-			
 			// the vote of the winning negative class
 			float maxNegClass = -numeric_limits<float>::max();
 			// the vote of the winning positive class
 			float minPosClass = numeric_limits<float>::max();
 			
-			
 			for ( lIt = labels.begin(); lIt != labels.end(); ++lIt )
 			{
 				// get the negative winner class
-				if ( lIt->y < 0 && currVotesVector[lIt->idx] > maxNegClass )
-					maxNegClass = currVotesVector[lIt->idx];
+				if ( lIt->y < 0 && currVotes[lIt->idx] > maxNegClass )
+					maxNegClass = currVotes[lIt->idx];
 				
 				// get the positive winner class
-				if ( lIt->y > 0 && currVotesVector[lIt->idx] < minPosClass )
-					minPosClass = currVotesVector[lIt->idx];
+				if ( lIt->y > 0 && currVotes[lIt->idx] < minPosClass )
+					minPosClass = currVotes[lIt->idx];
 			}
 			
 			// if the vote for the worst positive label is lower than the
 			// vote for the highest negative label -> error
-			if (minPosClass <= maxNegClass)
-				incorrect++;
-			else {
+			if (minPosClass > maxNegClass)
 				correct++;
+		}
+		
+		return ((double) correct / ((double) numExamples)) * 100.0;
+	}
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	const vector<AlphaReal>& DataReader::getEnsembleVotesOnCurrentDataSet()
+	{
+		if ( _pCurrentVotes->empty() && _pCurrentData->getNumExamples() > 0 )
+			computeEnsembleVotes( _pCurrentData, *_pCurrentOutputs, *_pCurrentVotes );
+		
+		return *_pCurrentVotes;
+	}
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	void DataReader::computeEnsembleVotes( InputData* pData, const vector<float>& outputs, vector<AlphaReal>& votes )
+	{
+		const int numClasses = pData->getNumClasses();
+		const int numExamples = pData->getNumExamples();
+		const int numWeakHyps = _weakHypotheses.size();
+		
+		votes.resize( (size_t)numExamples * numClasses );
+		fill( votes.begin(), votes.end(), 0.0 );
+		
+		if ( _isPrecomputed )
+		{
+#pragma omp parallel for schedule(static)
+			for( int i = 0; i < numExamples; ++i )
+			{
+				const float* row = &outputs[ (size_t)i * _numIterations * numClasses ];
+				AlphaReal* currVotes = &votes[ (size_t)i * numClasses ];
+				for( int j = 0; j < numWeakHyps; ++j )
+					for (int l = 0; l < numClasses; ++l)
+						currVotes[l] += row[j * numClasses + l];
 			}
-			
+			return;
 		}
 		
-	    acc = ((double) correct / ((double) numExamples)) * 100.0;
+		// the examples are processed in blocks, every weak hypothesis is applied to a whole block
+		// before moving to the next one, so its parameters stay in the cache
+		const int blockSize = 64;
+		const int numBlocks = (numExamples + blockSize - 1) / blockSize;
 		
-		return acc;
+#pragma omp parallel for schedule(dynamic)
+		for( int block = 0; block < numBlocks; ++block )
+		{
+			const int first = block * blockSize;
+			const int last = min( first + blockSize, numExamples );
+			
+			for( int j = 0; j < numWeakHyps; ++j )
+			{
+				BaseLearner* currWeakHyp = _weakHypotheses[j];
+				AlphaReal alpha = currWeakHyp->getAlpha();
+				
+				for( int i = first; i < last; ++i )
+				{
+					AlphaReal* currVotes = &votes[ (size_t)i * numClasses ];
+					for (int l = 0; l < numClasses; ++l)
+						currVotes[l] += alpha * currWeakHyp->classify(pData, i, l);
+				}
+			}
+		}
 	}
 	
 	// -----------------------------------------------------------------------
@@ -56,11 +56,17 @@ namespace MultiBoost {
 		// upload the data
 		void loadInputData(const string& dataFileName, const string& testDataFileName, const string& shypFileName);
 
+		// evaluate every weak hypothesis on every train and test example once and store alpha*h_k(x_i,l)
+		void precomputeWeakHypothesesOutputs();
+		
 		// update example result, and return the alpha of the weak classifier used
 		double classifyKthWeakLearner( const int wHypInd, const int instance, ExampleResults* exampleResult );
+		double classifyKthWeakLearner( const int wHypInd, const int instance, vector<AlphaReal>& currVotesVector );
 		
 		bool currentClassifyingResult( const int currentIstance, ExampleResults* exampleResult );
+		bool currentClassifyingResult( const int currentIstance, const vector<AlphaReal>& currVotesVector );
 		double getExponentialLoss( const int currentIstance, ExampleResults* exampleResult );
+		double getExponentialLoss( const int currentIstance, const vector<AlphaReal>& currVotesVector );
 		bool hasithLabel( int currentIstance, int classIdx );
 		
 		// getter setters
@@ -71,12 +77,29 @@ namespace MultiBoost {
 		int getTrainNumExamples() const { return _pTrainData->getNumExamples(); }
 		int getTestNumExamples() const { return _pTestData->getNumExamples(); }				
 		
-		void setCurrentDataToTrain() { _pCurrentData = _pTrainData; }
-		void setCurrentDataToTest() { _pCurrentData = _pTestData; }		
+		void setCurrentDataToTrain() { _pCurrentData = _pTrainData; _pCurrentOutputs = &_trainOutputs; _pCurrentVotes = &_trainVotes; }
+		void setCurrentDataToTest() { _pCurrentData = _pTestData; _pCurrentOutputs = &_testOutputs; _pCurrentVotes = &_testVotes; }		
+		
+		bool isPrecomputed() const { return _isPrecomputed; }
+		
+		// the precomputed alpha_k * h_k(x,l) of the example, numIterations*numClasses values (NULL if not precomputed)
+		const float* getWeakHypothesesOutputs( const int instance ) const
+		{
+			if ( !_isPrecomputed ) return NULL;
+			return &(*_pCurrentOutputs)[ (size_t)instance * _numIterations * _pCurrentData->getNumClasses() ];
+		}
 		
 		double getAccuracyOnCurrentDataSet();
 		
+		// the votes of the full ensemble on the current data set, numClasses values per example,
+		// computed at the first call for each data set
+		const vector<AlphaReal>& getEnsembleVotesOnCurrentDataSet();
+		const AlphaReal* getEnsembleVotes( const int instance ) { return &getEnsembleVotesOnCurrentDataSet()[ (size_t)instance * _pCurrentData->getNumClasses() ]; }
+		
 		double getSumOfAlphas() const { return _sumAlphas; }
+		
+		InputData* getCurrentData() const { return _pCurrentData; }
+		const vector<BaseLearner*>& getWeakHypotheses() const { return _weakHypotheses; }
 	protected:
 		int						_verbose;		
 		double					_sumAlphas;
@@ -90,6 +113,21 @@ namespace MultiBoost {
 		InputData*				_pTestData;
 		
 		int						_numIterations;		
+		
+		// precomputed outputs: row i holds alpha_k * h_k(x_i,l) for k < _numIterations, l < numClasses
+		bool					_isPrecomputed;
+		vector<float>			_trainOutputs;
+		vector<float>			_testOutputs;
+		vector<float>*			_pCurrentOutputs;
+		
+		void precomputeOutputs( InputData* pData, vector<float>& outputs );
+		
+		// the votes of the full ensemble, one row per example
+		vector<AlphaReal>		_trainVotes;
+		vector<AlphaReal>		_testVotes;
+		vector<AlphaReal>*		_pCurrentVotes;
+		
+		void computeEnsembleVotes( InputData* pData, const vector<float>& outputs, vector<AlphaReal>& votes );
 	};
 
 	////////////////////////////////////////////////////////////////////////////////////////////////	
@@ -163,6 +201,7 @@ namespace MultiBoost {
 		// destructor
 		virtual	~AdaBoostMDPClassifierAdvDiscrete() 
 		{
+			delete _exampleResult;
 			_outputStream.close();
 		}
 		
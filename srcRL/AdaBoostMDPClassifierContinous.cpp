@@ -13,6 +13,7 @@
 #include "cstate.h"
 #include "cstateproperties.h"
 #include "clinearfafeaturecalculator.h"
+#include "cactionstatistics.h"
 
 using namespace std;
 
@@ -33,7 +34,8 @@ namespace MultiBoost {
 			properties->setMaxValue(i, 1.0);
 		}
 		
-		_exampleResult = NULL;
+		// the vote buffer is reset in place at every episode
+		_exampleResult = new ExampleResults( 0, _data->getClassNumber() );
 		
 		// open result file
 		string tmpFname = _args.getValue<string>("traintestmdp", 4);			
@@ -80,6 +82,24 @@ namespace MultiBoost {
 		
 	}
 	
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	AdaBoostMDPClassifierContinous::AdaBoostMDPClassifierContinous( const AdaBoostMDPClassifierContinous& other )
+	: CEnvironmentModel(other.properties), _args(other._args), _verbose(other._verbose), _classNum(other._classNum), _data(other._data)
+	{
+		_classificationReward = other._classificationReward;
+		_skipReward = other._skipReward;
+		_jumpReward = other._jumpReward;
+		_successReward = other._successReward;
+		_succRewardMode = other._succRewardMode;
+		
+		_sumAlpha = other._sumAlpha;
+		_classifierUsed.resize( other._classifierUsed.size() );
+		
+		_exampleResult = new ExampleResults( 0, _data->getClassNumber() );
+		_currentRandomInstance = 0;
+	}
+	
 	// -----------------------------------------------------------------------
 	// -----------------------------------------------------------------------
 	void AdaBoostMDPClassifierContinous::getState(CState *state)
@@ -154,8 +174,8 @@ namespace MultiBoost {
 		_classifierNumber = 0;				
 		_currentSumAlpha = 0.0;
 		
-		if (_exampleResult==NULL) delete _exampleResult;
-		_exampleResult = new ExampleResults(_currentRandomInstance,_data->getClassNumber());		
+		vector<AlphaReal>& currVotesVector = _exampleResult->getVotesVector();
+		fill( currVotesVector.begin(), currVotesVector.end(), 0.0 );
 		
 		fill( _classifierUsed.begin(), _classifierUsed.end(), false );
 			
@@ -332,10 +352,157 @@ namespace MultiBoost {
 	}
 	// -----------------------------------------------------------------------
 	// -----------------------------------------------------------------------
+	CAgent* createWorkerAgent( CAgent* agent, CEnvironmentModel* environment, CAbstractQFunction* qFunction )
+	{
+		CAgent* workerAgent = new CAgent( environment );
+		
+		CActionSet* actions = agent->getActions();
+		for (CActionSet::iterator it = actions->begin(); it != actions->end(); ++it)
+			workerAgent->addAction( dynamic_cast<CPrimitiveAction*>(*it) );
+		
+		std::list<CStateModifier*>* modifiers = agent->getStateModifiers();
+		for (std::list<CStateModifier*>::iterator it = modifiers->begin(); it != modifiers->end(); ++it)
+			workerAgent->addStateModifier( *it );
+		
+		workerAgent->setController( new CQGreedyPolicy( workerAgent->getActions(), qFunction ) );
+		workerAgent->setLogEpisode(false);
+		
+		return workerAgent;
+	}
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	void deleteWorkerAgent( CAgent* workerAgent )
+	{
+		CAgentController* greedyPolicy = workerAgent->getController();
+		delete workerAgent;
+		delete greedyPolicy;
+	}
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	CAction* WorkerQStochasticPolicy::getNextAction( CStateCollection* state, CActionDataSet* dataSet, CActionStatistics* stat )
+	{
+		getActions()->getAvailableActions( availableActions, state );
+		assert( availableActions->size() > 0 );
+		
+		getActionProbabilities( state, availableActions, actionValues, dataSet );
+		
+		// sample the distribution like CStochasticPolicy::getNextAction
+		double sum = actionValues[0];
+		CActionSet::iterator it = availableActions->begin();
+		double z = (double) rand_r( _seed ) / (RAND_MAX);
+		unsigned int i = 0;
+		
+		while ( sum <= z && i < availableActions->size() - 1 )
+		{
+			i++;
+			it++;
+			sum += actionValues[i];
+		}
+		
+		if ( stat != NULL )
+		{
+			stat->owner = this;
+			getActionStatistics( state, (*it), stat );
+		}
+		
+		return *it;
+	}
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	AdaBoostMDPParallelSarsaTrainer::AdaBoostMDPParallelSarsaTrainer( CAgent* agent, AdaBoostMDPClassifierContinous* classifier, CAbstractQFunction* qFunction, CTDLearner* learner, double epsilon, int numThreads )
+	: _numThreads( numThreads )
+	{
+		// seeded from the global generator, so --seed fixes them too; the policies keep pointers into the vector
+		_workerSeeds.resize( _numThreads );
+		for( int t = 0; t < _numThreads; ++t )
+			_workerSeeds[t] = (unsigned int) rand();
+		
+		for( int t = 0; t < _numThreads; ++t )
+		{
+			AdaBoostMDPClassifierContinous* workerClassifier = classifier->clone();
+			CAgent* workerAgent = createWorkerAgent( agent, workerClassifier, qFunction );
+			
+			// replace the greedy policy by the exploring one
+			CAgentController* greedyPolicy = workerAgent->getController();
+			CActionDistribution* distribution = new CEpsilonGreedyDistribution( epsilon );
+			CAgentController* policy = new WorkerQStochasticPolicy( workerAgent->getActions(), distribution, qFunction, &_workerSeeds[t] );
+			workerAgent->setController( policy );
+			delete greedyPolicy;
+			
+			// own eligibility traces, shared Q-function
+			CSarsaLearner* workerLearner = new CSarsaLearner( workerClassifier, qFunction, workerAgent );
+			workerLearner->setParameters( learner );
+			workerAgent->addSemiMDPListener( workerLearner );
+			
+			_workerClassifiers.push_back( workerClassifier );
+			_workerAgents.push_back( workerAgent );
+			_workerPolicies.push_back( policy );
+			_workerDistributions.push_back( distribution );
+			_workerLearners.push_back( workerLearner );
+		}
+	}
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	AdaBoostMDPParallelSarsaTrainer::~AdaBoostMDPParallelSarsaTrainer()
+	{
+		for( int t = 0; t < _numThreads; ++t )
+		{
+			_workerAgents[t]->removeSemiMDPListener( _workerLearners[t] );
+			delete _workerLearners[t];
+			deleteWorkerAgent( _workerAgents[t] ); // deletes the policy too
+			delete _workerDistributions[t];
+			delete _workerClassifiers[t];
+		}
+	}
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	void AdaBoostMDPParallelSarsaTrainer::setEpsilon( double epsilon )
+	{
+		for( int t = 0; t < _numThreads; ++t )
+			_workerPolicies[t]->setParameter( "EpsilonGreedy", epsilon );
+	}
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	void AdaBoostMDPParallelSarsaTrainer::setLearnerParameter( string name, double value )
+	{
+		for( int t = 0; t < _numThreads; ++t )
+			_workerLearners[t]->setParameter( name, value );
+	}
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	void AdaBoostMDPParallelSarsaTrainer::runEpisodes( int numEpisodes, int maxSteps, int& usedClassifierNumber, int& numSucceeded )
+	{
+		vector<int> threadUsedClassifier( _numThreads, 0 );
+		vector<int> threadSucceeded( _numThreads, 0 );
+		
+#pragma omp parallel for num_threads(_numThreads) schedule(static,1)
+		for( int t = 0; t < _numThreads; ++t )
+		{
+			AdaBoostMDPClassifierContinous* workerClassifier = _workerClassifiers[t];
+			CAgent* workerAgent = _workerAgents[t];
+			
+			// the episodes are dealt round robin
+			for( int i = t; i < numEpisodes; i += _numThreads )
+			{
+				workerAgent->startNewEpisode();
+				workerClassifier->setRandomizedInstance( &_workerSeeds[t] );
+				workerAgent->doControllerEpisode( 1, maxSteps );
+				
+				threadUsedClassifier[t] += workerClassifier->getUsedClassifierNumber();
+				if ( workerClassifier->classifyCorrectly() ) threadSucceeded[t]++;
+			}
+		}
+		
+		for( int t = 0; t < _numThreads; ++t )
+		{
+			usedClassifierNumber += threadUsedClassifier[t];
+			numSucceeded += threadSucceeded[t];
+		}
+	}
 	// -----------------------------------------------------------------------
 	// -----------------------------------------------------------------------
 	// -----------------------------------------------------------------------
 	// -----------------------------------------------------------------------
 	
 	
-} // end of namespace MultiBoost
\ No newline at end of file
+} // end of namespace MultiBoost
@@ -34,11 +34,19 @@
 #include "cstate.h"
 #include "cstatemodifier.h"
 #include "clinearfafeaturecalculator.h"
+#include "cpolicies.h"
+#include "ctdlearner.h"
 //////////////////////////////////////////////////////////////////////
 // general includes
 //////////////////////////////////////////////////////////////////////
 #include "AdaBoostMDPClassifierAdv.h"
 
+#include <sstream>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 using namespace std;
 
 namespace MultiBoost {
@@ -48,6 +56,32 @@ namespace MultiBoost {
 		RT_EXP
 	};
 	
+	////////////////////////////////////////////////////////////////////////////////////////////////	
+	// per-thread accumulators of the evaluators, merged after the episodes
+	struct EvaluationCounters {
+		int correct;
+		int usedClassifier;
+		int posNum;
+		int correctP;
+		int negNum;
+		int correctN;
+		double reward;
+		
+		EvaluationCounters() : correct(0), usedClassifier(0), posNum(0), correctP(0), negNum(0), correctN(0), reward(0.0) {}
+		
+		EvaluationCounters& operator+=( const EvaluationCounters& other )
+		{
+			correct += other.correct;
+			usedClassifier += other.usedClassifier;
+			posNum += other.posNum;
+			correctP += other.correctP;
+			negNum += other.negNum;
+			correctN += other.correctN;
+			reward += other.reward;
+			return *this;
+		}
+	};
+	
 	////////////////////////////////////////////////////////////////////////////////////////////////	
 	////////////////////////////////////////////////////////////////////////////////////////////////	
 	////////////////////////////////////////////////////////////////////////////////////////////////
@@ -88,10 +122,15 @@ namespace MultiBoost {
 		
 		// contain the sum of alphas
 		double					_sumAlpha;
+		
+		// copy for the evaluation threads, it shares the properties and the data but does not open the output file
+		AdaBoostMDPClassifierContinous( const AdaBoostMDPClassifierContinous& other );
 	public:
 		// set randomzed element
 		void setCurrentRandomIsntace( int r ) { _currentRandomInstance = r; }		
 		void setRandomizedInstance() {_currentRandomInstance = (int) (rand() % _data->getNumExamples() ); }
+		// the same with a caller owned random state, for the worker threads (see rand_r)
+		void setRandomizedInstance( unsigned int* seed ) {_currentRandomInstance = (int) (rand_r( seed ) % _data->getNumExamples() ); }
 		
 		// getter setter
 		int getUsedClassifierNumber() { return _classifierNumber; }
@@ -99,6 +138,11 @@ namespace MultiBoost {
 		void setSkipReward( double r ) { _skipReward=r; }		
 		void setJumpReward( double r ) { _jumpReward=r; }
 		void setSuccessReward( double r ) { _successReward=r; }
+		double getClassificationReward() const { return _classificationReward; }
+		double getSkipReward() const { return _skipReward; }
+		double getJumpReward() const { return _jumpReward; }
+		double getSuccessReward() const { return _successReward; }
+		SuccesRewardModes getSuccessRewardMode() const { return _succRewardMode; }
 		
 		int getIterNum() { return _data->getIterationNumber(); };
 		int getNumClasses() { return _data->getClassNumber(); };
@@ -119,9 +163,13 @@ namespace MultiBoost {
 		// destructor
 		virtual	~AdaBoostMDPClassifierContinous() 
 		{
+			delete _exampleResult;
 			_outputStream.close();
 		}
 		
+		// environment of an evaluation thread
+		virtual AdaBoostMDPClassifierContinous* clone() const { return new AdaBoostMDPClassifierContinous( *this ); }
+		
 		///returns the reward for the transition, implements the CRewardFunction interface
 		virtual	double	getReward( CStateCollection	*oldState , CAction *action , CStateCollection *newState);
 		
@@ -142,106 +190,260 @@ namespace MultiBoost {
 	////////////////////////////////////////////////////////////////////////////////////////////////	
 	////////////////////////////////////////////////////////////////////////////////////////////////	
 	////////////////////////////////////////////////////////////////////////////////////////////////					
-	class AdaBoostMDPClassifierContinousEvaluator : public CRewardPerEpisodeCalculator
+	
+	// Creates an agent for an evaluation thread on its own environment. The actions, the state modifiers
+	// and the Q-function are shared with the given agent, the Q-function is only read by the greedy policy.
+	// The state modifiers must not use internal buffers (like RBFStateModifier).
+	CAgent* createWorkerAgent( CAgent* agent, CEnvironmentModel* environment, CAbstractQFunction* qFunction );
+	void deleteWorkerAgent( CAgent* workerAgent );
+	
+	////////////////////////////////////////////////////////////////////////////////////////////////	
+	////////////////////////////////////////////////////////////////////////////////////////////////	
+	////////////////////////////////////////////////////////////////////////////////////////////////					
+	// The evaluation loop shared by the evaluators of the MDDAG classifiers. It runs the episodes of the
+	// examples, on several threads when a Q-function is given, each of them evaluating a contiguous shard
+	// with an own agent and own counters, which are merged in the thread order. TClassifier is the
+	// environment, TEvaluator the evaluator deriving from this class, instantiated for every thread.
+	template <typename TClassifier, typename TEvaluator>
+	class AdaBoostMDPParallelEvaluator : public CRewardPerEpisodeCalculator
 	{
-	public:
-		AdaBoostMDPClassifierContinousEvaluator(CAgent *agent, CRewardFunction *rewardFunction) : CRewardPerEpisodeCalculator( agent, rewardFunction, 1000, 2000 )
+	protected:
+		CAbstractQFunction*		_qFunction; // shared by the evaluation threads
+		int						_numThreads;
+		
+		// the evaluator specific part of an example: updates the counters beyond the accuracy, the usage
+		// and the reward, and writes the label and the votes of the log line if output is not NULL
+		virtual void recordExample( TClassifier* classifier, bool clRes, EvaluationCounters& counters, ostream* output ) = 0;
+		
+		// runs the episodes of the examples [first,last) with the agent of this evaluator
+		void evaluateRange( int first, int last, EvaluationCounters& counters, vector<string>* logLines )
 		{
+			TClassifier* classifier = dynamic_cast<TClassifier*>(semiMDPRewardFunction);
+			vector<bool> currentHistory(0);
+			stringstream output;
+			
+			for (int i = first; i < last; i ++)
+			{
+				agent->startNewEpisode();				
+				classifier->setCurrentRandomIsntace(i);
+				agent->doControllerEpisode(1, classifier->getIterNum()*2 );
+				
+				bool clRes = classifier->classifyCorrectly();				
+				if (clRes ) counters.correct++;
+				
+				if ( logLines ) {
+					output.str("");
+					output << (clRes ? "1" : "0");
+					output << " ";
+				}
+				
+				recordExample( classifier, clRes, counters, logLines ? &output : NULL );
+				
+				counters.usedClassifier += classifier->getUsedClassifierNumber();
+				counters.reward += this->getEpisodeValue();
+				
+				if ( logLines ) {
+					classifier->getHistory( currentHistory );
+					for( int j=0; j<currentHistory.size(); ++j) 
+					{ 
+						if ( currentHistory[j] )
+							output << j+1 << " ";
+					}
+					
+					(*logLines)[i] = output.str();
+				}
+			}
 		}
 		
-		double classficationAccruacy( double& acc, double& usedClassifierAvg, const char* logFileName = NULL)
+		// shards the examples across the threads, each of them evaluates its shard with an own agent
+		void evaluateParallel( TClassifier* classifier, int numExamples, EvaluationCounters& counters, vector<string>* logLines )
 		{
-			double value = 0;
-			
-			agent->addSemiMDPListener(this);
+			vector<EvaluationCounters> threadCounters( _numThreads );
 			
-			CAgentController *tempController = NULL;
-			if (controller)
+#pragma omp parallel for num_threads(_numThreads) schedule(static,1)
+			for( int t = 0; t < _numThreads; ++t )
 			{
-				tempController = detController->getController();
-				detController->setController(controller);	
+				TClassifier* workerClassifier;
+				CAgent* workerAgent;
+				
+				// the registration of the state collections is not thread safe
+#pragma omp critical (mddag_worker_agents)
+				{
+					workerClassifier = classifier->clone();
+					workerAgent = createWorkerAgent( agent, workerClassifier, _qFunction );
+				}
+				
+				TEvaluator workerEvaluator( workerAgent, workerClassifier );
+				workerAgent->addSemiMDPListener( &workerEvaluator );
+				
+				const int first = (int)(((long)numExamples * t) / _numThreads);
+				const int last = (int)(((long)numExamples * (t+1)) / _numThreads);
+				workerEvaluator.evaluateRange( first, last, threadCounters[t], logLines );
+				
+#pragma omp critical (mddag_worker_agents)
+				{
+					deleteWorkerAgent( workerAgent );
+					delete workerClassifier;
+				}
 			}
 			
-			AdaBoostMDPClassifierContinous* classifier = dynamic_cast<AdaBoostMDPClassifierContinous*>(semiMDPRewardFunction);
+			for( int t = 0; t < _numThreads; ++t )
+				counters += threadCounters[t];
+		}
+		
+		// evaluates all the examples of the current data set, and writes the log lines if logFileName is given
+		void evaluate( TClassifier* classifier, EvaluationCounters& counters, const char* logFileName )
+		{
 			const int numTestExamples = classifier->getNumExamples();
-			const int numClasses = classifier->getNumClasses();
-			int  correct = 0, notcorrect = 0;
-			usedClassifierAvg=0;
-			
-			//ofstream output( logFileName );
-			
-			//cout << "Output classfication reult: " << logFileName << endl;
-			ofstream output;
-			vector<double> currentVotes(0);
-			vector<bool> currentHistory(0);
+			vector<string> logLines;
 			
 			if ( logFileName )
 			{
-				output.open( logFileName );			
+				logLines.resize( numTestExamples );
 				cout << "Output classfication reult: " << logFileName << endl;
 			}
 			
-			for (int i = 0; i < numTestExamples; i ++)
+			if ( _qFunction && _numThreads > 1 )
 			{
+				evaluateParallel( classifier, numTestExamples, counters, logFileName ? &logLines : NULL );
+			} else {
+				agent->addSemiMDPListener(this);
 				
+				CAgentController *tempController = NULL;
+				if (controller)
+				{
+					tempController = detController->getController();
+					detController->setController(controller);	
+				}
 				
-				//cout << i << endl;
-				agent->startNewEpisode();				
-				//cout << "Length of history: " << classifier->getLengthOfHistory() << endl;
-				classifier->setCurrentRandomIsntace(i);
-				agent->doControllerEpisode(1, classifier->getIterNum()*2 );
-				//cout << "Length of history: " << classifier->getLengthOfHistory() << endl;
-				
-				//cout << "Intance: " << i << '\t' << "Num of classifier: " << classifier->getUsedClassifierNumber() << endl;
-				bool clRes = classifier->classifyCorrectly();				
-				if (clRes ) correct++;
-				else notcorrect++;
+				evaluateRange( 0, numTestExamples, counters, logFileName ? &logLines : NULL );
 				
-				usedClassifierAvg += classifier->getUsedClassifierNumber();
-				value += this->getEpisodeValue();
+				agent->removeSemiMDPListener(this);
 				
-				//if ((i>10)&&((i%100)==0))
-				//	cout << i << " " << flush;
-				if ( logFileName ) {
-					output << (clRes ? "1" : "0");
-					output << " ";
-					
-					//output << (isNeg ? "1" : "2");
-					output << " ";
-					classifier->getCurrentExmapleResult( currentVotes );
-					classifier->getHistory( currentHistory );
-					for( int l=0; l<numClasses; ++l ) output << currentVotes[l] << " ";
-					//for( int i=0; i<currentHistory.size(); ++i) output << currentHistory[i] << " ";
-					for( int i=0; i<currentHistory.size(); ++i) 
-					{ 
-						if ( currentHistory[i] )
-							output << i+1 << " ";
-					}
-					
-					output << endl << flush;
+				if (tempController)
+				{
+					detController->setController(tempController);
 				}
-				
 			}
 			
 			cout << endl;
 			
-			value /= (double)numTestExamples ;
-			usedClassifierAvg /= (double)numTestExamples ;
-			acc = ((double)correct/(double)numTestExamples)*100.0;
+			if ( logFileName )
+			{
+				ofstream output( logFileName );
+				for (int i = 0; i < numTestExamples; i ++)
+					output << logLines[i] << endl;
+				output.close();
+			}
+		}
+		
+	public:
+		AdaBoostMDPParallelEvaluator(CAgent *agent, CRewardFunction *rewardFunction) : CRewardPerEpisodeCalculator( agent, rewardFunction, 1000, 2000 ), _qFunction(NULL), _numThreads(1)
+		{
+		}
+		
+		// evaluate the greedy policy of qFunction on numThreads threads
+		void setParallelEvaluation( CAbstractQFunction* qFunction, int numThreads )
+		{
+			_qFunction = qFunction;
+			_numThreads = numThreads;
+		}
+	};
+	
+	////////////////////////////////////////////////////////////////////////////////////////////////	
+	////////////////////////////////////////////////////////////////////////////////////////////////	
+	////////////////////////////////////////////////////////////////////////////////////////////////					
+	class AdaBoostMDPClassifierContinousEvaluator : public AdaBoostMDPParallelEvaluator<AdaBoostMDPClassifierContinous, AdaBoostMDPClassifierContinousEvaluator>
+	{
+	protected:
+		// the votes of all the classes go to the log line
+		virtual void recordExample( AdaBoostMDPClassifierContinous* classifier, bool /*clRes*/, EvaluationCounters& /*counters*/, ostream* output )
+		{
+			if ( output ) {
+				vector<double> currentVotes(0);
+				const int numClasses = classifier->getNumClasses();
+				
+				//output << (isNeg ? "1" : "2");
+				*output << " ";
+				classifier->getCurrentExmapleResult( currentVotes );
+				for( int l=0; l<numClasses; ++l ) *output << currentVotes[l] << " ";
+			}
+		}
+		
+	public:
+		AdaBoostMDPClassifierContinousEvaluator(CAgent *agent, CRewardFunction *rewardFunction) : AdaBoostMDPParallelEvaluator<AdaBoostMDPClassifierContinous, AdaBoostMDPClassifierContinousEvaluator>( agent, rewardFunction )
+		{
+		}
+		
+		double classficationAccruacy( double& acc, double& usedClassifierAvg, const char* logFileName = NULL)
+		{
+			double value = 0;
 			
-			//output.close();
-			if (logFileName) output.close();
+			AdaBoostMDPClassifierContinous* classifier = dynamic_cast<AdaBoostMDPClassifierContinous*>(semiMDPRewardFunction);
+			const int numTestExamples = classifier->getNumExamples();
 			
-			agent->removeSemiMDPListener(this);
+			EvaluationCounters counters;
+			evaluate( classifier, counters, logFileName );
 			
-			if (tempController)
-			{
-				detController->setController(tempController);
-			}
+			value = counters.reward / (double)numTestExamples ;
+			usedClassifierAvg = (double)counters.usedClassifier / (double)numTestExamples ;
+			acc = ((double)counters.correct/(double)numTestExamples)*100.0;
 			
 			return value;		
 		}
 	};
+	////////////////////////////////////////////////////////////////////////////////////////////////	
+	////////////////////////////////////////////////////////////////////////////////////////////////	
+	////////////////////////////////////////////////////////////////////////////////////////////////	
+	// CQStochasticPolicy draws its actions with the global rand(), which is locked and shared by all the
+	// threads. This one draws them with rand_r on a random state owned by the worker.
+	class WorkerQStochasticPolicy : public CQStochasticPolicy
+	{
+	protected:
+		unsigned int*	_seed;
+		
+	public:
+		WorkerQStochasticPolicy( CActionSet* actions, CActionDistribution* distribution, CAbstractQFunction* qFunction, unsigned int* seed )
+		: CQStochasticPolicy( actions, distribution, qFunction ), _seed( seed ) {}
+		
+		virtual CAction* getNextAction( CStateCollection* state, CActionDataSet* dataSet, CActionStatistics* stat );
+	};
+	
+	////////////////////////////////////////////////////////////////////////////////////////////////	
+	////////////////////////////////////////////////////////////////////////////////////////////////	
+	////////////////////////////////////////////////////////////////////////////////////////////////	
+	// Hogwild-style SARSA(lambda): the training episodes run on several threads, every worker has its own
+	// environment clone, agent, epsilon greedy policy and SARSA learner (with its own eligibility traces),
+	// and all of them update the shared Q-function without locks. A racing update may be lost, which the
+	// stochastic gradient steps tolerate. The Q-function and the state modifiers must be thread safe, that
+	// is ArrayBasedQFunctionBinary with RBFStateModifier. Every worker draws its random numbers from its own
+	// state, seeded from rand() at construction, so with a fixed --seed the instances and the explorations
+	// of a worker do not depend on the other threads.
+	class AdaBoostMDPParallelSarsaTrainer
+	{
+	protected:
+		int										_numThreads;
+		vector<unsigned int>					_workerSeeds; // the random states of the workers, for the instances and the exploration
+		vector<AdaBoostMDPClassifierContinous*>	_workerClassifiers;
+		vector<CAgent*>							_workerAgents;
+		vector<CAgentController*>				_workerPolicies;
+		vector<CActionDistribution*>			_workerDistributions;
+		vector<CSarsaLearner*>					_workerLearners;
+		
+	public:
+		// the parameters of the workers' learners are copied from learner
+		AdaBoostMDPParallelSarsaTrainer( CAgent* agent, AdaBoostMDPClassifierContinous* classifier, CAbstractQFunction* qFunction, CTDLearner* learner, double epsilon, int numThreads );
+		virtual ~AdaBoostMDPParallelSarsaTrainer();
+		
+		// the schedules stay global, they are set on every worker
+		void setEpsilon( double epsilon );
+		void setLearnerParameter( string name, double value );
+		
+		// runs numEpisodes episodes on random examples of the current data set, and adds the number of the used
+		// classifiers and the number of the correctly classified episodes to the counters
+		void runEpisodes( int numEpisodes, int maxSteps, int& usedClassifierNumber, int& numSucceeded );
+	};
+	
 	////////////////////////////////////////////////////////////////////////////////////////////////	
 	////////////////////////////////////////////////////////////////////////////////////////////////	
 	////////////////////////////////////////////////////////////////////////////////////////////////	
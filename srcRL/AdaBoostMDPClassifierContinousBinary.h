@@ -70,6 +70,9 @@ namespace MultiBoost {
 	public:
 		AdaBoostMDPClassifierContinousBinary( const nor_utils::Args& args, int verbose, DataReader* datareader);
 		virtual ~AdaBoostMDPClassifierContinousBinary() {}
+		AdaBoostMDPClassifierContinousBinary( const AdaBoostMDPClassifierContinousBinary& other ) : AdaBoostMDPClassifierContinous( other ) {}
+		
+		virtual AdaBoostMDPClassifierContinousBinary* clone() const { return new AdaBoostMDPClassifierContinousBinary( *this ); }
 		
 		double getReward(CStateCollection *oldState, CAction *action, CStateCollection *newState);
 		
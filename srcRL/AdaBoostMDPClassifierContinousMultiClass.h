@@ -57,6 +57,9 @@ namespace MultiBoost {
 	public:
 		AdaBoostMDPClassifierContinousMH( const nor_utils::Args& args, int verbose, DataReader* datareader, int classNum);
 		virtual ~AdaBoostMDPClassifierContinousMH() {}				
+		AdaBoostMDPClassifierContinousMH( const AdaBoostMDPClassifierContinousMH& other ) : AdaBoostMDPClassifierContinous( other ) {}
+		
+		virtual AdaBoostMDPClassifierContinousMH* clone() const { return new AdaBoostMDPClassifierContinousMH( *this ); }
 			
 		double getReward(CStateCollection *oldState, CAction *action, CStateCollection *newState);
 		
@@ -28,7 +28,9 @@ namespace MultiBoost {
 		// set the dim of state space
 		properties->setDiscreteStateSize(0,datareader->getIterationNumber()+1);		
 		
-		_exampleResult = NULL;
+		// the vote buffer and the history are reset in place at every episode
+		_exampleResult = new ExampleResults( 0, _classNum );
+		_classifierUsed.resize( datareader->getIterationNumber() );
 		
 		// open result file
 		string tmpFname = _args.getValue<string>("traintestmdp", 4);			
@@ -92,8 +94,8 @@ namespace MultiBoost {
 		_classifierNumber = 0;				
 		_currentSumAlpha = 0.0;
 		
-		if (_exampleResult==NULL) delete _exampleResult;
-		_exampleResult = new ExampleResults(_currentRandomInstance,_classNum);		
+		vector<AlphaReal>& currVotesVector = _exampleResult->getVotesVector();
+		fill( currVotesVector.begin(), currVotesVector.end(), 0.0 );
 		
 		fill( _classifierUsed.begin(), _classifierUsed.end(), false );
 				
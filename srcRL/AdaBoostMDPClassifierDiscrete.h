@@ -113,6 +113,7 @@ namespace MultiBoost {
 		// destructor
 		virtual	~AdaBoostMDPClassifierDiscrete() 
 		{
+			delete _exampleResult;
 			_outputStream.close();
 		}
 		
@@ -149,115 +150,51 @@ namespace MultiBoost {
 	
 	
 	template <typename T>
-	class AdaBoostMDPBinaryDiscreteEvaluator : public CRewardPerEpisodeCalculator
+	class AdaBoostMDPBinaryDiscreteEvaluator : public AdaBoostMDPParallelEvaluator<T, AdaBoostMDPBinaryDiscreteEvaluator<T> >
 	{
+	protected:
+		// the examples of the first class are the negatives, the log line gets the class and the first vote
+		virtual void recordExample( T* classifier, bool clRes, EvaluationCounters& counters, ostream* output )
+		{
+			bool isNeg = classifier->hasithLabelCurrentElement(0);
+			if (isNeg) // neg
+			{
+				counters.negNum++;
+				if (clRes ) counters.correctN++;					
+			} else {
+				counters.posNum++;
+				if (clRes ) counters.correctP++;			
+			}
+			
+			if ( output ) {
+				vector<double> currentVotes(0);
+				
+				*output << (isNeg ? "1" : "2");
+				*output << " ";
+				classifier->getCurrentExmapleResult( currentVotes );
+				*output << currentVotes[0] << " ";
+			}
+		}
+		
 	public:
-		AdaBoostMDPBinaryDiscreteEvaluator(CAgent *agent, CRewardFunction *rewardFunction ) : CRewardPerEpisodeCalculator( agent, rewardFunction, 1000, 2000 )
+		AdaBoostMDPBinaryDiscreteEvaluator(CAgent *agent, CRewardFunction *rewardFunction ) : AdaBoostMDPParallelEvaluator<T, AdaBoostMDPBinaryDiscreteEvaluator<T> >( agent, rewardFunction )
 		{
 		}
 		
 		void classficationAccruacy( BinaryResultStruct& binRes, const char* logFileName = NULL )
 		{
-			double value = 0.0;
-			
-			agent->addSemiMDPListener(this);
-			
-			CAgentController *tempController = NULL;
-			if (controller)
-			{
-				tempController = detController->getController();
-				detController->setController(controller);	
-			}
-			
-			T* classifier = dynamic_cast<T*>(semiMDPRewardFunction);
+			T* classifier = dynamic_cast<T*>(this->semiMDPRewardFunction);
 			const int numTestExamples = classifier->getNumExamples();
-			int  correct = 0, notcorrect = 0;
-			int usedClassifierAvg=0;
-			int correctP=0;
-			int posNum=0;
-			int correctN=0;
-			int negNum=0;
-			ofstream output;
-			vector<double> currentVotes(0);
-			vector<bool> currentHistory(0);
 			
-			if ( logFileName )
-			{
-				output.open( logFileName );			
-				cout << "Output classfication reult: " << logFileName << endl;
-			}
+			EvaluationCounters counters;
+			this->evaluate( classifier, counters, logFileName );
 			
-			for (int i = 0; i < numTestExamples; i ++)
-			{
-				
-				//cout << i << endl;
-				agent->startNewEpisode();				
-				//cout << "Length of history: " << classifier->getLengthOfHistory() << endl;
-				classifier->setCurrentRandomIsntace(i);
-				agent->doControllerEpisode(1, classifier->getIterNum()*2 );
-				//cout << "Length of history: " << classifier->getLengthOfHistory() << endl;
-				
-				//cout << "Intance: " << i << '\t' << "Num of classifier: " << classifier->getUsedClassifierNumber() << endl;
-				bool clRes = classifier->classifyCorrectly();				
-				if (clRes ) correct++;
-				else notcorrect++;
-				bool isNeg = classifier->hasithLabelCurrentElement(0);
-				if (isNeg) // neg
-				{
-					negNum++;
-					if (clRes ) correctN++;					
-				} else {
-					posNum++;
-					if (clRes ) correctP++;			
-				}
-				
-				
-				usedClassifierAvg += classifier->getUsedClassifierNumber();
-				value += this->getEpisodeValue();
-				
-				
-				if ( logFileName ) {
-					output << (clRes ? "1" : "0");
-					output << " ";					
-					output << (isNeg ? "1" : "2");
-					output << " ";
-					classifier->getCurrentExmapleResult( currentVotes );
-					classifier->getHistory( currentHistory );
-					output << currentVotes[0] << " ";
-					//for( int i=0; i<currentHistory.size(); ++i) output << currentHistory[i] << " ";
-					for( int i=0; i<currentHistory.size(); ++i) 
-					{ 
-						if ( currentHistory[i] )
-							output << i+1 << " ";
-					}
-					
-					output << endl << flush;
-				}
-				
-				//if ((i>10)&&((i%100)==0))
-				//	cout << i << " " << flush;
-				
-			}
-			
-			cout << endl;
-			
-			binRes.avgReward = value/(double)numTestExamples ;
-			binRes.usedClassifierAvg = (double)usedClassifierAvg/(double)numTestExamples ;
-			binRes.acc = ((double)correct/(double)numTestExamples)*100.0;
-			
-			binRes.TP = (double)correctP/(double)posNum;
-			binRes.TN = (double)correctN/(double)negNum;
-			
-			//cout << posNum << " " << negNum << endl << flush;
-			if (logFileName) output.close();
-			
-			agent->removeSemiMDPListener(this);
-			
-			if (tempController)
-			{
-				detController->setController(tempController);
-			}
+			binRes.avgReward = counters.reward/(double)numTestExamples ;
+			binRes.usedClassifierAvg = (double)counters.usedClassifier/(double)numTestExamples ;
+			binRes.acc = ((double)counters.correct/(double)numTestExamples)*100.0;
 			
+			binRes.TP = (double)counters.correctP/(double)counters.posNum;
+			binRes.TN = (double)counters.correctN/(double)counters.negNum;
 		}
 	};
 			
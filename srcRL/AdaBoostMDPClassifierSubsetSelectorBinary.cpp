@@ -31,8 +31,6 @@ namespace MultiBoost {
 		//properties->setMinValue(0, -1.0); // not needed
 		//properties->setMaxValue(0,  1.0);
 		
-		_exampleResult = NULL;
-		
 		// set the dim of state space
 		properties->setDiscreteStateSize(0,datareader->getIterationNumber()+1);		
 		
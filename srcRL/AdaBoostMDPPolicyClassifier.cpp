@@ -0,0 +1,186 @@
+/*
+ *  AdaBoostMDPPolicyClassifier.cpp
+ *  RLTools
+ *
+ *  Greedy MDDAG classification with a trained Q-function, without CAgent.
+ *
+ */
+
+#include "AdaBoostMDPPolicyClassifier.h"
+#include "AdaBoostMDPBatchEnvironment.h"
+
+#include "cstate.h"
+
+using namespace std;
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace MultiBoost {
+
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	FeatureQFunctionGreedyPolicy::FeatureQFunctionGreedyPolicy( CFeatureQFunction* qFunction, CStateModifier* stateModifier, CStateProperties* modelProperties, CActionSet* actions, int stateDimension )
+	: _qFunction( qFunction ), _stateDimension( stateDimension )
+	{
+		_stateCollection = new CStateCollectionImpl( modelProperties );
+		_stateCollection->addStateModifier( stateModifier );
+
+		_actions.resize( 3, NULL );
+		for (CActionSet::iterator it = actions->begin(); it != actions->end(); ++it)
+		{
+			int mode = dynamic_cast<CAdaBoostAction*>(*it)->getMode();
+			_actions[mode] = *it;
+		}
+	}
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	FeatureQFunctionGreedyPolicy::~FeatureQFunctionGreedyPolicy()
+	{
+		delete _stateCollection;
+	}
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	int FeatureQFunctionGreedyPolicy::getGreedyMode( int iteration, vector<double>& margins )
+	{
+		CState* state = _stateCollection->getState();
+		state->resetState();
+		state->setDiscreteState( 0, iteration );
+		for( int i = 0; i < _stateDimension; ++i )
+			state->setContinuousState( i, margins[i] );
+		_stateCollection->newModelState();
+
+		// CFeatureQFunction hides the state collection interface
+		CAbstractQFunction* qFunction = _qFunction;
+		
+		int bestMode = 0;
+		double bestValue = qFunction->getValue( _stateCollection, _actions[0] );
+		for( int mode = 1; mode < 3; ++mode )
+		{
+			double value = qFunction->getValue( _stateCollection, _actions[mode] );
+			if ( bestValue < value )
+			{
+				bestValue = value;
+				bestMode = mode;
+			}
+		}
+		return bestMode;
+	}
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	AdaBoostMDPPolicyClassifier::AdaBoostMDPPolicyClassifier( DataReader* datareader, MDDAGGreedyPolicy* policy )
+	: _data( datareader ), _policy( policy )
+	{
+		_sumAlpha = _data->getSumOfAlphas();
+		_margins.resize( _policy->getStateDimension() );
+	}
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	int AdaBoostMDPPolicyClassifier::classify( const int instance, vector<AlphaReal>& votes )
+	{
+		const int numIterations = _data->getIterationNumber();
+		const int stateDimension = _margins.size();
+		int numEvaluated = 0;
+
+		fill( votes.begin(), votes.end(), 0.0 );
+
+		int currentClassifier = 0;
+		while ( currentClassifier < numIterations )
+		{
+			for( int i = 0; i < stateDimension; ++i )
+				_margins[i] = ((votes[i] / _sumAlpha) + 1) / 2.0; // rescale between [0,1]
+
+			int mode = _policy->getGreedyMode( currentClassifier, _margins );
+
+			if ( mode == 0 ) // skip
+			{
+				currentClassifier++;
+			}
+			else if ( mode == 1 ) // classify
+			{
+				_data->classifyKthWeakLearner( currentClassifier, instance, votes );
+				numEvaluated++;
+				currentClassifier++;
+			}
+			else // jump to end
+			{
+				break;
+			}
+		}
+
+		return numEvaluated;
+	}
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	void AdaBoostMDPPolicyClassifier::classifyBatch( const int first, const int last, vector<AlphaReal>& votes, vector<int>& numEvaluated )
+	{
+		const int numClasses = _data->getClassNumber();
+		const int batchSize = 256;
+
+		votes.resize( (last - first) * numClasses );
+		numEvaluated.resize( last - first );
+
+		// the episodes of a chunk are stepped together, so the policy is asked once per step for the whole chunk
+		AdaBoostMDPBatchEnvironment environment( _data, batchSize );
+		vector<int> instances( batchSize );
+
+		for( int chunkBegin = first; chunkBegin < last; chunkBegin += batchSize )
+		{
+			const int chunkSize = min( batchSize, last - chunkBegin );
+			for( int b = 0; b < chunkSize; ++b )
+				instances[b] = chunkBegin + b;
+
+			environment.reset( &instances[0], chunkSize );
+			environment.runGreedyEpisodes( _policy );
+
+			const AlphaReal* chunkVotes = environment.getVotes();
+			copy( chunkVotes, chunkVotes + chunkSize * numClasses, votes.begin() + (chunkBegin - first) * numClasses );
+
+			const int* chunkEvaluated = environment.getUsedClassifierNumbers();
+			copy( chunkEvaluated, chunkEvaluated + chunkSize, numEvaluated.begin() + (chunkBegin - first) );
+		}
+	}
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	double AdaBoostMDPPolicyClassifier::getAccuracyOnCurrentDataSet( double& usedClassifierAvg )
+	{
+		const int numExamples = _data->getNumExamples();
+		const int numClasses = _data->getClassNumber();
+		vector<AlphaReal> votes;
+		vector<int> numEvaluated;
+		vector<AlphaReal> currVotes( numClasses );
+
+		classifyBatch( 0, numExamples, votes, numEvaluated );
+
+		int correct = 0;
+		int usedClassifier = 0;
+
+		for( int i = 0; i < numExamples; ++i )
+		{
+			copy( votes.begin() + i * numClasses, votes.begin() + (i + 1) * numClasses, currVotes.begin() );
+			usedClassifier += numEvaluated[i];
+			if ( _data->currentClassifyingResult( i, currVotes ) )
+				correct++;
+		}
+
+		usedClassifierAvg = (double)usedClassifier / (double)numExamples;
+		return ((double)correct / (double)numExamples) * 100.0;
+	}
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	void compileCascade( MDDAGGreedyPolicy* policy, MDDAGCascade& cascade )
+	{
+		assert( policy->getStateDimension() == cascade.getStateDimension() );
+
+		vector<double> margins;
+		for( int k = 0; k < cascade.getIterationNumber(); ++k )
+		{
+			for( int cell = 0; cell < cascade.getCellNumber(); ++cell )
+			{
+				cascade.getCellCenter( cell, margins );
+				cascade.setMode( k, cell, policy->getGreedyMode( k, margins ) );
+			}
+		}
+	}
+
+} // end of namespace MultiBoost
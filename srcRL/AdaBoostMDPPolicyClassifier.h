@@ -0,0 +1,170 @@
+/*
+ *  AdaBoostMDPPolicyClassifier.h
+ *  RLTools
+ *
+ *  Greedy MDDAG classification with a trained Q-function, without CAgent.
+ *
+ */
+
+#ifndef __ADABOOST_MDP_POLICY_CLASSIFIER_H
+#define __ADABOOST_MDP_POLICY_CLASSIFIER_H
+
+//////////////////////////////////////////////////////////////////////
+// for RL toolbox
+//////////////////////////////////////////////////////////////////////
+#include "cqfunction.h"
+#include "cstatecollection.h"
+#include "cstatemodifier.h"
+//////////////////////////////////////////////////////////////////////
+// general includes
+//////////////////////////////////////////////////////////////////////
+#include "AdaBoostMDPClassifierAdv.h"
+#include "ArrayBasedQFunctionBinary.h"
+#include "MDDAGCascade.h"
+
+#include <vector>
+
+using namespace std;
+
+namespace MultiBoost {
+
+	////////////////////////////////////////////////////////////////////////////////////////////////
+	////////////////////////////////////////////////////////////////////////////////////////////////
+	////////////////////////////////////////////////////////////////////////////////////////////////
+	// The greedy action of a trained Q-function in the raw MDDAG state, that is the index of the
+	// next weak classifier and the rescaled margins ((f_l(x)/sumAlpha)+1)/2.
+	// The returned action is the mode of CAdaBoostAction (0 skip, 1 classify, 2 jump to the end).
+	class MDDAGGreedyPolicy
+	{
+	public:
+		virtual ~MDDAGGreedyPolicy() {}
+
+		virtual int getGreedyMode( int iteration, vector<double>& margins ) = 0;
+
+		// greedy modes of a batch of states, margins holds getStateDimension() values per state
+		virtual void getGreedyModes( int numStates, const int* iterations, const double* margins, int* modes )
+		{
+			const int stateDimension = getStateDimension();
+			vector<double> currMargins( stateDimension );
+			for( int b = 0; b < numStates; ++b )
+			{
+				copy( margins + b * stateDimension, margins + (b + 1) * stateDimension, currMargins.begin() );
+				modes[b] = getGreedyMode( iterations[b], currMargins );
+			}
+		}
+
+		// the number of margins in the state
+		virtual int getStateDimension() = 0;
+	};
+
+	////////////////////////////////////////////////////////////////////////////////////////////////
+	////////////////////////////////////////////////////////////////////////////////////////////////
+	////////////////////////////////////////////////////////////////////////////////////////////////
+	template <typename T>
+	class ArrayBasedGreedyPolicy : public MDDAGGreedyPolicy
+	{
+	protected:
+		ArrayBasedQFunctionBinary<T>*	_qFunction;
+		vector<double>					_values; // buffers of getGreedyModes
+		vector<double>					_bestValues;
+
+	public:
+		ArrayBasedGreedyPolicy( ArrayBasedQFunctionBinary<T>* qFunction ) : _qFunction( qFunction ) {}
+		virtual ~ArrayBasedGreedyPolicy() {}
+
+		virtual int getGreedyMode( int iteration, vector<double>& margins )
+		{
+			// the first maximum wins, like in CAbstractQFunction::getMax
+			int bestMode = 0;
+			double bestValue = _qFunction->getValue( 0, iteration, margins );
+			for( int mode = 1; mode < 3; ++mode )
+			{
+				double value = _qFunction->getValue( mode, iteration, margins );
+				if ( bestValue < value )
+				{
+					bestValue = value;
+					bestMode = mode;
+				}
+			}
+			return bestMode;
+		}
+
+		// one pass over the batch per action instead of three virtual calls per state
+		virtual void getGreedyModes( int numStates, const int* iterations, const double* margins, int* modes )
+		{
+			_values.resize( numStates );
+			_bestValues.resize( numStates );
+
+			_qFunction->getValues( 0, numStates, iterations, margins, &_bestValues[0] );
+			fill( modes, modes + numStates, 0 );
+			for( int mode = 1; mode < 3; ++mode )
+			{
+				_qFunction->getValues( mode, numStates, iterations, margins, &_values[0] );
+				for( int b = 0; b < numStates; ++b )
+				{
+					if ( _bestValues[b] < _values[b] )
+					{
+						_bestValues[b] = _values[b];
+						modes[b] = mode;
+					}
+				}
+			}
+		}
+
+		virtual int getStateDimension() { return _qFunction->getDimension(); }
+	};
+
+	////////////////////////////////////////////////////////////////////////////////////////////////
+	////////////////////////////////////////////////////////////////////////////////////////////////
+	////////////////////////////////////////////////////////////////////////////////////////////////
+	// Feature (table or RBF network) Q-functions need the features of their state modifier, so this
+	// policy keeps a single state collection which is refilled at every query.
+	class FeatureQFunctionGreedyPolicy : public MDDAGGreedyPolicy
+	{
+	protected:
+		CFeatureQFunction*		_qFunction;
+		CStateCollectionImpl*	_stateCollection;
+		vector<CAction*>		_actions; // indexed by mode
+		int						_stateDimension;
+
+	public:
+		FeatureQFunctionGreedyPolicy( CFeatureQFunction* qFunction, CStateModifier* stateModifier, CStateProperties* modelProperties, CActionSet* actions, int stateDimension );
+		virtual ~FeatureQFunctionGreedyPolicy();
+
+		virtual int getGreedyMode( int iteration, vector<double>& margins );
+		virtual int getStateDimension() { return _stateDimension; }
+	};
+
+	////////////////////////////////////////////////////////////////////////////////////////////////
+	////////////////////////////////////////////////////////////////////////////////////////////////
+	////////////////////////////////////////////////////////////////////////////////////////////////
+	// Runs the greedy episodes in a tight loop over a batch of examples of the current data set of
+	// the DataReader. The weak classifiers are evaluated only when the policy asks for it.
+	class AdaBoostMDPPolicyClassifier
+	{
+	protected:
+		DataReader*				_data;
+		MDDAGGreedyPolicy*		_policy;
+		double					_sumAlpha;
+
+		vector<double>			_margins; // buffer of the state
+
+	public:
+		AdaBoostMDPPolicyClassifier( DataReader* datareader, MDDAGGreedyPolicy* policy );
+
+		// classifies the example and returns the number of the evaluated weak classifiers, votes must have numClasses elements
+		int classify( const int instance, vector<AlphaReal>& votes );
+
+		// classifies the examples [first,last) in batches (see AdaBoostMDPBatchEnvironment), votes is filled row-wise (numClasses values per example)
+		void classifyBatch( const int first, const int last, vector<AlphaReal>& votes, vector<int>& numEvaluated );
+
+		// accuracy (in percent) and the average number of evaluated weak classifiers on the current data set
+		double getAccuracyOnCurrentDataSet( double& usedClassifierAvg );
+	};
+
+	// fills the cascade with the greedy mode of the policy in the center of every cell of the margin grid
+	void compileCascade( MDDAGGreedyPolicy* policy, MDDAGCascade& cascade );
+
+} // end of namespace MultiBoost
+
+#endif // __ADABOOST_MDP_POLICY_CLASSIFIER_H
@@ -17,33 +17,39 @@
 #include "AdaBoostMDPClassifierAdv.h"
 #include "ArrayBasedQFunctionBinary.h"
 #include <vector>
-#include <list>
 
 //class RBFBasedQFunctionBinary;
 using namespace std;
 
-typedef vector<vector<double> > OneIterETrace;
-typedef list<OneIterETrace > CustomETrace;
-typedef CustomETrace::iterator ETIterator;
-typedef CustomETrace::reverse_iterator ETReverseIterator;
-
-
-
+// The traces are kept in flat buffers which are reused in the following episodes, so adding and
+// updating the traces doesn't allocate once the buffers have reached the length of an episode.
 template< typename T >
 class ArrayBasedQETraces : public CAbstractQETraces 
 {
 protected:
-	list<double> _margins;
-	list<int>	 _iters;
+	ArrayBasedQFunctionBinary<T>* _arrayQFunction;
 	
-	list<CAction*> _actions;
-    CustomETrace _eTraces; //strange ETrace struture, due to our peculiar state representation
-	CStateCollection* _currentState;
+	int				_gradientSize; // the size of one trace
+	int				_numETraces;
+	
+	vector<int>		_actionModes;
+	vector<int>		_iters;
+    vector<double>	_eTraces; // the j-th trace is at _eTraces[j*_gradientSize], strange ETrace struture, due to our peculiar state representation
 public:
 	
 	// constructor
 	ArrayBasedQETraces(CAbstractQFunction *qFunction) : CAbstractQETraces(qFunction) {
         addParameter("ETraceTreshold", 0.001);
+		
+		_arrayQFunction = dynamic_cast<ArrayBasedQFunctionBinary<T>* >(qFunction);
+		_gradientSize = _arrayQFunction->getGradientSize();
+		_numETraces = 0;
+		
+		// an episode visits every iteration at most once
+		const int maxEpisodeLength = _arrayQFunction->getNumberOfIterations() + 1;
+		_actionModes.resize( maxEpisodeLength );
+		_iters.resize( maxEpisodeLength );
+		_eTraces.resize( maxEpisodeLength * _gradientSize );
     }
 	virtual ~ArrayBasedQETraces() {};
 	
@@ -51,10 +57,8 @@ public:
 	/// Interface function for reseting the ETraces
 	virtual void resetETraces()
 	{
-		_actions.clear();        
-		_eTraces.clear();
-		_iters.clear();
-		_margins.clear();
+		// the buffers are kept for the next episode
+		_numETraces = 0;
 		
 #ifdef RBFDEB		
 		cout << "------------------------------------------------" << endl;
@@ -70,99 +74,48 @@ public:
 	virtual void updateETraces(CAction *action, CActionData *data = NULL)
 	{
 		double mult = getParameter("Lambda") * getParameter("DiscountFactor");
-		ETIterator eIt = _eTraces.begin();
-		
-		list<CAction*>::iterator actionIt = _actions.begin();
-		
-		list<double>::iterator itMargin = _margins.begin();
-		list<int>::iterator itIters = _iters.begin();		
-		
-		// later should be done for acceleratiung the E-trace update
-		double treshold = getParameter("ETraceTreshold");
-		int i = 0;
 		
-		while (eIt != _eTraces.end())
-		{
-			OneIterETrace & oneItEtrace = *eIt;
-			//OneIterETrace gradient;
-			
-			//dynamic_cast<ArrayBasedQFunctionBinary<T>* >(qFunction)->getGradient(*itMargin, *itIters, *actionIt, gradient);
-			
-			for (int j = 0; j < oneItEtrace.size(); ++j) {
-				for (int k = 0; k < oneItEtrace[j].size(); ++k) {
-					oneItEtrace[j][k] = oneItEtrace[j][k] * mult ;
-					//oneItEtrace[j][k] +=  gradient[j][k];
-				}
-			}
-			
-			++eIt;
-			++actionIt;
-			++itMargin;
-			++itIters;
-		}
+		const int numValues = _numETraces * _gradientSize;
+		for (int j = 0; j < numValues; ++j)
+			_eTraces[j] *= mult;
 	}
 	
 	
 	/// Interface function for adding a State-Action pair with the given factor to the ETraces
 	virtual void addETrace(CStateCollection *state, CAction *action, double factor = 1.0, CActionData *data = NULL)
 	{
-		_currentState = state;
-		_actions.push_back( action );
-		
-		OneIterETrace gradient;
-		dynamic_cast<ArrayBasedQFunctionBinary<T>* >(qFunction)->getGradient(state, action, gradient);
+		if ( _numETraces == (int)_iters.size() )
+		{
+			_actionModes.resize( 2 * _numETraces );
+			_iters.resize( 2 * _numETraces );
+			_eTraces.resize( 2 * _numETraces * _gradientSize );
+		}
 		
-		_eTraces.push_back(gradient);
+		_arrayQFunction->getGradient(state, action, &_eTraces[_numETraces * _gradientSize]);
 		
-		CState* currState = state->getState();
-		int currIter = currState->getDiscreteState(0);
-		_iters.push_back(currIter);
-		double margin = currState->getContinuousState(0);
-		_margins.push_back(margin);		
+		_actionModes[_numETraces] = dynamic_cast<MultiBoost::CAdaBoostAction* >(action)->getMode();
+		_iters[_numETraces] = state->getState()->getDiscreteState(0);
+		_numETraces++;
 	}
 	
 	/// Interface function for updating the Q-Values of all State-Action Pairs in the ETraces
 	virtual void updateQFunction(double td)
 	{		
-		list<CAction*>::iterator invitAction = _actions.begin();
-		ETIterator invitTrace = _eTraces.begin();
-		
-		list<double>::iterator itMargin = _margins.begin();
-		list<int>::iterator itIters = _iters.begin();		
-		
 #ifdef RBFDEB				
-		int index = dynamic_cast<MultiBoost::CAdaBoostAction* >(*(_actions.rbegin()))->getMode();
-		cout << "Action: " << index << " TD " << td << endl;
+		cout << "Action: " << _actionModes[_numETraces-1] << " TD " << td << endl;
 #endif
 		
-		for (; itMargin != _margins.end(); ++itMargin, ++itIters, ++invitAction, ++invitTrace)
+		for (int j = 0; j < _numETraces; ++j)
 		{
-			CAction* currentAction = *invitAction;
-			OneIterETrace& currentETrace = *invitTrace;
-			
-			
-			double currMargin = *itMargin;
-			int currIter = *itIters;
-			
-			CState* artificialState = _currentState->getState()->clone();
-			artificialState->setContinuousState(0, currMargin);
-			artificialState->setDiscreteState(0, currIter);
-			
-#ifdef RBFDEB					
-			cout << "(A:" << dynamic_cast<MultiBoost::CAdaBoostAction* >(*(invitAction))->getMode() << "," << flush; 
-			cout << "M: " << currMargin << ",";
-			cout << "I: " << currIter << ",";
-			cout << "O:" << dynamic_cast<ArrayBasedQFunctionBinary<T>** >(qFunction)->getValue(artificialState, currentAction)<< "," << flush;
-#endif			
-			dynamic_cast<ArrayBasedQFunctionBinary<T>* >(qFunction)->updateValue(artificialState, currentAction, td, currentETrace);
 #ifdef RBFDEB					
-			cout << "N:" << dynamic_cast<ArrayBasedQFunctionBinary<T>** >(qFunction)->getValue(artificialState, currentAction) << ")" << endl << flush;
+			cout << "(A:" << _actionModes[j] << ",";
+			cout << "I: " << _iters[j] << ")" << endl;
 #endif			
-			delete artificialState;
+			_arrayQFunction->updateValue(_actionModes[j], _iters[j], td, &_eTraces[j * _gradientSize]);
 		}
 #ifdef RBFDEB				
 		cout << endl;
-		if (index==2) cout << "End of episode" << endl;
+		if (_actionModes[_numETraces-1]==2) cout << "End of episode" << endl;
 #endif		
 	}
 	
@@ -24,6 +24,8 @@ using namespace std;
 
 //-----------------------------------------------------------------------------------------------
 //-----------------------------------------------------------------------------------------------
+// The static kernels (activation, gradient) are used by the RBF arrays below, which keep the
+// parameters of all centers in flat arrays and don't store RBF objects.
 class RBF {
 protected:
 	double _mean;
@@ -33,49 +35,51 @@ protected:
 public:
 	RBF() : _mean(0), _sigma(0), _alpha(0) {}
 	virtual ~RBF() {}
-	
+
+	static inline double activation( double x, double mean, double sigma )
+	{
+		return exp( - (( x-mean )*( x-mean ))/(2*sigma*sigma));
+	}
+
+	static inline void activationGradient( double x, double mean, double sigma, double alpha, double& alphaGrad, double& meanGrad, double& sigmaGrad )
+	{
+		double diff = x - mean;
+		double rbfValue = activation( x, mean, sigma );
+
+		alphaGrad = rbfValue;
+		meanGrad = rbfValue * alpha * diff / (sigma*sigma);
+		sigmaGrad = rbfValue * alpha * diff * diff / (sigma*sigma*sigma);
+	}
+
 	virtual double getMean() { return _mean; }
 	virtual double getSigma() { return _sigma; }
 	virtual double getAlpha() { return _alpha; }
-	
+
 	virtual void setMean( double m ) { _mean=m; }
 	virtual void setSigma( double s ) { _sigma = s; }
 	virtual void setAlpha( double a ) { _alpha = a; }
-	
+
 	virtual void addMean( double m ) { _mean += m; }
 	virtual void addSigma( double s ) { _sigma += s; }
-	virtual void addAlpha( double a ) { _alpha += a; }	
+	virtual void addAlpha( double a ) { _alpha += a; }
 
-	virtual double getValue( vector<double>& x ) const { return getValue(x[0]); }	
+	virtual double getValue( vector<double>& x ) const { return getValue(x[0]); }
 	virtual double getValue( double x ) const
-	{ 
+	{
 		double retVal = _alpha * getActivationFactor(x);
 		return retVal;
 	}
-    
+
 	virtual double getActivationFactor( vector<double>&  x ) const { return getActivationFactor(x[0]); }
-    virtual double getActivationFactor( double x ) const
-	{ 
-		double retVal = exp( - (( x-_mean )*( x-_mean ))/(2*_sigma*_sigma));
-		return retVal;
-	}
-    
+    virtual double getActivationFactor( double x ) const { return activation( x, _mean, _sigma ); }
+
 	virtual string& getID() { return _ID;}
 	virtual void setID( const string ID ) { _ID = ID; }
-	
+
 	virtual void getGradient( double x, vector<double>& gradient )
-	{		
-		double diff = x - _mean;
-		double rbfValue = this->getActivationFactor(x);
-		
-		double alphaGrad = rbfValue;
-		double meanGrad = rbfValue * _alpha * diff / (_sigma*_sigma);
-		double sigmaGrad = rbfValue * _alpha * diff * diff / (_sigma*_sigma*_sigma);        
-		
+	{
 		gradient.resize(3);
-		gradient[0] = alphaGrad;
-		gradient[1] = meanGrad;
-		gradient[2] = sigmaGrad;						
+		activationGradient( x, _mean, _sigma, _alpha, gradient[0], gradient[1], gradient[2] );
 	}
 };
 //-----------------------------------------------------------------------------------------------
@@ -86,42 +90,46 @@ protected:
 	vector<double> _mean;
 	vector<double> _sigma;
 	double _alpha;
-	string _ID;	
-public:	
+	string _ID;
+public:
 	MultiDimRBFSingleSigma() : _mean(0), _sigma(0), _alpha(0) {}
 	virtual ~MultiDimRBFSingleSigma() {}
-	
-	virtual vector<double>& getMean() { return _mean; }
-	virtual vector<double>& getSigma() { return _sigma; }
-	virtual double getAlpha() { return _alpha; }
-	
-	virtual void setMean( vector<double>& m ) 
+
+	// the mean of the center is given by dimension strided values: mean[i*stride]
+	static inline double squaredDistance( const double* x, const double* mean, int stride, int dimension )
 	{
-		_mean.resize(m.size());
-		copy( _mean.begin(), _mean.end(), m.begin() ); 
+		double dsquare = 0.0;
+		for(int i=0; i<dimension; ++i ) dsquare += ((mean[i*stride] - x[i])*(mean[i*stride] - x[i]));
+		return dsquare;
 	}
-	
-	virtual void setSigma( vector<double>& s )
+
+	static inline double activation( double dsquare, double sigma )
 	{
-		_sigma.resize(s.size());
-		copy( _sigma.begin(), _sigma.end(), s.begin() ); 
+		return exp( - dsquare / (2*sigma*sigma) );
 	}
-	
+
+	virtual vector<double>& getMean() { return _mean; }
+	virtual vector<double>& getSigma() { return _sigma; }
+	virtual double getAlpha() { return _alpha; }
+
+	virtual void setMean( vector<double>& m ) { _mean = m; }
+	virtual void setSigma( vector<double>& s ) { _sigma = s; }
+
 	virtual void setAlpha( double a ) { _alpha = a; }
-	
-	virtual void addMean( vector<double>& m ) 
-	{ 
-		for(int i=0; i< _mean.size(); ++i ) _mean[i] += m[i]; 
+
+	virtual void addMean( vector<double>& m )
+	{
+		for(int i=0; i< _mean.size(); ++i ) _mean[i] += m[i];
 	}
 	virtual void addSigma( vector<double>& s )
-	{ 
-		for(int i=0; i< _sigma.size(); ++i ) _sigma[i] += s[i]; 
+	{
+		for(int i=0; i< _sigma.size(); ++i ) _sigma[i] += s[i];
 	}
-	
-	virtual void addAlpha( double a ) { _alpha += a; }	
-	
+
+	virtual void addAlpha( double a ) { _alpha += a; }
+
 	virtual double getValue( vector<double>& x )
-	{ 
+	{
 		double retVal = _alpha * getActivationFactor(x);
 		return retVal;
 	}
@@ -130,209 +138,209 @@ public:
 		cout << "getValue: Multidimensional RBF is called with a single values" << endl;
 		exit(-1);
 	}
-	
+
 	virtual double getActivationFactor( double x ) const
 	{
 		cout << "getActivationFactor: Multidimensional RBF is called with a single values" << endl;
 		exit(-1);
 	}
-	
+
 	virtual double getActivationFactor( vector<double>&  x ) const
-	{ 
-		double retVal = 0.0;
-		for(int i=0; i< _mean.size(); ++i ) retVal += ((_mean[i] - x[i])*(_mean[i] - x[i]) / (2*_sigma[0]*_sigma[0]) ); 
-		retVal = exp( - retVal);
-		return retVal;
+	{
+		return activation( squaredDistance( &x[0], &_mean[0], 1, _mean.size() ), _sigma[0] );
 	}
-    
+
 	virtual string& getID() { return _ID;}
 	virtual void setID( const string ID ) { _ID = ID; }
-	
+
 	virtual void getGradient( double x, vector<double>& gradient )
 	{
 		cout << "getGradient: Multidimensional RBF is called with a single values" << endl;
 		exit(-1);
 	}
-	
+
 	virtual void getGradient( vector<double>& x, vector<double>& gradient )
-	{		
+	{
+		double dsquare = squaredDistance( &x[0], &_mean[0], 1, _mean.size() );
+		double rbfValue = activation( dsquare, _sigma[0] );
 
-		double dsquare = 0.0;
-		for(int i=0; i< _mean.size(); ++i )
-		{
-			dsquare += ((_mean[i] - x[i])*(_mean[i] - x[i]));
-		}
-		
-		double rbfValue = this->getActivationFactor(x);
-		
-		double alphaGrad = rbfValue;
-		
-		vector<double> meanGrad(_mean.size());
-		for (int i=0; i<_mean.size(); ++i )
-		{
-			meanGrad[i] = rbfValue * _alpha * (x[i]-_mean[i]) / (_sigma[0]*_sigma[0]);
-		}
-		
-		double sigmaGrad = rbfValue * _alpha * dsquare / (_sigma[0]*_sigma[0]*_sigma[0]);        
-		
 		gradient.resize(_mean.size()+2);
-		gradient[0] = alphaGrad;
-		for (int i=0; i<_mean.size(); ++i ) gradient[i+1] = meanGrad[i];
-		gradient[meanGrad.size()+1] = sigmaGrad;						
+		gradient[0] = rbfValue;
+		for (int i=0; i<_mean.size(); ++i )
+			gradient[i+1] = rbfValue * _alpha * (x[i]-_mean[i]) / (_sigma[0]*_sigma[0]);
+		gradient[_mean.size()+1] = rbfValue * _alpha * dsquare / (_sigma[0]*_sigma[0]*_sigma[0]);
 	}
-	
+
 };
 
 
 //-----------------------------------------------------------------------------------------------
 //-----------------------------------------------------------------------------------------------
 class RBFLogScaled : public RBF
-{   
+{
 public:
-    virtual double getActivationFactor( double x ) const
-	{ 
-		double retVal = exp( - (( x-_mean )*( x-_mean ))/(2*exp(_sigma)*exp(_sigma)));
-		return retVal;
+	static inline double activation( double x, double mean, double sigma )
+	{
+		return exp( - (( x-mean )*( x-mean ))/(2*exp(sigma)*exp(sigma)));
 	}
 
+	static inline void activationGradient( double x, double mean, double sigma, double alpha, double& alphaGrad, double& meanGrad, double& sigmaGrad )
+	{
+		double distance = x - mean;
+		double rbfValue = activation( x, mean, sigma );
+
+		alphaGrad = rbfValue;
+		meanGrad = rbfValue * alpha * distance / (exp(sigma)*exp(sigma));
+		sigmaGrad = rbfValue * alpha * distance * distance / (2*exp(sigma*sigma)*exp(sigma*sigma));
+	}
+
+    virtual double getActivationFactor( double x ) const { return activation( x, _mean, _sigma ); }
+
 	virtual void getGradient( double x, vector<double>& gradient )
-	{		
-		double distance = x - _mean;
-		double rbfValue = this->getActivationFactor(x);
-		
-		double alphaGrad = rbfValue;
-		double meanGrad = rbfValue * _alpha * distance / (exp(_sigma)*exp(_sigma));
-		double sigmaGrad = rbfValue * _alpha * distance * distance / (2*exp(_sigma*_sigma)*exp(_sigma*_sigma));        
-		
+	{
 		gradient.resize(3);
-		gradient[0] = alphaGrad;
-		gradient[1] = meanGrad;
-		gradient[2] = sigmaGrad;						
+		activationGradient( x, _mean, _sigma, _alpha, gradient[0], gradient[1], gradient[2] );
 	}
 };
 
 //-----------------------------------------------------------------------------------------------
 //-----------------------------------------------------------------------------------------------
-template <typename T>
-class AbstractArrayFunction
+// Structure of arrays storage of the RBF centers of one (action, iteration) pair. The parameters
+// are in a single block: [ alpha_0..alpha_{n-1} | mean of dimension 0 | ... | mean of dimension d-1 | sigma_0..sigma_{n-1} ]
+// so that the loops over the centers run on contiguous memory. Nothing is virtual, the concrete
+// array type is the template parameter of ArrayBasedQFunctionBinary.
+class RBFArrayStorage
 {
 protected:
-	vector<T> _data;
+	vector<double> _params;
 	int _size;
 	int _dimension;
+
+	double* _alphas;
+	double* _means; // _means[d * _size + i]
+	double* _sigmas;
+
+	void setPointers()
+	{
+		_alphas = _params.empty() ? NULL : &_params[0];
+		_means = _alphas + _size;
+		_sigmas = _means + _size * _dimension;
+	}
+
 public:
-	AbstractArrayFunction() : _data(0), _size(0) {}
-	
+	RBFArrayStorage() : _size(0), _dimension(1), _alphas(NULL), _means(NULL), _sigmas(NULL) {}
+	RBFArrayStorage( const RBFArrayStorage& other ) : _params(other._params), _size(other._size), _dimension(other._dimension) { setPointers(); }
+
+	RBFArrayStorage& operator=( const RBFArrayStorage& other )
+	{
+		_params = other._params;
+		_size = other._size;
+		_dimension = other._dimension;
+		setPointers();
+		return *this;
+	}
+
 	void resize( int size )
 	{
-		_data.resize( size );
-		_size = size;				
+		_size = size;
+		_params.resize( _size * (_dimension + 2) );
+		setPointers();
 	}
-	
-	virtual int getDimension() const { return _dimension; }
-	virtual void setDimension( int dim ) { _dimension = dim; }
-	
-	
-	virtual void initUniformly( double coeff ) = 0;
-	virtual double getValue( double x ) = 0;	
-	virtual double getValue( vector<double>& x ) = 0;		
-	virtual void getGradient( double x, vector<vector< double > >& gradient ) = 0;
-	virtual void getGradient( vector<double>& x, vector<vector< double > >& gradient ) = 0;
-	virtual void updateParameters( vector< vector< double > >& updates ) = 0;	
-	virtual void toString( string& str ) = 0;
-	
-};
 
-template <typename T>
-class MultiDimAbstractArrayFunction : virtual public AbstractArrayFunction<T>
-{
-public:
-	virtual double getValue( double x ) { exit(-1); }
-	virtual void getGradient( double x, vector<vector< double > >& gradient ) {exit(-1); }
+	int getSize() const { return _size; }
+	int getDimension() const { return _dimension; }
+	void setDimension( int dim ) { _dimension = dim; resize( _size ); }
+
+	// size of the gradient of one center: alpha, mean, sigma
+	int getGradientSize() const { return _dimension + 2; }
+
+	// one gradient step along the eligibility trace (getGradient layout), the steps of the means and sigmas are clipped
+	void updateParameters( const double* eTrace, double td )
+	{
+		const int gradientSize = getGradientSize();
+		for( int i=0; i<_size; ++i, eTrace += gradientSize )
+		{
+			_alphas[i] += eTrace[0] * td;
+			for(int j=0; j < _dimension; ++j )
+				clipAndAdd( _means[j * _size + i], eTrace[j+1] * td );
+			clipAndAdd( _sigmas[i], eTrace[_dimension+1] * td );
+		}
+	}
+
+protected:
+	inline void clipAndAdd( double& param, double step )
+	{
+		const double th=0.001;
+		step = (step>th) ?  th : step;
+		step = (step<-th) ? -th : step;
+		param += step;
+	}
 };
 
 //-----------------------------------------------------------------------------------------------
 //-----------------------------------------------------------------------------------------------
 template< typename TF = RBF >
-class RBFArray : public AbstractArrayFunction<TF>
+class RBFArray : public RBFArrayStorage
 {
-protected:	
-	
 public:
-	RBFArray() : AbstractArrayFunction<TF>() {}
-	
-	virtual ~RBFArray() {}
-	
-	virtual void initUniformly( double coeff )
+	RBFArray() : RBFArrayStorage() {}
+
+	// the centers are one dimensional, the margin of the binary case
+	void setDimension( int dim )
 	{
-		for (int j = 0; j < this->_size; ++j) 
+		if ( dim != 1 )
 		{
-			this->_data[j].setAlpha( coeff );
-			this->_data[j].setMean((j+1) * 1.0/(this->_size+1));			
-			this->_data[j].setSigma(1./ (2*this->_size));
-			
+			cerr << "ERROR: RBFArray supports only one margin, use MultiDimRBFArraySingleSigma for " << dim << " classes!" << endl;
+			exit(1);
 		}
+		RBFArrayStorage::setDimension( dim );
 	}
-	
-	virtual void getGradient( vector<double>& x, vector<vector< double > >& gradient )
-	{
-		getGradient( x[0], gradient );
-	}
-	
-	virtual void getGradient( double x, vector<vector< double > >& gradient )
+
+	void initUniformly( double coeff )
 	{
-		gradient.resize(this->_size);
-		for(int i=0; i < this->_size; ++i )
+		for (int j = 0; j < _size; ++j)
 		{
-			this->_data[i].getGradient( x, gradient[i] );
+			_alphas[j] = coeff;
+			_means[j] = (j+1) * 1.0/(_size+1);
+			_sigmas[j] = 1./ (2*_size);
 		}
 	}
-	
-	virtual double getValue( vector<double>& x ) { return getValue(x[0]); }
-	
-	virtual double getValue( double x )	
+
+	// the gradient of center i is at gradient[i*getGradientSize()]
+	inline void getGradient( const double* x, double* gradient ) const
 	{
-		double retVal = 0.0;
-		
-		for( int i=0; i<this->_size; ++i )
-		{
-			retVal += this->_data[i].getValue(x); 
-		}		
-		return retVal;		
+		getGradient( x[0], gradient );
 	}
-	
-	virtual void updateParameters( vector< vector< double > >& updates )
+
+	inline void getGradient( double x, double* gradient ) const
 	{
-		double th=0.001;
-		assert(this->_size == updates.size());
-		for( int i=0; i<this->_size; ++i )
-		{
-			this->_data[i].addAlpha(updates[i][0]);
+		const int gradientSize = getGradientSize();
+		for(int i=0; i < _size; ++i, gradient += gradientSize )
+			TF::activationGradient( x, _means[i], _sigmas[i], _alphas[i], gradient[0], gradient[1], gradient[2] );
+	}
 
-			double step = updates[i][1];
-			step = (step>th) ?  th : step;		
-			step = (step<-th) ? -th : step;		
-			this->_data[i].addMean(step);
+	inline double getValue( const double* x ) const { return getValue(x[0]); }
 
-			step = updates[i][2];
-			step = (step>th) ?  th : step;		
-			step = (step<-th) ? -th : step;					
-			this->_data[i].addSigma(step);
-		}		
+	inline double getValue( double x ) const
+	{
+		double retVal = 0.0;
+		for( int i=0; i<_size; ++i )
+			retVal += _alphas[i] * TF::activation( x, _means[i], _sigmas[i] );
+		return retVal;
 	}
-	
-	virtual void toString( string& str )
+
+	void toString( string& str )
 	{
 		stringstream ss("");
-		for( int i=0; i<this->_size; ++i )
+		for( int i=0; i<_size; ++i )
 		{
-			ss << this->_data[i].getAlpha() << " ";
-			ss << this->_data[i].getMean() << " ";
-			ss << this->_data[i].getSigma() << " ";
-		}				
+			ss << _alphas[i] << " ";
+			ss << _means[i] << " ";
+			ss << _sigmas[i] << " ";
+		}
 		str=ss.str();
-	}	
-	
+	}
+
 };
 
 //-----------------------------------------------------------------------------------------------
@@ -340,95 +348,74 @@ public:
 //-----------------------------------------------------------------------------------------------
 //-----------------------------------------------------------------------------------------------
 template< typename TF = MultiDimRBFSingleSigma >
-class MultiDimRBFArraySingleSigma : virtual public  MultiDimAbstractArrayFunction<TF>
+class MultiDimRBFArraySingleSigma : public RBFArrayStorage
 {
-protected:	
-	
 public:
-	MultiDimRBFArraySingleSigma() : AbstractArrayFunction<TF>() {}
-	
-	virtual ~MultiDimRBFArraySingleSigma() {}
-	
-	virtual void initUniformly( double coeff )
+	MultiDimRBFArraySingleSigma() : RBFArrayStorage() {}
+
+	void initUniformly( double coeff )
 	{
-		for (int j = 0; j < this->_size; ++j) 
+		for (int j = 0; j < _size; ++j)
 		{
-			this->_data[j].setAlpha( coeff );
-			vector<double> mean(this->_dimension, 0.0);
-			for(int i=0; i< this->_dimension; ++i ) mean[i] = (double) rand() / (double) RAND_MAX;
-			this->_data[j].setMean(mean);	
-			vector<double> sigma(1,1./ (2*this->_size));
-			this->_data[j].setSigma(sigma);
-			
+			_alphas[j] = coeff;
+			for(int i=0; i< _dimension; ++i ) _means[i * _size + j] = (double) rand() / (double) RAND_MAX;
+			_sigmas[j] = 1./ (2*_size);
 		}
 	}
-	// i don't know why this function has to be redefined here
-	virtual double getValue( double x ) { exit(-1); }	
-	virtual void getGradient( double x, vector<vector< double > >& gradient ) {exit(-1); }
-	
-	
-	virtual void getGradient( vector<double>& x, vector<vector< double > >& gradient )
+
+	// the gradient of center i is at gradient[i*getGradientSize()]
+	inline void getGradient( const double* x, double* gradient ) const
 	{
-		gradient.resize(this->_size);
-		for(int i=0; i < this->_size; ++i )
+		for(int i=0; i < _size; ++i, gradient += _dimension+2 )
 		{
-			this->_data[i].getGradient( x, gradient[i] );
+			double* currGradient = gradient;
+
+			double dsquare = TF::squaredDistance( x, _means + i, _size, _dimension );
+			double rbfValue = TF::activation( dsquare, _sigmas[i] );
+			double sigma2 = _sigmas[i] * _sigmas[i];
+
+			currGradient[0] = rbfValue;
+			for (int d=0; d<_dimension; ++d )
+				currGradient[d+1] = rbfValue * _alphas[i] * (x[d]-_means[d * _size + i]) / sigma2;
+			currGradient[_dimension+1] = rbfValue * _alphas[i] * dsquare / (sigma2 * _sigmas[i]);
 		}
 	}
-	
-	virtual double getValue( vector<double>& x )
+
+	inline double getValue( const double* x ) const
 	{
+		if (_dimension==1) return getValue(x[0]);
+
 		double retVal = 0.0;
-		
-		for( int i=0; i<this->_size; ++i )
-		{
-			retVal += this->_data[i].getValue(x); 
-		}		
-		return retVal;		
+		for( int i=0; i<_size; ++i )
+			retVal += _alphas[i] * TF::activation( TF::squaredDistance( x, _means + i, _size, _dimension ), _sigmas[i] );
+		return retVal;
 	}
-	
-	virtual void updateParameters( vector< vector< double > >& updates )
+
+	// the single margin of the binary case, the loop over the centers has no inner loop
+	inline double getValue( double x ) const
 	{
-		double th=0.001;
-		assert(this->_size == updates.size());
-		for( int i=0; i<this->_size; ++i )
-		{
-			this->_data[i].addAlpha(updates[i][0]);
-			double step =0.0;
-			
-			vector<double> meanStep(this->_dimension);
-			for(int j=0; j < this->_dimension; ++j )
-			{
-				step = updates[i][j+1];
-				step = (step>th) ?  th : step;		
-				step = (step<-th) ? -th : step;		
-				meanStep[j] = step;
-			}	
-			this->_data[i].addMean(meanStep);
-			
-			step = updates[i][this->_dimension+1];
-			step = (step>th) ?  th : step;		
-			step = (step<-th) ? -th : step;	
-			
-			vector<double> sigmaStep(1,step);
-			this->_data[i].addSigma(sigmaStep);
-		}		
+		double retVal = 0.0;
+		for( int i=0; i<_size; ++i )
+			retVal += _alphas[i] * TF::activation( (_means[i] - x) * (_means[i] - x), _sigmas[i] );
+		return retVal;
 	}
-	
-	virtual void toString( string& str )
+
+	inline void getGradient( double x, double* gradient ) const
+	{
+		getGradient( &x, gradient );
+	}
+
+	void toString( string& str )
 	{
 		stringstream ss("");
-		
-		for( int i=0; i<this->_size; ++i )
-		{			
-			ss << this->_data[i].getAlpha() << " ";
-			//vector<int>& mean = this->_data[i].getMean();
-			//for( int i=0; i<this->_size; ++i ) ss << mean[i] << " ";
-			//ss << this->_data[i].getSigma() << " ";
-		}				
+
+		for( int i=0; i<_size; ++i )
+		{
+			ss << _alphas[i] << " ";
+		}
 		str=ss.str();
-	}	
-	
+	}
+
 };
 
 
@@ -441,8 +428,8 @@ template< typename T=RBFArray<RBF> >
 class ArrayBasedQFunctionBinary : public CAbstractQFunction // CAbstractQFunction
 {
 protected:	
-	//map< CAction*, vector<T> > 	_data;
-	map<int, vector<T> > 	_data;
+	// the RBF arrays of all (action, iteration) pairs, indexed by getIndex
+	vector<T> 	_data;
 	
 	int _featureNumber;	
 	vector<int> _actionIndices;
@@ -450,6 +437,26 @@ protected:
 	int _numberOfActions;
     int _numberOfIterations;
 	int _dimension;
+	
+	// the number of margins which fit in the stack buffer of the callers of getMargins
+	static const int maxStackDimension = 16;
+	
+	inline int getIndex( int actionMode, int iteration ) const { return actionMode * _numberOfIterations + iteration; }
+	
+	// the margins of the state in buffers owned by the caller, so that any thread can evaluate without
+	// allocating: stackBuffer holds up to maxStackDimension margins, localBuffer is used beyond that
+	inline const double* getMargins( CState* currState, double* stackBuffer, vector<double>& localBuffer ) const
+	{
+		double* margins = stackBuffer;
+		if ( _dimension > maxStackDimension )
+		{
+			localBuffer.resize(_dimension);
+			margins = &localBuffer[0];
+		}
+		for(int i=0; i<_dimension; ++i )
+			margins[i] = currState->getContinuousState(i);
+		return margins;
+	}
 public:
 	ArrayBasedQFunctionBinary(CActionSet *actions, CStateModifier* statemodifier ) : CAbstractQFunction(actions)
 	{
@@ -469,18 +476,20 @@ public:
 		_actions = actions;
 		_numberOfActions = actions->size();
 		
+		int maxActionIndex = 0;
 		CActionSet::iterator it=(*actions).begin();
 		for(;it!=(*actions).end(); ++it )
 		{			
 			int currentActionIndex = dynamic_cast<MultiBoost::CAdaBoostAction* >(*it)->getMode();
-			_data[currentActionIndex].resize( iterationNumber );
-			for( int i=0; i<iterationNumber; ++i)
-			{
-				_data[currentActionIndex][i].resize(_featureNumber);
-				_data[currentActionIndex][i].setDimension( _dimension );
-			}
+			if (currentActionIndex > maxActionIndex) maxActionIndex = currentActionIndex;
 		}
 		
+		_data.resize( (maxActionIndex+1) * iterationNumber );
+		for( int i=0; i<_data.size(); ++i)
+		{
+			_data[i].setDimension( _dimension );
+			_data[i].resize(_featureNumber);
+		}
 	}	
 	//------------------------------------------------------
 	//------------------------------------------------------    
@@ -502,48 +511,50 @@ public:
 		if (_dimension==1)
 		{				
 			double margin = currState->getContinuousState(0);		
-			retVal = _data[currentActionIndex][currIter].getValue(margin);		
+			retVal = _data[getIndex(currentActionIndex, currIter)].getValue(margin);		
 		} else {
-			vector<double> margins(_dimension);
-			for(int i=0; i<_dimension; ++i )
-				margins[i]= currState->getContinuousState(i);		
-			retVal = _data[currentActionIndex][currIter].getValue(margins);			
+			double stackBuffer[maxStackDimension];
+			vector<double> localBuffer;
+			retVal = _data[getIndex(currentActionIndex, currIter)].getValue( getMargins(currState, stackBuffer, localBuffer) );			
 		}
 		return retVal;
 	}
 	
 	//------------------------------------------------------
 	//------------------------------------------------------    
-	void updateValue(CStateCollection *state, CAction *action, double td, vector<vector<double> >& eTraces)
+	// value of the action mode (see CAdaBoostAction) in the raw state, without a state collection
+	double getValue( int actionMode, int iteration, vector<double>& margins )
 	{
-		CState* currState = state->getState();
-		int currentActionIndex = dynamic_cast<MultiBoost::CAdaBoostAction* >(action)->getMode();
-		
-		int currIter = currState->getDiscreteState(0);
-		
-		//AbstractArrayFunction<T>& currData = _data[action][currIter];
-		int numCenters = eTraces.size();//_rbfs[currIter][action].size();
-		
-		//        assert(numCenters = eTraces.size());
-		
-		vector< vector< double > > updateSteps( numCenters );		
-		for (int i = 0; i < numCenters; ++i) 
-		{
-			//update the center and shape
-			vector<double>& currentETrace = eTraces[i];
-			updateSteps[i].resize( currentETrace.size());
-			
-			for( int j=0; j<currentETrace.size(); ++j )
-			{
-				double step = currentETrace[j] * td;								
-				updateSteps[i][j]=step;
-			}
-		}
-		_data[currentActionIndex][currIter].updateParameters( updateSteps );
+		if (_dimension==1)
+			return _data[getIndex(actionMode, iteration)].getValue(margins[0]);
+		else
+			return _data[getIndex(actionMode, iteration)].getValue(&margins[0]);
+	}
+	
+	// values of the action mode in a batch of raw states, margins holds getDimension() values per state
+	void getValues( int actionMode, int numStates, const int* iterations, const double* margins, double* values ) const
+	{
+		for( int b = 0; b < numStates; ++b )
+			values[b] = _data[getIndex(actionMode, iterations[b])].getValue( margins + b * _dimension );
+	}
+	
+	int getDimension() const { return _dimension; }
+	int getNumberOfIterations() const { return _numberOfIterations; }
+	
+	// the number of values in the gradient of one (action, iteration) pair
+	int getGradientSize() const { return _featureNumber * _data[0].getGradientSize(); }
+	
+	//------------------------------------------------------
+	//------------------------------------------------------    
+	// one gradient step along the eligibility trace of the (action, iteration) pair, see getGradient
+	void updateValue(int actionMode, int iteration, double td, const double* eTrace)
+	{
+		_data[getIndex(actionMode, iteration)].updateParameters( eTrace, td );
 	}
 	//------------------------------------------------------
 	//------------------------------------------------------    
-	void getGradient(CStateCollection *state, CAction *action, vector<vector<double> >& gradient)
+	// gradient must have getGradientSize() elements
+	void getGradient(CStateCollection *state, CAction *action, double* gradient)
 	{
 		CState* currState = state->getState();
 		int currentActionIndex = dynamic_cast<MultiBoost::CAdaBoostAction* >(action)->getMode();
@@ -552,11 +563,11 @@ public:
 		if (this->_dimension==1)
 		{
 			double margin = currState->getContinuousState(0);		
-			_data[currentActionIndex][currIter].getGradient( margin, gradient );
+			_data[getIndex(currentActionIndex, currIter)].getGradient( margin, gradient );
 		} else {
-			vector<double> margins(this->_dimension);
-			for( int i=0; i<this->_dimension; ++i ) margins[i]=currState->getContinuousState(i);		
-			_data[currentActionIndex][currIter].getGradient( margins, gradient );
+			double stackBuffer[maxStackDimension];
+			vector<double> localBuffer;
+			_data[getIndex(currentActionIndex, currIter)].getGradient( getMargins(currState, stackBuffer, localBuffer), gradient );
 		}
 	}
 			
@@ -568,13 +579,11 @@ public:
 		for (CActionSet::iterator it=_actions->begin(); it != _actions->end(); ++it)		
 		{
 			int currentActionIndex = dynamic_cast<MultiBoost::CAdaBoostAction* >(*it)->getMode();
-			vector<T> currentData = _data[currentActionIndex];
-			//cout << currentRBFs.size() << endl;
-			for(int i=0; i<currentData.size(); ++i)
+			for(int i=0; i<_numberOfIterations; ++i)
 			{				
 				fprintf( outFile, "%d ", i );
 				string tmpString("");
-				currentData[i].toString(tmpString);
+				_data[getIndex(currentActionIndex, i)].toString(tmpString);
 				fprintf(outFile, "%s", tmpString.c_str());
 				fprintf( outFile, "\n" );
 			}
@@ -599,10 +608,9 @@ public:
 				initAlpha = init[index];
 			}
 			
-			int iterationNumber = _data[currentActionIndex].size();
-			for( int i=0; i<iterationNumber; ++i)
+			for( int i=0; i<_numberOfIterations; ++i)
 			{                
-				_data[currentActionIndex][i].initUniformly(initAlpha);
+				_data[getIndex(currentActionIndex, i)].initUniformly(initAlpha);
 			}
 		}           
 	}
@@ -0,0 +1,218 @@
+/*
+ *  MDDAGCascade.cpp
+ *  RLTools
+ *
+ *  Static decision table of a trained MDDAG policy. It depends on MultiBoost only,
+ *  so a trained policy can be deployed without the RL toolbox.
+ *
+ */
+
+#include "MDDAGCascade.h"
+
+#include "IO/Serialization.h"
+#include "Utils/StreamTokenizer.h"
+#include "Utils/Utils.h"
+
+#include <fstream>
+#include <limits>
+
+using namespace std;
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace MultiBoost {
+
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	MDDAGCascade::MDDAGCascade()
+	: _numIterations(0), _numBuckets(0), _stateDimension(0), _numCells(0), _sumAlpha(0.0)
+	{}
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	MDDAGCascade::MDDAGCascade( int numIterations, int numBuckets, int stateDimension, double sumAlpha )
+	: _numIterations(numIterations), _numBuckets(numBuckets), _stateDimension(stateDimension), _sumAlpha(sumAlpha)
+	{
+		_numCells = 1;
+		for( int i = 0; i < _stateDimension; ++i )
+			_numCells *= _numBuckets;
+
+		// skip everywhere until the table is filled
+		_modes.resize( _numIterations * _numCells, 0 );
+	}
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	void MDDAGCascade::getCellCenter( int cell, vector<double>& margins ) const
+	{
+		margins.resize( _stateDimension );
+		for( int i = 0; i < _stateDimension; ++i )
+		{
+			margins[i] = ( (cell % _numBuckets) + 0.5 ) / _numBuckets;
+			cell /= _numBuckets;
+		}
+	}
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	int MDDAGCascade::getCell( const vector<double>& margins ) const
+	{
+		int cell = 0;
+		for( int i = _stateDimension - 1; i >= 0; --i )
+		{
+			int bucket = (int) ( margins[i] * _numBuckets );
+			if ( bucket < 0 ) bucket = 0;
+			if ( bucket >= _numBuckets ) bucket = _numBuckets - 1;
+			cell = cell * _numBuckets + bucket;
+		}
+		return cell;
+	}
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	void MDDAGCascade::save( const string& fileName ) const
+	{
+		ofstream outFile( fileName.c_str() );
+		if ( !outFile.is_open() )
+		{
+			cerr << "ERROR: Cannot open cascade file <" << fileName << ">!" << endl;
+			exit(1);
+		}
+
+		outFile << "<?xml version=\"1.0\"?>" << endl;
+		outFile << "<mddagcascade>" << endl;
+		outFile << Serialization::standardTag( "iterations", _numIterations, 1 ) << endl;
+		outFile << Serialization::standardTag( "buckets", _numBuckets, 1 ) << endl;
+		outFile << Serialization::standardTag( "dimension", _stateDimension, 1 ) << endl;
+		outFile << Serialization::standardTag( "sumalpha", _sumAlpha, 1 ) << endl;
+
+		// one row of modes per weak classifier
+		string row( _numCells, '0' );
+		for( int k = 0; k < _numIterations; ++k )
+		{
+			for( int cell = 0; cell < _numCells; ++cell )
+				row[cell] = (char) ( '0' + getMode( k, cell ) );
+			outFile << Serialization::standardTag( "stage", row, 1 ) << endl;
+		}
+
+		outFile << "</mddagcascade>" << endl;
+		outFile.close();
+	}
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	void MDDAGCascade::load( const string& fileName )
+	{
+		ifstream inFile( fileName.c_str() );
+		if ( !inFile.is_open() )
+		{
+			cerr << "ERROR: Cannot open cascade file <" << fileName << ">!" << endl;
+			exit(1);
+		}
+
+		nor_utils::StreamTokenizer st( inFile, "<>\n\r\t" );
+
+		if ( !UnSerialization::seekSimpleTag( st, "mddagcascade" ) )
+		{
+			cerr << "ERROR: Not a valid MDDAG cascade file <" << fileName << ">!" << endl;
+			exit(1);
+		}
+
+		int numIterations = UnSerialization::seekAndParseEnclosedValue<int>( st, "iterations" );
+		int numBuckets = UnSerialization::seekAndParseEnclosedValue<int>( st, "buckets" );
+		int stateDimension = UnSerialization::seekAndParseEnclosedValue<int>( st, "dimension" );
+		double sumAlpha = UnSerialization::seekAndParseEnclosedValue<double>( st, "sumalpha" );
+
+		*this = MDDAGCascade( numIterations, numBuckets, stateDimension, sumAlpha );
+
+		for( int k = 0; k < _numIterations; ++k )
+		{
+			string row = UnSerialization::seekAndParseEnclosedValue<string>( st, "stage" );
+			if ( (int)row.size() != _numCells )
+			{
+				cerr << "ERROR: Broken stage " << k << " in cascade file <" << fileName << ">!" << endl;
+				exit(1);
+			}
+
+			for( int cell = 0; cell < _numCells; ++cell )
+				setMode( k, cell, row[cell] - '0' );
+		}
+	}
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	int MDDAGCascade::classify( InputData* pData, const int instance, const vector<BaseLearner*>& weakHypotheses, vector<AlphaReal>& votes ) const
+	{
+		const int numClasses = pData->getNumClasses();
+		vector<double> margins( _stateDimension );
+		int numEvaluated = 0;
+
+		fill( votes.begin(), votes.end(), 0.0 );
+
+		int currentClassifier = 0;
+		while ( currentClassifier < _numIterations )
+		{
+			for( int i = 0; i < _stateDimension; ++i )
+				margins[i] = ((votes[i] / _sumAlpha) + 1) / 2.0; // rescale between [0,1]
+
+			int mode = getMode( currentClassifier, getCell( margins ) );
+
+			if ( mode == 0 ) // skip
+			{
+				currentClassifier++;
+			}
+			else if ( mode == 1 ) // classify
+			{
+				BaseLearner* currWeakHyp = weakHypotheses[currentClassifier];
+				AlphaReal alpha = currWeakHyp->getAlpha();
+				for( int l = 0; l < numClasses; ++l )
+					votes[l] += alpha * currWeakHyp->classify( pData, instance, l );
+
+				numEvaluated++;
+				currentClassifier++;
+			}
+			else // jump to end
+			{
+				break;
+			}
+		}
+
+		return numEvaluated;
+	}
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	double MDDAGCascade::getAccuracy( InputData* pData, const vector<BaseLearner*>& weakHypotheses, double& usedClassifierAvg ) const
+	{
+		if ( (int)weakHypotheses.size() < _numIterations )
+		{
+			cerr << "ERROR: The cascade needs " << _numIterations << " weak hypotheses, only " << weakHypotheses.size() << " are given!" << endl;
+			exit(1);
+		}
+
+		const int numExamples = pData->getNumExamples();
+		vector<AlphaReal> votes( pData->getNumClasses() );
+
+		int correct = 0;
+		int usedClassifier = 0;
+
+		for( int i = 0; i < numExamples; ++i )
+		{
+			usedClassifier += classify( pData, i, weakHypotheses, votes );
+
+			// the same decision as DataReader::currentClassifyingResult
+			const vector<Label>& labels = pData->getLabels( i );
+			float maxNegClass = -numeric_limits<float>::max();
+			float minPosClass = numeric_limits<float>::max();
+
+			for( vector<Label>::const_iterator lIt = labels.begin(); lIt != labels.end(); ++lIt )
+			{
+				if ( lIt->y < 0 && votes[lIt->idx] > maxNegClass )
+					maxNegClass = votes[lIt->idx];
+				if ( lIt->y > 0 && votes[lIt->idx] < minPosClass )
+					minPosClass = votes[lIt->idx];
+			}
+
+			if ( !nor_utils::is_zero( minPosClass - maxNegClass ) && minPosClass > maxNegClass )
+				correct++;
+		}
+
+		usedClassifierAvg = (double)usedClassifier / (double)numExamples;
+		return ((double)correct / (double)numExamples) * 100.0;
+	}
+
+} // end of namespace MultiBoost
@@ -0,0 +1,89 @@
+/*
+ *  MDDAGCascade.h
+ *  RLTools
+ *
+ *  Static decision table of a trained MDDAG policy. It depends on MultiBoost only,
+ *  so a trained policy can be deployed without the RL toolbox.
+ *
+ */
+
+#ifndef __MDDAG_CASCADE_H
+#define __MDDAG_CASCADE_H
+
+//////////////////////////////////////////////////////////////////////
+// for multiboost
+//////////////////////////////////////////////////////////////////////
+#include "WeakLearners/BaseLearner.h"
+#include "IO/InputData.h"
+//////////////////////////////////////////////////////////////////////
+// general includes
+//////////////////////////////////////////////////////////////////////
+#include <vector>
+#include <string>
+
+using namespace std;
+
+namespace MultiBoost {
+
+	////////////////////////////////////////////////////////////////////////////////////////////////
+	////////////////////////////////////////////////////////////////////////////////////////////////
+	////////////////////////////////////////////////////////////////////////////////////////////////
+	// For every weak classifier k and every cell of the margin grid the table stores the mode of
+	// CAdaBoostAction (0 skip, 1 classify, 2 jump to the end). Every margin is rescaled to [0,1] as
+	// in the MDDAG state and cut into numBuckets equal buckets, so a state of dimension d has
+	// numBuckets^d cells per weak classifier.
+	//
+	// The table is saved next to the strong hypothesis file:
+	//\verbatim
+	// <?xml version="1.0"?>
+	// <mddagcascade>
+	//	<iterations>100</iterations>
+	//	<buckets>20</buckets>
+	//	<dimension>1</dimension>
+	//	<sumalpha>12.3456</sumalpha>
+	//	<stage>00011111111111111222</stage>
+	//	...
+	// </mddagcascade> \endverbatim
+	class MDDAGCascade
+	{
+	protected:
+		int				_numIterations;
+		int				_numBuckets;
+		int				_stateDimension;
+		int				_numCells; // numBuckets^stateDimension
+		double			_sumAlpha; // the margins are normalized by the sum of the alphas of the weak classifiers
+
+		vector<char>	_modes; // _modes[k * _numCells + cell]
+
+	public:
+		MDDAGCascade();
+		MDDAGCascade( int numIterations, int numBuckets, int stateDimension, double sumAlpha );
+
+		int getIterationNumber() const { return _numIterations; }
+		int getBucketNumber() const { return _numBuckets; }
+		int getStateDimension() const { return _stateDimension; }
+		int getCellNumber() const { return _numCells; }
+
+		// the rescaled margins in the center of the cell
+		void getCellCenter( int cell, vector<double>& margins ) const;
+
+		// the cell of the rescaled margins
+		int getCell( const vector<double>& margins ) const;
+
+		void setMode( int iteration, int cell, int mode ) { _modes[ iteration * _numCells + cell ] = (char) mode; }
+		int getMode( int iteration, int cell ) const { return _modes[ iteration * _numCells + cell ]; }
+
+		void save( const string& fileName ) const;
+		void load( const string& fileName );
+
+		// classifies the example with the first numIterations weak hypotheses and returns the number of the evaluated ones,
+		// votes must have numClasses elements
+		int classify( InputData* pData, const int instance, const vector<BaseLearner*>& weakHypotheses, vector<AlphaReal>& votes ) const;
+
+		// accuracy (in percent) and the average number of evaluated weak classifiers on the data set
+		double getAccuracy( InputData* pData, const vector<BaseLearner*>& weakHypotheses, double& usedClassifierAvg ) const;
+	};
+
+} // end of namespace MultiBoost
+
+#endif // __MDDAG_CASCADE_H
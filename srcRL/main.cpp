@@ -56,6 +56,7 @@ typedef MultiDimRBFArraySingleSigma<MultiDimRBFSingleSigma> FUNCTIONTYPE;
 #include "AdaBoostMDPClassifierContinousBinary.h"
 #include "AdaBoostMDPClassifierContinousMultiClass.h"
 #include "AdaBoostMDPClassifierSubsetSelectorBinary.h"
+#include "AdaBoostMDPPolicyClassifier.h"
 
 using namespace std;
 using namespace MultiBoost;
@@ -68,6 +69,30 @@ using namespace Torch;
 
 static const char CURRENT_VERSION[] = "1.0.00";
 
+//---------------------------------------------------------------------------
+
+#ifdef MDDAG_COUNT_ALLOCATIONS
+#include <new>
+#include <cstdlib>
+
+// Micro-benchmark of the heap traffic of the training: with -DMDDAG_COUNT_ALLOCATIONS every
+// operator new is counted, and the allocations per training episode are printed with the statistics.
+static unsigned long g_numAllocations = 0;
+
+void* operator new(size_t size) throw(std::bad_alloc)
+{
+#pragma omp atomic
+	g_numAllocations++;
+	
+	void* p = malloc( size ? size : 1 );
+	if ( p == NULL ) throw std::bad_alloc();
+	return p;
+}
+void* operator new[](size_t size) throw(std::bad_alloc) { return operator new(size); }
+void operator delete(void* p) throw() { free(p); }
+void operator delete[](void* p) throw() { free(p); }
+#endif
+
 
 //---------------------------------------------------------------------------
 
@@ -244,6 +269,8 @@ void setBasicOptions(nor_utils::Args& args)
 						 "Compute only the data of the last iteration (fast resume, default)\n", 0, "" );
 	args.declareArgument("weights", "Outputs the weights of instances at the end of the learning process", 1, "<filename>" );
 	args.declareArgument("Cn", "Resampling size for FilterBoost (default=300)", 1, "<val>" );
+	args.declareArgument("filterstream", "FilterBoost reads the training file (arff) in blocks of the given size instead of loading it, the next block is read while the current one is filtered. The memory does not depend on the size of the training file.", 1, "<megabytes>" );
+	args.declareArgument("marginfile", "With --filterstream, the margins of the training examples are kept in this file instead of the memory. The file is removed at the end.", 1, "<filename>" );
 	//// ignored for the moment!
 	//args.declareArgument("arffheader", "Specify the arff header.", 1, "<arffHeaderFile>");
 	
@@ -261,6 +288,8 @@ void setBasicOptions(nor_utils::Args& args)
 	
 	/////////////////////////////////////////////
 	
+	args.declareArgument("datacache", "Keep a binary copy of the loaded data and of its sorted columns in the directory. The later runs on the same data file with the same parsing options load the copy instead of parsing and sorting.", 1, "<directory>");
+	
 	args.setGroup("Basic Algorithm Options");
 	args.declareArgument("weightpolicy", "Specify the type of weight initialization. The user specified weights (if available) are used inside the policy which can be:\n"
 						 "* sharepoints Share the weight equally among data points and between positiv and negative labels (DEFAULT)\n"
@@ -272,6 +301,7 @@ void setBasicOptions(nor_utils::Args& args)
 	
 	args.declareArgument("verbose", "Set the verbose level 0, 1 or 2 (0=no messages, 1=default, 2=all messages).", 1, "<val>");
 	args.declareArgument("outputinfo", "Output informations on the algorithm performances during training, on file <filename>.", 1, "<filename>");
+	args.declareArgument("aucperiod", "With --outputinfo, compute the AUC only at every <period>th iteration, repeat the last values in between (default 1).", 1, "<period>");
 	args.declareArgument("seed", "Defines the seed for the random operations.", 1, "<seedval>");
 	
 	//////////////////////////////////////////////////////////////////////////
@@ -287,12 +317,54 @@ void setBasicOptions(nor_utils::Args& args)
 	args.declareArgument("numoffeat", "The number of feature in statespace representation", 1, "<featnum>" );
     args.declareArgument("optimistic", "Set the initial values of the Q function", 3, "<real> <real> <real>" );
     args.declareArgument("etrace", "Lambda parameter", 1, "<real>" );
+    args.declareArgument("precompute", "Evaluate every weak hypothesis on every train and test example once at load time", 0, "" );
+    args.declareArgument("evalthreads", "The number of threads used for the greedy evaluation (default=1)", 1, "<num>" );
+    args.declareArgument("trainthreads", "The number of threads of the SARSA training with the RBF Q-function (statespace 4, default=1)", 1, "<num>" );
+    args.declareArgument("cascade", "Export the greedy policy of the best episode as a decision table into <shypfile>.cascade", 1, "<numOfBuckets>" );
 	
 }
 
 
 //---------------------------------------------------------------------------
 
+/**
+ * The last episode of a parallel training round which starts at episode i. A round ends
+ * where the statistics, the schedules or the evaluation of the training loop are due.
+ */
+int getRoundEnd(int i, int evalTestIteration, int episodeNumber)
+{
+	int roundEnd = i;
+	while ((roundEnd < episodeNumber-1) && !((roundEnd>2) && (((roundEnd%1000)==0) || ((roundEnd%evalTestIteration)==0))))
+		roundEnd++;
+	return roundEnd;
+}
+
+//---------------------------------------------------------------------------
+
+/**
+ * Export the greedy policy as a static decision table next to the strong hypothesis file.
+ * With verbose > 1 the saved table is reloaded and evaluated on the current data set,
+ * without the RL toolbox.
+ */
+void exportCascade(MDDAGGreedyPolicy* policy, DataReader* datahandler, int numBuckets, const string& cascadeFileName, int verbose)
+{
+	MDDAGCascade cascade( datahandler->getIterationNumber(), numBuckets, policy->getStateDimension(), datahandler->getSumOfAlphas() );
+	compileCascade( policy, cascade );
+	cascade.save( cascadeFileName );
+	
+	if (verbose > 1)
+	{
+		MDDAGCascade savedCascade;
+		savedCascade.load( cascadeFileName );
+		
+		double cascadeUsedClassifierAvg;
+		double cascadeAcc = savedCascade.getAccuracy( datahandler->getCurrentData(), datahandler->getWeakHypotheses(), cascadeUsedClassifierAvg );
+		cout << "******** Test accuracy by exported cascade: " << cascadeAcc << " (classifier used: " << cascadeUsedClassifierAvg << ")" << endl;
+	}
+}
+
+//---------------------------------------------------------------------------
+
 
 
 
@@ -445,6 +517,26 @@ int main(int argc, const char *argv[])
 	
 	
 	
+	int evalThreads = 1;
+	if (args.hasArgument("evalthreads"))
+	{
+		evalThreads = args.getValue<int>("evalthreads", 0);
+	}
+	
+	int trainThreads = 1;
+	if (args.hasArgument("trainthreads"))
+	{
+		trainThreads = args.getValue<int>("trainthreads", 0);
+	}
+	
+	int cascadeBuckets = 0;
+	string cascadeFileName = "";
+	if (args.hasArgument("cascade"))
+	{
+		cascadeBuckets = args.getValue<int>("cascade", 0);
+		cascadeFileName = args.getValue<string>("traintestmdp", 3) + ".cascade";
+	}
+	
 	string logDirContinous="";
 	if (args.hasArgument("logdir"))
 	{
@@ -643,6 +735,11 @@ int main(int argc, const char *argv[])
 		agentContinous->addSemiMDPListener(qFunctionLearner);
 		agentContinous->setController(policy);        
         
+		// Hogwild-style training on several threads, the Q-function must be thread safe
+		AdaBoostMDPParallelSarsaTrainer* parallelTrainer = NULL;
+		if ((trainThreads > 1)&&(dynamic_cast<ArrayBasedQFunctionBinary<FUNCTIONTYPE>* >(qData) != NULL))
+			parallelTrainer = new AdaBoostMDPParallelSarsaTrainer(agentContinous, classifierContinous, qData, qFunctionLearner, currentEpsilon, trainThreads);
+        
         //        agentContinous->addSemiMDPListener(vFunctionLearnerAB);
         //        agentContinous->setController(vLearnerPolicyAB);
         
@@ -688,6 +785,9 @@ int main(int argc, const char *argv[])
 		
 		int steps2 = 0;
 		int usedClassifierNumber=0;
+#ifdef MDDAG_COUNT_ALLOCATIONS
+		unsigned long episodeAllocations = 0;
+#endif
 		int max_Steps = 100000;		
 		double ovaccTrain, ovaccTest;
 		
@@ -705,28 +805,48 @@ int main(int argc, const char *argv[])
 		// Learn for 500 Episodes
 		for (int i = 0; i < episodeNumber; i++)
 		{
-			//cout << qFunctionLearner->getParameter("QLearningRate") << endl;			
-			// Do one training trial, with max max_Steps steps
-			agentContinous->startNewEpisode();
-			classifierContinous->setRandomizedInstance();
-			steps2 = agentContinous->doControllerEpisode(1, max_Steps);
+			if (parallelTrainer)
+			{
+				// the episodes i..roundEnd run in parallel, the checks below are done after the last one
+				int roundEnd = getRoundEnd(i, evalTestIteration, episodeNumber);
+				int roundSucceeded = 0;
+				parallelTrainer->runEpisodes(roundEnd - i + 1, max_Steps, usedClassifierNumber, roundSucceeded);
+				ges_succeeded += roundSucceeded;
+				ges_failed += (roundEnd - i + 1) - roundSucceeded;
+				i = roundEnd;
+			}
+			else
+			{
+				//cout << qFunctionLearner->getParameter("QLearningRate") << endl;			
+				// Do one training trial, with max max_Steps steps
+				agentContinous->startNewEpisode();
+				classifierContinous->setRandomizedInstance();
+#ifdef MDDAG_COUNT_ALLOCATIONS
+				unsigned long allocationsBefore = g_numAllocations;
+#endif
+				steps2 = agentContinous->doControllerEpisode(1, max_Steps);
+#ifdef MDDAG_COUNT_ALLOCATIONS
+				episodeAllocations += g_numAllocations - allocationsBefore;
+#endif
 			
-			//printf("Number fo classifier: %d\n", classifierContinous->getUsedClassifierNumber() );
-			//printf("Episode %d %s with %d steps\n", i, classifierContinous->classifyCorrectly() ? "*succed*" : "*failed*", steps2);
+				//printf("Number fo classifier: %d\n", classifierContinous->getUsedClassifierNumber() );
+				//printf("Episode %d %s with %d steps\n", i, classifierContinous->classifyCorrectly() ? "*succed*" : "*failed*", steps2);
 			
 			
 			
-			usedClassifierNumber += classifierContinous->getUsedClassifierNumber();
+				usedClassifierNumber += classifierContinous->getUsedClassifierNumber();
 			
-			bool clRes = classifierContinous->classifyCorrectly();				
-			if ( clRes ) {
-				//cout << "Classification result: CORRECT, instance: " << classifier->getCurrentInstance() << endl;
-				ges_succeeded++;
-			}
-			else {
-				ges_failed++;
-				//cout << "Classification result: FAILED, instance: " << classifier->getCurrentInstance() << endl;			
+				bool clRes = classifierContinous->classifyCorrectly();				
+				if ( clRes ) {
+					//cout << "Classification result: CORRECT, instance: " << classifier->getCurrentInstance() << endl;
+					ges_succeeded++;
+				}
+				else {
+					ges_failed++;
+					//cout << "Classification result: FAILED, instance: " << classifier->getCurrentInstance() << endl;			
+				}
 			}
+
 			
 			
 			
@@ -740,6 +860,10 @@ int main(int argc, const char *argv[])
 				cout << "Current alpha    :" << '\t' << currentAlpha << endl;
 				cout << "Current Epsilon  :" << '\t' << currentEpsilon << endl;
 				cout << "Current lambda   :" << '\t' << currentLambda << endl;
+#ifdef MDDAG_COUNT_ALLOCATIONS
+				cout << "Allocs/episode   :" << '\t' << ((double)episodeAllocations / 1000.0) << endl;
+				episodeAllocations = 0;
+#endif
 				usedClassifierNumber = 0;
 			}
 			
@@ -749,6 +873,7 @@ int main(int argc, const char *argv[])
 				epsDivisor++;
 				currentEpsilon =  initEps / epsDivisor;
 				policy->setParameter("EpsilonGreedy", currentEpsilon);
+				if (parallelTrainer) parallelTrainer->setEpsilon(currentEpsilon);
                 
 			}
 			if ((i>2)&&((i%10000)==0)) 
@@ -756,6 +881,7 @@ int main(int argc, const char *argv[])
 				qRateDivisor++;
 				currentAlpha = initAlpha / qRateDivisor;
 				qFunctionLearner->setParameter("QLearningRate", currentAlpha);			
+				if (parallelTrainer) parallelTrainer->setLearnerParameter("QLearningRate", currentAlpha);
 			}
 			
 			if ((i>2)&&((i%10000)==0)) 
@@ -763,6 +889,7 @@ int main(int argc, const char *argv[])
 				lambdaRateDivisor++;
 				currentLambda = initLambda / qRateDivisor;				
 				qFunctionLearner->setParameter("Lambda", currentLambda);
+				if (parallelTrainer) parallelTrainer->setLearnerParameter("Lambda", currentLambda);
 			}
 			
 			
@@ -798,6 +925,8 @@ int main(int argc, const char *argv[])
 				classifierContinous->setCurrentDataToTrain();
 				//AdaBoostMDPClassifierContinousBinaryEvaluator evalTrain( agentContinous, rewardFunctionContinous );
 				AdaBoostMDPBinaryDiscreteEvaluator<AdaBoostMDPClassifierContinousBinary> evalTrain( agentContinous, rewardFunctionContinous );
+				// only RBFStateModifier is free of internal buffers, so it can be shared by the threads
+				if (sptype==4) evalTrain.setParallelEvaluation( qData, evalThreads );
 				
 				BinaryResultStruct bres;
 				bres.origAcc = ovaccTrain;
@@ -824,11 +953,22 @@ int main(int argc, const char *argv[])
 				classifierContinous->setCurrentDataToTest();
 				//AdaBoostMDPClassifierContinousBinaryEvaluator evalTest( agentContinous, rewardFunctionContinous );
 				AdaBoostMDPBinaryDiscreteEvaluator<AdaBoostMDPClassifierContinousBinary> evalTest( agentContinous, rewardFunctionContinous );
+				if (sptype==4) evalTest.setParallelEvaluation( qData, evalThreads );
 				
 				bres.origAcc = ovaccTest;
 				sprintf( logfname, "./%s/classTest_%d.txt", logDirContinous.c_str(), i );
 				evalTest.classficationAccruacy(bres,logfname);			
                 
+				if ((sptype==4)&&(verbose>1))
+				{
+					// the same greedy policy without the agent, as it would be deployed
+					ArrayBasedGreedyPolicy<FUNCTIONTYPE> compiledPolicy( dynamic_cast<ArrayBasedQFunctionBinary<FUNCTIONTYPE>* >(qData) );
+					AdaBoostMDPPolicyClassifier compiledClassifier( datahandler, &compiledPolicy );
+					double compiledUsedClassifierAvg;
+					double compiledAcc = compiledClassifier.getAccuracyOnCurrentDataSet( compiledUsedClassifierAvg );
+					cout << "******** Test accuracy by compiled policy: " << compiledAcc << " (classifier used: " << compiledUsedClassifierAvg << ")" << endl;
+				}
+				
                 if (sptype==3)
                 {
                     cout << "CENTERS : " << endl;                    
@@ -865,6 +1005,11 @@ int main(int argc, const char *argv[])
                     fprintf(improvementLogFile, "%i\n", i);
                     fclose(improvementLogFile);
                     
+					if ((cascadeBuckets > 0)&&(sptype!=2))
+					{
+						FeatureQFunctionGreedyPolicy cascadePolicy( dynamic_cast<CFeatureQFunction*>(qData), discState, classifierContinous->getStateProperties(), agentContinous->getActions(), 1 );
+						exportCascade( &cascadePolicy, datahandler, cascadeBuckets, cascadeFileName, verbose );
+					}
                 }
 				if ((bres.acc >= bestAcc)&&(sptype==4)) {
                     bestEpNumber = i;
@@ -891,6 +1036,12 @@ int main(int argc, const char *argv[])
                     fprintf(improvementLogFile, "%i\n", i);
                     fclose(improvementLogFile);
                     
+					if (cascadeBuckets > 0)
+					{
+						ArrayBasedGreedyPolicy<FUNCTIONTYPE> cascadePolicy( dynamic_cast<ArrayBasedQFunctionBinary<FUNCTIONTYPE>* >(qData) );
+						exportCascade( &cascadePolicy, datahandler, cascadeBuckets, cascadeFileName, verbose );
+					}
+                    
                     //					dynamic_cast<RBFBasedQFunctionBinary*>(qData)->saveQTable("QTable.dta");
 				}
                 
@@ -924,6 +1075,10 @@ int main(int argc, const char *argv[])
 			
 			
 		}
+		
+		// frees the environments, agents, policies and learners of the workers
+		delete parallelTrainer;
+		
 		////////////////////////////////////////////////////
 		// multi-class
 		////////////////////////////////////////////////////		
@@ -1041,6 +1196,11 @@ int main(int argc, const char *argv[])
 		// Set the controller of the agent
 		agentContinous->setController(policy);
 		
+		// Hogwild-style training on several threads, the Q-function must be thread safe
+		AdaBoostMDPParallelSarsaTrainer* parallelTrainer = NULL;
+		if ((trainThreads > 1)&&(dynamic_cast<ArrayBasedQFunctionBinary<FUNCTIONTYPE>* >(qData) != NULL))
+			parallelTrainer = new AdaBoostMDPParallelSarsaTrainer(agentContinous, classifierContinous, qData, qFunctionLearner, currentEpsilon, trainThreads);
+		
 		//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 		//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 		//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1081,6 +1241,9 @@ int main(int argc, const char *argv[])
 		
 		int steps2 = 0;
 		int usedClassifierNumber=0;
+#ifdef MDDAG_COUNT_ALLOCATIONS
+		unsigned long episodeAllocations = 0;
+#endif
 		int max_Steps = 100000;
 		double ovacc = 0.0;
 		double ovaccTrain, ovaccTest;
@@ -1100,32 +1263,52 @@ int main(int argc, const char *argv[])
 		// Learn for 500 Episodes
 		for (int i = 0; i < episodeNumber; i++)
 		{
-			// set adaptive Epsilon
-			//policy->setParameter("EpsilonGreedy", 0.1 / (i + 1));
-			//policy->setParameter("EpsilonGreedy", 0.5 / epsDivisor);
-			//learner->setParameter("QLearningRate", 0.1 / qRateDivisor);
+			if (parallelTrainer)
+			{
+				// the episodes i..roundEnd run in parallel, the checks below are done after the last one
+				int roundEnd = getRoundEnd(i, evalTestIteration, episodeNumber);
+				int roundSucceeded = 0;
+				parallelTrainer->runEpisodes(roundEnd - i + 1, max_Steps, usedClassifierNumber, roundSucceeded);
+				ges_succeeded += roundSucceeded;
+				ges_failed += (roundEnd - i + 1) - roundSucceeded;
+				i = roundEnd;
+			}
+			else
+			{
+				// set adaptive Epsilon
+				//policy->setParameter("EpsilonGreedy", 0.1 / (i + 1));
+				//policy->setParameter("EpsilonGreedy", 0.5 / epsDivisor);
+				//learner->setParameter("QLearningRate", 0.1 / qRateDivisor);
 			
-			// Do one training trial, with max max_Steps steps
-			agentContinous->startNewEpisode();
-			classifierContinous->setRandomizedInstance();
-			steps2 = agentContinous->doControllerEpisode(1, max_Steps);
+				// Do one training trial, with max max_Steps steps
+				agentContinous->startNewEpisode();
+				classifierContinous->setRandomizedInstance();
+#ifdef MDDAG_COUNT_ALLOCATIONS
+				unsigned long allocationsBefore = g_numAllocations;
+#endif
+				steps2 = agentContinous->doControllerEpisode(1, max_Steps);
+#ifdef MDDAG_COUNT_ALLOCATIONS
+				episodeAllocations += g_numAllocations - allocationsBefore;
+#endif
 			
-			//printf("Number fo classifier: %d\n", classifierContinous->getUsedClassifierNumber() );
-			//printf("Episode %d %s with %d steps\n", i, classifierContinous->classifyCorrectly() ? "*succed*" : "*failed*", steps2);
+				//printf("Number fo classifier: %d\n", classifierContinous->getUsedClassifierNumber() );
+				//printf("Episode %d %s with %d steps\n", i, classifierContinous->classifyCorrectly() ? "*succed*" : "*failed*", steps2);
 			
 			
 			
-			usedClassifierNumber += classifierContinous->getUsedClassifierNumber();
+				usedClassifierNumber += classifierContinous->getUsedClassifierNumber();
 			
-			bool clRes = classifierContinous->classifyCorrectly();				
-			if ( clRes ) {
-				//cout << "Classification result: CORRECT, instance: " << classifier->getCurrentInstance() << endl;
-				ges_succeeded++;
-			}
-			else {
-				ges_failed++;
-				//cout << "Classification result: FAILED, instance: " << classifier->getCurrentInstance() << endl;			
+				bool clRes = classifierContinous->classifyCorrectly();				
+				if ( clRes ) {
+					//cout << "Classification result: CORRECT, instance: " << classifier->getCurrentInstance() << endl;
+					ges_succeeded++;
+				}
+				else {
+					ges_failed++;
+					//cout << "Classification result: FAILED, instance: " << classifier->getCurrentInstance() << endl;			
+				}
 			}
+
 			
 			
 			if ((i>2)&&((i%1000)==0))
@@ -1138,6 +1321,10 @@ int main(int argc, const char *argv[])
 				cout << "Current alpha    :" << '\t' << currentAlpha << endl;
 				cout << "Current Epsilon  :" << '\t' << currentEpsilon << endl;
 				cout << "Current lambda   :" << '\t' << currentLambda << endl;
+#ifdef MDDAG_COUNT_ALLOCATIONS
+				cout << "Allocs/episode   :" << '\t' << ((double)episodeAllocations / 1000.0) << endl;
+				episodeAllocations = 0;
+#endif
 				usedClassifierNumber = 0;
 			}
 			
@@ -1147,6 +1334,7 @@ int main(int argc, const char *argv[])
 				epsDivisor++;
 				currentEpsilon =  initEps / epsDivisor;
 				policy->setParameter("EpsilonGreedy", currentEpsilon);
+				if (parallelTrainer) parallelTrainer->setEpsilon(currentEpsilon);
                 
 			}
 			if ((i>2)&&((i%10000)==0)) 
@@ -1154,6 +1342,7 @@ int main(int argc, const char *argv[])
 				qRateDivisor++;
 				currentAlpha = initAlpha / qRateDivisor;
 				qFunctionLearner->setParameter("QLearningRate", currentAlpha);			
+				if (parallelTrainer) parallelTrainer->setLearnerParameter("QLearningRate", currentAlpha);
 			}
 			
 			if ((i>2)&&((i%10000)==0)) 
@@ -1161,6 +1350,7 @@ int main(int argc, const char *argv[])
 				lambdaRateDivisor++;
 				currentLambda = initLambda / qRateDivisor;				
 				qFunctionLearner->setParameter("Lambda", currentLambda);
+				if (parallelTrainer) parallelTrainer->setLearnerParameter("Lambda", currentLambda);
 			}
 			
 			
@@ -1186,6 +1376,7 @@ int main(int argc, const char *argv[])
 				// TRAIN			
 				classifierContinous->setCurrentDataToTrain();				
 				AdaBoostMDPClassifierContinousEvaluator evalTrain( agentContinous, rewardFunctionContinous );
+				evalTrain.setParallelEvaluation( qData, evalThreads );
 				
 				double acc, usedclassifierNumber;			
 				sprintf( logfname, "./%s/classValid_%d.txt", logDirContinous.c_str(), i );
@@ -1207,6 +1398,7 @@ int main(int argc, const char *argv[])
 				// TEST
 				classifierContinous->setCurrentDataToTest();
 				AdaBoostMDPClassifierContinousEvaluator evalTest( agentContinous, rewardFunctionContinous);
+				evalTest.setParallelEvaluation( qData, evalThreads );
 				
 				
 				sprintf( logfname, "./%s/classTest_%d.txt", logDirContinous.c_str(), i );				
@@ -1232,7 +1424,8 @@ int main(int argc, const char *argv[])
 			
 		}
 		
-		
+		// frees the environments, agents, policies and learners of the workers
+		delete parallelTrainer;
 		
 	}
 	
@@ -141,6 +141,28 @@ namespace MultiBoost {
 			AlphaReal halfTheta,
 			vector<sRates>* pMu = NULL, vector<AlphaReal>* pV = NULL);
 
+		/**
+		* Same as findSingleThresholdWithInit, but on a column quantized by SortedData. 
+		* The weighted labels are summed into per-class histograms of the bins in a single
+		* pass over the examples (in the order of the examples), then only the borders of 
+		* the bins are tried as thresholds. If every distinct value has its own bin the 
+		* result is the same as the one of findSingleThresholdWithInit.
+		* \param bins The bin of each example, indexed by the raw index of the example.
+		* \param binMins The smallest value of each bin.
+		* \param binMaxs The largest value of each bin.
+		* \param numBins The number of bins. Examples with a larger bin index (missing values) are skipped.
+		* \param pData The pointer to the original data class. 
+		* \param pMu The The class-wise rates to update. (if provided)
+		* \param pV The alignment vector to update. (if provided)
+		* \see SortedData::getHistogramColumn
+		* \return The threshold found.
+		*/
+		FeatureReal findSingleThresholdHistogramWithInit(const unsigned char* bins,
+			const FeatureReal* binMins, const FeatureReal* binMaxs, int numBins,
+			InputData* pData,
+			AlphaReal halfTheta,
+			vector<sRates>* pMu = NULL, vector<AlphaReal>* pV = NULL);
+
 		/**
 		* Find the optimal thresholds (one for each class) that maximizes
 		* the edge (or minimizes the error) on the given data weighted data.
@@ -196,6 +218,8 @@ namespace MultiBoost {
 		vector<AlphaReal> _halfWeightsPerClass; //!< The half of the total weights per class.
 		vector<vpIterator> _bestSplitPoss; // the iterator of the best split
 		vector<vpIterator> _bestPreviousSplitPoss; // the iterator of the example before the best split
+		vector<AlphaReal> _histogram; //!< the weighted labels of the bins, [bin * numClasses + classIdx]
+		vector<int> _binCounts; //!< the number of examples in the bins
         
 	};
 
@@ -340,6 +364,123 @@ namespace MultiBoost {
 
 	//////////////////////////////////////////////////////////////////////////
 
+	template <typename T> 
+	FeatureReal StumpAlgorithm<T>::findSingleThresholdHistogramWithInit
+		(const unsigned char* bins, const FeatureReal* binMins, const FeatureReal* binMaxs, int numBins,
+		InputData* pData, AlphaReal halfTheta, vector<sRates>* pMu, vector<AlphaReal>* pV)
+	{ 
+		const int numClasses = pData->getNumClasses();
+		const int numExamples = pData->getNumExamples();
+
+		_histogram.assign(numBins * numClasses, 0);
+		_binCounts.assign(numBins, 0);
+
+		vector<Label>::const_iterator lIt;
+
+		// fill the histograms, the examples (and their labels) are read sequentially
+		for (int i = 0; i < numExamples; ++i)
+		{
+			const int bin = bins[ pData->getRawIndex(i) ];
+			if ( bin >= numBins ) // missing value
+				continue;
+
+			++_binCounts[bin];
+
+			AlphaReal* binHistogram = &_histogram[ bin * numClasses ];
+			vector<Label>& labels = pData->getLabels(i);
+			for (lIt = labels.begin(); lIt != labels.end(); ++lIt )
+				binHistogram[ lIt->idx ] += lIt->weight * lIt->y;
+		}
+
+		// the cut after the last non-empty bin would be the constant classifier
+		int lastBin = numBins - 1;
+		while ( lastBin >= 0 && _binCounts[lastBin] == 0 )
+			--lastBin;
+
+		// initialize halfEdges to the constant classifier's half edges 
+		copy(_constantHalfEdges.begin(), _constantHalfEdges.end(), _halfEdges.begin());
+
+		AlphaReal currHalfEdge = 0;
+		AlphaReal bestHalfEdge = -numeric_limits<AlphaReal>::max();
+		int bestBin = -1;
+
+		// find the best cut between two bins
+		for (int b = 0; b < lastBin; ++b)
+		{
+			// an empty bin gives the same cut as the previous one
+			if ( _binCounts[b] == 0 )
+				continue;
+
+			const AlphaReal* binHistogram = &_histogram[ b * numClasses ];
+			for (int l = 0; l < numClasses; ++l)
+				_halfEdges[l] -= binHistogram[l];
+
+			currHalfEdge = 0;
+
+			if ( nor_utils::is_zero(halfTheta) ) {
+				for (int l = 0; l < numClasses; ++l) { 
+					// flip the class-wise edge if it is negative
+					if ( _halfEdges[l] > 0 )
+						currHalfEdge += _halfEdges[l];
+					else
+						currHalfEdge -= _halfEdges[l];
+				}
+			}
+			else {
+				for (int l = 0; l < numClasses; ++l) { 
+					if ( _halfEdges[l] > halfTheta )
+						currHalfEdge += _halfEdges[l];
+					else if ( _halfEdges[l] < -halfTheta )
+						currHalfEdge -= _halfEdges[l];
+				}
+			}
+
+			// the current edge is the new maximum
+			if (currHalfEdge > bestHalfEdge)
+			{
+				bestHalfEdge = currHalfEdge;
+				bestBin = b;
+
+				for (int l = 0; l < numClasses; ++l)
+					_bestHalfEdges[l] = _halfEdges[l];
+			}
+		}
+
+		// If we found a valid stump in this dimension
+		if (bestBin >= 0) 
+		{
+			// the threshold is between the best bin and the next non-empty one
+			int nextBin = bestBin + 1;
+			while ( _binCounts[nextBin] == 0 )
+				++nextBin;
+
+			FeatureReal threshold = static_cast<FeatureReal>( binMaxs[bestBin] + binMins[nextBin] ) / 2;
+
+			if ( pMu ) 
+			{
+				for (int l = 0; l < numClasses; ++l)
+				{
+					if (_bestHalfEdges[l] > 0)
+						(*pV)[l] = +1;
+					else
+						(*pV)[l] = -1;
+
+					(*pMu)[l].classIdx = l;
+
+					(*pMu)[l].rPls  = _halfWeightsPerClass[l] + (*pV)[l] * _bestHalfEdges[l];
+					(*pMu)[l].rMin  = _halfWeightsPerClass[l] - (*pV)[l] * _bestHalfEdges[l];
+					(*pMu)[l].rZero = (*pMu)[l].rPls + (*pMu)[l].rMin; // == weightsPerClass[l]
+				}
+			}
+			return threshold;
+		}
+		else
+			return numeric_limits<FeatureReal>::signaling_NaN();
+
+	} // end of findSingleThresholdHistogramWithInit
+
+	//////////////////////////////////////////////////////////////////////////
+
 	template <typename T> 
 	void StumpAlgorithm<T>::findMultiThresholds(const vpIterator& dataBegin,
 		const vpIterator& dataEnd,
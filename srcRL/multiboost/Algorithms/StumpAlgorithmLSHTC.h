@@ -239,7 +239,7 @@ namespace MultiBoost {
 	{ 
 		const int numClasses = pData->getNumClasses();
 
-		if ( static_cast<SortedData*>(pData)->isFilteredAttributeEmpty() ) { // empty the current feature, so we can use only the constant learner		
+		if ( dataBegin == dataEnd ) { // empty the current feature, so we can use only the constant learner		
 			FeatureReal threshold = -numeric_limits<FeatureReal>::max(); // we assume that the missing values are equal to zero
 
 			// Fill the mus if present. This could have been done in the threshold loop, 
@@ -55,7 +55,7 @@ template< typename BaseType=double,typename KeyType=string>
 class UCT : public GenericBanditAlgorithmLS< BaseType, KeyType>
 {
 protected:
-	InnerNodeUCTSparse	_root;
+	UCTTree	_root;
 	locale										_loc; 
 
 public:
@@ -64,8 +64,8 @@ public:
 	virtual void initialize( map<KeyType,BaseType>& vals );
 	virtual KeyType getNextAction( KeyType defaultValue );
 
-	virtual void setDepth( int d ) { InnerNodeUCTSparse::setDepth( d ); }
-	virtual void setOrder( int o ) { InnerNodeUCTSparse::setBranchOrder( o ); }
+	virtual void setDepth( int d ) { UCTTree::setDepth( d ); }
+	virtual void setOrder( int o ) { UCTTree::setBranchOrder( o ); }
 
 protected:
 	virtual void updateithValue( KeyType key ){}		
@@ -88,7 +88,7 @@ void UCT<BaseType,KeyType>::initialize( map<KeyType,BaseType>& vals )
 template< typename BaseType,typename KeyType>
 void UCT<BaseType,KeyType>::receiveReward( KeyType key, BaseType reward )
 {
-	int d = InnerNodeUCTSparse::getDepth();
+	int d = UCTTree::getDepth();
 	stringstream ss( static_cast<string>(key) );
 	ss.imbue( _loc );
 	vector<int> tmpArms( d );
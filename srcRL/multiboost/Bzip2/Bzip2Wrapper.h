@@ -153,6 +153,30 @@ public:
 		return bzr;
 	}
 	
+	// reads at most size characters, returns the number of characters read
+	int read( char* pBuffer, int size ) {
+		int numRead = 0;
+		
+		// first the characters put back
+		while ( bufPos > 0 && numRead < size ) {
+			pBuffer[ numRead++ ] = (char) get();
+		}
+		
+		if ( numRead < size && !eof() ) {
+			int bzerror = 0;
+			int nbuf = BZ2_bzRead ( &bzerror, b, pBuffer + numRead, size - numRead );
+			if ( bzerror == BZ_OK || bzerror == BZ_STREAM_END ) {
+				numRead += nbuf;
+				filePos += nbuf;
+			}
+			if ( bzerror != BZ_OK ) {
+				setError( BZ_STREAM_END );
+			}
+		}
+		
+		return numRead;
+	}
+
 	int get( void ) {
 		int bzerror = 0;
 		char tmpBuf[ 8 ];
@@ -65,27 +65,8 @@ namespace MultiBoost {
     
     InputData* SoftCascadeClassifier::loadInputData(const string& dataFileName, const string& shypFileName)
     {
-        // open file
-        ifstream inFile(shypFileName.c_str());
-        if (!inFile.is_open())
-        {
-            cerr << "ERROR: Cannot open strong hypothesis file <" << shypFileName << ">!" << endl;
-            exit(1);
-        }
-        
-        // Declares the stream tokenizer
-        nor_utils::StreamTokenizer st(inFile, "<>\n\r\t");
-        
-        // Move until it finds the multiboost tag
-        if ( !UnSerialization::seekSimpleTag(st, "multiboost") )
-        {
-            // no multiboost tag found: this is not the correct file!
-            cerr << "ERROR: Not a valid MultiBoost Strong Hypothesis file!!" << endl;
-            exit(1);
-        }
-        
-        // Move until it finds the algo tag
-        string basicLearnerName = UnSerialization::seekAndParseEnclosedValue<string>(st, "algo");
+        // the name of the weak learner, from a text or a binary strong hypothesis file
+        string basicLearnerName = UnSerialization::getWeakLearnerName(shypFileName);
         
         // Check if the weak learner exists
         if ( !BaseLearner::RegisteredLearners().hasLearner(basicLearnerName) )
@@ -46,6 +46,7 @@
 
 static const char SHYP_NAME[] = "shyp"; //!< The default strong hypothesis file name
 static const char SHYP_EXTENSION[] = "xml"; //!< The default strong hypothesis file name extension
+static const char SHYP_BINARY_EXTENSION[] = "bshyp"; //!< The default extension of the binary strong hypothesis files
 static const char OUTPUT_NAME[] = "outputinfo.dta"; //!< The default outputinfo file name
 
 static const char COMMENT[] = "Research code"; //!< Comment to put in the executable 
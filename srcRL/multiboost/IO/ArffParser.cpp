@@ -44,8 +44,6 @@ namespace MultiBoost {
 	ArffParser::ArffParser(const string& fileName,const string& headerFileName)
 	: GenericParser(fileName, headerFileName), _hasName(false)
 	{
-		_denseLocale  = locale(locale(), new nor_utils::white_spaces(", "));
-		_sparseLocale = locale(locale(), new nor_utils::white_spaces(", "));
 	}
 	
 	// ------------------------------------------------------------------------
@@ -65,8 +63,14 @@ namespace MultiBoost {
 		_dataRep = DR_UNKNOWN;
 		_labelRep = LR_UNKNOWN;
 		
+		// where the data section starts, the whole file with a separate header
+		streamoff dataOffset = 0;
+		
 		if (_headerFileName.empty())
+		{
 			readHeader(inFile, classMap, enumMaps, attributeNameMap, attributeTypes);
+			dataOffset = inFile.tellg();
+		}
 		else {
 			// open separate header file
 			ifstream inHeaderFile(_headerFileName.c_str());
@@ -77,7 +81,14 @@ namespace MultiBoost {
 			}		
 			readHeader(inHeaderFile, classMap, enumMaps, attributeNameMap, attributeTypes);
 		}
-		readData(inFile, examples, classMap, enumMaps, attributeTypes);
+		inFile.close();
+		
+		// the data section is parsed from the memory
+		MappedFile mappedFile(_fileName);
+		if ( dataOffset < 0 || dataOffset > static_cast<streamoff>(mappedFile.size()) )
+			dataOffset = mappedFile.size(); // the header ended with the file
+		readData(mappedFile.begin() + dataOffset, mappedFile.end(), 
+				 examples, classMap, enumMaps, attributeTypes);
 		
 	}
 	
@@ -219,219 +230,175 @@ namespace MultiBoost {
 	
 	// ------------------------------------------------------------------------
 	
-	void ArffParser::readData( ifstream& in, vector<Example>& examples,
-							  NameMap& classMap, vector<NameMap>& enumMaps,
+	void ArffParser::readData( const char* pBegin, const char* pEnd, vector<Example>& examples,
+							  const NameMap& classMap, const vector<NameMap>& enumMaps,
 							  const vector<RawData::eAttributeType>& attributeTypes )
 	{
-		char firstChar = 0;
-		string tmpLine;
+		ArffRowParser rowParser(_numAttributes, _hasName, classMap, enumMaps, attributeTypes);
 		
-		istringstream ssDense;
-		ssDense.imbue(_denseLocale);
-		istringstream ssSparse;
-		ssSparse.imbue(_sparseLocale);
+		cout << "Now reading file.." << flush;
+		ChunkedParser::parseRows(pBegin, pEnd, rowParser, examples);
+		cout << "Done!" << endl;
 		
-		cout << "Counting rows.." << flush;
-		size_t numRows = nor_utils::count_rows(in);
-		cout << "Allocating.." << flush;
-		try {
-			examples.resize(numRows);
-		} 
-		catch(...) {
-			cerr << "ERROR: Cannot allocate memory for storage!" << endl;
-			exit(1);
+		rowParser.mergeRepresentations(_dataRep, _labelRep);
+		
+		// sparse representation always set the weight!
+		if ( _labelRep == LR_SPARSE )
+			_hasWeigthInit = true;
+	}
+	
+	// ------------------------------------------------------------------------
+	// ------------------------------------------------------------------------
+	
+	ArffRowParser::ArffRowParser(int numAttributes, bool hasName, const NameMap& classMap, 
+								 const vector<NameMap>& enumMaps, 
+								 const vector<RawData::eAttributeType>& attributeTypes)
+	: _numAttributes(numAttributes), _hasName(hasName), _classMap(classMap), 
+	  _enumMaps(enumMaps), _attributeTypes(attributeTypes)
+	{
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	bool ArffRowParser::isRow(const char* pLine, const char* pLineEnd) const
+	{
+		for ( ; pLine != pLineEnd; ++pLine )
+		{
+			if ( !isspace(*pLine) )
+				return *pLine != '%'; // comment!
 		}
-		cout << "Done!" << endl;
+		return false;
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	void ArffRowParser::beginChunks(int numChunks)
+	{
+		_chunkDataReps.assign(numChunks, DR_UNKNOWN);
+		_chunkLabelReps.assign(numChunks, LR_UNKNOWN);
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	void ArffRowParser::parseRow(int chunkIdx, const char* pLine, const char* pLineEnd, Example& example)
+	{
+		const char* pTokenEnd;
+		const char* p = ChunkedParser::nextToken(pLine, pLineEnd, pTokenEnd);
 		
-		cout << "Now reading file.." << flush;
-		size_t i;
-		for (i = 0; i < numRows; ++i)
+		// read the name if specified
+		if ( _hasName )
 		{
-			while ( isspace(firstChar = in.get()) && !in.eof() );
-			
-			if (in.eof())
-				break;
+			example.setName( string(p, pTokenEnd) );
+			p = ChunkedParser::nextToken(pTokenEnd, pLineEnd, pTokenEnd);
+		}
+		
+		if ( p != pLineEnd && *p == '{' ) // sparse data!
+		{
+			setDataRep(chunkIdx, DR_SPARSE);
 			
-			Example& currExample = examples[i];
+			bool hasLabels;
+			p = parseSparseValues(pTokenEnd, pLineEnd, example.getValues(), example.getValuesIndexes(), 
+								  example.getValuesIndexesMap(), hasLabels);
 			
-			//////////////////////////////////////////////////////////////////////////
-			// first read the data
-			if ( firstChar == '%' ) // comment!
+			p = ChunkedParser::nextToken(p, pLineEnd, pTokenEnd);
+			if ( hasLabels && p != pLineEnd && *p == '{' ) // sparse label
 			{
-				getline(in, tmpLine);
-				continue;
+				setLabelRep(chunkIdx, LR_SPARSE);
+				parseExtendedLabels(pTokenEnd, pLineEnd, example.getLabels());
 			}
-			
-			// read the name if specified
-			if ( _hasName )
+			else // dense, only one label in the brackets
 			{
-				in.putback(firstChar);
-				currExample.setName( readName(in) );
-				while ( !in.eof() )
+				setLabelRep(chunkIdx, LR_DENSE);
+				
+				// if empty, set to default value
+				if ( !hasLabels || p == pLineEnd || *p == '}' )
 				{
-					// skip spaces and the comma
-					firstChar = in.get();
-					if ( !isspace(firstChar) && firstChar != ',' )
-						break;
+					vector<Label>& labels = example.getLabels();
+					parseSimpleLabels(pLineEnd, pLineEnd, labels, 0);
+					labels[0].y = +1;
 				}
+				else
+					parseSimpleLabels(p, pLineEnd, example.getLabels(), 1);
 			}
+		}
+		else // dense!
+		{
+			setDataRep(chunkIdx, DR_DENSE);
+			
+			p = parseDenseValues(p, pLineEnd, example.getValues());
 			
-			if ( firstChar == '{' ) // sparse data!
+			// now read the labels
+			p = ChunkedParser::nextToken(p, pLineEnd, pTokenEnd);
+			if ( p != pLineEnd && *p == '{' ) // weight is specified!
 			{
-				if ( _dataRep == DR_DENSE )
-				{
-					cerr << "ERROR: Cannot have dense and sparse data at the same time!" << endl;
-					exit(1);
-				}
-				else if ( _dataRep == DR_UNKNOWN )
-					_dataRep = DR_SPARSE;
-				
-				getline(in, tmpLine, '}');
-				ssSparse.clear();
-				ssSparse.str(tmpLine);
-				
-				readSparseValues(ssSparse, currExample.getValues(), currExample.getValuesIndexes(), currExample.getValuesIndexesMap(),
-								 enumMaps, attributeTypes );
-				
-				
-				//string remaining(ssSparse.str().substr(ssSparse.tellg()));
-				
-				ios::pos_type currPos = ssSparse.tellg();				
-				string nextToken;
-				ssSparse >> nextToken;												
-				
-				if ( nextToken.empty() || (nextToken[0] != '{') ) // dense 
-				{
-					if ( _labelRep == LR_SPARSE )
-					{
-						cerr << "ERROR: Labels were declared sparse, but they are not formatted correctly (with {}!)!" << endl;
-						exit(1);
-					}
-					
-					_labelRep = LR_DENSE;
-					
-					// if empty, set to default value					
-					if (nextToken.empty()) nextToken = classMap.getNameFromIdx(0);					
-					ssSparse.clear();
-					ssSparse.str(nextToken);
-					readSimpleLabels(ssSparse, currExample.getLabels(), classMap);
-				} else if (nextToken[0] == '{'){ //sparse label
-					if ( _labelRep == LR_DENSE )
-					{
-						cerr << "ERROR: Labels cannot be formatted both in dense and sparse format!" << endl;
-						exit(1);
-					}
-					_labelRep = LR_SPARSE;
-					
-					ssSparse.clear();
-					ssSparse.seekg(currPos);
-															
-					while ( !in.eof() )
-					{
-						// skip spaces and the last bracket
-						firstChar = ssSparse.get();
-						if ( firstChar == '{' )
-							break;
-					}										
-					
-					readExtendedLabels(ssSparse, currExample.getLabels(), classMap);
-					
-					while ( !in.eof() )
-					{
-						// skip spaces and the last bracket
-						firstChar = in.get();
-						if ( !isspace(firstChar) && firstChar != '}' )
-							break;
-					}	
-					in.putback(firstChar);
-				} else {
-					cout << "Unknown label representation! (ArffPArser)" << endl;
-					exit(-1);
-				}
-				
-				
+				setLabelRep(chunkIdx, LR_SPARSE);
+				parseExtendedLabels(pTokenEnd, pLineEnd, example.getLabels());
 			}
-			else // dense!
+			else
 			{
-				if ( _dataRep == DR_SPARSE )
-				{
-					cerr << "ERROR: Cannot have dense and sparse data at the same time!" << endl;
-					exit(1);
-				}
-				else if ( _dataRep == DR_UNKNOWN )
-					_dataRep = DR_DENSE;
-				
-				in.putback(firstChar);
-				readDenseValues(in, currExample.getValues(), enumMaps, attributeTypes);
-				
-				
-				//////////////////////////////////////////////////////////////////////////
-				while ( !in.eof() )
-				{
-					// skip spaces and the last comma
-					firstChar = in.get();
-					if ( !isspace(firstChar) && firstChar != ',' )
-						break;
-				}
-				
-				// now read the labels
-				if ( firstChar == '{' ) // weight is specified!
-				{
-					if ( _labelRep == LR_DENSE )
-					{
-						cerr << "ERROR: Labels cannot be formatted both in dense and sparse format!" << endl;
-						exit(1);
-					}
-					_labelRep = LR_SPARSE;
-					
-					getline(in, tmpLine);
-					ssSparse.clear();
-					ssSparse.str(tmpLine);
-					
-					readExtendedLabels(ssSparse, currExample.getLabels(), classMap);
-				}
-				else // dense!
-				{
-					if ( _labelRep == LR_SPARSE )
-					{
-						cerr << "ERROR: Labels were declared sparse, but they are not formatted correctly (with {}!)!" << endl;
-						exit(1);
-					}
-					
-					_labelRep = LR_DENSE;
-					
-					in.putback(firstChar);
-					
-					getline(in, tmpLine);
-					ssDense.clear();
-					ssDense.str(tmpLine);
-					
-					readSimpleLabels(ssDense, currExample.getLabels(), classMap);
-				}
+				setLabelRep(chunkIdx, LR_DENSE);
+				parseSimpleLabels(p, pLineEnd, example.getLabels(), numeric_limits<int>::max());
 			}
 		}
-		
-		cout << "Done!" << endl;
-		
-		if ( i != numRows )
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	void ArffRowParser::mergeRepresentations(eDataRep& dataRep, eLabelRep& labelRep) const
+	{
+		for (size_t c = 0; c < _chunkDataReps.size(); ++c)
 		{
-			// last row was empty!
-			examples.resize(i);
+			if ( _chunkDataReps[c] == DR_UNKNOWN )
+				continue; // no row in the chunk
+			
+			if ( dataRep != DR_UNKNOWN && dataRep != _chunkDataReps[c] )
+			{
+				cerr << "ERROR: Cannot have dense and sparse data at the same time!" << endl;
+				exit(1);
+			}
+			dataRep = _chunkDataReps[c];
+			
+			if ( labelRep != LR_UNKNOWN && labelRep != _chunkLabelReps[c] )
+			{
+				cerr << "ERROR: Labels cannot be formatted both in dense and sparse format!" << endl;
+				exit(1);
+			}
+			labelRep = _chunkLabelReps[c];
 		}
-		
-		// sparse representation always set the weight!
-		if ( _labelRep == LR_SPARSE )
-			_hasWeigthInit = true;
 	}
 	
 	// ------------------------------------------------------------------------
 	
-	void ArffParser::readSimpleLabels( istringstream& ss, vector<Label>& labels,
-									  NameMap& classMap )
+	void ArffRowParser::setDataRep(int chunkIdx, eDataRep dataRep)
 	{
-		
-		string strLabel;
-		const int numClasses = classMap.getNumNames();
+		eDataRep& chunkDataRep = _chunkDataReps[chunkIdx];
+		if ( chunkDataRep != DR_UNKNOWN && chunkDataRep != dataRep )
+		{
+			cerr << "ERROR: Cannot have dense and sparse data at the same time!" << endl;
+			exit(1);
+		}
+		chunkDataRep = dataRep;
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	void ArffRowParser::setLabelRep(int chunkIdx, eLabelRep labelRep)
+	{
+		eLabelRep& chunkLabelRep = _chunkLabelReps[chunkIdx];
+		if ( chunkLabelRep != LR_UNKNOWN && chunkLabelRep != labelRep )
+		{
+			cerr << "ERROR: Labels cannot be formatted both in dense and sparse format!" << endl;
+			exit(1);
+		}
+		chunkLabelRep = labelRep;
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	void ArffRowParser::parseSimpleLabels( const char* p, const char* pLineEnd, 
+										  vector<Label>& labels, int maxNumLabels )
+	{
+		const int numClasses = _classMap.getNumNames();
 		labels.resize(numClasses);
 		
 		for ( int i = 0; i < numClasses; ++i )
@@ -441,100 +408,128 @@ namespace MultiBoost {
 		}
 		
 		// now get the declared labels
-		while (!ss.eof())
+		const char* pTokenEnd = p;
+		for ( int i = 0; i < maxNumLabels; ++i )
 		{
-			ss >> strLabel;
-			strLabel = nor_utils::trim(strLabel);
-			labels[ classMap.getIdxFromName(strLabel) ].y = +1;
+			p = ChunkedParser::nextToken(pTokenEnd, pLineEnd, pTokenEnd);
+			if ( p == pLineEnd || *p == '}' )
+				break;
+			
+			labels[ ChunkedParser::lookupName(_classMap, p, pTokenEnd) ].y = +1;
 		}
-		
 	}
 	
 	// ------------------------------------------------------------------------
 	
-	void ArffParser::readExtendedLabels( istringstream& ss, vector<Label>& labels,
-										NameMap& classMap )
+	void ArffRowParser::parseExtendedLabels( const char* p, const char* pLineEnd, vector<Label>& labels )
 	{
-		string strLabel;
-		AlphaReal weight;
+		const char* pTokenEnd = p;
+		const char* pName;
+		const char* pNameEnd;
+		bool ok;
 		
 		// now get the declared labels
-		while (!ss.eof())
+		for (;;)
 		{
-			Label tmpLabel;
-			ss >> strLabel;
+			pName = ChunkedParser::nextToken(pTokenEnd, pLineEnd, pNameEnd);
+			if ( pName == pLineEnd || *pName == '}' )
+				break;
 			
-			if ( strLabel == "}" || ss.eof() )
+			p = ChunkedParser::nextToken(pNameEnd, pLineEnd, pTokenEnd);
+			if ( p == pLineEnd || *p == '}' )
 				break;
 			
-			ss >> weight;
+			const AlphaReal weight = ChunkedParser::parseReal(p, pTokenEnd, ok);
 			
+			Label tmpLabel;
 			tmpLabel.y = nor_utils::sign(weight);
 			tmpLabel.weight = abs(weight); // this will be used later in RawData to set the weights
-			
-			strLabel = nor_utils::trim(strLabel);
-			tmpLabel.idx = classMap.getIdxFromName(strLabel);
+			tmpLabel.idx = ChunkedParser::lookupName(_classMap, pName, pNameEnd);
 			labels.push_back(tmpLabel);
 		}
 	}
 	
 	// ------------------------------------------------------------------------
 	
-	void ArffParser::readDenseValues(ifstream& in, vector<FeatureReal>& values,
-									 vector<NameMap>& enumMaps, 
-									 const vector<RawData::eAttributeType>& attributeTypes )
+	FeatureReal ArffRowParser::parseValue(int attributeIdx, const char* pBegin, const char* pEnd) const
+	{
+		if ( _attributeTypes[attributeIdx] == RawData::ATTRIBUTE_NUMERIC ) 
+		{
+			if ( ChunkedParser::isToken(pBegin, pEnd, "?") || ChunkedParser::isToken(pBegin, pEnd, "NaN") || 
+				ChunkedParser::isToken(pBegin, pEnd, "Nan") )
+				return numeric_limits<float>::infinity();
+			
+			// as atof, the malformed numbers are not errors
+			bool ok;
+			return static_cast<FeatureReal>( ChunkedParser::parseReal(pBegin, pEnd, ok) );
+		}
+		else //if ( attributeTypes[i] == RawData::ATTRIBUTE_ENUM ) 
+			return ChunkedParser::lookupName(_enumMaps[attributeIdx], pBegin, pEnd);
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	const char* ArffRowParser::parseDenseValues( const char* p, const char* pLineEnd, vector<FeatureReal>& values )
 	{
-		const locale& originalLocale = in.imbue(_denseLocale); 
-		
 		values.reserve(_numAttributes);
-		string tmpVal;
 		
+		const char* pTokenEnd;
 		for ( int j = 0; j < _numAttributes; ++j )
 		{
-			in >> tmpVal;
-			if ( attributeTypes[j] == RawData::ATTRIBUTE_NUMERIC ) 
-				if ( ( ! tmpVal.compare( "Nan" ) ) || ( ! tmpVal.compare( "NaN" ) ) || ( ! tmpVal.compare( "?" ) ) )
-					values.push_back( numeric_limits<float>::infinity() );
-			//values.push_back( numeric_limits<float>::max() );
-			//values.push_back( numeric_limits<float>::signaling_NaN() );
-				else
-					values.push_back(atof(tmpVal.c_str()));
-				else //if ( attributeTypes[i] == RawData::ATTRIBUTE_ENUM ) 
-					values.push_back( enumMaps[j].getIdxFromName(tmpVal) );
+			if ( p == pLineEnd )
+			{
+				cerr << "ERROR: A row has " << j << " values instead of " << _numAttributes << "!" << endl;
+				exit(1);
+			}
+			
+			ChunkedParser::nextToken(p, pLineEnd, pTokenEnd);
+			values.push_back( parseValue(j, p, pTokenEnd) );
+			p = ChunkedParser::nextToken(pTokenEnd, pLineEnd, pTokenEnd);
 		}
 		
-		in.imbue(originalLocale);
+		return p;
 	}
 	
 	// -----------------------------------------------------------------------------
 	
-	void ArffParser::readSparseValues(istringstream& ss, vector<FeatureReal>& values, 
-									  vector<int>& idxs, map<int, int>& idxmap, vector<NameMap>& enumMaps, 
-									  const vector<RawData::eAttributeType>& attributeTypes)
+	const char* ArffRowParser::parseSparseValues( const char* p, const char* pLineEnd, vector<FeatureReal>& values, 
+												 vector<int>& idxs, map<int, int>& idxmap, bool& hasLabels )
 	{
-		string tmpVal;
-		int tmpIdx;
+		const int labelFeatureIndex = _attributeTypes.size();
+		const char* pTokenEnd = p;
+		bool ok;
 		int i = 0;
-		int labelFeatureIndex = attributeTypes.size();
-		while (!ss.eof())
+		
+		hasLabels = false;
+		for (;;)
 		{
-			ss >> tmpIdx;
+			p = ChunkedParser::nextToken(pTokenEnd, pLineEnd, pTokenEnd);
+			if ( p == pLineEnd || *p == '}' )
+				return pTokenEnd;
+			
+			const int tmpIdx = ChunkedParser::parseInt(p, pTokenEnd, ok);
+			if ( tmpIdx == labelFeatureIndex )
+			{
+				hasLabels = true;
+				return pTokenEnd;
+			}
 			
-			if (tmpIdx == labelFeatureIndex ) break;
+			if ( !ok || tmpIdx < 0 || tmpIdx > labelFeatureIndex )
+			{
+				cerr << "ERROR: Wrong attribute index <" << string(p, pTokenEnd) << "> in a sparse row!" << endl;
+				exit(1);
+			}
 			
-			idxs.push_back(tmpIdx);
-			idxmap[ tmpIdx ] = i++;
-			ss >> tmpVal;
-			if ( attributeTypes[tmpIdx] == RawData::ATTRIBUTE_NUMERIC ) 
+			p = ChunkedParser::nextToken(pTokenEnd, pLineEnd, pTokenEnd);
+			if ( p == pLineEnd || *p == '}' )
 			{
-				FeatureReal val;
-				stringstream ss;
-				ss.str(tmpVal);
-				ss >> val;
-				values.push_back( val );
-			} else  {// if ( attributeTypes[tmpIdx] == InputData::ATTRIBUTE_ENUM) 
-				values.push_back( enumMaps[tmpIdx].getIdxFromName(tmpVal) );
+				cerr << "ERROR: The attribute " << tmpIdx << " has no value in a sparse row!" << endl;
+				exit(1);
 			}
+			
+			idxs.push_back(tmpIdx);
+			idxmap[ tmpIdx ] = i++;
+			values.push_back( parseValue(tmpIdx, p, pTokenEnd) );
 		}
 	}
 	
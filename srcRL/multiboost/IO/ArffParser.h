@@ -43,6 +43,7 @@
 #include <fstream>
 #include <sstream>
 #include "GenericParser.h"
+#include "ChunkedParser.h"
 #include "NameMap.h"
 #include "InputData.h"
 
@@ -50,66 +51,66 @@ using namespace std;
 
 namespace MultiBoost {
 	
-	class ArffParser : public GenericParser
+	/**
+	 * The parser of the rows of the data section of the arff files, one example per
+	 * line. It is used by ChunkedParser, so the rows are parsed in parallel.
+	 * \date 17/10/2026
+	 */
+	class ArffRowParser
 	{
 	public:
+		/**
+		 * The constructor. The parameters are the ones found in the header.
+		 * \param numAttributes The number of attributes, that is the index of the labels in the sparse rows.
+		 * \param hasName The first value of the rows is the name of the example.
+		 */
+		ArffRowParser(int numAttributes, bool hasName, const NameMap& classMap, 
+					  const vector<NameMap>& enumMaps, 
+					  const vector<RawData::eAttributeType>& attributeTypes);
 		
 		/**
-		 * The constructor. It initializes the file names and the separators.
-		 * \date 30/07/2010
+		 * The empty and the comment lines are not rows.
+		 * \see ChunkedParser
 		 */
-		ArffParser(const string& fileName, const string& headerFileName);
+		bool isRow(const char* pLine, const char* pLineEnd) const;
 		
+		/**
+		 * Set the number of chunks to parse, it resets the representations of the chunks.
+		 * \see ChunkedParser
+		 */
+		void beginChunks(int numChunks);
 		
 		/**
-		 * Read the data.
-		 * \see GenericParser::readData
-		 * \date 30/07/2010
-		 */		
-		virtual void readData(vector<Example>& examples, NameMap& classMap, 
-							  vector<NameMap>& enumMaps, NameMap& attributeNameMap,
-							  vector<RawData::eAttributeType>& attributeTypes);
+		 * Parse a row into the example.
+		 * \see ChunkedParser
+		 */
+		void parseRow(int chunkIdx, const char* pLine, const char* pLineEnd, Example& example);
 		
 		/**
-		 * It retrurns the number of features. 
-		 * \remark It might be implemented here, and not as an abstract function.
-		 * \return The number of features.
-		 * \data 30/07/2011 
-		 */		
-		virtual int  getNumAttributes() const
-		{ return _numAttributes; }
+		 * Merge the representations of the parsed chunks into the given ones.
+		 * It exits if the dense and the sparse representations are mixed.
+		 * \param dataRep The data representation, DR_UNKNOWN if it is not known yet.
+		 * \param labelRep The label representation, LR_UNKNOWN if it is not known yet.
+		 */
+		void mergeRepresentations(eDataRep& dataRep, eLabelRep& labelRep) const;
 		
 	protected:
 		/**
-		 * Read the header. It reads the class labels, attribute names, attribute types and
-		 * the mappings of nominal features.
-		 * \param in The file stream.
-		 * \param \see GenericParser::readData		 
-		 * \data 30/07/2011 
+		 * Parse the dense values and return the position after them.
 		 */
-		void readHeader(ifstream& in, NameMap& classMap, 
-						vector<NameMap>& enumMaps, NameMap& attributeNameMap, 
-						vector<RawData::eAttributeType>& attributeTypes);
-
+		const char* parseDenseValues(const char* p, const char* pLineEnd, vector<FeatureReal>& values);
+		
 		/**
-		 * Read the data. The arff can be sparse and dense as well.
-		 * \param in The file stream.
-		 * \param \see GenericParser::readData		 
-		 * \data 30/07/2011 		 
+		 * Parse the sparse values, until the labels or the closing bracket, and return the position after them.
+		 * \param pHasLabels Set to true if the sparse values end with the label index.
 		 */
-		void readData(ifstream& in, vector<Example>& examples, NameMap& classMap, 
-					  vector<NameMap>& enumMaps, 
-					  const vector<RawData::eAttributeType>& attributeTypes);
-		
-		string readName(ifstream& in);
-		
-		void readDenseValues(ifstream& in, vector<FeatureReal>& values,
-							 vector<NameMap>& enumMaps, 
-							 const vector<RawData::eAttributeType>& attributeTypes);
+		const char* parseSparseValues(const char* p, const char* pLineEnd, vector<FeatureReal>& values, 
+									  vector<int>& idxs, map<int, int>& idxmap, bool& hasLabels);
 		
-		void readSparseValues(istringstream& ss, vector<FeatureReal>& values, vector<int>& idxs, map<int, int>& idxmap, 
-							  vector<NameMap>& enumMaps, 
-							  const vector<RawData::eAttributeType>& attributeTypes);
+		/**
+		 * Parse the value of an attribute.
+		 */
+		FeatureReal parseValue(int attributeIdx, const char* pBegin, const char* pEnd) const;
 		
 		/**
 		 * Read labels declared in the standard arff format:
@@ -132,8 +133,9 @@ namespace MultiBoost {
 		 -1, +1, +1
 		 -1, -1, +1
 		 \endverbatim
+		 * \param maxNumLabels The number of label tokens to read at most.
 		 */
-		void readSimpleLabels(istringstream& ss, vector<Label>& labels, NameMap& classMap);
+		void parseSimpleLabels(const char* p, const char* pLineEnd, vector<Label>& labels, int maxNumLabels);
 		
 		/**
 		 * Read sparse labels declared in a non-standard arff variant:
@@ -160,8 +162,77 @@ namespace MultiBoost {
 		 \endverbatim
 		 * \remark Internally this type of label is stored as sparse. This will have
 		 * a small hit in terms of memory, but nothing in terms of performance.
+		 * \param p The position after the opening bracket.
+		 */
+		void parseExtendedLabels(const char* p, const char* pLineEnd, vector<Label>& labels);
+		
+		void setDataRep(int chunkIdx, eDataRep dataRep);
+		void setLabelRep(int chunkIdx, eLabelRep labelRep);
+		
+		int								_numAttributes;
+		bool							_hasName;
+		const NameMap&					_classMap;
+		const vector<NameMap>&			_enumMaps;
+		const vector<RawData::eAttributeType>& _attributeTypes;
+		
+		vector<eDataRep>				_chunkDataReps; //!< The data representation found in each chunk
+		vector<eLabelRep>				_chunkLabelReps; //!< The label representation found in each chunk
+	};
+	
+	// -----------------------------------------------------------------------------
+	
+	class ArffParser : public GenericParser
+	{
+	public:
+		
+		/**
+		 * The constructor. It initializes the file names and the separators.
+		 * \date 30/07/2010
 		 */
-		void readExtendedLabels(istringstream& ss, vector<Label>& labels, NameMap& classMap);
+		ArffParser(const string& fileName, const string& headerFileName);
+		
+		
+		/**
+		 * Read the data.
+		 * \see GenericParser::readData
+		 * \date 30/07/2010
+		 */		
+		virtual void readData(vector<Example>& examples, NameMap& classMap, 
+							  vector<NameMap>& enumMaps, NameMap& attributeNameMap,
+							  vector<RawData::eAttributeType>& attributeTypes);
+		
+		/**
+		 * It retrurns the number of features. 
+		 * \remark It might be implemented here, and not as an abstract function.
+		 * \return The number of features.
+		 * \data 30/07/2011 
+		 */		
+		virtual int  getNumAttributes() const
+		{ return _numAttributes; }
+		
+	protected:
+		/**
+		 * Read the header. It reads the class labels, attribute names, attribute types and
+		 * the mappings of nominal features.
+		 * \param in The file stream.
+		 * \param \see GenericParser::readData		 
+		 * \data 30/07/2011 
+		 */
+		void readHeader(ifstream& in, NameMap& classMap, 
+						vector<NameMap>& enumMaps, NameMap& attributeNameMap, 
+						vector<RawData::eAttributeType>& attributeTypes);
+
+		/**
+		 * Read the data. The arff can be sparse and dense as well.
+		 * The rows are parsed in parallel, see ChunkedParser and ArffRowParser.
+		 * \param pBegin The beginning of the data section in the mapped file.
+		 * \param pEnd The end of the data section.
+		 * \param \see GenericParser::readData		 
+		 * \data 30/07/2011 		 
+		 */
+		void readData(const char* pBegin, const char* pEnd, vector<Example>& examples, 
+					  const NameMap& classMap, const vector<NameMap>& enumMaps, 
+					  const vector<RawData::eAttributeType>& attributeTypes);
 		
 		enum eTokenType
 		{
@@ -178,24 +249,11 @@ namespace MultiBoost {
 		int            _numAttributes;
 		string         _headerFileName;
 		
-		locale         _denseLocale;
-		locale         _sparseLocale;
 		bool           _hasName;
 	};
 	
 	// -----------------------------------------------------------------------------
 	
-	inline string ArffParser::readName(ifstream& in)
-	{
-		const locale& originalLocale = in.imbue(_denseLocale); 
-		string name;
-		in >> name;
-		in.imbue(originalLocale);
-		return name;
-	}
-	
-	// -----------------------------------------------------------------------------
-	
 	
 } // end of namespace MultiBoost
 
@@ -44,8 +44,6 @@ namespace MultiBoost {
 	ArffParserBzip2::ArffParserBzip2(const string& fileName,const string& headerFileName)
 		: ArffParser(fileName,headerFileName), _hasName(false)
 	{
-		_denseLocale  = locale(locale(), new nor_utils::white_spaces(", "));
-		_sparseLocale = locale(locale(), new nor_utils::white_spaces(", "));
 	}
 
 	// ------------------------------------------------------------------------
@@ -205,273 +203,97 @@ namespace MultiBoost {
 	// ------------------------------------------------------------------------
 
 	void ArffParserBzip2::readData( Bzip2WrapperReader& in, vector<Example>& examples,
-		NameMap& classMap, vector<NameMap>& enumMaps,
+		const NameMap& classMap, const vector<NameMap>& enumMaps,
 		const vector<RawData::eAttributeType>& attributeTypes )
 	{
-		char firstChar = 0;
-		string tmpLine;
-
-		istringstream ssDense;
-		ssDense.imbue(_denseLocale);
-		istringstream ssSparse;
-		ssSparse.imbue(_sparseLocale);
-
-		cout << "Counting rows.." << flush;
-		//size_t numRows = nor_utils::count_rows(in);
-		/////////////////////////////////////////////////////
-		size_t numRows = in.remainingRowNum();
-		cout << "Allocating.." << flush;
-		try {
-			examples.resize(numRows);
-		} 
-		catch(...) {
-			cerr << "ERROR: Cannot allocate memory for storage!" << endl;
-			exit(1);
-		}
-		cout << "Done!" << endl;
-
+		ArffRowParser rowParser(_numAttributes, _hasName, classMap, enumMaps, attributeTypes);
+		
+		// the next block is decompressed while the current one is parsed
+		vector<char> currBlock;
+		vector<char> nextBlock;
+		string tail;
+		
 		cout << "Now reading file.." << flush;
-		size_t i;
-		for (i = 0; i < numRows; ++i)
+		
+#ifdef _OPENMP
+		// the parsing of a block is parallel inside the pipeline
+		const int maxActiveLevels = omp_get_max_active_levels();
+		omp_set_max_active_levels( max(maxActiveLevels, 2) );
+#endif
+		
+		bool hasMore = readBlock(in, tail, currBlock);
+		for (;;)
 		{
-
-			while ( isspace(firstChar = in.get()) && !in.eof() );
-
-			if (in.eof())
-				break;
-
-			//if ( i == 7493 ) {
-				//cout << i << endl;
-			//}
-
-
-			Example& currExample = examples[i];
-
-			//////////////////////////////////////////////////////////////////////////
-			// first read the data
-			if ( firstChar == '%' ) // comment!
-			{
-				getline(in, tmpLine);
-				continue;
-			}
-
-			// read the name if specified
-			if ( _hasName )
-			{
-				in.putback(firstChar);
-				currExample.setName( readName(in) );
-				while ( !in.eof() )
-				{
-					// skip spaces and the comma
-					firstChar = in.get();
-					if ( !isspace(firstChar) && firstChar != ',' )
-						break;
-				}
-			}
-
-			if ( firstChar == '{' ) // sparse data!
-			{
-				if ( _dataRep == DR_DENSE )
-				{
-					cerr << "ERROR: Cannot have dense and sparse data at the same time!" << endl;
-					exit(1);
-				}
-				else if ( _dataRep == DR_UNKNOWN )
-					_dataRep = DR_SPARSE;
-
-				getline(in, tmpLine, '}');
-				ssSparse.clear();
-				ssSparse.str(tmpLine);
-
-				readSparseValues(ssSparse, currExample.getValues(), currExample.getValuesIndexes(), currExample.getValuesIndexesMap(),
-					enumMaps, attributeTypes );
-			}
-			else // dense!
+			bool nextHasMore = false;
+			
+#pragma omp parallel sections num_threads(2)
 			{
-				if ( _dataRep == DR_SPARSE )
+#pragma omp section
 				{
-					cerr << "ERROR: Cannot have dense and sparse data at the same time!" << endl;
-					exit(1);
+					if ( hasMore )
+						nextHasMore = readBlock(in, tail, nextBlock);
 				}
-				else if ( _dataRep == DR_UNKNOWN )
-					_dataRep = DR_DENSE;
-
 				
-
-				in.putback(firstChar);
-				readDenseValues(in, currExample.getValues(), enumMaps, attributeTypes);
-				/*
-				vector <float > vals = currExample.getValues();
-				for( int i= 0; i < vals.size(); i++ ) 
+#pragma omp section
 				{
-					cout << vals[ i ] << ",";
-				}
-				cout << endl;
-				*/
-			}
-
-			//////////////////////////////////////////////////////////////////////////
-			while ( !in.eof() )
-			{
-				// skip spaces and the last comma
-				firstChar = in.get();
-				if ( !isspace(firstChar) && firstChar != ',' )
-					break;
-			}
-
-			// now read the labels
-			if ( firstChar == '{' ) // weight is specified!
-			{
-				if ( _labelRep == LR_DENSE )
-				{
-					cerr << "ERROR: Labels cannot be formatted both in dense and sparse format!" << endl;
-					exit(1);
-				}
-				_labelRep = LR_SPARSE;
-
-				getline(in, tmpLine);
-				ssSparse.clear();
-				ssSparse.str(tmpLine);
-
-				readExtendedLabels(ssSparse, currExample.getLabels(), classMap);
-			}
-			else // dense!
-			{
-				if ( _labelRep == LR_SPARSE )
-				{
-					cerr << "ERROR: Labels were declared sparse, but they are not formatted correctly (with {}!)!" << endl;
-					exit(1);
+					if ( !currBlock.empty() )
+					{
+						const char* pBegin = &currBlock[0];
+						ChunkedParser::parseRows(pBegin, pBegin + currBlock.size(), rowParser, examples);
+						rowParser.mergeRepresentations(_dataRep, _labelRep);
+					}
 				}
-				_labelRep = LR_DENSE;
-
-				in.putback(firstChar);
-
-				getline(in, tmpLine);
-				ssDense.clear();
-				ssDense.str(tmpLine);
-
-				readSimpleLabels(ssDense, currExample.getLabels(), classMap);
 			}
+			
+			if ( !hasMore )
+				break;
+			
+			currBlock.swap(nextBlock);
+			hasMore = nextHasMore;
 		}
-
+		
+#ifdef _OPENMP
+		omp_set_max_active_levels( maxActiveLevels );
+#endif
+		
 		cout << "Done!" << endl;
-
-		if ( i != numRows )
-		{
-			// last row was empty!
-			examples.resize(i);
-		}
-
+		
 		// sparse representation always set the weight!
 		if ( _labelRep == LR_SPARSE )
 			_hasWeigthInit = true;
 	}
-
-	// ------------------------------------------------------------------------
-
-	void ArffParserBzip2::readSimpleLabels( istringstream& ss, vector<Label>& labels,
-		NameMap& classMap )
-	{
-
-		string strLabel;
-		const int numClasses = classMap.getNumNames();
-		labels.resize(numClasses);
-
-		for ( int i = 0; i < numClasses; ++i )
-		{
-			labels[i].idx = i;
-			labels[i].y = -1;
-		}
-
-		// now get the declared labels
-		while (!ss.eof())
-		{
-			ss >> strLabel;
-			strLabel = nor_utils::trim(strLabel);
-			labels[ classMap.getIdxFromName(strLabel) ].y = +1;
-		}
-
-	}
-
-	// ------------------------------------------------------------------------
-
-	void ArffParserBzip2::readExtendedLabels( istringstream& ss, vector<Label>& labels,
-		NameMap& classMap )
-	{
-		string strLabel;
-		AlphaReal weight;
-
-		// now get the declared labels
-		while (!ss.eof())
-		{
-			Label tmpLabel;
-			ss >> strLabel;
-
-			if ( strLabel == "}" || ss.eof() )
-				break;
-
-			ss >> weight;
-
-			tmpLabel.y = nor_utils::sign(weight);
-			tmpLabel.weight = abs(weight); // this will be used later in RawData to set the weights
-
-			strLabel = nor_utils::trim(strLabel);
-			tmpLabel.idx = classMap.getIdxFromName(strLabel);
-			labels.push_back(tmpLabel);
-		}
-	}
-
+	
 	// ------------------------------------------------------------------------
-
-	void ArffParserBzip2::readDenseValues(Bzip2WrapperReader& in, vector<FeatureReal>& values,
-		vector<NameMap>& enumMaps, 
-		const vector<RawData::eAttributeType>& attributeTypes )
+	
+	bool ArffParserBzip2::readBlock( Bzip2WrapperReader& in, string& tail, vector<char>& block )
 	{
-		//const locale& originalLocale = in.imbue(_denseLocale); 
-
-		values.reserve(_numAttributes);
-		string tmpVal;
-
-		for ( int j = 0; j < _numAttributes; ++j )
-		{
-			in >> tmpVal;
-			if ( attributeTypes[j] == RawData::ATTRIBUTE_NUMERIC ) 
-				if ( ( ! tmpVal.compare( "NaN" ) ) || ( ! tmpVal.compare( "?" ) ) )
-					values.push_back( numeric_limits<FeatureReal>::infinity() );
-				else
-					values.push_back(atof(tmpVal.c_str()));
-			else //if ( attributeTypes[i] == RawData::ATTRIBUTE_ENUM ) 
-				values.push_back( enumMaps[j].getIdxFromName(tmpVal) );
-		}
-
-		//in.imbue(originalLocale);
-	}
-
-
-	// -----------------------------------------------------------------------------
-
-	void ArffParserBzip2::readSparseValues(istringstream& ss, vector<FeatureReal>& values, 
-		vector<int>& idxs, map<int,int>& idxmap, vector<NameMap>& enumMaps, 
-		const vector<RawData::eAttributeType>& attributeTypes)
-	{
-		string tmpVal;
-		int tmpIdx;
-		int i = 0;
-		while (!ss.eof())
-		{
-			ss >> tmpIdx;
-			idxs.push_back(tmpIdx);
-			idxmap[ tmpIdx ] = i++;
-			ss >> tmpVal;
-			if ( attributeTypes[tmpIdx] == RawData::ATTRIBUTE_NUMERIC ) 
-				values.push_back( atof(tmpVal.c_str()) );
-			else // if ( attributeTypes[tmpIdx] == InputData::ATTRIBUTE_ENUM) 
-				values.push_back( enumMaps[tmpIdx].getIdxFromName(tmpVal) );
-		}
+		// the partial line of the previous block
+		block.assign(tail.begin(), tail.end());
+		tail.clear();
+		
+		if ( in.eof() )
+			return false;
+		
+		const size_t tailSize = block.size();
+		block.resize(tailSize + BLOCK_SIZE);
+		const int numRead = in.read(&block[tailSize], BLOCK_SIZE);
+		block.resize(tailSize + numRead);
+		
+		if ( in.eof() )
+			return false;
+		
+		// the partial last line goes to the next block
+		size_t blockEnd = block.size();
+		while ( blockEnd > 0 && block[blockEnd - 1] != '\n' )
+			--blockEnd;
+		
+		tail.assign(block.begin() + blockEnd, block.end());
+		block.resize(blockEnd);
+		return true;
 	}
-
+	
 	// -----------------------------------------------------------------------------
-
+	
 	ArffParserBzip2::eTokenType ArffParserBzip2::getNextTokenType( Bzip2WrapperReader& in )
 	{
 		char firstChar = 0;
@@ -71,96 +71,38 @@ protected:
    void readHeader(Bzip2WrapperReader& in, NameMap& classMap, 
 		   vector<NameMap>& enumMaps, NameMap& attributeNameMap, 
 		   vector<RawData::eAttributeType>& attributeTypes);
-   void readData(Bzip2WrapperReader& in, vector<Example>& examples, NameMap& classMap, 
-		 vector<NameMap>& enumMaps, 
-		 const vector<RawData::eAttributeType>& attributeTypes);
-
-   string readName(Bzip2WrapperReader& in);
-
-   void readDenseValues(Bzip2WrapperReader& in, vector<FeatureReal>& values,
-			vector<NameMap>& enumMaps, 
-			const vector<RawData::eAttributeType>& attributeTypes);
-
-   void readSparseValues(istringstream& ss, vector<FeatureReal>& values, vector<int>& idxs, map<int,int>& idxmap, 
-			 vector<NameMap>& enumMaps, 
-			 const vector<RawData::eAttributeType>& attributeTypes);
 
    /**
-   * Read labels declared in the standard arff format:
-   * each class (label) is set to +1 if it's there, otherwise is -1
-   * i.e.:
-   * \verbatim
-   @ATTRIBUTE sepallength  NUMERIC
-   @ATTRIBUTE sepalwidth   NUMERIC
-   @ATTRIBUTE petallength  NUMERIC
-   @ATTRIBUTE petalwidth   NUMERIC
-   @ATTRIBUTE class        {Iris-setosa, Iris-versicolor, Iris-virginica}
-   @DATA
-    4,  2,  4,  2, Iris-setosa
-   25, 23,  1,  0, Iris-versicolor, Iris-virginica
-    0,  1, 10, 12, Iris-virginica
-   \endverbatim
-   * In this case the labels the the example will respectively be:
-   \verbatim
-   +1, -1, -1
-   -1, +1, +1
-   -1, -1, +1
-   \endverbatim
+   * Read the data section. The file is decompressed by blocks of BLOCK_SIZE characters
+   * and the next block is decompressed while the rows of the current one are parsed
+   * in parallel, see ChunkedParser and ArffRowParser.
    */
-   void readSimpleLabels(istringstream& ss, vector<Label>& labels, NameMap& classMap);
+   void readData(Bzip2WrapperReader& in, vector<Example>& examples, const NameMap& classMap, 
+		 const vector<NameMap>& enumMaps, 
+		 const vector<RawData::eAttributeType>& attributeTypes);
 
    /**
-   * Read labels declared in a non-standard arff variant:
-   * each class (label) is declared with a value that can be positive, or negative
-   * left out labels are automatically considered zero (abstention!).
-   * i.e.:
-   * \verbatim
-   @ATTRIBUTE sepallength  NUMERIC
-   @ATTRIBUTE sepalwidth   NUMERIC
-   @ATTRIBUTE petallength  NUMERIC
-   @ATTRIBUTE petalwidth   NUMERIC
-   @ATTRIBUTE class        {Iris-setosa, Iris-versicolor, Iris-virginica}
-   @DATA
-    4,  2,  4,  2, {Iris-setosa -2} 
-   25, 23,  1,  0, {Iris-versicolor 1, Iris-virginica -1}
-    0,  1, 10, 12, {Iris-setosa +2, Iris-versicolor -1, Iris-virginica -3}
-   \endverbatim
-   * The sign is used to set the value of y[l], and the magnitude to initialize the weights.
-   * In this case the labels the the example will respectively be:
-   \verbatim
-   -1, 0, 0
-   0, +1, -1
-   +1, -1, -1
-   \endverbatim
-   * \remark Internally this type of label is stored as sparse. This will have
-   * a small hit in terms of memory, but nothing in terms of performance.
+   * Decompress the next block. The block ends with the last complete line, the rest
+   * is kept in tail for the next block.
+   * \param in The bzip2 stream.
+   * \param tail The partial line of the previous block, then the one of this block.
+   * \param block The decompressed block.
+   * \return false if this block is the last one.
    */
-   void readExtendedLabels(istringstream& ss, vector<Label>& labels, NameMap& classMap);
+   bool readBlock(Bzip2WrapperReader& in, string& tail, vector<char>& block);
 
+   enum { BLOCK_SIZE = 32 << 20 }; //!< The size of the decompressed blocks
 
    eTokenType getNextTokenType(Bzip2WrapperReader& in);
 
    int					_numAttributes;
    string				_headerFileName;
 
-   locale				_denseLocale;
-   locale				_sparseLocale;
    bool					_hasName;
 };
 
 // -----------------------------------------------------------------------------
 
-inline string ArffParserBzip2::readName(Bzip2WrapperReader& in)
-{
-   //const locale& originalLocale = in.imbue(_denseLocale); 
-   string name;
-   in >> name;
-   //in.imbue(originalLocale);
-   return name;
-}
-
-// -----------------------------------------------------------------------------
-
 
 } // end of namespace MultiBoost
 
@@ -0,0 +1,296 @@
+/*
+ *
+ *    MultiBoost - Multi-purpose boosting package
+ *
+ *    Copyright (C)        AppStat group
+ *                         Laboratoire de l'Accelerateur Lineaire
+ *                         Universite Paris-Sud, 11, CNRS
+ *
+ *    This file is part of the MultiBoost library
+ *
+ *    This library is free software; you can redistribute it 
+ *    and/or modify it under the terms of the GNU General Public
+ *    License as published by the Free Software Foundation
+ *    version 2.1 of the License.
+ *
+ *    This library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public
+ *    License along with this library; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin St, 5th Floor, Boston, MA 02110-1301 USA
+ *
+ *    Contact: multiboost@googlegroups.com 
+ * 
+ *    For more information and up-to-date version, please visit
+ *        
+ *                       http://www.multiboost.org/
+ *
+ */
+
+
+#include <iostream>
+
+#include "IO/ChunkedParser.h"
+
+#include <sys/mman.h> // for mmap
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace MultiBoost {
+	
+	// the exact powers of ten in double
+	static const double EXACT_POWERS_OF_TEN[] = 
+	{
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 
+		1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+	static const int MAX_EXACT_POWER_OF_TEN = 22;
+	
+	// the integers up to 10^15 are exact in double
+	static const int MAX_EXACT_DIGITS = 15;
+	
+	// the chunks are not smaller than this, so the small files are not cut for nothing
+	static const size_t MIN_CHUNK_SIZE = 1 << 20;
+	
+	// ------------------------------------------------------------------------
+	
+	MappedFile::MappedFile(const string& fileName)
+	: _pBegin(NULL), _size(0)
+	{
+		int fd = open(fileName.c_str(), O_RDONLY);
+		if (fd < 0)
+		{
+			cerr << "\nERROR: Cannot open file <" << fileName << ">!!" << endl;
+			exit(1);
+		}
+		
+		struct stat fileStat;
+		if ( fstat(fd, &fileStat) != 0 )
+		{
+			cerr << "\nERROR: Cannot read file <" << fileName << ">!!" << endl;
+			exit(1);
+		}
+		
+		_size = fileStat.st_size;
+		if ( _size > 0 )
+		{
+			void* pMapped = mmap(NULL, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (pMapped == MAP_FAILED)
+			{
+				cerr << "\nERROR: Cannot map file <" << fileName << ">!!" << endl;
+				exit(1);
+			}
+			
+			// the file is read once from the beginning to the end
+			madvise(pMapped, _size, MADV_SEQUENTIAL);
+			_pBegin = static_cast<const char*>(pMapped);
+		}
+		
+		close(fd);
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	MappedFile::~MappedFile()
+	{
+		if ( _pBegin )
+			munmap(const_cast<char*>(_pBegin), _size);
+	}
+	
+	// ------------------------------------------------------------------------
+	// ------------------------------------------------------------------------
+	
+	void ChunkedParser::splitIntoChunks(const char* pBegin, const char* pEnd, vector<TextChunk>& chunks)
+	{
+		int numThreads = 1;
+#ifdef _OPENMP
+		numThreads = omp_get_max_threads();
+#endif
+		
+		// a few chunks per thread so that the dynamic schedule can balance the lines of different lengths
+		const size_t chunkSize = max( MIN_CHUNK_SIZE, static_cast<size_t>(pEnd - pBegin) / (4 * numThreads) + 1 );
+		
+		chunks.clear();
+		for ( const char* p = pBegin; p < pEnd; )
+		{
+			TextChunk chunk;
+			chunk.pBegin = p;
+			
+			if ( static_cast<size_t>(pEnd - p) <= chunkSize )
+				chunk.pEnd = pEnd;
+			else
+			{
+				chunk.pEnd = lineEnd(p + chunkSize, pEnd);
+				if ( chunk.pEnd != pEnd )
+					++chunk.pEnd; // the new line belongs to the chunk
+			}
+			
+			chunks.push_back(chunk);
+			p = chunk.pEnd;
+		}
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	void ChunkedParser::resizeExamples(vector<Example>& examples, size_t newSize)
+	{
+		if ( newSize <= examples.capacity() )
+		{
+			examples.resize(newSize);
+			return;
+		}
+		
+		vector<Example> newExamples;
+		try {
+			newExamples.reserve( max(newSize, 2 * examples.size()) );
+			newExamples.resize(newSize);
+		}
+		catch(...) {
+			cerr << "ERROR: Cannot allocate memory for storage!" << endl;
+			exit(1);
+		}
+		
+		for (size_t i = 0; i < examples.size(); ++i)
+			newExamples[i].swap(examples[i]);
+		
+		examples.swap(newExamples);
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	double ChunkedParser::parseReal(const char* pBegin, const char* pEnd, bool& ok)
+	{
+		const char* p = pBegin;
+		bool isNegative = false;
+		
+		if ( p != pEnd && (*p == '-' || *p == '+') )
+		{
+			isNegative = (*p == '-');
+			++p;
+		}
+		
+		double mantissa = 0;
+		int numDigits = 0; // the significant ones
+		int exponent = 0;
+		bool hasDigits = false;
+		bool isExact = true;
+		
+		for ( ; p != pEnd && *p >= '0' && *p <= '9'; ++p )
+		{
+			hasDigits = true;
+			if ( numDigits > 0 || *p != '0' )
+			{
+				if ( ++numDigits > MAX_EXACT_DIGITS ) isExact = false;
+				mantissa = mantissa * 10 + (*p - '0');
+			}
+		}
+		
+		if ( p != pEnd && *p == '.' )
+		{
+			for ( ++p; p != pEnd && *p >= '0' && *p <= '9'; ++p )
+			{
+				hasDigits = true;
+				if ( numDigits > 0 || *p != '0' )
+				{
+					if ( ++numDigits > MAX_EXACT_DIGITS ) isExact = false;
+					mantissa = mantissa * 10 + (*p - '0');
+				}
+				--exponent;
+			}
+		}
+		
+		if ( hasDigits && p != pEnd && (*p == 'e' || *p == 'E') )
+		{
+			const char* pExponent = p + 1;
+			bool isExponentNegative = false;
+			if ( pExponent != pEnd && (*pExponent == '-' || *pExponent == '+') )
+			{
+				isExponentNegative = (*pExponent == '-');
+				++pExponent;
+			}
+			
+			int explicitExponent = 0;
+			const char* pDigits = pExponent;
+			for ( ; pExponent != pEnd && *pExponent >= '0' && *pExponent <= '9'; ++pExponent )
+			{
+				if ( explicitExponent < 10000 )
+					explicitExponent = explicitExponent * 10 + (*pExponent - '0');
+			}
+			
+			if ( pExponent != pDigits )
+			{
+				exponent += isExponentNegative ? -explicitExponent : explicitExponent;
+				p = pExponent;
+			}
+		}
+		
+		// a single multiplication or division of exact values is correctly rounded, 
+		// so the result is the same as the one of strtod
+		if ( hasDigits && p == pEnd && isExact && 
+			exponent >= -MAX_EXACT_POWER_OF_TEN && exponent <= MAX_EXACT_POWER_OF_TEN )
+		{
+			ok = true;
+			double value = ( exponent < 0 ) ? mantissa / EXACT_POWERS_OF_TEN[-exponent] 
+			                                : mantissa * EXACT_POWERS_OF_TEN[exponent];
+			return isNegative ? -value : value;
+		}
+		
+		// the rest (long mantissas, large exponents, inf, hexadecimal...)
+		const string str(pBegin, pEnd);
+		char* pStrEnd = NULL;
+		const double value = strtod(str.c_str(), &pStrEnd);
+		ok = !str.empty() && pStrEnd == str.c_str() + str.size();
+		return value;
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	int ChunkedParser::parseInt(const char* pBegin, const char* pEnd, bool& ok)
+	{
+		const char* p = pBegin;
+		bool isNegative = false;
+		
+		if ( p != pEnd && (*p == '-' || *p == '+') )
+		{
+			isNegative = (*p == '-');
+			++p;
+		}
+		
+		int value = 0;
+		ok = (p != pEnd);
+		for ( ; p != pEnd; ++p )
+		{
+			if ( *p < '0' || *p > '9' )
+			{
+				ok = false;
+				break;
+			}
+			value = value * 10 + (*p - '0');
+		}
+		
+		return isNegative ? -value : value;
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	bool ChunkedParser::isToken(const char* pBegin, const char* pEnd, const char* str)
+	{
+		const size_t length = strlen(str);
+		return static_cast<size_t>(pEnd - pBegin) == length && memcmp(pBegin, str, length) == 0;
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	int ChunkedParser::lookupName(const NameMap& nameMap, const char* pBegin, const char* pEnd)
+	{
+		const int idx = nameMap.findIdxFromName( string(pBegin, pEnd) );
+		return ( idx < 0 ) ? 0 : idx;
+	}
+	
+	// ------------------------------------------------------------------------
+	
+} // end of namespace MultiBoost
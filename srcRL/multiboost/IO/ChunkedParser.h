@@ -0,0 +1,287 @@
+/*
+ *
+ *    MultiBoost - Multi-purpose boosting package
+ *
+ *    Copyright (C)        AppStat group
+ *                         Laboratoire de l'Accelerateur Lineaire
+ *                         Universite Paris-Sud, 11, CNRS
+ *
+ *    This file is part of the MultiBoost library
+ *
+ *    This library is free software; you can redistribute it 
+ *    and/or modify it under the terms of the GNU General Public
+ *    License as published by the Free Software Foundation
+ *    version 2.1 of the License.
+ *
+ *    This library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public
+ *    License along with this library; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin St, 5th Floor, Boston, MA 02110-1301 USA
+ *
+ *    Contact: multiboost@googlegroups.com 
+ * 
+ *    For more information and up-to-date version, please visit
+ *        
+ *                       http://www.multiboost.org/
+ *
+ */
+
+
+/**
+ * \file ChunkedParser.h The parallel parsing of the data sections of the input files.
+ */
+
+#ifndef __CHUNKED_PARSER_H
+#define __CHUNKED_PARSER_H
+
+#include <string>
+#include <vector>
+#include <cstdlib> // for strtod
+#include <cstring> // for memchr
+
+#include "Others/Example.h"
+#include "NameMap.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace std;
+
+namespace MultiBoost {
+	
+	/**
+	 * A piece of text which starts at the beginning of a line and ends after
+	 * a new line, or at the end of the text.
+	 */
+	struct TextChunk
+	{
+		const char* pBegin;
+		const char* pEnd;
+	};
+	
+	// -----------------------------------------------------------------------------
+	
+	/**
+	 * A read only memory mapping of a whole file.
+	 * \date 17/10/2026
+	 */
+	class MappedFile
+	{
+	public:
+		/**
+		 * Map the file. It exits if the file cannot be opened.
+		 * \param fileName The name of the file.
+		 */
+		MappedFile(const string& fileName);
+		~MappedFile();
+		
+		const char* begin() const { return _pBegin; }
+		const char* end() const { return _pBegin + _size; }
+		size_t      size() const { return _size; }
+		
+	private:
+		MappedFile(const MappedFile&);
+		MappedFile& operator=(const MappedFile&);
+		
+		const char* _pBegin;
+		size_t      _size;
+	};
+	
+	// -----------------------------------------------------------------------------
+	
+	/**
+	 * The parallel parsing of the rows of a text, one example per line. The text is cut
+	 * into chunks at line boundaries, then the rows of every chunk are counted and the
+	 * chunks are parsed in parallel directly into their place, so the examples are in
+	 * the order of the file.
+	 * The format is given by the RowParser, which must have:
+	 * \code
+	 * bool isRow(const char* pLine, const char* pLineEnd) const; // false for the empty and comment lines
+	 * void beginChunks(int numChunks); // called before parsing the chunks
+	 * void parseRow(int chunkIdx, const char* pLine, const char* pLineEnd, Example& example);
+	 * \endcode
+	 * where [pLine, pLineEnd) is a line without its new line character. parseRow() is
+	 * called from parallel threads, but for a given chunk always from the same thread.
+	 * \date 17/10/2026
+	 */
+	class ChunkedParser
+	{
+	public:
+		
+		/**
+		 * Parse the rows of the text and append them to the examples.
+		 * \param pBegin The beginning of the text.
+		 * \param pEnd The end of the text.
+		 * \param rowParser The parser of the format.
+		 * \param examples The examples, the new ones are appended.
+		 * \param pChunkRows If not NULL, filled with the first example of every chunk
+		 * and the end of the last one, for the formats which post-process the chunks.
+		 */
+		template <typename RowParser>
+		static void parseRows(const char* pBegin, const char* pEnd, RowParser& rowParser,
+							  vector<Example>& examples, vector<size_t>* pChunkRows = NULL);
+		
+		/**
+		 * Cut the text into chunks at line boundaries.
+		 * \param pBegin The beginning of the text.
+		 * \param pEnd The end of the text.
+		 * \param chunks The chunks, they cover the whole text.
+		 */
+		static void splitIntoChunks(const char* pBegin, const char* pEnd, vector<TextChunk>& chunks);
+		
+		/**
+		 * Resize the examples without copying the old ones, since the copy of an
+		 * example copies all its values.
+		 */
+		static void resizeExamples(vector<Example>& examples, size_t newSize);
+		
+		/**
+		 * Find the next token.
+		 * \param p The position where the search starts.
+		 * \param pEnd The end of the line.
+		 * \param pTokenEnd Set to the end of the token.
+		 * \return The beginning of the token, pEnd if there is no more token.
+		 * \remark The separators are the spaces and the commas, '{' and '}' are tokens of their own.
+		 */
+		static const char* nextToken(const char* p, const char* pEnd, const char*& pTokenEnd);
+		
+		/**
+		 * Parse a real number. It handles the usual decimal forms without a copy,
+		 * the others go through strtod.
+		 * \param pBegin The beginning of the number.
+		 * \param pEnd The end of the number.
+		 * \param ok Set to false if the text is not a number.
+		 */
+		static double parseReal(const char* pBegin, const char* pEnd, bool& ok);
+		
+		/**
+		 * Parse an integer.
+		 * \param ok Set to false if the text is not an integer.
+		 * \see parseReal
+		 */
+		static int parseInt(const char* pBegin, const char* pEnd, bool& ok);
+		
+		/**
+		 * Tell whether the token is the same as the given string.
+		 */
+		static bool isToken(const char* pBegin, const char* pEnd, const char* str);
+		
+		/**
+		 * Find a name in the map without changing it, as NameMap::getIdxFromName()
+		 * the unknown names are mapped to 0.
+		 */
+		static int lookupName(const NameMap& nameMap, const char* pBegin, const char* pEnd);
+		
+		/**
+		 * Count the rows of a chunk, see RowParser::isRow().
+		 */
+		template <typename RowParser>
+		static size_t countRows(const TextChunk& chunk, const RowParser& rowParser);
+		
+	protected:
+		/**
+		 * Find the end of the line, that is the next new line or pEnd.
+		 */
+		static const char* lineEnd(const char* p, const char* pEnd);
+	};
+	
+	// -----------------------------------------------------------------------------
+	
+	inline const char* ChunkedParser::lineEnd(const char* p, const char* pEnd)
+	{
+		const void* pNewLine = memchr(p, '\n', pEnd - p);
+		return pNewLine ? static_cast<const char*>(pNewLine) : pEnd;
+	}
+	
+	// -----------------------------------------------------------------------------
+	
+	inline const char* ChunkedParser::nextToken(const char* p, const char* pEnd, const char*& pTokenEnd)
+	{
+		while ( p != pEnd && (*p == ' ' || *p == ',' || *p == '\t' || *p == '\r') )
+			++p;
+		
+		pTokenEnd = p;
+		if ( p == pEnd )
+			return p;
+		
+		if ( *p == '{' || *p == '}' )
+		{
+			++pTokenEnd;
+			return p;
+		}
+		
+		while ( pTokenEnd != pEnd && *pTokenEnd != ' ' && *pTokenEnd != ',' && *pTokenEnd != '\t' && 
+			   *pTokenEnd != '\r' && *pTokenEnd != '{' && *pTokenEnd != '}' )
+			++pTokenEnd;
+		
+		return p;
+	}
+	
+	// -----------------------------------------------------------------------------
+	
+	template <typename RowParser>
+	size_t ChunkedParser::countRows(const TextChunk& chunk, const RowParser& rowParser)
+	{
+		size_t numRows = 0;
+		for ( const char* pLine = chunk.pBegin; pLine < chunk.pEnd; )
+		{
+			const char* pLineEnd = lineEnd(pLine, chunk.pEnd);
+			if ( rowParser.isRow(pLine, pLineEnd) )
+				++numRows;
+			pLine = pLineEnd + 1;
+		}
+		return numRows;
+	}
+	
+	// -----------------------------------------------------------------------------
+	
+	template <typename RowParser>
+	void ChunkedParser::parseRows(const char* pBegin, const char* pEnd, RowParser& rowParser,
+								  vector<Example>& examples, vector<size_t>* pChunkRows)
+	{
+		vector<TextChunk> chunks;
+		splitIntoChunks(pBegin, pEnd, chunks);
+		const int numChunks = static_cast<int>( chunks.size() );
+		
+		// the first example of every chunk
+		vector<size_t> chunkRows(numChunks + 1, 0);
+		
+#pragma omp parallel for schedule(dynamic)
+		for (int c = 0; c < numChunks; ++c)
+			chunkRows[c + 1] = countRows(chunks[c], rowParser);
+		
+		chunkRows[0] = examples.size();
+		for (int c = 0; c < numChunks; ++c)
+			chunkRows[c + 1] += chunkRows[c];
+		
+		resizeExamples(examples, chunkRows[numChunks]);
+		
+		rowParser.beginChunks(numChunks);
+		
+#pragma omp parallel for schedule(dynamic)
+		for (int c = 0; c < numChunks; ++c)
+		{
+			size_t i = chunkRows[c];
+			for ( const char* pLine = chunks[c].pBegin; pLine < chunks[c].pEnd; )
+			{
+				const char* pLineEnd = lineEnd(pLine, chunks[c].pEnd);
+				if ( rowParser.isRow(pLine, pLineEnd) )
+					rowParser.parseRow(c, pLine, pLineEnd, examples[i++]);
+				pLine = pLineEnd + 1;
+			}
+		}
+		
+		if ( pChunkRows )
+			pChunkRows->swap(chunkRows);
+	}
+	
+	// -----------------------------------------------------------------------------
+	
+} // end of namespace MultiBoost
+
+#endif // __CHUNKED_PARSER_H
@@ -0,0 +1,238 @@
+/*
+ *
+ *    MultiBoost - Multi-purpose boosting package
+ *
+ *    Copyright (C)        AppStat group
+ *                         Laboratoire de l'Accelerateur Lineaire
+ *                         Universite Paris-Sud, 11, CNRS
+ *
+ *    This file is part of the MultiBoost library
+ *
+ *    This library is free software; you can redistribute it 
+ *    and/or modify it under the terms of the GNU General Public
+ *    License as published by the Free Software Foundation
+ *    version 2.1 of the License.
+ *
+ *    This library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public
+ *    License along with this library; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin St, 5th Floor, Boston, MA 02110-1301 USA
+ *
+ *    Contact: multiboost@googlegroups.com 
+ * 
+ *    For more information and up-to-date version, please visit
+ *        
+ *                       http://www.multiboost.org/
+ *
+ */
+
+
+#include <iostream>
+#include <sstream>
+#include <cstdio> // for rename, remove
+
+#include "IO/DataCache.h"
+
+#include <sys/stat.h>
+#include <unistd.h> // for getpid
+
+namespace MultiBoost {
+	
+	static const char DATA_CACHE_MAGIC[] = "MBDATAC1";
+	static const int DATA_CACHE_MAGIC_SIZE = 8;
+	
+	// the size of the blocks of the data file which are hashed into the key
+	static const long long KEY_BLOCK_SIZE = 64 << 10;
+	
+	// ------------------------------------------------------------------------
+	
+	// 64 bit FNV-1a
+	static void hashBytes(DataCache::Key& key, const char* pBytes, size_t size)
+	{
+		for ( size_t i = 0; i < size; ++i )
+		{
+			key ^= static_cast<unsigned char>( pBytes[i] );
+			key *= 1099511628211ULL;
+		}
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	template <typename T>
+	static void hashValue(DataCache::Key& key, const T& value)
+	{ hashBytes( key, reinterpret_cast<const char*>(&value), sizeof(T) ); }
+	
+	// ------------------------------------------------------------------------
+	// ------------------------------------------------------------------------
+	
+	bool DataCache::getKey(const string& fileName, const string& options, Key& key)
+	{
+		struct stat fileStat;
+		if ( stat(fileName.c_str(), &fileStat) != 0 )
+			return false;
+		
+		key = 14695981039346656037ULL;
+		hashValue( key, static_cast<long long>(fileStat.st_size) );
+		hashValue( key, static_cast<long long>(fileStat.st_mtime) );
+		
+		// the first and the last blocks catch the files copied with their time
+		ifstream inFile(fileName.c_str(), ios::binary);
+		if ( !inFile.is_open() )
+			return false;
+		
+		const long long fileSize = fileStat.st_size;
+		vector<char> block( static_cast<size_t>( min(fileSize, KEY_BLOCK_SIZE) ) );
+		if ( !block.empty() )
+		{
+			inFile.read( &block[0], block.size() );
+			hashBytes( key, &block[0], block.size() );
+			
+			inFile.seekg( fileSize - static_cast<long long>(block.size()) );
+			inFile.read( &block[0], block.size() );
+			hashBytes( key, &block[0], block.size() );
+		}
+		
+		if ( !inFile.good() )
+			return false;
+		
+		hashBytes( key, options.data(), options.size() );
+		return true;
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	string DataCache::getFileName(const string& cacheDir, const string& fileName, Key key, 
+								  const string& extension)
+	{
+		// the caches of the files of the same name in different directories differ in the key
+		const size_t slashPos = fileName.find_last_of('/');
+		const string baseName = ( slashPos == string::npos ) ? fileName : fileName.substr(slashPos + 1);
+		
+		ostringstream cacheFileName;
+		cacheFileName << cacheDir;
+		if ( !cacheDir.empty() && cacheDir[cacheDir.size() - 1] != '/' )
+			cacheFileName << '/';
+		cacheFileName << baseName << '.' << hex << key << extension;
+		return cacheFileName.str();
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	bool DataCache::fileExists(const string& fileName)
+	{
+		struct stat fileStat;
+		return stat(fileName.c_str(), &fileStat) == 0;
+	}
+	
+	// ------------------------------------------------------------------------
+	// ------------------------------------------------------------------------
+	
+	DataCacheWriter::DataCacheWriter(const string& cacheFileName, DataCache::Key key)
+	: _cacheFileName(cacheFileName), _isCommitted(false)
+	{
+		ostringstream tmpFileName;
+		tmpFileName << cacheFileName << ".tmp" << getpid();
+		_tmpFileName = tmpFileName.str();
+		
+		_outFile.open(_tmpFileName.c_str(), ios::binary);
+		if ( !_outFile.is_open() )
+			return;
+		
+		_outFile.write(DATA_CACHE_MAGIC, DATA_CACHE_MAGIC_SIZE);
+		write( key );
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	DataCacheWriter::~DataCacheWriter()
+	{
+		if ( !_isCommitted && _outFile.is_open() )
+		{
+			_outFile.close();
+			remove( _tmpFileName.c_str() );
+		}
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	void DataCacheWriter::writeString(const string& str)
+	{
+		write<long long>( str.size() );
+		_outFile.write( str.data(), str.size() );
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	void DataCacheWriter::writeNameMap(const NameMap& nameMap)
+	{
+		write<int>( nameMap.getNumNames() );
+		for ( int i = 0; i < nameMap.getNumNames(); ++i )
+			writeString( nameMap.getNameFromIdx(i) );
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	bool DataCacheWriter::commit()
+	{
+		if ( !_outFile.is_open() )
+			return false;
+		
+		_outFile.close();
+		_isCommitted = true;
+		
+		// rename replaces the file atomically, even if another run wrote it meanwhile
+		if ( _outFile.fail() || rename( _tmpFileName.c_str(), _cacheFileName.c_str() ) != 0 )
+		{
+			remove( _tmpFileName.c_str() );
+			return false;
+		}
+		return true;
+	}
+	
+	// ------------------------------------------------------------------------
+	// ------------------------------------------------------------------------
+	
+	DataCacheReader::DataCacheReader(const string& cacheFileName, DataCache::Key key)
+	: _mappedFile(cacheFileName), _pPos(_mappedFile.begin()), _isValid(true)
+	{
+		if ( !checkSize( DATA_CACHE_MAGIC_SIZE ) || memcmp( _pPos, DATA_CACHE_MAGIC, DATA_CACHE_MAGIC_SIZE ) != 0 )
+		{
+			_isValid = false;
+			return;
+		}
+		_pPos += DATA_CACHE_MAGIC_SIZE;
+		
+		if ( read<DataCache::Key>() != key )
+			_isValid = false;
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	string DataCacheReader::readString()
+	{
+		const long long size = read<long long>();
+		if ( !checkSize( size ) )
+			return string();
+		
+		string str( _pPos, size );
+		_pPos += size;
+		return str;
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	void DataCacheReader::readNameMap(NameMap& nameMap)
+	{
+		nameMap.clear();
+		const int numNames = read<int>();
+		for ( int i = 0; i < numNames && _isValid; ++i )
+			nameMap.addName( readString() );
+	}
+	
+	// ------------------------------------------------------------------------
+	
+} // end of namespace MultiBoost
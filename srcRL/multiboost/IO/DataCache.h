@@ -0,0 +1,246 @@
+/*
+ *
+ *    MultiBoost - Multi-purpose boosting package
+ *
+ *    Copyright (C)        AppStat group
+ *                         Laboratoire de l'Accelerateur Lineaire
+ *                         Universite Paris-Sud, 11, CNRS
+ *
+ *    This file is part of the MultiBoost library
+ *
+ *    This library is free software; you can redistribute it 
+ *    and/or modify it under the terms of the GNU General Public
+ *    License as published by the Free Software Foundation
+ *    version 2.1 of the License.
+ *
+ *    This library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public
+ *    License along with this library; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin St, 5th Floor, Boston, MA 02110-1301 USA
+ *
+ *    Contact: multiboost@googlegroups.com 
+ * 
+ *    For more information and up-to-date version, please visit
+ *        
+ *                       http://www.multiboost.org/
+ *
+ */
+
+
+/**
+ * \file DataCache.h The binary cache of the loaded data.
+ */
+
+#ifndef __DATA_CACHE_H
+#define __DATA_CACHE_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstring> // for memcpy
+
+#include "ChunkedParser.h" // for MappedFile
+#include "NameMap.h"
+
+using namespace std;
+
+namespace MultiBoost {
+	
+	/**
+	 * The cache files hold the data as it is after the loading, so that the later runs
+	 * on the same data file can skip the parsing (see RawData::load()) and the sorting
+	 * (see SortedData::load()). A cache file is:
+	 * \verbatim
+	 <magic "MBDATAC1"> <key> <the sections written by the data class>
+	 \endverbatim
+	 * in the byte order of the machine. The key identifies the data file and the options
+	 * of the parsing, and it is also a part of the name of the cache file, so the caches
+	 * of different options live together in the directory.
+	 * \date 17/10/2026
+	 */
+	class DataCache
+	{
+	public:
+		typedef unsigned long long Key;
+		
+		/**
+		 * The key of a data file. It hashes the size and the modification time of the file
+		 * and its first and last blocks, then the given options.
+		 * \param fileName The name of the data file.
+		 * \param options The options which change the parsed data.
+		 * \param key Set to the key.
+		 * \return False if the file cannot be read.
+		 */
+		static bool getKey(const string& fileName, const string& options, Key& key);
+		
+		/**
+		 * The name of a cache file.
+		 * \param cacheDir The directory of the caches.
+		 * \param fileName The name of the data file.
+		 * \param key The key of the data file.
+		 * \param extension The extension of the cache, which tells what is in it.
+		 */
+		static string getFileName(const string& cacheDir, const string& fileName, Key key, 
+								  const string& extension);
+		
+		/**
+		 * Tell whether a file exists.
+		 */
+		static bool fileExists(const string& fileName);
+	};
+	
+	// -----------------------------------------------------------------------------
+	
+	/**
+	 * Writes a cache file. The file is written under a temporary name and renamed by
+	 * commit(), so the concurrent runs never read a partial cache.
+	 */
+	class DataCacheWriter
+	{
+	public:
+		/**
+		 * Open the temporary file and write the magic and the key.
+		 */
+		DataCacheWriter(const string& cacheFileName, DataCache::Key key);
+		
+		/**
+		 * Remove the temporary file if it was not committed.
+		 */
+		~DataCacheWriter();
+		
+		bool isOpen() const { return _outFile.is_open(); }
+		
+		template <typename T>
+		void write(const T& value)
+		{ _outFile.write( reinterpret_cast<const char*>(&value), sizeof(T) ); }
+		
+		/**
+		 * Write an array: its size then the elements.
+		 */
+		template <typename T>
+		void writeArray(const vector<T>& values)
+		{
+			write<long long>( values.size() );
+			writeElements( values );
+		}
+		
+		/**
+		 * Write the elements of an array without its size, for the arrays which are
+		 * written in pieces.
+		 */
+		template <typename T>
+		void writeElements(const vector<T>& values)
+		{
+			if ( !values.empty() )
+				_outFile.write( reinterpret_cast<const char*>(&values[0]), values.size() * sizeof(T) );
+		}
+		
+		void writeString(const string& str);
+		
+		void writeNameMap(const NameMap& nameMap);
+		
+		/**
+		 * Close the file and give it its name.
+		 * \return False if the file could not be written.
+		 */
+		bool commit();
+		
+	private:
+		DataCacheWriter(const DataCacheWriter&);
+		DataCacheWriter& operator=(const DataCacheWriter&);
+		
+		string   _cacheFileName;
+		string   _tmpFileName;
+		ofstream _outFile;
+		bool     _isCommitted;
+	};
+	
+	// -----------------------------------------------------------------------------
+	
+	/**
+	 * Reads a mapped cache file. A file which is too short or not of the given key is
+	 * not valid, and then the reads return empty values, so the callers check isValid()
+	 * after reading and fall back to the parsing.
+	 */
+	class DataCacheReader
+	{
+	public:
+		/**
+		 * Map the file and check the magic and the key.
+		 * \remark The file must exist.
+		 */
+		DataCacheReader(const string& cacheFileName, DataCache::Key key);
+		
+		bool isValid() const { return _isValid; }
+		
+		template <typename T>
+		T read()
+		{
+			T value = T();
+			if ( checkSize( sizeof(T) ) )
+			{
+				memcpy( &value, _pPos, sizeof(T) );
+				_pPos += sizeof(T);
+			}
+			return value;
+		}
+		
+		/**
+		 * Read an array written by DataCacheWriter::writeArray().
+		 */
+		template <typename T>
+		void readArray(vector<T>& values)
+		{
+			const long long size = read<long long>();
+			values.clear();
+			if ( size < 0 || !checkSize( size * sizeof(T) ) )
+			{
+				_isValid = false;
+				return;
+			}
+			values.resize( size );
+			if ( size > 0 )
+				memcpy( &values[0], _pPos, size * sizeof(T) );
+			_pPos += size * sizeof(T);
+		}
+		
+		/**
+		 * Move forward without copying.
+		 * \param size The number of bytes.
+		 * \return The position in the mapped file, the bytes are not aligned; NULL
+		 * if the file is too short.
+		 */
+		const char* readBytes(long long size)
+		{
+			if ( !checkSize( size ) )
+				return NULL;
+			const char* pBytes = _pPos;
+			_pPos += size;
+			return pBytes;
+		}
+		
+		string readString();
+		
+		void readNameMap(NameMap& nameMap);
+		
+	private:
+		bool checkSize(long long size)
+		{
+			if ( _isValid && size >= 0 && size <= _mappedFile.end() - _pPos )
+				return true;
+			_isValid = false;
+			return false;
+		}
+		
+		MappedFile  _mappedFile;
+		const char* _pPos;
+		bool        _isValid;
+	};
+	
+} // end of namespace MultiBoost
+
+#endif // __DATA_CACHE_H
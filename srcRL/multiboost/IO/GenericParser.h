@@ -64,7 +64,12 @@ namespace MultiBoost
 		GenericParser(const string& fileName, const string& headerFileName)
 		: _fileName(fileName), _headerFileName(headerFileName), 
 		_dataRep(DR_DENSE), _labelRep(LR_DENSE), _hasWeigthInit(false) {}
-		
+
+		/**
+		 * The parsers are deleted through this class by RawData.
+		 */
+		virtual ~GenericParser() {}
+
 		/**
 		 * Abstract function for reading data.
 		 * \param examples The vector of examples to be filled up.
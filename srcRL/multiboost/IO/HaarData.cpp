@@ -32,12 +32,15 @@
 
 
 #include "HaarData.h"
+#include "WeakLearners/Haar/HaarBlocks.h"
 
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <iomanip> // for setprecision
 #include <algorithm> // for sort
 #include <cmath> // for sqrt
+#include <cstring> // for memcmp
 
 // ------------------------------------------------------------------------
 namespace MultiBoost {
@@ -89,6 +92,16 @@ namespace MultiBoost {
 			_loadedFeatures.push_back( hf );
 		}
 		
+		// the memory budget of the sorted responses
+		if ( args.hasArgument("haarcache") )
+		{
+			int cacheSize; // in megabytes
+			args.getValue("haarcache", 0, cacheSize);
+			_responseCache.setMaxSize( static_cast<size_t>( max(cacheSize, 0) ) << 20 );
+		}
+		
+		_checkBlocks = args.hasArgument("haarcheck");
+		
 		string tmpVal = args.getValue<string>("iisize", 0);
 		
 		size_t divPos = tmpVal.find('x');
@@ -231,6 +244,8 @@ namespace MultiBoost {
 		if (inputType == IT_TEST)
 			return;
 		
+		buildIntImageBlocks();
+		
 		if (verboseLevel > 0)
 			cout << "Pre-compute configurations.." << flush;
 		
@@ -241,6 +256,8 @@ namespace MultiBoost {
 		for (it = _loadedFeatures.begin(); it != _loadedFeatures.end(); ++it)
 		{
 			nPrecs = (*it)->precomputeConfigs();
+			if (_checkBlocks)
+				checkIntImageBlocks(*it, nPrecs);
 			if (verboseLevel > 1)
 				cout << "(" << (*it)->getShortName() << ": " << nPrecs << ")" << flush;
 		}
@@ -304,5 +321,207 @@ namespace MultiBoost {
 		return inputValid;
 	}
 	
+	// ------------------------------------------------------------------------
+	
+	void HaarData::buildIntImageBlocks()
+	{
+		const int numExamples = _pData->getNumExample();
+		const int numValues = _width * _height;
+		const int numLanes = HaarLanes::numLanes;
+		const int numBlocks = (numExamples + numLanes - 1) / numLanes;
+		
+		_intImageBlocks.assign( static_cast<size_t>(numBlocks) * numValues * numLanes + 
+							   HaarLanes::alignment / sizeof(FeatureReal), 0 );
+		FeatureReal* pBlocks = const_cast<FeatureReal*>( getIntImageBlocks() );
+		
+		const vector<Example>& examples = _pData->getExamples();
+		for (int i = 0; i < numExamples; ++i)
+		{
+			const vector<FeatureReal>& intImage = examples[i].getValues();
+			FeatureReal* pLane = pBlocks + static_cast<size_t>(i / numLanes) * numValues * numLanes + i % numLanes;
+			
+			for (int p = 0; p < numValues; ++p)
+				pLane[p * numLanes] = intImage[p];
+		}
+		
+		_numBlockExamples = numExamples;
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	const FeatureReal* HaarData::getIntImageBlocks() const
+	{
+		if ( _intImageBlocks.empty() )
+			return NULL;
+		
+		const FeatureReal* pBlocks = &_intImageBlocks[0];
+		while ( reinterpret_cast<size_t>(pBlocks) % HaarLanes::alignment != 0 )
+			++pBlocks;
+		
+		return pBlocks;
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	void HaarData::fillAllHaarData( HaarFeature* pFeature, vector< pair<int, FeatureReal> >& haarData )
+	{
+		haarData.resize( _pData->getNumExample() );
+		
+		// examples might have been added since the blocks were built, see InputData::addExample
+		if ( !_intImageBlocks.empty() && _numBlockExamples != _pData->getNumExample() )
+			buildIntImageBlocks();
+		
+		if ( _intImageBlocks.empty() )
+			pFeature->fillHaarData( _pData->getExamples(), haarData );
+		else
+			pFeature->fillHaarData( getIntImageBlocks(), _pData->getNumExample(), haarData );
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	void HaarData::checkIntImageBlocks( HaarFeature* pFeature, int numConfigs )
+	{
+		const int numExamples = _pData->getNumExample();
+		vector< pair<int, FeatureReal> > exampleData(numExamples);
+		vector< pair<int, FeatureReal> > blockData(numExamples);
+		
+		for (int c = 0; c < numConfigs; ++c)
+		{
+			pFeature->loadConfigByNum(c);
+			pFeature->fillHaarData( _pData->getExamples(), exampleData );
+			pFeature->fillHaarData( getIntImageBlocks(), numExamples, blockData );
+			
+			// bit-exact, or the stumps could pick different thresholds
+			for (int i = 0; i < numExamples; ++i)
+			{
+				if ( memcmp(&exampleData[i].second, &blockData[i].second, sizeof(FeatureReal)) != 0 )
+				{
+					cerr << "ERROR: the blocked value of feature " << pFeature->getShortName() 
+					     << " (configuration " << c << ") on example " << i << " is " << setprecision(10)
+					     << blockData[i].second << " instead of " << exampleData[i].second << "!" << endl;
+					exit(1);
+				}
+			}
+		}
+		
+		// back where precomputeConfigs left it
+		pFeature->loadConfigByNum(0);
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	void HaarData::fillSortedHaarData( HaarFeature* pFeature, vector< pair<int, FeatureReal> >& haarData )
+	{
+		if ( _responseCache.getMaxSize() == 0 )
+		{
+			// transform the data from intImages to the feature's space
+			if ( _intImageBlocks.empty() )
+				pFeature->fillHaarData( getExamples(), haarData );
+			else if ( !isFiltered() )
+				fillAllHaarData( pFeature, haarData );
+			else
+			{
+				// the blocks hold all the examples, keep the ones of the index set
+				vector< pair<int, FeatureReal> > allHaarData;
+				fillAllHaarData( pFeature, allHaarData );
+				
+				haarData.clear();
+				for (int i = 0; i < (int)allHaarData.size(); ++i)
+				{
+					if ( _rawIndices[i] >= 0 )
+						haarData.push_back( make_pair( _rawIndices[i], allHaarData[i].second ) );
+				}
+			}
+			
+			// sort the examples in the new space by their coordinate
+			sort( haarData.begin(), haarData.end(), 
+				 nor_utils::comparePair<2, int, FeatureReal, less<FeatureReal> >() );
+			return;
+		}
+		
+		const int featureType = pFeature->getType();
+		const int configIdx = pFeature->getLoadedConfigIndex();
+		
+		// the cached columns hold all the examples, so they stay valid when the index set changes
+		HaarResponseCache::column responses;
+		const HaarResponseCache::column* pResponses = 
+		_responseCache.find( featureType, configIdx, _pData->getNumExample() );
+		
+		if ( !pResponses )
+		{
+			fillAllHaarData( pFeature, responses );
+			sort( responses.begin(), responses.end(), 
+				 nor_utils::comparePair<2, int, FeatureReal, less<FeatureReal> >() );
+			
+			pResponses = _responseCache.insert( featureType, configIdx, responses );
+			if ( !pResponses )
+				pResponses = &responses; // larger than the cache
+		}
+		
+		if ( !isFiltered() )
+		{
+			haarData.assign( pResponses->begin(), pResponses->end() );
+			return;
+		}
+		
+		// the examples of the index set, with their index in it
+		haarData.clear();
+		HaarResponseCache::column::const_iterator rIt;
+		for ( rIt = pResponses->begin(); rIt != pResponses->end(); ++rIt )
+		{
+			const int idx = _rawIndices[ rIt->first ];
+			if ( idx >= 0 )
+				haarData.push_back( make_pair( idx, rIt->second ) );
+		}
+	}
+	
+	// ------------------------------------------------------------------------
+	// ------------------------------------------------------------------------
+	
+	const HaarResponseCache::column* HaarResponseCache::find( int featureType, int configIdx, int numExamples )
+	{
+		map<key, entry>::iterator cIt = _columns.find( key( featureType, configIdx ) );
+		if ( cIt == _columns.end() )
+			return NULL;
+		
+		// examples have been added since the column was cached
+		if ( static_cast<int>(cIt->second.responses.size()) != numExamples )
+		{
+			clear();
+			return NULL;
+		}
+		
+		// move it to the front of the list
+		_lru.splice( _lru.begin(), _lru, cIt->second.lruIt );
+		return &cIt->second.responses;
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	const HaarResponseCache::column* HaarResponseCache::insert( int featureType, int configIdx, column& responses )
+	{
+		const size_t columnSize = responses.size() * sizeof(column::value_type);
+		if ( columnSize > _maxSize )
+			return NULL;
+		
+		// drop the least recently used columns
+		while ( _size + columnSize > _maxSize )
+		{
+			map<key, entry>::iterator cIt = _columns.find( _lru.back() );
+			_size -= cIt->second.responses.size() * sizeof(column::value_type);
+			_columns.erase( cIt );
+			_lru.pop_back();
+		}
+		
+		const key columnKey( featureType, configIdx );
+		entry& newEntry = _columns[ columnKey ];
+		newEntry.responses.swap( responses );
+		newEntry.lruIt = _lru.insert( _lru.begin(), columnKey );
+		_size += columnSize;
+		
+		return &newEntry.responses;
+	}
+	
+	// ------------------------------------------------------------------------
 	
 } // end of namespace MultiBoost
@@ -49,6 +49,7 @@
 
 #include <string>
 #include <map>
+#include <list>
 #include <cassert>
 
 using namespace std;
@@ -59,6 +60,66 @@ namespace MultiBoost {
 	typedef vector< pair<int, int> >::iterator       vpIntIterator; //!< Iterator on pair 
 	typedef vector< pair<int, int> >::const_iterator cvpIntIterator; //!< Const iterator on pair 
 	
+	/**
+	 * The responses of Haar-like feature configurations on all the examples, sorted by 
+	 * their value. The responses do not depend on the weights, so a configuration which 
+	 * is visited again in a later iteration is neither evaluated nor sorted again.
+	 * When the cache is full the least recently used columns are dropped.
+	 * \see HaarData::fillSortedHaarData
+	 * \date 17/10/2026
+	 */
+	class HaarResponseCache
+	{
+	public:
+		typedef vector< pair<int, FeatureReal> > column; //!< (example index, response) sorted by response
+		
+		HaarResponseCache() : _size(0), _maxSize(0) {}
+		
+		/**
+		 * Set the memory budget of the cache, 0 switches it off.
+		 * \param maxSize The size in bytes.
+		 */
+		void   setMaxSize(size_t maxSize) { _maxSize = maxSize; clear(); }
+		size_t getMaxSize() const { return _maxSize; }
+		
+		/**
+		 * Find a cached column, and make it the most recently used one.
+		 * The cached columns hold all the examples, if their number changed (see
+		 * InputData::addExample) every column is stale and the cache is cleared.
+		 * \param featureType The type of the feature.
+		 * \param configIdx The index of the configuration of the feature.
+		 * \param numExamples The current number of examples of the data.
+		 * \return The column, or NULL if it is not cached.
+		 */
+		const column* find(int featureType, int configIdx, int numExamples);
+		
+		/**
+		 * Add a column, after dropping the least recently used ones if it does not fit.
+		 * \param responses The column, it is swapped into the cache if it is added.
+		 * \return The cached column, or NULL if it is larger than the cache.
+		 * \see find
+		 */
+		const column* insert(int featureType, int configIdx, column& responses);
+		
+		void clear() { _columns.clear(); _lru.clear(); _size = 0; }
+		
+	private:
+		typedef pair<int, int> key; //!< (feature type, configuration index)
+		
+		struct entry
+		{
+			column                 responses;
+			list<key>::iterator    lruIt; //!< The position in _lru
+		};
+		
+		map<key, entry> _columns;
+		list<key>       _lru; //!< The keys from the most recently used one
+		size_t          _size; //!< The bytes of the cached columns
+		size_t          _maxSize;
+	};
+	
+	// ------------------------------------------------------------------------
+	
 	/**
 	 * Overloading of the InputData class to load data which has been already
 	 * transformed into integral image representation. To get more information about
@@ -95,6 +156,12 @@ namespace MultiBoost {
 	{
 	public:
 		
+		/**
+		 * The constructor. It does noting but initializing some variables.
+		 * \date 17/10/2026
+		 */
+		HaarData() : _numBlockExamples(0), _checkBlocks(false) {}
+		
 		/**
 		 * The destructor. Erases the integral image data.
 		 * \date 17/12/2005
@@ -154,6 +221,27 @@ namespace MultiBoost {
 		 */
 		vector<HaarFeature*>& getLoadedFeatures() { return _loadedFeatures; }
 		
+		/**
+		 * Transform the used examples into the space of the current configuration of a 
+		 * feature, and sort them by their value. It is what HaarFeature::fillHaarData() and 
+		 * a sort would do, but with --haarcache the sorted columns of all the examples are
+		 * kept in a HaarResponseCache, and only the examples of the index set are taken
+		 * out of them.
+		 * \param pFeature The feature, with the configuration to use.
+		 * \param haarData The returned vector of (example index, feature output) pairs.
+		 * \date 17/10/2026
+		 */
+		void fillSortedHaarData( HaarFeature* pFeature, vector< pair<int, FeatureReal> >& haarData );
+		
+		/**
+		 * Get the integral images of all the examples, stored by blocks of 
+		 * HaarLanes::numLanes interleaved examples for the batched HaarFeature::fillHaarData. 
+		 * \return The aligned blocks, or NULL if they have not been built (test data).
+		 * \see IntImageBlockSums
+		 * \date 17/10/2026
+		 */
+		const FeatureReal* getIntImageBlocks() const;
+		
 		//////////////////////////////////////////////////////////////////////////
 		
 		/**
@@ -171,6 +259,30 @@ namespace MultiBoost {
 	protected:
 		bool checkInput(const string& line, int numColumns);
 		
+		/**
+		 * Copy the integral images of the examples into _intImageBlocks. It is called again
+		 * when examples are added to the data.
+		 * \date 17/10/2026
+		 */
+		void buildIntImageBlocks();
+		
+		/**
+		 * Fill the outputs of the current configuration of a feature for all the
+		 * examples, that is ignoring the index set.
+		 * \date 17/10/2026
+		 */
+		void fillAllHaarData( HaarFeature* pFeature, vector< pair<int, FeatureReal> >& haarData );
+		
+		/**
+		 * Compare the values of the batched HaarFeature::fillHaarData on the blocks with
+		 * the per-example ones, for every configuration of the feature, and exit on the
+		 * first one that differs. It runs in load() with --haarcheck.
+		 * \param pFeature The feature, with its configurations precomputed.
+		 * \param numConfigs The number of configurations of the feature.
+		 * \date 17/10/2026
+		 */
+		void checkIntImageBlocks( HaarFeature* pFeature, int numConfigs );
+		
 		//vector< int* >   _intImages;       //!< the data of the examples.
 		
 		static short   _width;  //!< The width of the integral image.
@@ -180,6 +292,12 @@ namespace MultiBoost {
 		 * The list of features that have been requested by the user.
 		 */
 		vector<HaarFeature*> _loadedFeatures; //!< 
+		
+		HaarResponseCache _responseCache; //!< The sorted responses of the configurations, see --haarcache
+		
+		vector<FeatureReal> _intImageBlocks; //!< The interleaved integral images, with room for the alignment
+		int                 _numBlockExamples; //!< The number of examples in _intImageBlocks
+		bool                _checkBlocks; //!< Check the blocked values after loading, see --haarcheck
 	};
 	
 } // end of namespace Multiboost
@@ -159,6 +159,28 @@ namespace MultiBoost {
 			_nExamplesPerClass = _pData->getExamplesPerClass();				
 		}
 		
+		/**
+		 * Replace the data with examples which were parsed elsewhere, all of them are used.
+		 * \param examples The examples, they are swapped into the data.
+		 * \see RawData::setExamples
+		 */
+		virtual void loadExamples( vector<Example>& examples, const NameMap& classMap, 
+								  const vector<NameMap>& enumMaps, const NameMap& attributeNameMap, 
+								  const vector<RawData::eAttributeType>& attributeTypes, 
+								  eDataRep dataRep, eLabelRep labelRep ) {
+			_pData->setExamples( examples, classMap, enumMaps, attributeNameMap, attributeTypes, dataRep, labelRep );
+			_numExamples = _pData->getNumExample();
+			_rawIndices.resize( _numExamples );
+			_indirectIndices.resize( _numExamples );
+			for( int i=0; i < _numExamples; i++ ) {
+				_indirectIndices[i] = i;
+				_rawIndices[i] = i;
+			}
+			
+			_subsetAlreadyComputed = true;
+			_nExamplesPerClass = _pData->getExamplesPerClass();
+		}
+		
 		/**
 		 * Gets the labels of the given example.
 		 * \param idx The index of the example
@@ -194,6 +216,22 @@ namespace MultiBoost {
 		//////////////////////////////////////////////////////////////////////////
 		//////////////////////////////////////////////////////////////////////////
 		
+		/**
+		 * The nonzero values of an attribute of sparse data in compressed column format.
+		 * \param columnIdx The index of the attribute.
+		 * \param rows Set to the raw indices of the examples, in increasing order.
+		 * \param values Set to the values.
+		 * \return The number of the nonzero values.
+		 * \remark The rows are raw indices, on filtered data they must be mapped with
+		 * getOrderBasedOnRawIndex(). Only for DR_SPARSE data. The first call builds
+		 * the columns and must be made outside parallel regions.
+		 * \see RawData::getSparseColumn
+		 */
+		int getSparseColumn(int columnIdx, const int*& rows, const FeatureReal*& values)
+		{ return _pData->getSparseColumn( columnIdx, rows, values ); }
+		
+		const eDataRep getDataRep() const { return _pData->getDataRep(); } //!< Returns the data representation.
+		
 		inline const Example& getExample(int idx)
 		{ return _pData->getExample( _indirectIndices[idx] ); }
 		
@@ -281,7 +319,7 @@ namespace MultiBoost {
 		 * Clear the indices of subset we use, the whole dataset containing _pData will be used 
 		 * 	* \data 12/10/2009
 		 */
-		void	clearIndexSet( void );
+		virtual void	clearIndexSet( void );
 		//TODO: comment		
 		inline bool isFiltered() { return _numExamples != _pData->getNumExample(); }
 		//TODO: comment		
@@ -91,6 +91,17 @@ int NameMap::getIdxFromName(const string& name) const
 
 // ------------------------------------------------------------------------
 
+int NameMap::findIdxFromName(const string& name) const
+{
+   map<string, int>::const_iterator it = _mapNameToIdx.find(name);
+   if ( it == _mapNameToIdx.end() )
+      return -1;
+
+   return it->second;
+}
+
+// ------------------------------------------------------------------------
+
 void NameMap::clear( void ) {
 	_mapIdxToName.clear();
 	_mapNameToIdx.clear();
@@ -94,6 +94,14 @@ public:
    */
    int getIdxFromName(const string& name) const;
 
+   /**
+   * Get the index using the name, without changing the map even if the name
+   * is unknown. Unlike getIdxFromName() it can be called from parallel threads.
+   * \param name The name.
+   * \return The index, or -1 if the name is not in the map.
+   */
+   int findIdxFromName(const string& name) const;
+
    int getNumNames() const { return _numRegNames; }   //!< Returns the number of names 
 
    void clear( void );
@@ -49,6 +49,7 @@ namespace MultiBoost {
 	{
         //some intializations
         _customTablesUpdate = customUpdate;
+        _beginingTime = time( NULL );
         
 		// open the stream
 		_outStream.open(outputInfoFile.c_str());
@@ -71,6 +72,7 @@ namespace MultiBoost {
 	{
         //internal intializations
         _customTablesUpdate = customUpdate;
+        _beginingTime = time( NULL );
         
         _outputListString = outList;
         getOutputListFromString(outList);
@@ -93,6 +95,7 @@ namespace MultiBoost {
 	OutputInfo::OutputInfo(const nor_utils::Args& args, bool customUpdate, const string & clArg)
 	{
         _customTablesUpdate = customUpdate;
+        _beginingTime = time( NULL );
         
         string outputInfoFile;
         
@@ -202,7 +205,7 @@ namespace MultiBoost {
         
         OutInfIt outputIt;
         for (outputIt = _outputList.begin(); outputIt != _outputList.end(); ++outputIt) {
-            (*outputIt)->computeAndOutput(_outStream, pData, _gTableMap, _margins, _alphaSums, pWeakHypothesis);
+            (*outputIt)->computeAndOutput(_outStream, pData, _gTableMap, _alphaSums, pWeakHypothesis);
             if ((outputIt+1) != _outputList.end()) _outStream << OUTPUT_SEPARATOR;
         } 
         
@@ -212,26 +215,24 @@ namespace MultiBoost {
     void OutputInfo::updateTables(InputData* pData, BaseLearner* pWeakHypothesis)
     {
 		const int numExamples = pData->getNumExamples();
+		const AlphaReal alpha = pWeakHypothesis->getAlpha();
 		
 		table& g = _gTableMap[pData];
-        table& margins = _margins[pData];
         
-		vector<Label>::const_iterator lIt;
-		
 		// Building the strong learner (discriminant function)
+		// The weak hypothesis is evaluated only here, once per label, the outputs
+		// compute their metrics from the updated tables.
+#pragma omp parallel for schedule(static)
 		for (int i = 0; i < numExamples; ++i)
 		{
 			const vector<Label>& labels = pData->getLabels(i);
+			vector<Label>::const_iterator lIt;
 			
 			for (lIt = labels.begin(); lIt != labels.end(); ++lIt )
 			{
                 // update the posteriors table
-				g[i][lIt->idx] += pWeakHypothesis->getAlpha() * // alpha
+				g[i][lIt->idx] += alpha * // alpha
 				pWeakHypothesis->classify( pData, i, lIt->idx ); 
-                
-                // update the margins table
-                // FIXME: redundancy 
-                margins[i][lIt->idx] += g[i][lIt->idx] * lIt->y ;
 			}
 		}
         
@@ -296,18 +297,6 @@ namespace MultiBoost {
                 g[i][l] = 0;
         }
         
-        table& margins = _margins[pData];
-        margins.resize(numExamples);
-        
-        for ( int i = 0; i < numExamples; ++i )
-        {
-            //if (pData->isSparseLabel())
-            //   numClasses = pData->getNumNonzeroLabels(i);
-            margins[i].resize(numClasses);
-            for (int l = 0; l < numClasses; ++l)
-                margins[i][l] = 0;
-        }
-        
         _alphaSums[pData] = 0;
 
 	}
@@ -329,7 +318,7 @@ namespace MultiBoost {
         if ( type.compare("mae") == 0 ) return new MAEOuput();
         if ( type.compare("mar") == 0 ) return new MarginsOutput();
         if ( type.compare("edg") == 0 ) return new EdgeOutput();
-        if ( type.compare("auc") == 0 ) return new AUCOutput();
+        if ( type.compare("auc") == 0 ) return new AUCOutput(args);
         if ( type.compare("tfr") == 0 ) return new TPRFPROutput();
         if ( type.compare("sca") == 0 ) return new SoftCascadeOutput(*args); 
         if ( type.compare("pos") == 0 ) return new PosteriorsOutput();
@@ -345,7 +334,6 @@ namespace MultiBoost {
 
     void RestrictedZeroOneError::computeAndOutput(ostream& outStream, InputData* pData, 
                           map<InputData*, table>& gTableMap, 
-                          map<InputData*, table>& marginsTableMap, 
                           map<InputData*, AlphaReal>& alphaSums,
                           BaseLearner* pWeakHypothesis)
     {
@@ -394,7 +382,6 @@ namespace MultiBoost {
 	
     void ZeroOneErrorOutput::computeAndOutput(ostream& outStream, InputData* pData, 
 											 map<InputData*, table>& gTableMap, 
-											 map<InputData*, table>& marginsTableMap, 
 											 map<InputData*, AlphaReal>& alphaSums,
 											 BaseLearner* pWeakHypothesis)
     {
@@ -406,9 +393,11 @@ namespace MultiBoost {
         
         int numErrors = 0;   
         
+#pragma omp parallel for private(lIt) reduction(+:numErrors) schedule(static)
         for (int i = 0; i < numExamples; ++i)
         {
             const vector<Label>& labels = pData->getLabels(i);
+            const vector<AlphaReal>& gi = g[i];
             
             // the vote of the winning negative class
             AlphaReal maxNegClass = -numeric_limits<AlphaReal>::max();
@@ -418,12 +407,12 @@ namespace MultiBoost {
             for ( lIt = labels.begin(); lIt != labels.end(); ++lIt )
             {
                 // get the negative winner class
-                if ( lIt->y < 0 && g[i][lIt->idx] > maxNegClass )
-                    maxNegClass = g[i][lIt->idx];
+                if ( lIt->y < 0 && gi[lIt->idx] > maxNegClass )
+                    maxNegClass = gi[lIt->idx];
                 
                 // get the positive winner class
-                if ( lIt->y > 0 && g[i][lIt->idx] > maxPosClass )
-                    maxPosClass = g[i][lIt->idx];
+                if ( lIt->y > 0 && gi[lIt->idx] > maxPosClass )
+                    maxPosClass = gi[lIt->idx];
             }
             
             // if the vote for the worst positive label is lower than the
@@ -443,7 +432,6 @@ namespace MultiBoost {
 	
     void WeightedZeroOneErrorOutput::computeAndOutput(ostream& outStream, InputData* pData, 
 											  map<InputData*, table>& gTableMap, 
-											  map<InputData*, table>& marginsTableMap, 
 											  map<InputData*, AlphaReal>& alphaSums,
 											  BaseLearner* pWeakHypothesis)
     {
@@ -501,7 +489,6 @@ namespace MultiBoost {
 	
     void HammingErrorOutput::computeAndOutput(ostream& outStream, InputData* pData, 
 											  map<InputData*, table>& gTableMap, 
-											  map<InputData*, table>& marginsTableMap, 
 											  map<InputData*, AlphaReal>& alphaSums,
 											  BaseLearner* pWeakHypothesis)
     {
@@ -532,7 +519,6 @@ namespace MultiBoost {
 	
     void WeightedHammingErrorOutput::computeAndOutput(ostream& outStream, InputData* pData, 
 											  map<InputData*, table>& gTableMap, 
-											  map<InputData*, table>& marginsTableMap, 
 											  map<InputData*, AlphaReal>& alphaSums,
 											  BaseLearner* pWeakHypothesis)
     {
@@ -571,7 +557,6 @@ namespace MultiBoost {
 
     void WeightedErrorOutput::computeAndOutput(ostream& outStream, InputData* pData, 
                                            map<InputData*, table>& gTableMap, 
-                                           map<InputData*, table>& marginsTableMap, 
                                            map<InputData*, AlphaReal>& alphaSums,
                                            BaseLearner* pWeakHypothesis)
     {
@@ -627,7 +612,6 @@ namespace MultiBoost {
 
     void BalancedErrorOutput::computeAndOutput(ostream& outStream, InputData* pData, 
                                                map<InputData*, table>& gTableMap, 
-                                               map<InputData*, table>& marginsTableMap, 
                                                map<InputData*, AlphaReal>& alphaSums,
                                                BaseLearner* pWeakHypothesis)
     {
@@ -705,7 +689,6 @@ namespace MultiBoost {
 
     void MAEOuput::computeAndOutput(ostream& outStream, InputData* pData, 
                                                map<InputData*, table>& gTableMap, 
-                                               map<InputData*, table>& marginsTableMap,
                                                map<InputData*, AlphaReal>& alphaSums,
                                                BaseLearner* pWeakHypothesis)
 	{
@@ -752,7 +735,6 @@ namespace MultiBoost {
 
     void MarginsOutput::computeAndOutput(ostream& outStream, InputData* pData, 
                                                map<InputData*, table>& gTableMap, 
-                                               map<InputData*, table>& marginsTableMap, 
                                                map<InputData*, AlphaReal>& alphaSums,
                                                BaseLearner* pWeakHypothesis)
 	{
@@ -761,7 +743,9 @@ namespace MultiBoost {
 		
 		//    to be continued: single/dense/sparse
 		
-		table& margins = marginsTableMap[pData];
+		// the margins are read from the posteriors table, which is up to date
+		// even if the learner updates the tables itself (see OutputInfo::setTable)
+		table& g = gTableMap[pData];
 		
 		AlphaReal minMargin = numeric_limits<AlphaReal>::max();
 		AlphaReal belowZeroMargin = 0;                        
@@ -774,24 +758,21 @@ namespace MultiBoost {
 			
 			for (lIt = labels.begin(); lIt != labels.end(); ++lIt )
 			{
-				AlphaReal hy =  pWeakHypothesis->classify(pData, i, lIt->idx) * // h_l(x_i)
-				lIt->y; // y
-				
-				// compute the margin
-				margins[i][lIt->idx] += pWeakHypothesis->getAlpha() * hy;
+				// the margin: sum_t alpha^(t) h_l^(t)(x_i) y_i
+				const AlphaReal margin = g[i][lIt->idx] * lIt->y;
 				
 				// gets the margin below zero
 #ifdef NOTIWEIGHT
-				if ( margins[i][lIt->idx] < 0 )
+				if ( margin < 0 )
 					belowZeroMargin += lIt->weight;
 #else
-				if ( margins[i][lIt->idx] < 0 )
+				if ( margin < 0 )
 					belowZeroMargin += lIt->initialWeight;
 #endif
 				
 				// get the minimum margin among classes and examples
-				if (margins[i][lIt->idx] < minMargin)
-					minMargin = margins[i][lIt->idx];
+				if (margin < minMargin)
+					minMargin = margin;
 			}
 		}	
 		
@@ -804,7 +785,6 @@ namespace MultiBoost {
 
     void EdgeOutput::computeAndOutput(ostream& outStream, InputData* pData, 
                                                map<InputData*, table>& gTableMap, 
-                                               map<InputData*, table>& marginsTableMap, 
                                                map<InputData*, AlphaReal>& alphaSums,
                                                BaseLearner* pWeakHypothesis)
 	{
@@ -834,24 +814,28 @@ namespace MultiBoost {
 
     void AUCOutput::computeAndOutput(ostream& outStream, InputData* pData, 
                                                map<InputData*, table>& gTableMap, 
-                                               map<InputData*, table>& marginsTableMap, 
                                                map<InputData*, AlphaReal>& alphaSums,
                                                BaseLearner* pWeakHypothesis)
 	{
 		const int numClasses = pData->getNumClasses();
 		const int numExamples = pData->getNumExamples();
 		
-		vector< int > fp( numClasses );   
-		fill( fp.begin(), fp.end(), 0 );
+		vector< double >& ROCscores = _ROCscores[pData];
+		
+		// between two samplings the last computed AUCs are repeated
+		int& numCalls = _numCalls[pData];
+		if ( (numCalls++ % _period) != 0 && (int)ROCscores.size() == numClasses ) {
+			outputScores( outStream, ROCscores );
+			return;
+		}
 		
 		table& g = gTableMap[pData];
-		vector<Label>::const_iterator lIt;
 		
-		vector< pair< int, AlphaReal > > data( numExamples );
+		vector< pair< int, AlphaReal > >& data = _data;
+		data.resize( numExamples );
 		
-		vector< double > ROCscores( numClasses );
+		ROCscores.resize( numClasses );
 		fill( ROCscores.begin(), ROCscores.end(), 0.0 );
-		double ROCsum = 0.0;
 		
 		for( int i=0; i < numClasses; i++ ) {
 			if ( 0 < pData->getNumExamplesPerClass( i ) ) {
@@ -884,16 +868,26 @@ namespace MultiBoost {
 			} else {
 				ROCscores[i] = 0.0;
 			}
-			
-			ROCsum += ROCscores[i];
 		}
+		
+		outputScores( outStream, ROCscores );
+	}
+	
+    // -------------------------------------------------------------------------	
+
+    void AUCOutput::outputScores(ostream& outStream, const vector< double >& ROCscores)
+	{
+		const int numClasses = ROCscores.size();
+		
+		double ROCsum = 0.0;
+		for( int i=0; i < numClasses; i++ )
+			ROCsum += ROCscores[i];
 		ROCsum /= (double) numClasses;
 		
 		outStream << ROCsum; // mean of AUC
 		for( int i=0; i < numClasses; i++ ) {
 			outStream << OUTPUT_SEPARATOR << ROCscores[i];
 		}
-		
 	}
 	
     // -------------------------------------------------------------------------	
@@ -901,7 +895,6 @@ namespace MultiBoost {
 
     void TPRFPROutput::computeAndOutput(ostream& outStream, InputData* pData, 
                                                map<InputData*, table>& gTableMap, 
-                                               map<InputData*, table>& marginsTableMap, 
                                                map<InputData*, AlphaReal>& alphaSums,
                                                BaseLearner* pWeakHypothesis)
 
@@ -993,7 +986,6 @@ namespace MultiBoost {
     
     void SoftCascadeOutput::computeAndOutput(ostream& outStream, InputData* pData, 
                           map<InputData*, table>& gTableMap, 
-                          map<InputData*, table>& marginsTableMap, 
                           map<InputData*, AlphaReal>& alphaSums,
                                            BaseLearner* pWeakHypothesis) {
         set<int> indices ;
@@ -1124,7 +1116,6 @@ namespace MultiBoost {
 
     void PosteriorsOutput::computeAndOutput(ostream& outStream, InputData* pData, 
                           map<InputData*, table>& gTableMap, 
-                          map<InputData*, table>& marginsTableMap, 
                           map<InputData*, AlphaReal>& alphaSums,
                           BaseLearner* pWeakHypothesis)
     {
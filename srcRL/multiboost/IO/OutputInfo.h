@@ -212,14 +212,9 @@ namespace MultiBoost {
 				copy( tmpTable[i].begin(), tmpTable[i].end(), g[i].begin() ); 
 		}
 		
-		table& getMargins( InputData* pData )
-		{
-			table& g = _margins[pData];
-			return g;
-		}
         
         /*
-         * Updates the G and Margin tables and alphaSums vector
+         * Updates the G table and alphaSums vector
          * \date 17/06/2011
          */
         void updateTables(InputData* pData, BaseLearner* pWeakHypothesis);
@@ -261,16 +256,6 @@ namespace MultiBoost {
 		 */
 		map<InputData*, table> _gTableMap; 
 		
-		/**
-		 * Maps the data to the margins table.
-		 * It is needed to keep this information saved from iteration to
-		 * iteration.
-		 * \see table
-		 * \see outputMargins()
-		 * \date 16/11/2005
-		 */
-		map<InputData*, table>  _margins;
-		
 		/**
 		 * Maps the data to the sum of the alpha.
 		 * It is needed to keep this information saved from iteration to
@@ -341,7 +326,6 @@ namespace MultiBoost {
          */
         virtual void computeAndOutput(ostream& outStream, InputData* pData, 
                                       map<InputData*, table>& gTableMap, 
-                                      map<InputData*, table>& marginsTableMap, 
                                       map<InputData*, AlphaReal>& alphaSums,
                                       BaseLearner* pWeakHypothesis = 0) = 0;
         
@@ -420,7 +404,6 @@ namespace MultiBoost {
         
         void computeAndOutput(ostream& outStream, InputData* pData, 
                               map<InputData*, table>& gTableMap, 
-                              map<InputData*, table>& marginsTableMap, 
                               map<InputData*, AlphaReal>& alphaSums,
                               BaseLearner* pWeakHypothesis = 0);
     };
@@ -442,7 +425,6 @@ namespace MultiBoost {
         
         void computeAndOutput(ostream& outStream, InputData* pData, 
                               map<InputData*, table>& gTableMap, 
-                              map<InputData*, table>& marginsTableMap, 
                               map<InputData*, AlphaReal>& alphaSums,
                               BaseLearner* pWeakHypothesis = 0);
     };
@@ -464,7 +446,6 @@ namespace MultiBoost {
         
         void computeAndOutput(ostream& outStream, InputData* pData, 
                               map<InputData*, table>& gTableMap, 
-                              map<InputData*, table>& marginsTableMap, 
                               map<InputData*, AlphaReal>& alphaSums,
                               BaseLearner* pWeakHypothesis = 0);
     };
@@ -486,7 +467,6 @@ namespace MultiBoost {
         
         void computeAndOutput(ostream& outStream, InputData* pData, 
                               map<InputData*, table>& gTableMap, 
-                              map<InputData*, table>& marginsTableMap, 
                               map<InputData*, AlphaReal>& alphaSums,
                               BaseLearner* pWeakHypothesis = 0);
     };
@@ -507,7 +487,6 @@ namespace MultiBoost {
         
         void computeAndOutput(ostream& outStream, InputData* pData, 
                               map<InputData*, table>& gTableMap, 
-                              map<InputData*, table>& marginsTableMap, 
                               map<InputData*, AlphaReal>& alphaSums,
                               BaseLearner* pWeakHypothesis = 0);
     };
@@ -530,7 +509,6 @@ namespace MultiBoost {
         
         void computeAndOutput(ostream& outStream, InputData* pData, 
                               map<InputData*, table>& gTableMap, 
-                              map<InputData*, table>& marginsTableMap, 
                               map<InputData*, AlphaReal>& alphaSums,
                               BaseLearner* pWeakHypothesis = 0);
     };
@@ -561,7 +539,6 @@ namespace MultiBoost {
         
         void computeAndOutput(ostream& outStream, InputData* pData, 
                               map<InputData*, table>& gTableMap, 
-                              map<InputData*, table>& marginsTableMap, 
                               map<InputData*, AlphaReal>& alphaSums,
                               BaseLearner* pWeakHypothesis = 0);
     };
@@ -583,7 +560,6 @@ namespace MultiBoost {
         
         void computeAndOutput(ostream& outStream, InputData* pData, 
                               map<InputData*, table>& gTableMap, 
-                              map<InputData*, table>& marginsTableMap, 
                               map<InputData*, AlphaReal>& alphaSums,
                               BaseLearner* pWeakHypothesis = 0);
     };
@@ -623,7 +599,6 @@ namespace MultiBoost {
         
         void computeAndOutput(ostream& outStream, InputData* pData, 
                               map<InputData*, table>& gTableMap, 
-                              map<InputData*, table>& marginsTableMap, 
                               map<InputData*, AlphaReal>& alphaSums,
                               BaseLearner* pWeakHypothesis = 0);
     };
@@ -648,7 +623,6 @@ namespace MultiBoost {
         
         void computeAndOutput(ostream& outStream, InputData* pData, 
                               map<InputData*, table>& gTableMap, 
-                              map<InputData*, table>& marginsTableMap, 
                               map<InputData*, AlphaReal>& alphaSums,
                               BaseLearner* pWeakHypothesis = 0);
     };
@@ -659,12 +633,32 @@ namespace MultiBoost {
     /**
      * The Area Under the ROC curve
      * (see \link http://sites.google.com/a/lesoliveira.net/luiz-eduardo-s-oliveira/Reconhecimento-de-Padr%C3%B5es--SS-/Artigos/ROCintro.pdf )
+     * Sorting the scores of every class is the most expensive output, so with --aucperiod <p>
+     * the AUCs are computed only at every p-th output of a dataset (including the first one),
+     * the last values are repeated in between.
      * \date 20/06/2011
      */
     class AUCOutput : public BaseOutputInfoType {
         
+    protected:
+        
+        int _period; //!< the AUCs are computed at every _period-th call
+        map<InputData*, int> _numCalls; //!< the number of outputs per dataset
+        map<InputData*, vector<double> > _ROCscores; //!< the last AUCs per dataset
+        vector< pair< int, AlphaReal > > _data; //!< buffer of the (label, score) pairs
+        
+        void outputScores(ostream& outStream, const vector< double >& ROCscores);
+        
     public:
         
+        AUCOutput(const nor_utils::Args* args = NULL) : _period(1)
+        {
+            if ( args && args->hasArgument("aucperiod") )
+                args->getValue("aucperiod", 0, _period);
+            if ( _period < 1 )
+                _period = 1;
+        }
+        
         void outputHeader(ostream& outStream, const NameMap& namemap)
         { 
             outStream << "auc" ;
@@ -678,7 +672,6 @@ namespace MultiBoost {
         
         void computeAndOutput(ostream& outStream, InputData* pData, 
                               map<InputData*, table>& gTableMap, 
-                              map<InputData*, table>& marginsTableMap, 
                               map<InputData*, AlphaReal>& alphaSums,
                               BaseLearner* pWeakHypothesis = 0);
     };
@@ -713,7 +706,6 @@ namespace MultiBoost {
         
         void computeAndOutput(ostream& outStream, InputData* pData, 
                               map<InputData*, table>& gTableMap, 
-                              map<InputData*, table>& marginsTableMap, 
                               map<InputData*, AlphaReal>& alphaSums,
                               BaseLearner* pWeakHypothesis = 0);
     };
@@ -770,7 +762,6 @@ namespace MultiBoost {
         
         void computeAndOutput(ostream& outStream, InputData* pData, 
                               map<InputData*, table>& gTableMap, 
-                              map<InputData*, table>& marginsTableMap, 
                               map<InputData*, AlphaReal>& alphaSums,
                               BaseLearner* pWeakHypothesis = 0);
         
@@ -839,7 +830,6 @@ namespace MultiBoost {
         
         void computeAndOutput(ostream& outStream, InputData* pData, 
                               map<InputData*, table>& gTableMap, 
-                              map<InputData*, table>& marginsTableMap, 
                               map<InputData*, AlphaReal>& alphaSums,
                               BaseLearner* pWeakHypothesis = 0);
         
@@ -882,7 +872,6 @@ namespace MultiBoost {
         
         void computeAndOutput(ostream& outStream, InputData* pData, 
                               map<InputData*, table>& gTableMap, 
-                              map<InputData*, table>& marginsTableMap, 
                               map<InputData*, AlphaReal>& alphaSums,
                               BaseLearner* pWeakHypothesis = 0);
         
@@ -39,6 +39,8 @@
 #include <algorithm> // for sort
 #include <functional> // for less
 #include <fstream>
+#include <sstream>
+#include <cstring> // for memcpy
 
 #include "IO/TxtParser.h"
 #include "IO/ArffParser.h"
@@ -50,10 +52,61 @@
 
 
 namespace MultiBoost {			
+	
+	// the extension of the cache files of the raw data
+	static const char RAW_DATA_CACHE_EXTENSION[] = ".mbraw";
+	
 	// ------------------------------------------------------------------------
 	
 	RawData* RawData::load( const string& fileName,
 						   eInputType inputType, int verboseLevel )
+	{
+		// the cache holds the whole data, so it is used only for an empty object
+		_hasCacheKey = false;
+		if ( !_cacheDir.empty() && _data.empty() )
+		{
+			_cacheDataFileName = fileName;
+			_hasCacheKey = DataCache::getKey( fileName, getCacheOptions(), _cacheKey );
+		}
+		
+		const string cacheFileName = getCacheFileName( RAW_DATA_CACHE_EXTENSION );
+		if ( !cacheFileName.empty() && DataCache::fileExists( cacheFileName ) && loadCache( cacheFileName ) )
+		{
+			if (verboseLevel > 0)
+				cout << "Loading file " << fileName << " from the cache " << cacheFileName << endl;
+		}
+		else
+		{
+			parseFile( fileName, verboseLevel );
+			
+			if ( !cacheFileName.empty() )
+				saveCache( cacheFileName );
+		}
+		
+		if (verboseLevel > 0)
+		{
+			cout << "!!Loading is done!!" << endl;
+			
+			if (verboseLevel > 1)
+			{
+				cout << "Num Attributes = " << _numAttributes << endl;
+				
+				for (int l = 0; l < _numClasses; ++l)
+					cout << "Of class '" << _classMap.getNameFromIdx(l) << "': "
+					<< _nExamplesPerClass[l] << endl;
+				
+				cout << "Total: " << _numExamples << " examples read." << endl;
+			}
+		}
+		// DEBUG: to check that the different data format results in the same data representation
+		//outputData();
+		
+		return this;
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	void RawData::parseFile( const string& fileName, int verboseLevel )
 	{
 		GenericParser* pParser = NULL;
 		
@@ -98,8 +151,6 @@ namespace MultiBoost {
 		 }
 		 */
 		
-		_numExamples = static_cast<int>( _data.size() );
-		
 		// Initialize weights
 		if ( !pParser->hasWeightInitialized() && _labelRep == LR_SPARSE )
 		{
@@ -108,8 +159,52 @@ namespace MultiBoost {
 		}
 		delete pParser;
 		
+		setupExamples();
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	void RawData::setExamples( vector<Example>& examples, const NameMap& classMap, 
+							  const vector<NameMap>& enumMaps, const NameMap& attributeNameMap, 
+							  const vector<eAttributeType>& attributeTypes, 
+							  eDataRep dataRep, eLabelRep labelRep )
+	{
+		_data.swap( examples );
+		
+		_classMap = classMap;
+		_enumMaps = enumMaps;
+		_attributeNameMap = attributeNameMap;
+		_attributeTypes = attributeTypes;
+		
+		_numClasses = _classMap.getNumNames();
+		_numAttributes = _attributeNameMap.getNumNames();
+		_dataRep = dataRep;
+		_labelRep = labelRep;
+		
+		setupExamples();
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	void RawData::setupExamples()
+	{
+		_numExamples = static_cast<int>( _data.size() );
+		
+		// getValue reads the sparse values from the compressed rows
+		if ( _dataRep == DR_SPARSE )
+		{
+			_sparseRowBegin.assign( 1, 0 );
+			_sparseRowColumns.clear();
+			_sparseRowValues.clear();
+			_sparseColumnsBuilt = false;
+			
+			for ( vector<Example>::iterator eIt = _data.begin(); eIt != _data.end(); ++eIt )
+				compressSparseRow( *eIt );
+		}
+		
 		vector<Example>::const_iterator it;
 		map<int, int> tmpPointsPerClass;
+		_nExamplesPerClass.clear();
 		
 		for ( it = _data.begin(); it != _data.end(); ++it )
 		{
@@ -139,28 +234,328 @@ namespace MultiBoost {
 		
 		// set the initial weight of instances
 		initWeights();
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	string RawData::getCacheFileName( const string& extension ) const
+	{
+		if ( !_hasCacheKey )
+			return "";
 		
-		if (verboseLevel > 0)
+		return DataCache::getFileName( _cacheDir, _cacheDataFileName, _cacheKey, extension );
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	string RawData::getCacheOptions() const
+	{
+		ostringstream options;
+		options << _fileFormat << ' ' << _headerFile << ' ' << _sepChars << ' '
+				<< _hasExampleName << ' ' << _classInLastColumn << ' ' << _weightInitType << ' '
+				<< sizeof(FeatureReal) << ' ' << sizeof(AlphaReal);
+#ifdef NOTIWEIGHT
+		options << " NOTIWEIGHT";
+#endif
+		
+		// the header file is part of the data
+		DataCache::Key headerKey;
+		if ( !_headerFile.empty() && DataCache::getKey( _headerFile, "", headerKey ) )
+			options << ' ' << headerKey;
+		
+		return options.str();
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	void RawData::saveCache( const string& cacheFileName )
+	{
+		DataCacheWriter writer( cacheFileName, _cacheKey );
+		if ( !writer.isOpen() )
 		{
-			cout << "!!Loading is done!!" << endl;
+			cerr << "Warning: Cannot write the cache file <" << cacheFileName << ">!" << endl;
+			return;
+		}
+		
+		writer.write<int>( _numExamples );
+		writer.write<int>( _numAttributes );
+		writer.write<int>( _numClasses );
+		writer.write<int>( _dataRep );
+		writer.write<int>( _labelRep );
+		
+		writer.writeNameMap( _classMap );
+		writer.writeNameMap( _attributeNameMap );
+		writer.write<int>( _enumMaps.size() );
+		for ( int j = 0; j < (int)_enumMaps.size(); ++j )
+			writer.writeNameMap( _enumMaps[j] );
+		
+		vector<int> attributeTypes( _attributeTypes.begin(), _attributeTypes.end() );
+		writer.writeArray( attributeTypes );
+		writer.writeArray( _nExamplesPerClass );
+		
+		// the labels and the values of the examples are written field by field, after the
+		// number of labels and values of every example
+		vector<int> numLabels( _numExamples );
+		vector<int> numValues( _numExamples );
+		bool hasNames = false;
+		for ( int i = 0; i < _numExamples; ++i )
+		{
+			numLabels[i] = _data[i].getLabels().size();
+			numValues[i] = _data[i].getValues().size();
+			hasNames = hasNames || !_data[i].getName().empty();
+		}
+		writer.writeArray( numLabels );
+		writer.writeArray( numValues );
+		
+		vector<Example>::const_iterator eIt;
+		vector<Label>::const_iterator lIt;
+		for ( eIt = _data.begin(); eIt != _data.end(); ++eIt )
+			for ( lIt = eIt->getLabels().begin(); lIt != eIt->getLabels().end(); ++lIt )
+				writer.write<int>( lIt->idx );
+		for ( eIt = _data.begin(); eIt != _data.end(); ++eIt )
+			for ( lIt = eIt->getLabels().begin(); lIt != eIt->getLabels().end(); ++lIt )
+				writer.write<char>( lIt->y );
+		for ( eIt = _data.begin(); eIt != _data.end(); ++eIt )
+			for ( lIt = eIt->getLabels().begin(); lIt != eIt->getLabels().end(); ++lIt )
+				writer.write<AlphaReal>( lIt->weight );
+#ifndef NOTIWEIGHT
+		for ( eIt = _data.begin(); eIt != _data.end(); ++eIt )
+			for ( lIt = eIt->getLabels().begin(); lIt != eIt->getLabels().end(); ++lIt )
+				writer.write<AlphaReal>( lIt->initialWeight );
+#endif
+		
+		for ( eIt = _data.begin(); eIt != _data.end(); ++eIt )
+			writer.writeElements( eIt->getValues() );
+		if ( _dataRep == DR_SPARSE )
+		{
+			for ( eIt = _data.begin(); eIt != _data.end(); ++eIt )
+				writer.writeElements( eIt->getValuesIndexes() );
+		}
+		
+		writer.write<char>( hasNames );
+		if ( hasNames )
+		{
+			for ( eIt = _data.begin(); eIt != _data.end(); ++eIt )
+				writer.writeString( eIt->getName() );
+		}
+		
+		writer.writeArray( _sparseRowBegin );
+		writer.writeArray( _sparseRowColumns );
+		writer.writeArray( _sparseRowValues );
+		
+		if ( !writer.commit() )
+			cerr << "Warning: Cannot write the cache file <" << cacheFileName << ">!" << endl;
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	bool RawData::loadCache( const string& cacheFileName )
+	{
+		DataCacheReader reader( cacheFileName, _cacheKey );
+		if ( !reader.isValid() )
+			return false;
+		
+		const int numExamples = reader.read<int>();
+		const int numAttributes = reader.read<int>();
+		const int numClasses = reader.read<int>();
+		const eDataRep dataRep = static_cast<eDataRep>( reader.read<int>() );
+		const eLabelRep labelRep = static_cast<eLabelRep>( reader.read<int>() );
+		
+		NameMap classMap, attributeNameMap;
+		reader.readNameMap( classMap );
+		reader.readNameMap( attributeNameMap );
+		vector<NameMap> enumMaps( max( 0, reader.read<int>() ) );
+		for ( int j = 0; j < (int)enumMaps.size() && reader.isValid(); ++j )
+			reader.readNameMap( enumMaps[j] );
+		
+		vector<int> attributeTypes, nExamplesPerClass, numLabels, numValues;
+		reader.readArray( attributeTypes );
+		reader.readArray( nExamplesPerClass );
+		reader.readArray( numLabels );
+		reader.readArray( numValues );
+		if ( !reader.isValid() || (int)numLabels.size() != numExamples || (int)numValues.size() != numExamples )
+			return false;
+		
+		// the first label and value of every example in the field arrays
+		vector<long long> labelBegin( numExamples + 1, 0 );
+		vector<long long> valueBegin( numExamples + 1, 0 );
+		for ( int i = 0; i < numExamples; ++i )
+		{
+			labelBegin[i + 1] = labelBegin[i] + numLabels[i];
+			valueBegin[i + 1] = valueBegin[i] + numValues[i];
+		}
+		
+		const char* pLabelIdxs = reader.readBytes( labelBegin[numExamples] * sizeof(int) );
+		const char* pLabelYs = reader.readBytes( labelBegin[numExamples] * sizeof(char) );
+		const char* pLabelWeights = reader.readBytes( labelBegin[numExamples] * sizeof(AlphaReal) );
+#ifndef NOTIWEIGHT
+		const char* pLabelInitialWeights = reader.readBytes( labelBegin[numExamples] * sizeof(AlphaReal) );
+#endif
+		const char* pValues = reader.readBytes( valueBegin[numExamples] * sizeof(FeatureReal) );
+		const char* pValueIdxs = NULL;
+		if ( dataRep == DR_SPARSE )
+			pValueIdxs = reader.readBytes( valueBegin[numExamples] * sizeof(int) );
+		
+		vector<string> names;
+		if ( reader.read<char>() )
+		{
+			names.resize( numExamples );
+			for ( int i = 0; i < numExamples; ++i )
+				names[i] = reader.readString();
+		}
+		
+		vector<int> sparseRowBegin, sparseRowColumns;
+		vector<FeatureReal> sparseRowValues;
+		reader.readArray( sparseRowBegin );
+		reader.readArray( sparseRowColumns );
+		reader.readArray( sparseRowValues );
+		
+		if ( !reader.isValid() )
+			return false;
+		
+		// the cache is valid, fill the data
+		_data.clear();
+		_data.resize( numExamples );
+		
+#pragma omp parallel for schedule(static)
+		for ( int i = 0; i < numExamples; ++i )
+		{
+			Example& example = _data[i];
 			
-			if (verboseLevel > 1)
+			vector<Label>& labels = example.getLabels();
+			labels.resize( numLabels[i] );
+			for ( int k = 0; k < numLabels[i]; ++k )
 			{
-				cout << "Num Attributes = " << _numAttributes << endl;
-				
-				for (int l = 0; l < _numClasses; ++l)
-					cout << "Of class '" << _classMap.getNameFromIdx(l) << "': "
-					<< _nExamplesPerClass[l] << endl;
+				const long long pos = labelBegin[i] + k;
+				memcpy( &labels[k].idx, pLabelIdxs + pos * sizeof(int), sizeof(int) );
+				labels[k].y = pLabelYs[pos];
+				memcpy( &labels[k].weight, pLabelWeights + pos * sizeof(AlphaReal), sizeof(AlphaReal) );
+#ifndef NOTIWEIGHT
+				memcpy( &labels[k].initialWeight, pLabelInitialWeights + pos * sizeof(AlphaReal), sizeof(AlphaReal) );
+#endif
+			}
+			
+			if ( numValues[i] > 0 )
+			{
+				vector<FeatureReal>& values = example.getValues();
+				values.resize( numValues[i] );
+				memcpy( &values[0], pValues + valueBegin[i] * sizeof(FeatureReal), numValues[i] * sizeof(FeatureReal) );
 				
-				cout << "Total: " << _numExamples << " examples read." << endl;
+				if ( pValueIdxs )
+				{
+					vector<int>& valueIdxs = example.getValuesIndexes();
+					valueIdxs.resize( numValues[i] );
+					memcpy( &valueIdxs[0], pValueIdxs + valueBegin[i] * sizeof(int), numValues[i] * sizeof(int) );
+				}
 			}
+			
+			if ( !names.empty() )
+				example.setName( names[i] );
 		}
-		// DEBUG: to check that the different data format results in the same data representation
-		//outputData();
 		
-		return this;
+		_numExamples = numExamples;
+		_numAttributes = numAttributes;
+		_numClasses = numClasses;
+		_dataRep = dataRep;
+		_labelRep = labelRep;
+		
+		_classMap = classMap;
+		_attributeNameMap = attributeNameMap;
+		_enumMaps.swap( enumMaps );
+		
+		_attributeTypes.resize( attributeTypes.size() );
+		for ( int j = 0; j < (int)attributeTypes.size(); ++j )
+			_attributeTypes[j] = static_cast<eAttributeType>( attributeTypes[j] );
+		_nExamplesPerClass.swap( nExamplesPerClass );
+		
+		_sparseRowBegin.swap( sparseRowBegin );
+		_sparseRowColumns.swap( sparseRowColumns );
+		_sparseRowValues.swap( sparseRowValues );
+		_sparseColumnsBuilt = false;
+		
+		return true;
+	}
+	
+	
+	// ------------------------------------------------------------------------
+	
+	void RawData::compressSparseRow( Example& example )
+	{
+		const vector<FeatureReal>& values = example.getValues();
+		const vector<int>& valIdx = example.getValuesIndexes();
+		
+		vector< pair<int, FeatureReal> > row( valIdx.size() );
+		for ( int j = 0; j < (int)valIdx.size(); ++j )
+			row[j] = make_pair( valIdx[j], values[j] );
+		
+		// the parsers keep the order of the file
+		sort( row.begin(), row.end() );
+		
+		for ( int j = 0; j < (int)row.size(); ++j )
+		{
+			_sparseRowColumns.push_back( row[j].first );
+			_sparseRowValues.push_back( row[j].second );
+		}
+		_sparseRowBegin.push_back( _sparseRowColumns.size() );
+		
+		// the map of the example is the largest part of a sparse example
+		map<int,int>().swap( example.getValuesIndexesMap() );
+		
+		_sparseColumnsBuilt = false;
 	}
 	
+	// ------------------------------------------------------------------------
+	
+	void RawData::buildSparseColumns()
+	{
+		const int numValues = _sparseRowColumns.size();
+		
+		// count the values of every attribute, then place them with the running offsets
+		_sparseColumnBegin.assign( _numAttributes + 1, 0 );
+		for ( int k = 0; k < numValues; ++k )
+			_sparseColumnBegin[ _sparseRowColumns[k] + 1 ]++;
+		for ( int j = 0; j < _numAttributes; ++j )
+			_sparseColumnBegin[j + 1] += _sparseColumnBegin[j];
+		
+		_sparseColumnRows.resize( numValues );
+		_sparseColumnValues.resize( numValues );
+		
+		vector<int> offsets( _sparseColumnBegin.begin(), _sparseColumnBegin.end() - 1 );
+		for ( int i = 0; i < _numExamples; ++i )
+		{
+			for ( int k = _sparseRowBegin[i]; k < _sparseRowBegin[i + 1]; ++k )
+			{
+				const int pos = offsets[ _sparseRowColumns[k] ]++;
+				_sparseColumnRows[pos] = i;
+				_sparseColumnValues[pos] = _sparseRowValues[k];
+			}
+		}
+		
+		_sparseColumnsBuilt = true;
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	int RawData::getSparseColumn(int columnIdx, const int*& rows, const FeatureReal*& values)
+	{
+		assert( columnIdx >= 0 );
+		
+		// an attribute beyond the last one of this data (for example the test data of a model
+		// trained on more attributes) has no nonzero values, like in getValue
+		if ( columnIdx >= _numAttributes )
+			return 0;
+		
+		if ( !_sparseColumnsBuilt )
+			buildSparseColumns();
+		
+		const int columnBegin = _sparseColumnBegin[columnIdx];
+		const int columnSize = _sparseColumnBegin[columnIdx + 1] - columnBegin;
+		if ( columnSize > 0 ) {
+			rows = &_sparseColumnRows[columnBegin];
+			values = &_sparseColumnValues[columnBegin];
+		}
+		return columnSize;
+	}
 	
 	// ------------------------------------------------------------------------
 	
@@ -211,6 +606,9 @@ namespace MultiBoost {
 			_headerFile = headerFile;
 		}	
 		
+		if ( args.hasArgument("datacache") )
+			_cacheDir = args.getValue<string>("datacache");
+		
 		_weightInitType = WIT_SHARE_POINT; // default
 		if ( args.hasArgument("weightpolicy") )
 		{
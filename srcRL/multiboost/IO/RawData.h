@@ -42,12 +42,14 @@
 #include <map> // for class mappings
 #include <utility> // for pair
 #include <iosfwd> // for I/O
+#include <algorithm> // for lower_bound
 
 #include "Utils/Args.h"
 #include "Defaults.h" // for MB_DEBUG
 
 //#include "GenericParser.h"
 #include "NameMap.h"
+#include "DataCache.h"
 #include "Others/Example.h"
 
 //#include "Parser.h"
@@ -95,7 +97,8 @@ namespace MultiBoost {
 		 * \date 12/11/2005
 		 */
 		RawData() : _hasExampleName(false), _classInLastColumn(false), _sepChars(" \t\n"),
-		_numAttributes(0), _numExamples(0), _fileFormat(FF_SIMPLE), _headerFile("") {  }
+		_numAttributes(0), _numExamples(0), _fileFormat(FF_SIMPLE), _weightInitType(WIT_SHARE_POINT), _dataRep(DR_UNKNOWN),
+		_sparseColumnsBuilt(false), _headerFile(""), _hasCacheKey(false), _cacheKey(0) { _sparseRowBegin.push_back(0); }
 		
 		
 		/**
@@ -123,6 +126,20 @@ namespace MultiBoost {
 							  eInputType inputType = IT_TRAIN, 
 							  int verboseLevel = 1);
 		
+		/**
+		 * The name of a cache file of the loaded data file, see --datacache.
+		 * \param extension The extension of the cache, which tells what is in it.
+		 * \return The name of the file, or an empty string if the data is not cached.
+		 * \see DataCache
+		 */
+		string getCacheFileName( const string& extension ) const;
+		
+		/**
+		 * The key of the loaded data file in the cache files.
+		 * \see getCacheFileName()
+		 */
+		DataCache::Key getCacheKey() const { return _cacheKey; }
+		
 		
 		
 		/**
@@ -162,22 +179,66 @@ namespace MultiBoost {
 		inline FeatureReal getValue(int idx, int columnIdx) const { 
 			if ( _dataRep == DR_DENSE )	return _data[idx].getValues()[columnIdx]; 
 			else {
-				map<int,int>::iterator it = ((Example &)_data[idx]).getValuesIndexesMap().find( columnIdx );
-				if ( it == ((Example &)_data[idx]).getValuesIndexesMap().end() ) return 0;
-				else return _data[idx].getValues()[it->second];
+				// binary search in the compressed row, the missing values are zeros
+				const int rowBegin = _sparseRowBegin[idx];
+				const int rowEnd = _sparseRowBegin[idx+1];
+				if ( rowBegin == rowEnd ) return 0;
+				
+				const int* first = &_sparseRowColumns[0] + rowBegin;
+				const int* last = &_sparseRowColumns[0] + rowEnd;
+				const int* it = lower_bound( first, last, columnIdx );
+				if ( it == last || *it != columnIdx ) return 0;
+				else return _sparseRowValues[ it - &_sparseRowColumns[0] ];
 			}
 		}
 		
+		/**
+		 * The nonzero values of a sparse example in compressed row format.
+		 * \param idx The index of the example.
+		 * \param columns Set to the attribute indices of the values, in increasing order.
+		 * \param values Set to the values.
+		 * \return The number of the nonzero values.
+		 * \remark Only for DR_SPARSE data.
+		 */
+		inline int getSparseRow(int idx, const int*& columns, const FeatureReal*& values) const {
+			const int rowBegin = _sparseRowBegin[idx];
+			const int rowSize = _sparseRowBegin[idx+1] - rowBegin;
+			if ( rowSize > 0 ) {
+				columns = &_sparseRowColumns[rowBegin];
+				values = &_sparseRowValues[rowBegin];
+			}
+			return rowSize;
+		}
+		
+		/**
+		 * The nonzero values of an attribute of sparse data in compressed column format. The columns
+		 * are built from the rows at the first call after the examples changed.
+		 * \param columnIdx The index of the attribute.
+		 * \param rows Set to the example indices of the values, in increasing order.
+		 * \param values Set to the values.
+		 * \return The number of the nonzero values, 0 if \a columnIdx is beyond the last attribute.
+		 * \remark Only for DR_SPARSE data.
+		 * \warning The lazy build of the columns is not thread safe: the first call after the
+		 * examples changed must not be made inside a parallel region. Once the columns are built,
+		 * concurrent calls are fine.
+		 */
+		int getSparseColumn(int columnIdx, const int*& rows, const FeatureReal*& values);
+		
 		//////////////////////////////////////////////////////////////////////////
 		//////////////////////////////////////////////////////////////////////////
 		
 		/**
 		 */
-		void clearRawData() { _data.clear(); _numExamples = 0; } 
+		void clearRawData() { 
+			_data.clear(); _numExamples = 0; 
+			_sparseRowBegin.assign( 1, 0 ); _sparseRowColumns.clear(); _sparseRowValues.clear();
+			_sparseColumnsBuilt = false;
+		} 
 		
 		void addExample( Example example ) { 
 			_data.push_back( example ); 
 			_numExamples++; 
+			if ( _dataRep == DR_SPARSE ) compressSparseRow( _data.back() );
             
             const vector<Label> & labels = example.getLabels();
             vector<Label>::const_iterator lIt;
@@ -238,6 +299,19 @@ namespace MultiBoost {
 			WIT_BALANCED
 		};
 		
+		/**
+		 * Replace the data with examples which were parsed elsewhere, for the data
+		 * which is not loaded from a single file (see StreamingData).
+		 * \param examples The examples, they are swapped into the data.
+		 * \param \see GenericParser::readData
+		 * \param dataRep The data representation of the examples.
+		 * \param labelRep The label representation of the examples.
+		 */
+		void setExamples( vector<Example>& examples, const NameMap& classMap, 
+						 const vector<NameMap>& enumMaps, const NameMap& attributeNameMap, 
+						 const vector<eAttributeType>& attributeTypes, 
+						 eDataRep dataRep, eLabelRep labelRep );
+		
 		const string getSepChars() { return _sepChars; }
 		const eDataRep getDataRep() { return _dataRep; }
 		vector<Example>::iterator rawBegin() {return _data.begin(); }
@@ -272,6 +346,51 @@ namespace MultiBoost {
 		 * \date 11/11/2005
 		 */
 		virtual void  initWeights();
+		
+		/**
+		 * Parse the data file and initialize the weights, the part of load() which the
+		 * cache can replace.
+		 * \param fileName The name of the file to be loaded.
+		 * \param verboseLevel The level of verbosity.
+		 */
+		void parseFile( const string& fileName, int verboseLevel );
+		
+		/**
+		 * Compress the sparse rows, count the examples of the classes and initialize
+		 * the weights of the freshly read examples.
+		 */
+		void setupExamples();
+		
+		/**
+		 * The options which change the loaded data, they are part of the key of the cache.
+		 */
+		string getCacheOptions() const;
+		
+		/**
+		 * Save the loaded data into a cache file. A cache which cannot be written is
+		 * only a warning.
+		 * \param cacheFileName The name of the cache file.
+		 */
+		void saveCache( const string& cacheFileName );
+		
+		/**
+		 * Load the data from a cache file written by saveCache().
+		 * \param cacheFileName The name of the cache file.
+		 * \return False if the cache is not valid, then nothing is loaded.
+		 */
+		bool loadCache( const string& cacheFileName );
+		
+		/**
+		 * Appends the values of a sparse example to the compressed rows and releases the
+		 * attribute index map of the example, which is not needed by getValue() any more.
+		 * \param example The example, it must be the last one in _data.
+		 */
+		void compressSparseRow( Example& example );
+		
+		/**
+		 * Builds the compressed columns from the compressed rows.
+		 */
+		void buildSparseColumns();
 				
 		// --------------------------------------------------------------------
 		
@@ -286,8 +405,25 @@ namespace MultiBoost {
 		
 		vector<eAttributeType> _attributeTypes; //!< The vector of attribute types. 
 		
+		// Sparse data in compressed row (CSR) and compressed column (CSC) format. The values of the
+		// example idx are at [_sparseRowBegin[idx], _sparseRowBegin[idx+1]) of the row arrays, the
+		// ones of the attribute j at [_sparseColumnBegin[j], _sparseColumnBegin[j+1]) of the column arrays.
+		vector<int>			_sparseRowBegin;
+		vector<int>			_sparseRowColumns;
+		vector<FeatureReal>	_sparseRowValues;
+		
+		bool				_sparseColumnsBuilt;
+		vector<int>			_sparseColumnBegin;
+		vector<int>			_sparseColumnRows;
+		vector<FeatureReal>	_sparseColumnValues;
+		
 		//for LSHTC challenge		
 		string			_headerFile;
+		
+		string			_cacheDir; //!< The directory of the cache files, empty if the data is not cached
+		string			_cacheDataFileName; //!< The loaded data file, its caches are named after it
+		bool			_hasCacheKey;
+		DataCache::Key	_cacheKey;
 	};
 	
 }
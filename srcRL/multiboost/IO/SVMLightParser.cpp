@@ -33,6 +33,7 @@
 
 #include <iostream>
 #include <cmath> // for abs
+#include <cstring> // for memchr
 
 #include "IO/SVMLightParser.h"
 #include "Utils/Utils.h"
@@ -41,12 +42,106 @@ namespace MultiBoost {
 	
 	// ------------------------------------------------------------------------
 	
+	/**
+	 * Find the next word of the line, the words are separated by white spaces.
+	 */
+	static inline const char* nextWord(const char* p, const char* pEnd, const char*& pWordEnd)
+	{
+		while ( p != pEnd && isspace(*p) )
+			++p;
+		
+		pWordEnd = p;
+		while ( pWordEnd != pEnd && !isspace(*pWordEnd) )
+			++pWordEnd;
+		
+		return p;
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	bool SVMLightRowParser::isRow(const char* pLine, const char* pLineEnd) const
+	{
+		const char* pWordEnd;
+		const char* p = nextWord(pLine, pLineEnd, pWordEnd);
+		return p != pLineEnd && *p != '#';
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	void SVMLightRowParser::beginChunks(int numChunks)
+	{
+		_chunkAttributeNameMaps.clear();
+		_chunkAttributeNameMaps.resize(numChunks);
+		_chunkClassMaps.clear();
+		_chunkClassMaps.resize(numChunks);
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	void SVMLightRowParser::parseRow(int chunkIdx, const char* pLine, const char* pLineEnd, Example& example)
+	{
+		NameMap& attributeNameMap = _chunkAttributeNameMaps[chunkIdx];
+		NameMap& classMap = _chunkClassMaps[chunkIdx];
+		
+		// the labels are separated by commas
+		const char* pWordEnd;
+		const char* p = nextWord(pLine, pLineEnd, pWordEnd);
+		
+		vector<Label>& labels = example.getLabels();
+		while ( p < pWordEnd )
+		{
+			const char* pLabelEnd = static_cast<const char*>( memchr(p, ',', pWordEnd - p) );
+			if ( !pLabelEnd )
+				pLabelEnd = pWordEnd;
+			
+			if ( pLabelEnd != p )
+			{
+				Label label;
+				label.idx = classMap.addName( string(p, pLabelEnd) );
+				label.y = +1;
+				labels.push_back( label );
+			}
+			p = pLabelEnd + 1;
+		}
+		
+		// now the features, until the end of the line or the comment
+		vector<FeatureReal>& values = example.getValues();
+		vector<int>& idxs = example.getValuesIndexes();
+		map<int, int>& idxmap = example.getValuesIndexesMap();
+		
+		for ( p = nextWord(pWordEnd, pLineEnd, pWordEnd); p != pLineEnd && *p != '#'; 
+			  p = nextWord(pWordEnd, pLineEnd, pWordEnd) )
+		{
+			const char* pColon = static_cast<const char*>( memchr(p, ':', pWordEnd - p) );
+			bool ok = ( pColon != NULL );
+			FeatureReal val = 0;
+			if ( ok )
+				val = static_cast<FeatureReal>( ChunkedParser::parseReal(pColon + 1, pWordEnd, ok) );
+			if ( !ok )
+			{
+				cerr << "\nERROR: The feature <" << string(p, pWordEnd) << "> is not in the form name:value!" << endl;
+				exit(1);
+			}
+			
+			// discard the query ID
+			if ( ChunkedParser::isToken(p, pColon, "qid") ) continue;
+			
+			int tmpIdx = attributeNameMap.addName( string(p, pColon) );
+			
+			// add the feature value and its index
+			idxmap[ tmpIdx ] = static_cast<int>( values.size() );
+			idxs.push_back( tmpIdx );
+			values.push_back( val );
+		}
+	}
+	
+	// ------------------------------------------------------------------------
+	// ------------------------------------------------------------------------
+	
 	SVMLightParser::SVMLightParser(const string& fileName,const string& headerFileName)
-	: GenericParser(fileName,headerFileName), _hasName(false), _numRows(0)
+	: GenericParser(fileName,headerFileName), _hasName(false)
 	{
-		_denseLocale  = locale(locale(), new nor_utils::white_spaces(": "));
 		_sparseLocale = locale(locale(), new nor_utils::white_spaces(": "));
-		_labelLocale = locale(locale(), new nor_utils::white_spaces(", "));
 	}
 	
 	// ------------------------------------------------------------------------
@@ -62,80 +157,47 @@ namespace MultiBoost {
 			cerr << "\nERROR: Cannot open file <" << _fileName << ">!!" << endl;
 			exit(1);
 		}
+		inFile.close();
 		
 		_dataRep = DR_SPARSE;
 		_labelRep = LR_DENSE;
 		
 		if ( ! _headerFileName.empty() ) // there is no file name
 			readHeader( classMap, enumMaps, attributeNameMap, attributeTypes);
-		else
-			getHeaderInfoFromData(inFile, classMap, enumMaps, attributeNameMap, attributeTypes );
-		readData(inFile, examples, classMap, enumMaps, attributeNameMap, attributeTypes);
+		
+		MappedFile mappedFile(_fileName);
+		readData(mappedFile.begin(), mappedFile.end(), examples, classMap, attributeNameMap, attributeTypes);
 	}
 	
 	// ------------------------------------------------------------------------
-	void SVMLightParser::getHeaderInfoFromData(ifstream& in, NameMap& classMap, 
-							   vector<NameMap>& enumMaps, NameMap& attributeNameMap,
-							   vector<RawData::eAttributeType>& attributeTypes)
+	
+	void SVMLightParser::getHeaderInfoFromData(const SVMLightRowParser& rowParser, int numChunks, 
+											   NameMap& classMap, NameMap& attributeNameMap)
 	{
-		string tmpLine;
 		int maxLabel = -1;
 		int maxFeatureIndex = -1;
-		// get read pointer		
-		int numOfRaws = 0;
 		
-		while (getline(in, tmpLine) )
+		for ( int c = 0; c < numChunks; ++c )
 		{
-			if (tmpLine[0] == '#' ) continue;
-			
-			numOfRaws++;
-			
-			istringstream ss;
-			ss.imbue(_sparseLocale);
-			ss.clear();
-			ss.str(tmpLine);
-			
-			string lab;
-			ss >> lab;			
-			
-			stringstream labelStream(lab);
-			labelStream.imbue( _labelLocale );
-			
-			// read the label
-			while (!labelStream.eof())
+			const NameMap& chunkClassMap = rowParser.getClassMap(c);
+			for ( int k = 0; k < chunkClassMap.getNumNames(); ++k )
 			{
-				int tmpLab;
-				labelStream >> tmpLab;
-				
-				if (tmpLab>maxLabel) maxLabel = tmpLab;
+				const string name = chunkClassMap.getNameFromIdx(k);
+				bool ok;
+				int tmpLab = ChunkedParser::parseInt(name.data(), name.data() + name.size(), ok);
+				if ( ok && tmpLab > maxLabel ) maxLabel = tmpLab;
 			}
 			
-			
-			
-			//read the name of features
-			while (!ss.eof())
+			const NameMap& chunkAttributeNameMap = rowParser.getAttributeNameMap(c);
+			for ( int k = 0; k < chunkAttributeNameMap.getNumNames(); ++k )
 			{
-				//read the index of the feature				
-				int featureIndex;
-				ss >> featureIndex;
-				
-				if (maxFeatureIndex<featureIndex) maxFeatureIndex = featureIndex;
-				
-				FeatureReal tmpVal;
-				ss >> tmpVal;
- 			}
-			
+				const string name = chunkAttributeNameMap.getNameFromIdx(k);
+				bool ok;
+				int featureIndex = ChunkedParser::parseInt(name.data(), name.data() + name.size(), ok);
+				if ( ok && featureIndex > maxFeatureIndex ) maxFeatureIndex = featureIndex;
+			}
 		}
 		
-		// Put read pointer back to where it was
-		in.clear();
-		in.seekg(0, ios::beg);
-		//in.clear();
-		if (!in.good())
-			cout << "File is not good" << endl;
-		
-		_numRows = numOfRaws;
-		
 		// fill out the type attributes
 		for(int i = 1; i <= maxFeatureIndex; ++i ) 
 		{
@@ -144,17 +206,12 @@ namespace MultiBoost {
 			attributeNameMap.addName( ss.str() );
 		}
 		
-		attributeTypes.resize( attributeNameMap.getNumNames() );
-		fill( attributeTypes.begin(), attributeTypes.end(), RawData::ATTRIBUTE_NUMERIC );
-
-		
 		for(int i = 0; i <= maxLabel; ++i ) 
 		{
 			stringstream ss;
 			ss << i;
 			classMap.addName( ss.str() );
 		}
-		
 	}
 	
 	
@@ -242,102 +299,64 @@ namespace MultiBoost {
 	}
 	// ------------------------------------------------------------------------
 	
-	void SVMLightParser::readData( ifstream& in, vector<Example>& examples,
-								  NameMap& classMap, vector<NameMap>& enumMaps, NameMap& attributeNameMap,
+	void SVMLightParser::readData( const char* pBegin, const char* pEnd, vector<Example>& examples,
+								  NameMap& classMap, NameMap& attributeNameMap,
 								  vector<RawData::eAttributeType>& attributeTypes )
 	{
-		char firstChar = 0;
-		string tmpLine;
-		int maxColumnIdx = 0;;
-		
-		istringstream ss;
-		ss.imbue(_sparseLocale);
-		
-		if ( _numRows == 0 ) // if header file was provided, the data had not been parsed
+		cout << "Now reading file.." << flush;
+		SVMLightRowParser rowParser;
+		vector<size_t> chunkRows;
+		ChunkedParser::parseRows(pBegin, pEnd, rowParser, examples, &chunkRows);
+		const int numChunks = static_cast<int>( chunkRows.size() ) - 1;
+		
+		if ( _headerFileName.empty() )
+			getHeaderInfoFromData( rowParser, numChunks, classMap, attributeNameMap );
+		
+		// the names of the chunks are added in the order of the file, so the
+		// indices are the same as with a sequential reading
+		vector< vector<int> > chunkClassIdxs( numChunks );
+		vector< vector<int> > chunkAttributeIdxs( numChunks );
+		for ( int c = 0; c < numChunks; ++c )
 		{
-			cout << "Counting rows.." << flush;
-			_numRows = nor_utils::count_rows(in);
-		}
-		
-		cout << "Allocating.." << flush;
-		try {
-			examples.resize(_numRows);
-		} 
-		catch(...) {
-			cerr << "ERROR: Cannot allocate memory for storage!" << endl;
-			exit(1);
+			const NameMap& chunkClassMap = rowParser.getClassMap(c);
+			for ( int k = 0; k < chunkClassMap.getNumNames(); ++k )
+				chunkClassIdxs[c].push_back( classMap.addName( chunkClassMap.getNameFromIdx(k) ) );
+			
+			const NameMap& chunkAttributeNameMap = rowParser.getAttributeNameMap(c);
+			for ( int k = 0; k < chunkAttributeNameMap.getNumNames(); ++k )
+				chunkAttributeIdxs[c].push_back( attributeNameMap.addName( chunkAttributeNameMap.getNameFromIdx(k) ) );
 		}
-		cout << "Done!" << endl;
 		
-		cout << "Now reading file.." << flush;
-		int i;
-		vector<vector<int> > tmpLabelIdxs( _numRows );
+		attributeTypes.resize( attributeNameMap.getNumNames() );
+		fill( attributeTypes.begin(), attributeTypes.end(), RawData::ATTRIBUTE_NUMERIC );
 		
-		size_t currentSize = 0;
-		for (i = 0; i < _numRows; ++i)
+#pragma omp parallel for schedule(dynamic)
+		for ( int c = 0; c < numChunks; ++c )
 		{
-			while ( isspace(firstChar = in.get()) && !in.eof() );
+			const vector<int>& classIdxs = chunkClassIdxs[c];
+			const vector<int>& attributeIdxs = chunkAttributeIdxs[c];
+			vector<int> labelIdxs;
 			
-			if (in.eof())
-				break;						
-			
-			//////////////////////////////////////////////////////////////////////////
-			// first read the data
-			if ( firstChar == '#' ) // comment!
-			{
-				getline(in, tmpLine); // read the comment line and continue
-				continue;
-			}
-			
-			
-			in.putback(firstChar);
-						
-			// read the next line
-			getline(in, tmpLine);
-			tmpLine = nor_utils::trim( tmpLine );
-			ss.clear();
-			ss.str(tmpLine);
-			
-			// now read the labels			
-			string currLab;
-			ss >> currLab;
-						
-			stringstream labelStream(currLab);
-			labelStream.imbue( _labelLocale );
-			tmpLabelIdxs[currentSize].clear();
-			// read the label
-			while (!labelStream.eof())
+			for ( size_t i = chunkRows[c]; i < chunkRows[c + 1]; ++i )
 			{
-				string tmp;
-				labelStream >> tmp;
+				Example& currExample = examples[i];
 				
-				int tmpLabIDX = classMap.addName( tmp );
-				tmpLabelIdxs[currentSize].push_back( tmpLabIDX );
-			}						
-			
-			Example& currExample = examples[currentSize];
-			//now read values
-			readSparseValues(ss, currExample.getValues(), currExample.getValuesIndexes(), currExample.getValuesIndexesMap(),
-							 enumMaps, attributeTypes, attributeNameMap );
-			
-			currentSize++;
-		}
-		
-		if ( attributeTypes.empty() )
-		{
-			attributeTypes.resize( attributeNameMap.getNumNames() );
-			fill( attributeTypes.begin(), attributeTypes.end(), RawData::ATTRIBUTE_NUMERIC );
-		}
-		if ( currentSize != _numRows )
-		{
-			// for example last row was empty!
-			examples.resize( currentSize );
-		}
-		
-		for( int i=0; i<examples.size(); i++ )
-		{
-			Example& currExample = examples[i];
-			allocateSimpleLabels( tmpLabelIdxs[i], currExample.getLabels(), classMap );
+				vector<int>& idxs = currExample.getValuesIndexes();
+				map<int, int>& idxmap = currExample.getValuesIndexesMap();
+				idxmap.clear();
+				for ( size_t j = 0; j < idxs.size(); ++j )
+				{
+					idxs[j] = attributeIdxs[ idxs[j] ];
+					idxmap[ idxs[j] ] = static_cast<int>( j );
+				}
+				
+				vector<Label>& labels = currExample.getLabels();
+				labelIdxs.clear();
+				for ( size_t j = 0; j < labels.size(); ++j )
+					labelIdxs.push_back( classIdxs[ labels[j].idx ] );
+				
+				allocateSimpleLabels( labelIdxs, labels, classMap );
+			}
 		}
 		
 		cout << "Done!" << endl;
@@ -350,69 +369,14 @@ namespace MultiBoost {
 			_hasWeigthInit = true;
 	}
 	
-	
-	
-	// ------------------------------------------------------------------------
-	
-	void SVMLightParser::readDenseValues(ifstream& in, vector<FeatureReal>& values,
-										 vector<NameMap>& enumMaps, 
-										 const vector<RawData::eAttributeType>& attributeTypes )
-	{
-		const locale& originalLocale = in.imbue(_denseLocale); 
-		
-		values.reserve(_numAttributes);
-		string tmpVal;
-		
-		for ( int j = 0; j < _numAttributes; ++j )
-		{
-			in >> tmpVal;
-			if ( attributeTypes[j] == RawData::ATTRIBUTE_NUMERIC ) 
-				if ( ( ! tmpVal.compare( "NaN" ) ) || ( ! tmpVal.compare( "?" ) ) )
-					values.push_back( numeric_limits<FeatureReal>::infinity() );
-				else
-					values.push_back(atof(tmpVal.c_str()));
-				else //if ( attributeTypes[i] == RawData::ATTRIBUTE_ENUM ) 
-					values.push_back( enumMaps[j].getIdxFromName(tmpVal) );
-		}
-		
-		in.imbue(originalLocale);
-	}
-	
-	// -----------------------------------------------------------------------------
-	
-	void SVMLightParser::readSparseValues(istringstream& ss, vector<FeatureReal>& values, 
-										  vector<int>& idxs, map<int, int>& idxmap, vector<NameMap>& enumMaps, 
-										  const vector<RawData::eAttributeType>& attributeTypes, NameMap& attributeNameMap)
-	{
-		FeatureReal tmpFeatVal;
-		string tmpFeatName;
-		int i = 0;
-		while (!ss.eof())
-		{
-			//read the name of the next feature name and its value
-			ss >> tmpFeatName;
-			ss >> tmpFeatVal;
-			
-			// discard the query ID
-			if (tmpFeatName.compare("qid")==0) continue;
-			
-			//add the feature to the namemap if it doesn't exist
-			int tmpIdx = attributeNameMap.addName( tmpFeatName );
-			
-			// add the feature value and its index
-			idxs.push_back(tmpIdx);
-			idxmap[ tmpIdx ] = i++;
-			values.push_back( tmpFeatVal );
-		}
-	}
-	
 	// ------------------------------------------------------------------------
 	
 	void SVMLightParser::allocateSimpleLabels( vector<int>& labelIdx, vector<Label>& labels,
-											  NameMap& classMap )
+											  NameMap& classMap ) const
 	{
 		
 		const int numClasses = classMap.getNumNames();
+		labels.clear();
 		labels.resize(numClasses);
 		
 		for ( int i = 0; i < numClasses; ++i )
@@ -427,8 +391,12 @@ namespace MultiBoost {
 		
 		if ( ! _weightOfClasses.empty() ) // weighting
 		{
+			// the classes which are not in the header get zero weight
 			for ( int i = 0; i < labelIdx.size(); ++i )
-				labels[ labelIdx[i] ].weight = _weightOfClasses[ labelIdx[i] ];		
+			{
+				map<int, AlphaReal>::const_iterator wIt = _weightOfClasses.find( labelIdx[i] );
+				labels[ labelIdx[i] ].weight = ( wIt != _weightOfClasses.end() ) ? wIt->second : 0;
+			}
 		}
 	}
 	
@@ -43,6 +43,7 @@
 #include <fstream>
 #include <sstream>
 #include "GenericParser.h"
+#include "ChunkedParser.h"
 #include "NameMap.h"
 #include "InputData.h"
 #include "Utils/ClassHierarchy.h"
@@ -51,6 +52,45 @@ using namespace std;
 
 namespace MultiBoost {
 	
+	/**
+	 * The parser of the rows of the SVMLight files, used by ChunkedParser. The names 
+	 * of the features and the labels are mapped in a NameMap per chunk, since they
+	 * are not known in advance, so the indices of the parsed examples are local to
+	 * their chunk until SVMLightParser maps them.
+	 * \date 17/10/2026
+	 */
+	class SVMLightRowParser
+	{
+	public:
+		/**
+		 * The empty and the comment lines are not rows.
+		 * \see ChunkedParser
+		 */
+		bool isRow(const char* pLine, const char* pLineEnd) const;
+		
+		/**
+		 * Set the number of chunks to parse, it resets the names of the chunks.
+		 * \see ChunkedParser
+		 */
+		void beginChunks(int numChunks);
+		
+		/**
+		 * Parse a row. The values and their indices are set, the labels are stored
+		 * with their local index and y = +1.
+		 * \see ChunkedParser
+		 */
+		void parseRow(int chunkIdx, const char* pLine, const char* pLineEnd, Example& example);
+		
+		const NameMap& getAttributeNameMap(int chunkIdx) const { return _chunkAttributeNameMaps[chunkIdx]; }
+		const NameMap& getClassMap(int chunkIdx) const { return _chunkClassMaps[chunkIdx]; }
+		
+	protected:
+		vector<NameMap> _chunkAttributeNameMaps; //!< The feature names of each chunk, in the order they appear
+		vector<NameMap> _chunkClassMaps; //!< The label names of each chunk, in the order they appear
+	};
+	
+	// -----------------------------------------------------------------------------
+	
 	class SVMLightParser : public GenericParser
 	{
 	public:
@@ -74,59 +114,40 @@ namespace MultiBoost {
 						vector<NameMap>& enumMaps, NameMap& attributeNameMap,
 						vector<RawData::eAttributeType>& attributeTypes );
 		
-		void readData(ifstream& in, vector<Example>& examples, NameMap& classMap, 
-					  vector<NameMap>& enumMaps, NameMap& attributeNameMap,
-					  vector<RawData::eAttributeType>& attributeTypes);
+		/**
+		 * Parse the rows of the text in parallel chunks and map the names found
+		 * in the chunks in the order of the file.
+		 * \param pBegin The beginning of the text.
+		 * \param pEnd The end of the text.
+		 * \date 17/10/2026
+		 */
+		void readData(const char* pBegin, const char* pEnd, vector<Example>& examples, NameMap& classMap, 
+					  NameMap& attributeNameMap, vector<RawData::eAttributeType>& attributeTypes);
 
 		/**
 		 * If no header file is given, it is assumed that the labesl are 0..(K-1) and the features
-		 * are denoted by 1..F. This function finds the label and feauter having highest index.		 
+		 * are denoted by 1..F. This function finds the label and feauter having highest index
+		 * among the names of the chunks.
 		 * \data 27/07/2011
 		 */
-		void getHeaderInfoFromData(ifstream& in, NameMap& classMap, 
-					  vector<NameMap>& enumMaps, NameMap& attributeNameMap,
-					  vector<RawData::eAttributeType>& attributeTypes);
-		
-		string readName(ifstream& in);
-		
-		
-		void readDenseValues(ifstream& in, vector<FeatureReal>& values,
-							 vector<NameMap>& enumMaps, 
-							 const vector<RawData::eAttributeType>& attributeTypes);
-		
-		void readSparseValues(istringstream& ss, vector<FeatureReal>& values, vector<int>& idxs, map<int, int>& idxmap, 
-							  vector<NameMap>& enumMaps, 
-							  const vector<RawData::eAttributeType>& attributeTypes, NameMap& attributeNameMap);
+		void getHeaderInfoFromData(const SVMLightRowParser& rowParser, int numChunks, NameMap& classMap, 
+								   NameMap& attributeNameMap);
 		
 		void allocateSimpleLabels( vector<int>& labelIdx, vector<Label>& labels,
-								  NameMap& classMap );				
+								  NameMap& classMap ) const;
 		
 		int					 _numAttributes;
 		
-		locale				 _denseLocale;
 		locale				 _sparseLocale;
-		locale				 _labelLocale;
 		bool				 _hasName;
 	    map< int, AlphaReal> _weightOfClasses; //! In the header file it is possible to define initial weights for classes
 		
-		size_t				 _numRows;
 	public:
 		
 	};
 	
 	// -----------------------------------------------------------------------------
 	
-	inline string SVMLightParser::readName(ifstream& in)
-	{
-		const locale& originalLocale = in.imbue(_denseLocale); 
-		string name;
-		in >> name;
-		in.imbue(originalLocale);
-		return name;
-	}
-	
-	// -----------------------------------------------------------------------------
-	
 	
 } // end of namespace MultiBoost
 
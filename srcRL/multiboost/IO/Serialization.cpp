@@ -35,16 +35,34 @@
 #include "Utils/Utils.h" // for cmp_nocase
 #include "WeakLearners/BaseLearner.h"
 #include "Bzip2/Bzip2Wrapper.h"
+#include "IO/InputData.h"
+#include "IO/ChunkedParser.h" // for MappedFile
 
 #include <cctype> // for isspace
+#include <sstream>
+
 
 namespace MultiBoost {
 	
+	// the first bytes of the binary strong hypothesis files
+	static const char BINARY_SHYP_MAGIC[] = "MBSHYPB1";
+	static const int BINARY_SHYP_MAGIC_SIZE = 8;
+	
 	// -----------------------------------------------------------------------
 	
-	Serialization::Serialization(const string& shypFileName, bool isComp )
+	Serialization::Serialization(const string& shypFileName, bool isComp, bool isBinary )
+	: _isBinary(isBinary), _isClassMapWritten(false)
 	{ 
-		_shypFile.open(shypFileName.c_str());
+		if ( isBinary && isComp )
+		{
+			cerr << "WARNING: The binary strong hypothesis file is not compressed!" << endl;
+			isComp = false;
+		}
+		
+		if ( _isBinary )
+			_shypFile.open(shypFileName.c_str(), ios::out | ios::binary);
+		else
+			_shypFile.open(shypFileName.c_str());
 		_shypFileName = shypFileName;
 		_isComp = isComp;
 		_bzipFileName = _shypFileName;
@@ -56,6 +74,13 @@ namespace MultiBoost {
 	
 	void Serialization::writeHeader(const string& weakLearnerName)
 	{
+		if ( _isBinary )
+		{
+			_shypFile.write( BINARY_SHYP_MAGIC, BINARY_SHYP_MAGIC_SIZE );
+			writeBinaryString( _shypFile, weakLearnerName );
+			return;
+		}
+		
 		// print the header
 		_shypFile << "<?xml version=\"1.0\"?>" << endl;
 		_shypFile << "<multiboost>" << endl;
@@ -69,6 +94,8 @@ namespace MultiBoost {
 	
 	void Serialization::writeCascadeHeader(const string& weakLearnerName)
 	{
+		checkNotBinary();
+		
 		// print the header
 		_shypFile << "<?xml version=\"1.0\"?>" << endl;
 		_shypFile << "<cascade>" << endl;
@@ -81,6 +108,13 @@ namespace MultiBoost {
 	
 	void Serialization::writeFooter()
 	{
+		// the binary file has no footer
+		if ( _isBinary )
+		{
+			_shypFile.flush();
+			return;
+		}
+		
 		// close tag
 		_shypFile << "</multiboost>" << endl;
 		
@@ -93,6 +127,8 @@ namespace MultiBoost {
 	
 	void Serialization::writeCascadeFooter()
 	{
+		checkNotBinary();
+		
 		// close tag
 		_shypFile << "</cascade>" << endl;
 		
@@ -146,6 +182,8 @@ namespace MultiBoost {
 	// -----------------------------------------------------------------------	
 	void Serialization::appendStageSeparatorHeader( int stageIndex, int weakhypnum, double threshold )
 	{		
+		checkNotBinary();
+		
 		//_shypFile << "\t<stage num=\""  << stageIndex << "\" weakhypnum=\"" <<  weakhypnum << "\" threshold=\""<< threshold << "\">" << endl;
 		_shypFile << "\t<stage num=\""  << stageIndex << "\">" << endl; 
 		_shypFile << "\t\t<weakhypnum>" <<  weakhypnum << "</weakhypnum>" << endl;
@@ -166,6 +204,12 @@ namespace MultiBoost {
 	
 	void  Serialization::appendHypothesis(int iteration, BaseLearner* pWeakHypothesis, int numTab)
 	{
+		if ( _isBinary )
+		{
+			appendBinaryHypothesis(iteration, pWeakHypothesis);
+			return;
+		}
+		
         // just for readability
    		string shiftTab = getTabs(numTab);
         
@@ -217,6 +261,8 @@ namespace MultiBoost {
 
 	void  Serialization::appendHypothesisWithThreshold(int iteration, BaseLearner* pWeakHypothesis, double threshold, int numTab)
 	{
+		checkNotBinary();
+		
         // just for readability
    		string shiftTab = getTabs(numTab);
         
@@ -266,6 +312,94 @@ namespace MultiBoost {
 		}
 	}
 	
+	// -----------------------------------------------------------------------
+	
+	void Serialization::appendBinaryHypothesis(int iteration, BaseLearner* pWeakHypothesis)
+	{
+		// the class map, the saved class indices are mapped by name when loading
+		if ( !_isClassMapWritten )
+		{
+			const NameMap& classMap = pWeakHypothesis->getTrainingData()->getClassMap();
+			const int numClasses = classMap.getNumNames();
+			
+			_shypFile.put('C');
+			writeBinary( _shypFile, numClasses );
+			for (int l = 0; l < numClasses; ++l)
+				writeBinaryString( _shypFile, classMap.getNameFromIdx(l) );
+			
+			_isClassMapWritten = true;
+		}
+		
+		const bool hasBinaryFormat = pWeakHypothesis->hasBinaryFormat();
+		
+		if ( hasBinaryFormat )
+		{
+			const string learnerName = pWeakHypothesis->getName();
+			map<string, int>::const_iterator typeIt = _learnerTypes.find( learnerName );
+			int typeIdx;
+			
+			if ( typeIt == _learnerTypes.end() )
+			{
+				typeIdx = static_cast<int>( _learnerTypes.size() );
+				_learnerTypes[learnerName] = typeIdx;
+				
+				_shypFile.put('T');
+				writeBinary( _shypFile, typeIdx );
+				writeBinaryString( _shypFile, learnerName );
+			}
+			else
+				typeIdx = typeIt->second;
+			
+			_shypFile.put('H');
+			writeBinary( _shypFile, typeIdx );
+		}
+		else
+			_shypFile.put('X');
+		
+		writeBinary( _shypFile, iteration );
+		
+		// the size of the block is known only when it is written
+		const streampos sizePos = _shypFile.tellp();
+		int blockSize = 0;
+		writeBinary( _shypFile, blockSize );
+		
+		const streampos blockPos = _shypFile.tellp();
+		if ( hasBinaryFormat )
+			pWeakHypothesis->saveBinary( _shypFile );
+		else
+		{
+			// closed as in the xml file, UnSerialization::loadHypothesis() expects it
+			pWeakHypothesis->save( _shypFile, 2 );
+			_shypFile << "\t</weakhyp>" << endl;
+		}
+		const streampos endPos = _shypFile.tellp();
+		
+		blockSize = static_cast<int>( endPos - blockPos );
+		_shypFile.seekp( sizePos );
+		writeBinary( _shypFile, blockSize );
+		_shypFile.seekp( endPos );
+	}
+	
+	// -----------------------------------------------------------------------
+	
+	void Serialization::writeBinaryString(ostream& outputStream, const string& str)
+	{
+		const int length = static_cast<int>( str.size() );
+		writeBinary( outputStream, length );
+		outputStream.write( str.data(), length );
+	}
+	
+	// -----------------------------------------------------------------------
+	
+	void Serialization::checkNotBinary()
+	{
+		if ( _isBinary )
+		{
+			cerr << "ERROR: The cascades cannot be saved in the binary strong hypothesis format!" << endl;
+			exit(1);
+		}
+	}
+	
 	// -----------------------------------------------------------------------    
     // -----------------------------------------------------------------------
 	// -----------------------------------------------------------------------
@@ -274,6 +408,12 @@ namespace MultiBoost {
 										 vector<BaseLearner*>& weakHypotheses,
 										 InputData* pTrainingData, int verbose)
 	{
+		if ( isBinaryFile(shypFileName) )
+		{
+			loadBinaryHypotheses(shypFileName, weakHypotheses, pTrainingData, verbose);
+			return;
+		}
+		
 		// open file
 		ifstream inFile(shypFileName.c_str());
 		if (!inFile.is_open())
@@ -397,8 +537,152 @@ namespace MultiBoost {
 	
 	// -----------------------------------------------------------------------
 	
+	bool UnSerialization::isBinaryFile(const string& shypFileName)
+	{
+		ifstream inFile(shypFileName.c_str(), ios::in | ios::binary);
+		if (!inFile.is_open())
+			return false;
+		
+		char magic[BINARY_SHYP_MAGIC_SIZE];
+		inFile.read(magic, BINARY_SHYP_MAGIC_SIZE);
+		
+		return inFile.gcount() == BINARY_SHYP_MAGIC_SIZE && 
+		memcmp(magic, BINARY_SHYP_MAGIC, BINARY_SHYP_MAGIC_SIZE) == 0;
+	}
+	
+	// -----------------------------------------------------------------------
+	
+	void UnSerialization::loadBinaryHypotheses(const string& shypFileName, 
+											   vector<BaseLearner*>& weakHypotheses,
+											   InputData* pTrainingData, int verbose)
+	{
+		// map the file
+		MappedFile mappedFile(shypFileName);
+		if ( mappedFile.size() < static_cast<size_t>(BINARY_SHYP_MAGIC_SIZE) )
+		{
+			cerr << "ERROR: Not a valid MultiBoost Strong Hypothesis file!!" << endl;
+			exit(1);
+		}
+		
+		BinaryShypReader reader(mappedFile.begin(), mappedFile.end());
+		
+		reader.skip(BINARY_SHYP_MAGIC_SIZE);
+		
+		// Not used for the moment
+		string algoName = reader.readString();
+		
+		vector<int> classIndices;
+		vector<string> learnerTypes;
+		
+		while ( !reader.atEnd() )
+		{
+			const char recordType = reader.read<char>();
+			
+			if ( recordType == 'C' )
+			{
+				const NameMap& classMap = pTrainingData->getClassMap();
+				const int numClasses = reader.read<int>();
+				
+				classIndices.resize(numClasses);
+				for (int l = 0; l < numClasses; ++l)
+					classIndices[l] = classMap.getIdxFromName( reader.readString() );
+			}
+			else if ( recordType == 'T' )
+			{
+				const int typeIdx = reader.read<int>();
+				const string learnerName = reader.readString();
+				
+				// Check if the weak learner exists
+				if ( !BaseLearner::RegisteredLearners().hasLearner(learnerName) ) {
+					cerr << "ERROR: Weak learner <" << learnerName << "> not registered!!" << endl;
+					exit(1);
+				}
+				
+				if ( typeIdx >= static_cast<int>(learnerTypes.size()) )
+					learnerTypes.resize(typeIdx + 1);
+				learnerTypes[typeIdx] = learnerName;
+			}
+			else if ( recordType == 'H' || recordType == 'X' )
+			{
+				const int typeIdx = ( recordType == 'H' ) ? reader.read<int>() : -1;
+				reader.read<int>(); // the iteration, they are in order
+				const int blockSize = reader.read<int>();
+				
+				if ( blockSize < 0 || blockSize > reader.getRemainingSize() )
+				{
+					cerr << "WARNING: Incomplete weak hypothesis file found. Check the shyp file!" << endl;
+					break;
+				}
+				
+				const char* pBlock = reader.getPosition();
+				reader.skip(blockSize);
+				
+				if ( recordType == 'X' )
+				{
+					istringstream blockStream( string(pBlock, blockSize) );
+					nor_utils::StreamTokenizer st(blockStream, "<>\n\r\t");
+					loadHypothesis(st, weakHypotheses, pTrainingData, verbose);
+					continue;
+				}
+				
+				if ( typeIdx < 0 || typeIdx >= static_cast<int>(learnerTypes.size()) || learnerTypes[typeIdx].empty() )
+				{
+					cerr << "ERROR: Corrupted binary strong hypothesis file!" << endl;
+					exit(1);
+				}
+				
+				// allocate the weak learner object
+				BaseLearner* pWeakHypothesis = 
+				BaseLearner::RegisteredLearners().getLearner(learnerTypes[typeIdx])->create();
+				pWeakHypothesis->setTrainingData(pTrainingData);
+				
+				// load it from its block
+				BinaryShypReader blockReader(pBlock, pBlock + blockSize);
+				if ( !classIndices.empty() )
+					blockReader.setClassIndices(&classIndices);
+				pWeakHypothesis->loadBinary(blockReader);
+				
+				// store it in the vector
+				weakHypotheses.push_back(pWeakHypothesis);
+				
+				// show some progress while loading on verbose > 1
+				if (verbose > 1 && weakHypotheses.size() % 1000 == 0)
+					cout << "." << flush;
+			}
+			else
+			{
+				cerr << "ERROR: Corrupted binary strong hypothesis file!" << endl;
+				exit(1);
+			}
+		}
+		
+		cout << weakHypotheses.size() << endl;
+	}
+	
+	// -----------------------------------------------------------------------
+	
 	string UnSerialization::getWeakLearnerName(const string& shypFileName)
 	{
+		if ( isBinaryFile(shypFileName) )
+		{
+			ifstream binFile(shypFileName.c_str(), ios::in | ios::binary);
+			char header[BINARY_SHYP_MAGIC_SIZE + sizeof(int)];
+			binFile.read(header, sizeof(header));
+			
+			BinaryShypReader reader(header + BINARY_SHYP_MAGIC_SIZE, header + sizeof(header));
+			const int length = reader.read<int>();
+			if ( !binFile || length < 0 )
+			{
+				cerr << "ERROR: Not a valid MultiBoost Strong Hypothesis file!!" << endl;
+				exit(1);
+			}
+			
+			string algoName(length, ' ');
+			if ( length > 0 )
+				binFile.read(&algoName[0], length);
+			return algoName;
+		}
+		
 		// open file
 		ifstream inFile(shypFileName.c_str());
 		if (!inFile.is_open())
@@ -49,6 +49,8 @@
 #include <algorithm> // for fill
 #include <fstream> // input/output on file
 #include <iomanip> // for setprecision
+#include <map>
+#include <cstring> // for memcpy
 
 using namespace std;
 
@@ -64,6 +66,18 @@ namespace MultiBoost {
 	
 	/**
 	 * The serialization (saving) of the weak learners found.
+	 * Besides the xml file, the strong hypothesis can be saved in a binary format
+	 * which is loaded without tokenizing. The binary file is:
+	 * \verbatim
+	 <magic "MBSHYPB1"> <algo name>
+	 then a sequence of records, each starting with a char:
+	 'C' <numClasses> <class names>                 the class map, before the first hypothesis
+	 'T' <type index> <learner name>                the learner types, before their first use
+	 'H' <type index> <iteration> <size> <block>    a hypothesis saved by BaseLearner::saveBinary()
+	 'X' <iteration> <size> <xml>                   a hypothesis saved by BaseLearner::save() \endverbatim
+	 * The integers are int, the reals are double and the strings are their length (int)
+	 * followed by the characters, all in the byte order of the machine. The learners
+	 * without binary format (see BaseLearner::hasBinaryFormat()) are saved in xml.
 	 * \see UnSerialization
 	 * \date 13/11/2005
 	 */
@@ -74,10 +88,11 @@ namespace MultiBoost {
 		/**
 		 * The constructor. Create the serialization object
 		 * \param shypFileName The name of the serialized strong hypothesis file.
-		 * hypotheses.
+		 * \param isComp Compress the xml file with bzip2.
+		 * \param isBinary Save the binary format instead of xml (no compression then).
 		 * \date 16/11/2005
 		 */
-		Serialization(const string& shypFileName, bool isComp = false );
+		Serialization(const string& shypFileName, bool isComp = false, bool isBinary = false );
 		
 		/**
 		 * Write the header.
@@ -164,6 +179,22 @@ namespace MultiBoost {
 		inline static string getTabs(int numTabs)
 		{ return string(numTabs, '\t'); }
 		
+		/**
+		 * Write a value in the binary format.
+		 * \param outputStream The stream of the binary file.
+		 * \param value The value, an int or a double.
+		 */
+		template <typename T>
+		static void writeBinary(ostream& outputStream, const T& value)
+		{ outputStream.write( reinterpret_cast<const char*>(&value), sizeof(T) ); }
+		
+		/**
+		 * Write a string in the binary format: its length then the characters.
+		 * \param outputStream The stream of the binary file.
+		 * \param str The string.
+		 */
+		static void writeBinaryString(ostream& outputStream, const string& str);
+		
 		
 		/**
 		 * Put a stage separator in the XML. The VJ cascade consists of stages.
@@ -179,11 +210,25 @@ namespace MultiBoost {
 		//virtual void appendStageSeparatorFooter();
 	protected:
 		void flushCompressedBuffer();
+		
+		/**
+		 * Append the passed weak hypothesis to the binary file.
+		 * \see appendHypothesis
+		 */
+		void appendBinaryHypothesis(int iteration, BaseLearner* pWeakHypothesis);
+		
+		/**
+		 * Exit if the binary format is used, the cascade structures have no binary format.
+		 */
+		void checkNotBinary();
 	private:
 		ofstream _shypFile; //!< The strong learner file
 		string	_shypFileName;
 		string   _bzipFileName;
 		bool		_isComp;
+		bool		_isBinary; //!< The binary format is written instead of xml
+		bool		_isClassMapWritten; //!< The 'C' record of the binary format is written
+		map<string, int> _learnerTypes; //!< The learner type indices of the binary format
 		
 	};
 	
@@ -269,6 +314,78 @@ namespace MultiBoost {
 	// -----------------------------------------------------------------------
 	// -----------------------------------------------------------------------
 	
+	/**
+	 * Reads the values of a block of a binary strong hypothesis file (see Serialization).
+	 * It does not own the memory, which is usually the mapped file.
+	 */
+	class BinaryShypReader
+	{
+	public:
+		BinaryShypReader(const char* pBegin, const char* pEnd) : _pPos(pBegin), _pEnd(pEnd), _pClassIndices(NULL) {}
+		
+		/**
+		 * Read a value, an int or a double.
+		 */
+		template <typename T>
+		T read()
+		{
+			checkSize( sizeof(T) );
+			T value;
+			memcpy( &value, _pPos, sizeof(T) );
+			_pPos += sizeof(T);
+			return value;
+		}
+		
+		/**
+		 * Read a string: its length then the characters.
+		 */
+		string readString()
+		{
+			const int length = read<int>();
+			checkSize( length );
+			string str( _pPos, length );
+			_pPos += length;
+			return str;
+		}
+		
+		/**
+		 * Move forward without reading.
+		 */
+		void skip(int size) { checkSize( size ); _pPos += size; }
+		
+		bool atEnd() const { return _pPos >= _pEnd; }
+		
+		const char* getPosition() const { return _pPos; }
+		
+		int getRemainingSize() const { return _pEnd - _pPos; }
+		
+		/**
+		 * The index of a class of the saved class map in the class map of the data.
+		 * \param savedIdx The index of the class when the file was written.
+		 */
+		int getClassIdx(int savedIdx) const 
+		{ return _pClassIndices ? (*_pClassIndices)[savedIdx] : savedIdx; }
+		
+		void setClassIndices(const vector<int>* pClassIndices) { _pClassIndices = pClassIndices; }
+		
+	protected:
+		void checkSize(int size) const
+		{
+			if ( size < 0 || size > _pEnd - _pPos )
+			{
+				cerr << "ERROR: Corrupted binary strong hypothesis file!" << endl;
+				exit(1);
+			}
+		}
+		
+		const char* _pPos;
+		const char* _pEnd;
+		const vector<int>* _pClassIndices; //!< the map from the saved class indices to the indices of the data
+	};
+	
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	
 	/**
 	 * The un-serialization (loading) of the weak learners found.
 	 * \see Serialization
@@ -324,6 +441,25 @@ namespace MultiBoost {
 								   vector<BaseLearner*>& weakHypotheses,
 								   InputData* pTrainingData, int verbose = 1);
 		
+		/**
+		 * Check whether the file is a binary strong hypothesis file (see Serialization).
+		 * \param shypFileName The strong hypothesis file.
+		 */
+		static bool isBinaryFile(const string& shypFileName);
+		
+		/**
+		 * Load a binary strong hypothesis file. The file is mapped into the memory and the
+		 * weak hypotheses are built directly from their blocks, see BaseLearner::loadBinary().
+		 * loadHypotheses() calls it for the binary files.
+		 * \param shypFileName The name of the binary strong hypothesis file.
+		 * \param weakHypotheses The vector of weak hypotheses that will be filled.
+		 * \param pTrainingData Pointer to the training data, needed for classMap, enumMaps
+		 * \param verbose The level of verbosity. Default = 1.
+		 */
+		void loadBinaryHypotheses(const string& shypFileName, 
+								  vector<BaseLearner*>& weakHypotheses,
+								  InputData* pTrainingData, int verbose = 1);
+		
 		/**
 		 * Return the name of the weak learner defined at the beginning
 		 * of the strong hypothesis file.
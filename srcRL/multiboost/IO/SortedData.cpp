@@ -38,10 +38,16 @@
 #include <algorithm> // for sort
 
 #include <limits>
+#include <cstring> // for memcpy
 
 // ------------------------------------------------------------------------
 namespace MultiBoost {
 	
+	// the extension of the cache files of the sorted columns
+	static const char SORTED_DATA_CACHE_EXTENSION[] = ".mbsorted";
+	
+	// ------------------------------------------------------------------------
+	
 	void SortedData::load(const string& fileName, eInputType inputType, int verboseLevel)
 	{
 		InputData::load(fileName, inputType, verboseLevel);
@@ -50,11 +56,112 @@ namespace MultiBoost {
 		if (inputType == IT_TEST)
 			return;
 		
+		const string cacheFileName = _pData->getCacheFileName( SORTED_DATA_CACHE_EXTENSION );
+		if ( !cacheFileName.empty() && DataCache::fileExists( cacheFileName ) && loadSortedCache( cacheFileName ) )
+		{
+			if (verboseLevel > 0)
+				cout << "Sorted data loaded from the cache " << cacheFileName << endl;
+		}
+		else
+		{
+			if (verboseLevel > 0)
+				cout << "Sorting data..." << flush;
+			
+			sortColumns();
+			
+			if ( !cacheFileName.empty() )
+				saveSortedCache( cacheFileName );
+			
+			if (verboseLevel > 0)
+				cout << "Done!" << endl;
+		}
+		
+		initColumns( verboseLevel );
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	void SortedData::loadExamples( vector<Example>& examples, const NameMap& classMap, 
+								  const vector<NameMap>& enumMaps, const NameMap& attributeNameMap, 
+								  const vector<RawData::eAttributeType>& attributeTypes, 
+								  eDataRep dataRep, eLabelRep labelRep )
+	{
+		InputData::loadExamples( examples, classMap, enumMaps, attributeNameMap, attributeTypes, dataRep, labelRep );
+		
+		sortColumns();
+		initColumns( 0 );
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	void SortedData::initColumns( int verboseLevel )
+	{
+		// the missing values are filtered out of the columns
+		_hasMissingValues.resize(_pData->getNumAttributes());
+		for (int j = 0; j < _pData->getNumAttributes(); ++j)
+		{
+			_hasMissingValues[j] = 0;
+			for( column::iterator it = _sortedData[j].begin(); it != _sortedData[j].end(); it ++ )
+			{
+				if ( it->second != it->second )
+				{
+					_hasMissingValues[j] = 1;
+					break;
+				}
+			}
+		}
+		
+		_compactedData.resize(_pData->getNumAttributes());
+		_isCompacted.resize(_pData->getNumAttributes());
+		invalidateCompactedColumns();
+		
+		// the new examples of loadExamples() replace the quantized ones
+		if ( _numHistogramBins > 0 )
+			quantizeColumns( _numHistogramBins, verboseLevel );
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	void SortedData::quantizeColumns( int numBins, int verboseLevel )
+	{
+		_numHistogramBins = min( numBins, static_cast<int>(MAX_HISTOGRAM_BINS) );
+		_histogramBins.clear();
+		_binMins.clear();
+		_binMaxs.clear();
+		
+		if ( _numHistogramBins <= 0 )
+			return;
+		
+		if ( _pData->getDataRep() != DR_DENSE )
+		{
+			if (verboseLevel > 0)
+				cout << "Warning: only dense data can be quantized, the histograms are turned off!" << endl;
+			return;
+		}
+		
 		if (verboseLevel > 0)
-			cout << "Sorting data..." << flush;
+			cout << "Quantizing data into " << _numHistogramBins << " bins..." << flush;
+		
+		_histogramBins.resize(_pData->getNumAttributes());
+		_binMins.resize(_pData->getNumAttributes());
+		_binMaxs.resize(_pData->getNumAttributes());
+		
+		for (int j = 0; j < _pData->getNumAttributes(); ++j)
+			buildHistogramBins( j );
 		
-		// set the number of columns for the stored data
+		if (verboseLevel > 0)
+			cout << "Done!" << endl;
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	void SortedData::sortColumns()
+	{
+		// set the number of columns for the stored data, the columns of the previous
+		// examples are emptied but keep their memory
 		_sortedData.resize(_pData->getNumAttributes()); 
+		for (int j = 0; j < _pData->getNumAttributes(); ++j)
+			_sortedData[j].clear();
 		int i = 0;
 		
 		if ( _pData->getDataRep() == DR_DENSE )
@@ -69,27 +176,32 @@ namespace MultiBoost {
 		// and the pair represent the index of the example with the value
 		vector<Example>::iterator eIt;
 		
-		i = 0;
-		// for each example
-		for ( eIt = _pData->rawBegin(); eIt != _pData->rawEnd(); ++eIt, ++i )
+		if ( _pData->getDataRep() == DR_SPARSE )
 		{
-			vector<FeatureReal>& values = eIt->getValues();
-			const vector<int>& valIdx = eIt->getValuesIndexes();
-			vector<FeatureReal>::iterator vIt;
-			int j = 0;
-			
-			if ( valIdx.empty() ) // dense data!
+			// the compressed columns of the raw data hold exactly the stored values
+			const int* rows;
+			const FeatureReal* values;
+			for ( int j = 0; j < _pData->getNumAttributes(); ++j )
 			{
-				//_sortedData[j].reserve(values.size()); // <-- this should be done before, and only of dense!
-				// for each attribute of the example
-				for (vIt = values.begin(); vIt != values.end(); ++vIt, ++j )
-					_sortedData[j].push_back( make_pair(i, *vIt) ); // store the index of the example and the value
+				const int columnSize = _pData->getSparseColumn( j, rows, values );
+				_sortedData[j].reserve( columnSize );
+				for ( int k = 0; k < columnSize; ++k )
+					_sortedData[j].push_back( make_pair(rows[k], values[k]) ); // store the index of the example and the value
 			}
-			else // sparse data
+		}
+		else
+		{
+			i = 0;
+			// for each example
+			for ( eIt = _pData->rawBegin(); eIt != _pData->rawEnd(); ++eIt, ++i )
 			{
+				vector<FeatureReal>& values = eIt->getValues();
+				vector<FeatureReal>::iterator vIt;
+				int j = 0;
+				
 				// for each attribute of the example
 				for (vIt = values.begin(); vIt != values.end(); ++vIt, ++j )
-					_sortedData[ valIdx[j] ].push_back( make_pair(i, *vIt) ); // store the index of the example and the value
+					_sortedData[j].push_back( make_pair(i, *vIt) ); // store the index of the example and the value
 			}
 		}
 		
@@ -108,37 +220,190 @@ namespace MultiBoost {
 				 nor_utils::comparePair< 2, int, FeatureReal, less<FeatureReal> >() );
 #endif
 		}
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	void SortedData::saveSortedCache( const string& cacheFileName )
+	{
+		DataCacheWriter writer( cacheFileName, _pData->getCacheKey() );
+		if ( !writer.isOpen() )
+		{
+			cerr << "Warning: Cannot write the cache file <" << cacheFileName << ">!" << endl;
+			return;
+		}
 		
-		if (verboseLevel > 0)
-			cout << "Done!" << endl;
+		// the order of the equal values depends on the sort
+		writer.write<int>( STABLE_SORT );
+		
+		// only the order is saved, the values are in the raw data
+		writer.write<int>( _sortedData.size() );
+		vector<int> exampleIdxs;
+		for ( int j = 0; j < (int)_sortedData.size(); ++j )
+		{
+			exampleIdxs.resize( _sortedData[j].size() );
+			for ( int k = 0; k < (int)_sortedData[j].size(); ++k )
+				exampleIdxs[k] = _sortedData[j][k].first;
+			writer.writeArray( exampleIdxs );
+		}
+		
+		if ( !writer.commit() )
+			cerr << "Warning: Cannot write the cache file <" << cacheFileName << ">!" << endl;
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	bool SortedData::loadSortedCache( const string& cacheFileName )
+	{
+		DataCacheReader reader( cacheFileName, _pData->getCacheKey() );
+		if ( !reader.isValid() || reader.read<int>() != STABLE_SORT )
+			return false;
+		
+		const int numColumns = reader.read<int>();
+		if ( numColumns != _pData->getNumAttributes() )
+			return false;
+		
+		vector<long long> columnSizes( numColumns );
+		vector<const char*> pColumns( numColumns );
+		for ( int j = 0; j < numColumns; ++j )
+		{
+			columnSizes[j] = reader.read<long long>();
+			pColumns[j] = reader.readBytes( columnSizes[j] * sizeof(int) );
+		}
+		
+		if ( !reader.isValid() )
+			return false;
+		
+		_sortedData.clear();
+		_sortedData.resize( numColumns );
+		
+#pragma omp parallel for schedule(dynamic)
+		for ( int j = 0; j < numColumns; ++j )
+		{
+			column& sortedColumn = _sortedData[j];
+			sortedColumn.resize( columnSizes[j] );
+			for ( long long k = 0; k < columnSizes[j]; ++k )
+			{
+				int i;
+				memcpy( &i, pColumns[j] + k * sizeof(int), sizeof(int) );
+				sortedColumn[k] = make_pair( i, _pData->getValue( i, j ) );
+			}
+		}
+		
+		return true;
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	void SortedData::buildHistogramBins( int colIdx )
+	{
+		const column& sortedColumn = _sortedData[colIdx];
+		vector<unsigned char>& bins = _histogramBins[colIdx];
+		vector<FeatureReal>& binMins = _binMins[colIdx];
+		vector<FeatureReal>& binMaxs = _binMaxs[colIdx];
+		
+		bins.assign( _pData->getNumExample(), static_cast<unsigned char>(MAX_HISTOGRAM_BINS) );
+		binMins.clear();
+		binMaxs.clear();
+		
+		// count the values and the distinct values
+		int numValues = 0;
+		int numDistinctValues = 0;
+		FeatureReal previousValue = 0;
+		column::const_iterator it;
+		for( it = sortedColumn.begin(); it != sortedColumn.end(); ++it )
+		{
+			if ( it->second != it->second ) continue; // missing value
+			if ( numValues == 0 || it->second != previousValue )
+				++numDistinctValues;
+			previousValue = it->second;
+			++numValues;
+		}
+		
+		// a new bin starts at a new value if the current bin is full, so equal values are never split
+		const bool binPerValue = ( numDistinctValues <= _numHistogramBins );
+		const double binSize = static_cast<double>(numValues) / _numHistogramBins;
+		int k = 0;
+		for( it = sortedColumn.begin(); it != sortedColumn.end(); ++it )
+		{
+			const FeatureReal value = it->second;
+			if ( value != value ) continue;
+			
+			if ( binMins.empty() ||
+				( value != binMaxs.back() && 
+				 ( binPerValue || ( static_cast<int>(binMins.size()) < _numHistogramBins && k >= binMins.size() * binSize ) ) ) )
+			{
+				binMins.push_back( value );
+				binMaxs.push_back( value );
+			}
+			
+			binMaxs.back() = value;
+			bins[ it->first ] = static_cast<unsigned char>( binMins.size() - 1 );
+			++k;
+		}
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	int SortedData::getHistogramColumn( int colIdx, const unsigned char*& bins, 
+									   const FeatureReal*& binMins, const FeatureReal*& binMaxs )
+	{
+		const int numBins = _binMins[colIdx].size();
+		bins = &_histogramBins[colIdx][0];
+		binMins = ( numBins > 0 ) ? &_binMins[colIdx][0] : NULL;
+		binMaxs = ( numBins > 0 ) ? &_binMaxs[colIdx][0] : NULL;
+		return numBins;
 	}
 	
 	// ------------------------------------------------------------------------
 	
   // XXX fradav "old" optimized filter function cleaned of its O(log n) set::find()
   // using the new _rawIndices vector and untouched typo ;-)
-	pair<vpIterator,vpIterator> SortedData::getFileteredBeginEnd(int colIdx) {
-		_filteredColumn.clear();
-		for( column::iterator it = _sortedData[colIdx].begin(); it != _sortedData[colIdx].end(); it ++ ) {
-		  if ( this->isUsedIndice( it->first ) && ( it->second == it->second ) ) {
-				int i = this->getOrderBasedOnRawIndex( it->first );
-				_filteredColumn.push_back( pair<int, FeatureReal>(i, it->second) );
+	vector< pair<int, FeatureReal> >& SortedData::getFilteredColumn(int colIdx) {
+		// the order based index is the raw index and no value is dropped: the sorted column can be used as it is
+		if ( !this->isFiltered() && !_hasMissingValues[colIdx] )
+			return _sortedData[colIdx];
+		
+		column& filteredColumn = _compactedData[colIdx];
+		if ( !_isCompacted[colIdx] ) {
+			filteredColumn.clear();
+			for( column::iterator it = _sortedData[colIdx].begin(); it != _sortedData[colIdx].end(); it ++ ) {
+			  if ( this->isUsedIndice( it->first ) && ( it->second == it->second ) ) {
+					int i = this->getOrderBasedOnRawIndex( it->first );
+					filteredColumn.push_back( pair<int, FeatureReal>(i, it->second) );
+				}
 			}
+			_isCompacted[colIdx] = 1;
 		}
-		return make_pair(_filteredColumn.begin(),_filteredColumn.end());
+		return filteredColumn;
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	pair<vpIterator,vpIterator> SortedData::getFileteredBeginEnd(int colIdx) {
+		_pFilteredColumn = &getFilteredColumn( colIdx );
+		return make_pair(_pFilteredColumn->begin(),_pFilteredColumn->end());
 	}
 	
 	// ------------------------------------------------------------------------
 	
 	pair<vpReverseIterator,vpReverseIterator> SortedData::getFileteredReverseBeginEnd(int colIdx) {
-		_filteredColumn.clear();
-		for( column::iterator it = _sortedData[colIdx].begin(); it != _sortedData[colIdx].end(); it ++ ) {
-		  if ( this->isUsedIndice( it->first ) && ( it->second == it->second ) ) {
-				int i = this->getOrderBasedOnRawIndex( it->first );
-				_filteredColumn.push_back( pair<int, FeatureReal>(i, it->second) );
-			}
-		}
-		return make_pair(_filteredColumn.rbegin(),_filteredColumn.rend());
+		_pFilteredColumn = &getFilteredColumn( colIdx );
+		return make_pair(_pFilteredColumn->rbegin(),_pFilteredColumn->rend());
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	int SortedData::loadIndexSet( set< int > ind ) {
+		invalidateCompactedColumns();
+		return InputData::loadIndexSet( ind );
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	void SortedData::clearIndexSet( void ) {
+		invalidateCompactedColumns();
+		InputData::clearIndexSet();
 	}
 	
 	
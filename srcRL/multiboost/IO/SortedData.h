@@ -67,6 +67,8 @@ namespace MultiBoost {
 	{
 	public:
 		
+		SortedData() : _pFilteredColumn(NULL), _numHistogramBins(0) {}
+		
 		/**
 		 * The destructor. Must be declared (virtual) for the proper destruction of 
 		 * the object.
@@ -84,6 +86,15 @@ namespace MultiBoost {
 		 */
 		virtual void load(const string& fileName, eInputType inputType = IT_TRAIN, int verboseLevel = 1);
 		
+		/**
+		 * Overloading of the loadExamples function to support sorting.
+		 * \see InputData::loadExamples()
+		 */
+		virtual void loadExamples( vector<Example>& examples, const NameMap& classMap, 
+								  const vector<NameMap>& enumMaps, const NameMap& attributeNameMap, 
+								  const vector<RawData::eAttributeType>& attributeTypes, 
+								  eDataRep dataRep, eLabelRep labelRep );
+		
 		/**
 		 * Check whether a feature/attribute is empty.(This can happen using sparse data representation.)
 		 * \param idx the index of the attribute
@@ -101,7 +112,7 @@ namespace MultiBoost {
 		 * \date 01/07/2011		 
 		 */		
 		virtual bool isFilteredAttributeEmpty() {
-			return _filteredColumn.empty();
+			return ( _pFilteredColumn == NULL ) || _pFilteredColumn->empty();
 		}
 
 		/**
@@ -111,7 +122,7 @@ namespace MultiBoost {
 		 * \date 01/07/2011		 
 		 */				
 		virtual bool isFilteredAttributeHasOneValue() {
-			return ( _filteredColumn[0].second == _filteredColumn[_filteredColumn.size()-1].second );
+			return ( (*_pFilteredColumn)[0].second == (*_pFilteredColumn)[_pFilteredColumn->size()-1].second );
 		}
 		
 		
@@ -126,6 +137,17 @@ namespace MultiBoost {
 		 */								
 		virtual pair<vpIterator,vpIterator> getFileteredBeginEnd(int colIdx);
 
+		/**
+		 * The sorted and filtered column itself. Without filtering and missing values this is the
+		 * sorted column, otherwise a compacted copy which is built at the first request and kept
+		 * until the next change of the index set (see loadIndexSet() and clearIndexSet()).
+		 * \param colIdx The column index
+		 * \return The (order based index, value) pairs of the used examples, sorted by value
+		 * \remark It can be called from several threads at the same time for different columns.
+		 * \warning The column must not be modified.
+		 */
+		vector< pair<int, FeatureReal> >& getFilteredColumn(int colIdx);
+
 		/**
 		 * The same as SoterdData::getFileteredBeginEnd but it returns reverse iterator.
 		 * \ see SoterdData::getFileteredBeginEnd
@@ -133,6 +155,58 @@ namespace MultiBoost {
 		 */								
 		
 		virtual pair<vpReverseIterator,vpReverseIterator> getFileteredReverseBeginEnd(int colIdx);
+		
+		/**
+		 * The largest number of bins of a quantized column. The bin index MAX_HISTOGRAM_BINS
+		 * marks the missing values.
+		 */
+		enum { MAX_HISTOGRAM_BINS = 255 };
+		
+		/**
+		 * Quantizes every column into at most \a numBins bins, see getHistogramColumn(). The
+		 * learners call it on the data they train on, so the test data is never quantized.
+		 * The columns are quantized again when loadExamples() replaces the examples.
+		 * \param numBins The number of bins, at most MAX_HISTOGRAM_BINS. 0 drops the bins.
+		 * \param verboseLevel The level of verbosity.
+		 * \remark Only dense data is quantized.
+		 */
+		void quantizeColumns( int numBins, int verboseLevel );
+		
+		/**
+		 * The number of bins of the last quantizeColumns() call, 0 if there was none.
+		 */
+		int getNumHistogramBins() const { return _numHistogramBins; }
+		
+		/**
+		 * Whether the columns were quantized by quantizeColumns().
+		 */
+		bool hasHistogramBins() { return !_histogramBins.empty(); }
+		
+		/**
+		 * A quantized column. The bins follow the order of the values; every value of a bin is
+		 * smaller than the values of the next bin, and each distinct value has its own bin if
+		 * there are not more distinct values than bins. Otherwise the bins have roughly the same
+		 * number of examples.
+		 * \param colIdx The column index.
+		 * \param bins The bin of each example, indexed by the raw index (see getRawIndex()).
+		 * \param binMins The smallest value of each bin.
+		 * \param binMaxs The largest value of each bin.
+		 * \return The number of bins of the column.
+		 */
+		int getHistogramColumn( int colIdx, const unsigned char*& bins, 
+							   const FeatureReal*& binMins, const FeatureReal*& binMaxs );
+		
+		/**
+		 * Overridden to drop the compacted columns of the previous index set.
+		 * \see InputData::loadIndexSet
+		 */
+		virtual int loadIndexSet( set< int > ind );
+		
+		/**
+		 * Overridden to drop the compacted columns of the previous index set.
+		 * \see InputData::clearIndexSet
+		 */
+		virtual void clearIndexSet( void );
 	protected:
 		
 		/**
@@ -148,7 +222,53 @@ namespace MultiBoost {
 		
 		vector<column>    _sortedData; //!< the sorted data.
 		
-		column _filteredColumn; //!< the sorted filtered data
+		vector<column>    _compactedData; //!< the compacted copies of the filtered columns, see getFilteredColumn()
+		vector<char>      _isCompacted; //!< whether the compacted copy of the column is up to date
+		vector<char>      _hasMissingValues; //!< whether the column has NaN values (they are never returned)
+		
+		column* _pFilteredColumn; //!< the column of the last getFileteredBeginEnd() call
+		
+		int                            _numHistogramBins; //!< the number of bins asked to quantizeColumns(), 0 if the columns are not quantized
+		vector< vector<unsigned char> > _histogramBins; //!< the bin of every example in every column, see getHistogramColumn()
+		vector< vector<FeatureReal> >   _binMins; //!< the smallest value of every bin
+		vector< vector<FeatureReal> >   _binMaxs; //!< the largest value of every bin
+		
+		/**
+		 * Fills the columns from the raw data and sorts them.
+		 */
+		void sortColumns();
+		
+		/**
+		 * Finds the columns with missing values, and quantizes the columns again if they
+		 * were quantized. The columns must be sorted.
+		 * \param verboseLevel The level of verbosity.
+		 */
+		void initColumns( int verboseLevel );
+		
+		/**
+		 * Saves the order of the sorted columns into a cache file of the raw data.
+		 * \param cacheFileName The name of the cache file.
+		 * \see RawData::getCacheFileName()
+		 */
+		void saveSortedCache( const string& cacheFileName );
+		
+		/**
+		 * Loads the sorted columns from a cache file written by saveSortedCache().
+		 * \param cacheFileName The name of the cache file.
+		 * \return False if the cache is not valid.
+		 */
+		bool loadSortedCache( const string& cacheFileName );
+		
+		/**
+		 * Quantizes a sorted column into at most _numHistogramBins bins.
+		 * \param colIdx The column index.
+		 */
+		void buildHistogramBins( int colIdx );
+		
+		/**
+		 * Drops the compacted copies, they are rebuilt at the next request.
+		 */
+		void invalidateCompactedColumns() { fill( _isCompacted.begin(), _isCompacted.end(), 0 ); }
 		
 	};
 	
@@ -0,0 +1,291 @@
+/*
+ *
+ *    MultiBoost - Multi-purpose boosting package
+ *
+ *    Copyright (C)        AppStat group
+ *                         Laboratoire de l'Accelerateur Lineaire
+ *                         Universite Paris-Sud, 11, CNRS
+ *
+ *    This file is part of the MultiBoost library
+ *
+ *    This library is free software; you can redistribute it 
+ *    and/or modify it under the terms of the GNU General Public
+ *    License as published by the Free Software Foundation
+ *    version 2.1 of the License.
+ *
+ *    This library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public
+ *    License along with this library; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin St, 5th Floor, Boston, MA 02110-1301 USA
+ *
+ *    Contact: multiboost@googlegroups.com 
+ * 
+ *    For more information and up-to-date version, please visit
+ *        
+ *                       http://www.multiboost.org/
+ *
+ */
+
+
+
+#include <iostream>
+
+#include "IO/StreamingData.h"
+#include "IO/ChunkedParser.h"
+
+#include <sys/mman.h> // for mmap
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace MultiBoost {
+	
+	// ------------------------------------------------------------------------
+	
+	StreamingArffParser::StreamingArffParser(const string& fileName, const string& headerFileName, size_t blockSize)
+	: ArffParser(fileName, headerFileName), _blockSize(blockSize), _dataOffset(0), 
+	_numRows(0), _nextRow(0), _isEndOfData(false)
+	{
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	void StreamingArffParser::open()
+	{
+		// binary, so the offsets are the ones of the bytes read
+		_inFile.open(_fileName.c_str(), ios::in | ios::binary);
+		if ( !_inFile.is_open() )
+		{
+			cerr << "\nERROR: Cannot open file <" << _fileName << ">!!" << endl;
+			exit(1);
+		}
+		
+		_dataRep = DR_UNKNOWN;
+		_labelRep = LR_UNKNOWN;
+		
+		if (_headerFileName.empty())
+		{
+			readHeader(_inFile, _classMap, _enumMaps, _attributeNameMap, _attributeTypes);
+			_dataOffset = _inFile.tellg();
+		}
+		else {
+			// open separate header file
+			ifstream inHeaderFile(_headerFileName.c_str());
+			if ( !inHeaderFile.is_open() )
+			{
+				cerr << "\nERROR: Cannot open header file <" << _headerFileName << ">!!" << endl;
+				exit(1);
+			}
+			readHeader(inHeaderFile, _classMap, _enumMaps, _attributeNameMap, _attributeTypes);
+		}
+		
+		// the rows are counted once, the margins are stored by row
+		_numRows = 0;
+		if ( _dataOffset >= 0 )
+		{
+			ArffRowParser rowParser(_numAttributes, _hasName, _classMap, _enumMaps, _attributeTypes);
+			
+			rewind();
+			do
+			{
+				readText();
+				if ( !_text.empty() )
+				{
+					TextChunk chunk = { &_text[0], &_text[0] + _text.size() };
+					_numRows += ChunkedParser::countRows(chunk, rowParser);
+				}
+			} while ( !_isEndOfData );
+		}
+		
+		if ( _numRows == 0 )
+		{
+			cerr << "\nERROR: No data in file <" << _fileName << ">!!" << endl;
+			exit(1);
+		}
+		
+		rewind();
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	long long StreamingArffParser::readBlock(vector<Example>& examples)
+	{
+		for (;;)
+		{
+			if ( _isEndOfData )
+				rewind();
+			
+			const long long firstRow = _nextRow;
+			examples.clear();
+			
+			readText();
+			if ( !_text.empty() )
+			{
+				ArffRowParser rowParser(_numAttributes, _hasName, _classMap, _enumMaps, _attributeTypes);
+				ChunkedParser::parseRows(&_text[0], &_text[0] + _text.size(), rowParser, examples);
+				rowParser.mergeRepresentations(_dataRep, _labelRep);
+			}
+			
+			// a block of comments, or a line longer than the block
+			if ( examples.empty() )
+				continue;
+			
+			_nextRow += examples.size();
+			return firstRow;
+		}
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	void StreamingArffParser::readText()
+	{
+		// the partial line of the previous block
+		_text.assign(_tail.begin(), _tail.end());
+		_tail.clear();
+		
+		const size_t tailSize = _text.size();
+		_text.resize(tailSize + _blockSize);
+		_inFile.read(&_text[tailSize], _blockSize);
+		_text.resize(tailSize + _inFile.gcount());
+		
+		if ( _inFile.eof() )
+		{
+			_isEndOfData = true;
+			return;
+		}
+		
+		// the partial last line goes to the next block
+		size_t textEnd = _text.size();
+		while ( textEnd > 0 && _text[textEnd - 1] != '\n' )
+			--textEnd;
+		
+		_tail.assign(_text.begin() + textEnd, _text.end());
+		_text.resize(textEnd);
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	void StreamingArffParser::rewind()
+	{
+		_inFile.clear();
+		_inFile.seekg(_dataOffset);
+		_tail.clear();
+		_isEndOfData = false;
+		_nextRow = 0;
+	}
+	
+	// ------------------------------------------------------------------------
+	// ------------------------------------------------------------------------
+	
+	MappedMargins::MappedMargins(const string& fileName, long long numRows, int numClasses)
+	: _numClasses(numClasses), _pMapped(NULL)
+	{
+		_size = numRows * (sizeof(int) + numClasses * sizeof(float));
+		
+		if ( fileName.empty() )
+		{
+			_pMapped = mmap(NULL, _size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		}
+		else
+		{
+			int fd = ::open(fileName.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+			if ( fd < 0 || ftruncate(fd, _size) != 0 )
+			{
+				cerr << "\nERROR: Cannot create the margin file <" << fileName << ">!!" << endl;
+				exit(1);
+			}
+			
+			_pMapped = mmap(NULL, _size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			close(fd);
+			
+			// the mapping keeps the file until the end
+			unlink(fileName.c_str());
+		}
+		
+		if ( _pMapped == MAP_FAILED )
+		{
+			cerr << "\nERROR: Cannot map the margins!!" << endl;
+			exit(1);
+		}
+		
+		_pNumHypotheses = static_cast<int*>(_pMapped);
+		_pMargins = reinterpret_cast<float*>(_pNumHypotheses + numRows);
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	MappedMargins::~MappedMargins()
+	{
+		munmap(_pMapped, _size);
+	}
+	
+	// ------------------------------------------------------------------------
+	// ------------------------------------------------------------------------
+	
+	StreamingData::StreamingData(const string& fileName, const string& headerFileName, size_t blockSize, 
+								 const string& marginFileName, int verboseLevel)
+	: _fileName(fileName), _headerFileName(headerFileName), _parser(_fileName, _headerFileName, blockSize),
+	_pMargins(NULL), _pBlock(NULL), _blockFirstRow(0), _nextFirstRow(0), _hasNextBlock(false)
+	{
+		if (verboseLevel > 0)
+			cout << "Streaming file " << fileName << "..." << flush;
+		
+		_parser.open();
+		
+		if (verboseLevel > 0)
+			cout << "Done! (" << getNumRows() << " examples)" << endl;
+		
+		_pMargins = new MappedMargins(marginFileName, getNumRows(), getNumClasses());
+		
+		_pBlock = new InputData();
+		nextBlock();
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	StreamingData::~StreamingData()
+	{
+		delete _pBlock;
+		delete _pMargins;
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	void StreamingData::prefetch()
+	{
+		if ( _hasNextBlock )
+			return;
+		
+		_nextFirstRow = _parser.readBlock(_nextExamples);
+		_hasNextBlock = true;
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	void StreamingData::nextBlock()
+	{
+		prefetch();
+		
+		_blockFirstRow = _nextFirstRow;
+		loadExamples(_pBlock, _nextExamples);
+		_hasNextBlock = false;
+		
+		// the examples of the previous block
+		_nextExamples.clear();
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	void StreamingData::loadExamples(InputData* pData, vector<Example>& examples) const
+	{
+		pData->loadExamples(examples, _parser.getClassMap(), _parser.getEnumMaps(), 
+							_parser.getAttributeNameMap(), _parser.getAttributeTypes(), 
+							_parser.getDataRep(), _parser.getLabelRep());
+	}
+	
+	// ------------------------------------------------------------------------
+	
+} // end of namespace MultiBoost
@@ -0,0 +1,232 @@
+/*
+ *
+ *    MultiBoost - Multi-purpose boosting package
+ *
+ *    Copyright (C)        AppStat group
+ *                         Laboratoire de l'Accelerateur Lineaire
+ *                         Universite Paris-Sud, 11, CNRS
+ *
+ *    This file is part of the MultiBoost library
+ *
+ *    This library is free software; you can redistribute it 
+ *    and/or modify it under the terms of the GNU General Public
+ *    License as published by the Free Software Foundation
+ *    version 2.1 of the License.
+ *
+ *    This library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public
+ *    License along with this library; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin St, 5th Floor, Boston, MA 02110-1301 USA
+ *
+ *    Contact: multiboost@googlegroups.com 
+ * 
+ *    For more information and up-to-date version, please visit
+ *        
+ *                       http://www.multiboost.org/
+ *
+ */
+
+
+
+/**
+ * \file StreamingData.h The training data of FilterBoost read from the disk block by block.
+ */
+
+#ifndef __STREAMING_DATA_H
+#define __STREAMING_DATA_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+
+#include "ArffParser.h"
+#include "InputData.h"
+
+using namespace std;
+
+namespace MultiBoost {
+	
+	/**
+	 * The parser of an arff file which is read block by block, so the data section is
+	 * never in memory as a whole. The rows of a block are parsed in parallel as in
+	 * ArffParser. After the last row the reading starts again from the first one.
+	 * \date 17/10/2026
+	 */
+	class StreamingArffParser : public ArffParser
+	{
+	public:
+		/**
+		 * The constructor. The file is opened by open().
+		 * \param fileName The name of the arff file.
+		 * \param headerFileName The name of the header file, empty if the header is in the data file.
+		 * \param blockSize The number of bytes read at once, a block holds at least one row.
+		 */
+		StreamingArffParser(const string& fileName, const string& headerFileName, size_t blockSize);
+		
+		/**
+		 * Open the file, read the header and count the rows. It exits if there is no row.
+		 */
+		void open();
+		
+		/**
+		 * Read and parse the next rows.
+		 * \param examples The examples of the block, the previous ones are dropped.
+		 * \return The index of the first row of the block in the file.
+		 */
+		long long readBlock(vector<Example>& examples);
+		
+		long long getNumRows() const { return _numRows; }
+		
+		const NameMap&                         getClassMap() const { return _classMap; }
+		const vector<NameMap>&                 getEnumMaps() const { return _enumMaps; }
+		const NameMap&                         getAttributeNameMap() const { return _attributeNameMap; }
+		const vector<RawData::eAttributeType>& getAttributeTypes() const { return _attributeTypes; }
+		
+	protected:
+		/**
+		 * Read the next piece of the data section into _text, it ends after a new line
+		 * or at the end of the file. The partial last line is kept for the next piece.
+		 */
+		void readText();
+		
+		/**
+		 * Go back to the first row.
+		 */
+		void rewind();
+		
+		size_t          _blockSize;
+		ifstream        _inFile;
+		streamoff       _dataOffset; //!< Where the data section starts in the file
+		long long       _numRows;
+		long long       _nextRow; //!< The index of the first row of the next block
+		
+		vector<char>    _text; //!< The text of the current block
+		string          _tail; //!< The partial line at the end of the previous block
+		bool            _isEndOfData; //!< The text reached the end of the file
+		
+		NameMap                         _classMap;
+		vector<NameMap>                 _enumMaps;
+		NameMap                         _attributeNameMap;
+		vector<RawData::eAttributeType> _attributeTypes;
+	};
+	
+	// -----------------------------------------------------------------------------
+	
+	/**
+	 * The margins of the streamed examples, with the number of weak hypotheses which 
+	 * are already in them. They are in a memory mapping, of a file if it is given, so 
+	 * only the pages of the recently visited rows have to stay in the memory.
+	 * \date 17/10/2026
+	 */
+	class MappedMargins
+	{
+	public:
+		/**
+		 * Map the margins, all of them are zero. It exits if the file cannot be created.
+		 * \param fileName The file which holds the margins, it is removed right after the
+		 * mapping. If it is empty the margins are in an anonymous mapping.
+		 * \param numRows The number of examples.
+		 * \param numClasses The number of classes.
+		 */
+		MappedMargins(const string& fileName, long long numRows, int numClasses);
+		~MappedMargins();
+		
+		float* getMargins(long long row) { return _pMargins + row * _numClasses; }
+		int&   getNumHypotheses(long long row) { return _pNumHypotheses[row]; }
+		
+	private:
+		MappedMargins(const MappedMargins&);
+		MappedMargins& operator=(const MappedMargins&);
+		
+		int     _numClasses;
+		size_t  _size;
+		void*   _pMapped;
+		int*    _pNumHypotheses;
+		float*  _pMargins;
+	};
+	
+	// -----------------------------------------------------------------------------
+	
+	/**
+	 * The training data of the streaming FilterBoost. The examples are visited block by
+	 * block in the order of the file, and the next block can be read by prefetch() while 
+	 * the current one is used, so at most two blocks are in the memory.
+	 * \date 17/10/2026
+	 */
+	class StreamingData
+	{
+	public:
+		/**
+		 * Open the file and read its first block.
+		 * \param fileName The name of the arff file.
+		 * \param headerFileName The name of the header file, empty if the header is in the data file.
+		 * \param blockSize The number of bytes read at once.
+		 * \param marginFileName The file of the margins, see MappedMargins.
+		 * \param verboseLevel The level of verbosity.
+		 */
+		StreamingData(const string& fileName, const string& headerFileName, size_t blockSize, 
+					  const string& marginFileName, int verboseLevel);
+		~StreamingData();
+		
+		/**
+		 * Read the next block if it is not read yet. It touches only the next block, so
+		 * it can run while the current one is used.
+		 */
+		void prefetch();
+		
+		/**
+		 * Make the next block the current one.
+		 */
+		void nextBlock();
+		
+		/**
+		 * The examples of the current block.
+		 */
+		InputData* getBlock() { return _pBlock; }
+		
+		/**
+		 * The index of the first example of the current block in the file.
+		 */
+		long long getBlockFirstRow() const { return _blockFirstRow; }
+		
+		long long getNumRows() const { return _parser.getNumRows(); }
+		int       getNumClasses() const { return _parser.getClassMap().getNumNames(); }
+		const NameMap& getClassMap() const { return _parser.getClassMap(); }
+		
+		float* getMargins(long long row) { return _pMargins->getMargins(row); }
+		int&   getNumHypotheses(long long row) { return _pMargins->getNumHypotheses(row); }
+		
+		/**
+		 * Load examples with the header of the file.
+		 * \param pData The data to fill.
+		 * \param examples The examples, they are swapped into the data.
+		 * \see InputData::loadExamples
+		 */
+		void loadExamples(InputData* pData, vector<Example>& examples) const;
+		
+	private:
+		StreamingData(const StreamingData&);
+		StreamingData& operator=(const StreamingData&);
+		
+		const string        _fileName; //!< The parser keeps a reference to the names
+		const string        _headerFileName;
+		StreamingArffParser _parser;
+		MappedMargins*      _pMargins;
+		
+		InputData*          _pBlock;
+		long long           _blockFirstRow;
+		
+		vector<Example>     _nextExamples; //!< The prefetched block
+		long long           _nextFirstRow;
+		bool                _hasNextBlock;
+	};
+	
+	// -----------------------------------------------------------------------------
+	
+} // end of namespace MultiBoost
+
+#endif // __STREAMING_DATA_H
@@ -34,6 +34,7 @@
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <algorithm> // for fill
 
 #include "IO/TxtParser.h"
 #include "Utils/Utils.h"
@@ -42,6 +43,105 @@ namespace MultiBoost {
 	
 	// ------------------------------------------------------------------------
 	
+	TxtRowParser::TxtRowParser(int numAttributes, bool hasExampleName, bool hasClassEnd, const string& sepChars)
+	: _numAttributes(numAttributes), _hasExampleName(hasExampleName), _hasClassEnd(hasClassEnd)
+	{
+		fill( _isSeparator, _isSeparator + 256, false );
+		for (string::const_iterator it = sepChars.begin(); it != sepChars.end(); ++it)
+			_isSeparator[ static_cast<unsigned char>(*it) ] = true;
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	const char* TxtRowParser::nextToken(const char* p, const char* pEnd, const char*& pTokenEnd) const
+	{
+		while ( p != pEnd && _isSeparator[ static_cast<unsigned char>(*p) ] )
+			++p;
+		
+		pTokenEnd = p;
+		while ( pTokenEnd != pEnd && !_isSeparator[ static_cast<unsigned char>(*pTokenEnd) ] )
+			++pTokenEnd;
+		
+		return p;
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	bool TxtRowParser::isRow(const char* pLine, const char* pLineEnd) const
+	{
+		const char* pTokenEnd;
+		return nextToken(pLine, pLineEnd, pTokenEnd) != pLineEnd;
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	void TxtRowParser::beginChunks(int numChunks)
+	{
+		_chunkClassMaps.clear();
+		_chunkClassMaps.resize(numChunks);
+	}
+	
+	// ------------------------------------------------------------------------
+	
+	void TxtRowParser::parseRow(int chunkIdx, const char* pLine, const char* pLineEnd, Example& example)
+	{
+		const char* pTokenEnd;
+		const char* p = nextToken(pLine, pLineEnd, pTokenEnd);
+		
+		if (_hasExampleName)
+		{
+			example.setName( string(p, pTokenEnd) );
+			p = nextToken(pTokenEnd, pLineEnd, pTokenEnd);
+		}
+		
+		const char* pClass = p;
+		const char* pClassEnd = pTokenEnd;
+		if (!_hasClassEnd)
+			p = nextToken(pTokenEnd, pLineEnd, pTokenEnd);
+		
+		vector<FeatureReal>& values = example.getValues();
+		values.resize(_numAttributes);
+		
+		for (int j = 0; j < _numAttributes; ++j)
+		{
+			if ( p == pLineEnd )
+			{
+				cerr << "ERROR: A row has " << j << " values instead of " << _numAttributes << "!" << endl;
+				exit(1);
+			}
+			
+			bool ok;
+			values[j] = static_cast<FeatureReal>( ChunkedParser::parseReal(p, pTokenEnd, ok) );
+			if ( !ok )
+			{
+				cerr << "ERROR: The value <" << string(p, pTokenEnd) << "> is not a number!" << endl;
+				exit(1);
+			}
+			
+			p = nextToken(pTokenEnd, pLineEnd, pTokenEnd);
+		}
+		
+		if (_hasClassEnd)
+		{
+			pClass = p;
+			pClassEnd = pTokenEnd;
+		}
+		
+		if ( pClass == pClassEnd )
+		{
+			cerr << "ERROR: A row has no class!" << endl;
+			exit(1);
+		}
+		
+		Label label;
+		label.idx = _chunkClassMaps[chunkIdx].addName( string(pClass, pClassEnd) );
+		label.y = +1;
+		example.getLabels().push_back( label );
+	}
+	
+	// ------------------------------------------------------------------------
+	// ------------------------------------------------------------------------
+	
 	void TxtParser::readData( vector<Example>& examples, NameMap& classMap, 
 							 vector<NameMap>& enumMaps, NameMap& attributeNameMap,
 							 vector<RawData::eAttributeType>& attributeTypes )
@@ -75,73 +175,40 @@ namespace MultiBoost {
 			<< "or your separation option -d (if you are using it)" << endl;
 			exit(1);
 		}
+		inFile.close();
 		
-		inFile.clear(); // reset position
-		inFile.seekg(0);
+		cout << "Now reading file.." << flush;
 		
-		string tmpExampleName;
-		string tmpClassName;
+		MappedFile mappedFile(_fileName);
+		TxtRowParser rowParser(_numAttributes, _hasExampleName, _hasClassEnd, _sepChars);
+		vector<size_t> chunkRows;
+		ChunkedParser::parseRows(mappedFile.begin(), mappedFile.end(), rowParser, examples, &chunkRows);
+		const int numChunks = static_cast<int>( chunkRows.size() ) - 1;
 		
-		cout << "Counting rows.." << flush;
-		size_t numRows = nor_utils::count_rows(inFile);
-		
-		cout << "Allocating.." << flush;
-		try {
-			examples.resize(numRows);
-		} 
-		catch(...) {
-			cerr << "ERROR: Cannot allocate memory for storage!" << endl;
-			exit(1);
-		}
-		
-		cout << "Done!" << endl;
-		
-		cout << "Reading file.." << endl;
-		
-		/////////////////////////
-		size_t i;
-		for (i = 0; i < numRows; ++i)
+		// the class names of the chunks are added in the order of the file, so the
+		// indices are the same as with a sequential reading
+		vector< vector<int> > chunkClassIdxs( numChunks );
+		for ( int c = 0; c < numChunks; ++c )
 		{
-			if (_hasExampleName)
-				inFile >> tmpExampleName; // store file name
-			
-			if (!_hasClassEnd)
-				inFile >> tmpClassName; // store class
-			
-			Example& currExample = examples[i];
-			currExample.setName(tmpExampleName);
-			
-			vector<FeatureReal>& values = currExample.getValues();
-			values.resize(_numAttributes);
-			
-			for (int j = 0; j < _numAttributes; ++j)
-				inFile >> values[j]; // store values
-			
-			// to avoid problems in the case of an empty line at the end
-			// of the file
-			if ( inFile.eof() )
-				break;
-			
-			if (_hasClassEnd)
-				inFile >> tmpClassName; // store class
-			
-			int classIdx = classMap.addName(tmpClassName);
-			if ( classIdx > 1 )
+			const NameMap& chunkClassMap = rowParser.getClassMap(c);
+			for ( int k = 0; k < chunkClassMap.getNumNames(); ++k )
 			{
-				cerr << "ERROR: Only binary labels are accepted (max 2!) for .txt parser!!" << endl;
-				exit(1);
+				const int classIdx = classMap.addName( chunkClassMap.getNameFromIdx(k) );
+				if ( classIdx > 1 )
+				{
+					cerr << "ERROR: Only binary labels are accepted (max 2!) for .txt parser!!" << endl;
+					exit(1);
+				}
+				chunkClassIdxs[c].push_back( classIdx );
 			}
-			
-			currExample.addBinaryLabel(classIdx);
 		}
 		
-		if ( i != examples.size() )
+#pragma omp parallel for schedule(dynamic)
+		for ( int c = 0; c < numChunks; ++c )
 		{
-			cerr << "WARNING: Different number of read examples (" 
-			<< i << ") and lines (" 
-			<< examples.size() << ")!"  << endl;
-			
-			examples.resize(i);
+			const vector<int>& classIdxs = chunkClassIdxs[c];
+			for ( size_t i = chunkRows[c]; i < chunkRows[c + 1]; ++i )
+				examples[i].addBinaryLabel( classIdxs[ examples[i].getLabels()[0].idx ] );
 		}
 		
 		cout << "Done!" << endl;
@@ -39,11 +39,69 @@
 #define __TXT_PARSER_H
 
 #include "IO/GenericParser.h"
+#include "IO/ChunkedParser.h"
+#include "IO/NameMap.h"
 
 using namespace std;
 
 namespace MultiBoost {
 	
+	/**
+	 * The parser of the rows of the simple text files, used by ChunkedParser. The class
+	 * names are mapped in a NameMap per chunk, so the class of a parsed example is stored
+	 * in its first label with an index local to its chunk, until TxtParser maps it.
+	 * \date 17/10/2026
+	 */
+	class TxtRowParser
+	{
+	public:
+		/**
+		 * The constructor.
+		 * \param numAttributes The number of values of a row.
+		 * \param hasExampleName The first column is the name of the example.
+		 * \param hasClassEnd The class is in the last column instead of the first one.
+		 * \param sepChars The characters which separate the columns.
+		 */
+		TxtRowParser(int numAttributes, bool hasExampleName, bool hasClassEnd, const string& sepChars);
+		
+		/**
+		 * The lines with only separators are not rows.
+		 * \see ChunkedParser
+		 */
+		bool isRow(const char* pLine, const char* pLineEnd) const;
+		
+		/**
+		 * Set the number of chunks to parse, it resets the class names of the chunks.
+		 * \see ChunkedParser
+		 */
+		void beginChunks(int numChunks);
+		
+		/**
+		 * Parse a row. The name and the values are set, the class is stored as a 
+		 * single label with its local index.
+		 * \see ChunkedParser
+		 */
+		void parseRow(int chunkIdx, const char* pLine, const char* pLineEnd, Example& example);
+		
+		const NameMap& getClassMap(int chunkIdx) const { return _chunkClassMaps[chunkIdx]; }
+		
+	protected:
+		/**
+		 * Find the next column, as ChunkedParser::nextToken() but with the separators
+		 * given by the user.
+		 */
+		const char* nextToken(const char* p, const char* pEnd, const char*& pTokenEnd) const;
+		
+		int      _numAttributes;
+		bool     _hasExampleName;
+		bool     _hasClassEnd;
+		bool     _isSeparator[256]; //!< The separators, indexed by unsigned char
+		
+		vector<NameMap> _chunkClassMaps; //!< The class names of each chunk, in the order they appear
+	};
+	
+	// -----------------------------------------------------------------------------
+	
 	/**
 	 * Parse simple text data.
 	 * Here is an example of valid data (note: in this case the argument \b --examplelabel has been provided!):
@@ -60,6 +118,8 @@ namespace MultiBoost {
 	 * separator needs to be specified (for instance when the class name contains spaces), 
 	 * use the --d option.
 	 * \remark The TxtParser is STRICTLY single class (can have many classes but just one per example).
+	 * \remark Every example must be on a line of its own, the lines are parsed in parallel 
+	 * chunks by ChunkedParser.
 	 */
 	class TxtParser : public GenericParser
 	{
@@ -144,10 +144,10 @@ public:
    }
 
    inline void addLabels(vector<Label>& labels)
-   { swap(_labels, labels); } // should be done in constant time
+   { _labels.swap(labels); } // should be done in constant time
 
    inline void addValues(vector<FeatureReal>& values)
-   { swap(_values, values); } // should be done in constant time
+   { _values.swap(values); } // should be done in constant time
 
    inline const vector<Label>& getLabels() const { return _labels; }
    inline       vector<Label>& getLabels()       { return _labels; }
@@ -183,6 +183,20 @@ public:
 
    //////////////////////////////////////////////////////////////////////////
 
+   /**
+   * Exchange the content with another example in constant time.
+   */
+   inline void swap(Example& other)
+   {
+      _labels.swap(other._labels);
+      _values.swap(other._values);
+      _valIdxs.swap(other._valIdxs);
+      _valIdxsMap.swap(other._valIdxsMap);
+      _name.swap(other._name);
+   }
+
+   //////////////////////////////////////////////////////////////////////////
+
 private:
 
    /**
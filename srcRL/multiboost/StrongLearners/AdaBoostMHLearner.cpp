@@ -35,6 +35,7 @@
 #include <cmath> // for exp
 #include <fstream> // for ofstream of the step-by-step data
 #include <limits>
+#include <algorithm> // for min
 #include <iomanip> // setprecision
 
 #include "Utils/Utils.h" // for addAndCheckExtension
@@ -70,7 +71,17 @@ namespace MultiBoost {
 		else
 			_shypFileName = string(SHYP_NAME);
 
-		_shypFileName = nor_utils::addAndCheckExtension(_shypFileName, SHYP_EXTENSION);
+		///////////////////////////////////////////////////
+		// save the strong hypothesis in binary format, if given
+		if ( args.hasArgument("shypbin") )
+			args.getValue("shypbin", 0, _isShypBinary );
+		else
+			_isShypBinary = false;
+
+		if ( _isShypBinary )
+			_shypFileName = nor_utils::addAndCheckExtension(_shypFileName, SHYP_BINARY_EXTENSION);
+		else
+			_shypFileName = nor_utils::addAndCheckExtension(_shypFileName, SHYP_EXTENSION);
 
 		///////////////////////////////////////////////////
 		// get the output strong hypothesis file name, if given
@@ -208,7 +219,7 @@ namespace MultiBoost {
 		int startingIteration = resumeWeakLearners(pTrainingData);
 
 
-		Serialization ss(_shypFileName, _isShypCompressed );
+		Serialization ss(_shypFileName, _isShypCompressed, _isShypBinary );
 		ss.writeHeader(_baseLearnerName); // this must go after resumeProcess has been called
 
 		// perform the resuming if necessary. If not it will just return
@@ -477,64 +488,74 @@ namespace MultiBoost {
 	AlphaReal AdaBoostMHLearner::updateWeights(InputData* pData, BaseLearner* pWeakHypothesis)
 	{
 		const int numExamples = pData->getNumExamples();
-		const int numClasses = pData->getNumClasses();
 
 		const AlphaReal alpha = pWeakHypothesis->getAlpha();
 
 		AlphaReal Z = 0; // The normalization factor
-
-		_hy.resize(numExamples);
-		for ( int i = 0; i < numExamples; ++i) {
-			_hy[i].resize(numClasses);
-			fill( _hy[i].begin(), _hy[i].end(), 0.0 );
-		}
-		// recompute weights
-		// computing the normalization factor Z
-
-		// for each example
-		for (int i = 0; i < numExamples; ++i)
+		AlphaReal gamma = 0; // The edge
+
+		// Some learners (for example the sparse stumps) can classify all the examples at
+		// once, then h_l(x_i) = votes[l] * phis[i] and classify() is not called at all
+		vector<AlphaReal> votes, phis;
+		const bool isClassifiedAll = pWeakHypothesis->classifyAll(pData, votes, phis);
+
+		// A single pass computes h_l(x_i) * y_i once per label, the edge with the
+		// old weights and the unnormalized new weights w * exp( -alpha * h_l(x_i) * y_i ).
+		// Each example only touches its own labels, so the examples can be
+		// reweighted in parallel. Z and gamma are summed by chunks of a fixed size,
+		// each chunk in the example order, and then the chunks in their order: unlike
+		// an OpenMP reduction, the rounding does not depend on the number of threads,
+		// so the model is the same for any OMP_NUM_THREADS.
+		const int chunkSize = 1024;
+		const int numChunks = (numExamples + chunkSize - 1) / chunkSize;
+		vector<AlphaReal> chunkZ(numChunks, 0), chunkGamma(numChunks, 0);
+
+#pragma omp parallel for schedule(static)
+		for (int c = 0; c < numChunks; ++c)
 		{
-			vector<Label>& labels = pData->getLabels(i);
-			vector<Label>::iterator lIt;
+			const int last = min(numExamples, (c + 1) * chunkSize);
+			AlphaReal partialZ = 0;
+			AlphaReal partialGamma = 0;
 
-			for (lIt = labels.begin(); lIt != labels.end(); ++lIt )
+			for (int i = c * chunkSize; i < last; ++i)
 			{
-				_hy[i][lIt->idx] = pWeakHypothesis->classify(pData, i, lIt->idx) * // h_l(x_i)
-					lIt->y;
-				Z += lIt->weight * // w
-					exp( 
-					-alpha * _hy[i][lIt->idx] // -alpha * h_l(x_i) * y_i
-				);
-				// important!
-				// _hy[i] must be a vector with different sizes, depending on the
-				// example!
-				// so it will become:
-				// _hy[i][l] 
-				// where l is NOT the index of the label (lIt->idx), but the index in the 
-				// label vector of the example
+				vector<Label>& labels = pData->getLabels(i);
+				vector<Label>::iterator lIt;
+
+				for (lIt = labels.begin(); lIt != labels.end(); ++lIt )
+				{
+					const AlphaReal w = lIt->weight;
+					const AlphaReal h = isClassifiedAll ? votes[lIt->idx] * phis[i] :
+						pWeakHypothesis->classify(pData, i, lIt->idx); // h_l(x_i)
+					const AlphaReal hy = h * lIt->y;
+
+					partialGamma += w * hy;
+
+					const AlphaReal newWeight = w * exp( -alpha * hy ); // w * exp( -alpha * h_l(x_i) * y_i )
+					partialZ += newWeight;
+					lIt->weight = newWeight;
+				}
 			}
+
+			chunkZ[c] = partialZ;
+			chunkGamma[c] = partialGamma;
 		}
 
-		AlphaReal gamma = 0;
+		for (int c = 0; c < numChunks; ++c)
+		{
+			Z += chunkZ[c];
+			gamma += chunkGamma[c];
+		}
 
-		// Now do the actual re-weight
-		// (and compute the edge at the same time)
-		// for each example
+		// Now normalize the weights
+#pragma omp parallel for schedule(static)
 		for (int i = 0; i < numExamples; ++i)
 		{
 			vector<Label>& labels = pData->getLabels(i);
 			vector<Label>::iterator lIt;
 
 			for (lIt = labels.begin(); lIt != labels.end(); ++lIt )
-			{
-				AlphaReal w = lIt->weight;
-				gamma += w * _hy[i][lIt->idx];
-				//if ( gamma < -0.8 ) {
-				//	cout << gamma << endl;
-				//}
-				// The new weight is  w * exp( -alpha * h(x_i) * y_i ) / Z
-				lIt->weight = w * exp( -alpha * _hy[i][lIt->idx] ) / Z;
-			}
+				lIt->weight /= Z;
 		}
 
 
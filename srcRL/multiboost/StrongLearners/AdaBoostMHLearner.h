@@ -137,6 +137,8 @@ namespace MultiBoost {
          * with the classifier found at the current iteration (see BaseLearner::classify()), 
          * and \f$y_i\f$ is the binary label of that 
          * example, defined in InputData::getBinaryClass().
+         * The examples are reweighted in parallel (OpenMP), computing \f$h_\ell(x_i)\f$
+         * and the exponential once per label; Z and the edge are parallel reductions.
          * \param pTrainingData The pointer to the training data.
          * \param pWeakHypothesis The current weak hypothesis.
          * \return The value of the edge. It will be used to see if the algorithm can continue
@@ -209,6 +211,7 @@ namespace MultiBoost {
         string  _baseLearnerName; //!< The name of the basic learner used by AdaBoost. 
         string  _shypFileName; //!< File name of the strong hypothesis.
         bool	   _isShypCompressed; 
+        bool	   _isShypBinary; //!< The strong hypothesis is saved in the binary format
         
         string  _trainFileName;
         string  _testFileName;
@@ -246,7 +249,7 @@ namespace MultiBoost {
         AdaBoostMHLearner& operator=( const AdaBoostMHLearner& ) {return *this;}
         
         /**
-         * A temporary variable for h(x)*y. Helps saving time during re-weighting.
+         * The margins f(x) of the examples, filled by the OutputInfo version of updateWeights().
          */
         vector< vector<AlphaReal> > _hy;
         
@@ -3,12 +3,15 @@
 #include <fstream> // for ofstream of the step-by-step data
 #include <limits>
 #include <iomanip> // setprecision
+#include <typeinfo>
 
 #include "Utils/Utils.h" // for addAndCheckExtension
 #include "Defaults.h" // for defaultLearner
 #include "IO/OutputInfo.h"
 #include "Others/Rates.h"
 #include "IO/InputData.h"
+#include "IO/SortedData.h"
+#include "IO/StreamingData.h"
 #include "IO/Serialization.h" // to save the found strong hypothesis
 
 #include "WeakLearners/BaseLearner.h"
@@ -31,6 +34,28 @@ namespace MultiBoost {
 				cout << "--> Resampling size: " << _Cn << endl;
 		}
 
+		// Read the training file block by block
+		if ( args.hasArgument("filterstream") )
+		{
+			int blockSize; // in megabytes
+			args.getValue("filterstream", 0, blockSize);
+			if ( blockSize <= 0 )
+			{
+				cerr << "ERROR: The block size of --filterstream must be positive!" << endl;
+				exit(1);
+			}
+			_streamBlockSize = static_cast<size_t>(blockSize) << 20;
+
+			if ( !args.hasArgument("fileformat") || args.getValue<string>("fileformat") != "arff" )
+			{
+				cerr << "ERROR: --filterstream needs the arff file format (--fileformat arff)!" << endl;
+				exit(1);
+			}
+
+			if ( args.hasArgument("marginfile") )
+				args.getValue("marginfile", 0, _marginFileName);
+		}
+
 	}
 
 	// -----------------------------------------------------------------------------------
@@ -40,6 +65,12 @@ namespace MultiBoost {
 		// load the arguments
 		this->getArgs(args);
 
+		if ( _streamBlockSize > 0 )
+		{
+			runStreaming(args);
+			return;
+		}
+
 		time_t startTime, currentTime;
 		time(&startTime);
 
@@ -124,7 +155,7 @@ namespace MultiBoost {
 		int startingIteration = resumeWeakLearners(pTrainingData);
 
 
-		Serialization ss(_shypFileName, _isShypCompressed );
+		Serialization ss(_shypFileName, _isShypCompressed, _isShypBinary );
 		ss.writeHeader(_baseLearnerName); // this must go after resumeProcess has been called
 
 		// perform the resuming if necessary. If not it will just return
@@ -251,6 +282,187 @@ namespace MultiBoost {
 
 	// -------------------------------------------------------------------------
 
+	void FilterBoostLearner::runStreaming(const nor_utils::Args& args)
+	{
+		time_t startTime, currentTime;
+		time(&startTime);
+
+		if ( !_resumeShypFileName.empty() )
+		{
+			cerr << "ERROR: The training cannot be resumed with --filterstream!" << endl;
+			exit(1);
+		}
+
+		// get the registered weak learner (type from name)
+		BaseLearner* pWeakHypothesisSource = 
+			BaseLearner::RegisteredLearners().getLearner(_baseLearnerName);
+		pWeakHypothesisSource->initLearningOptions(args);
+
+		BaseLearner* pConstantWeakHypothesisSource = 
+			BaseLearner::RegisteredLearners().getLearner("ConstantLearner");
+
+		// the training examples, they are read block by block
+		StreamingData* pStream = new StreamingData(_trainFileName, "", _streamBlockSize, _marginFileName, _verbose);
+		_streamPos = 0;
+
+		// the filtered examples are loaded into the same object in every iteration, 
+		// since the weak hypotheses keep their training data
+		InputData* pTrainingData = pWeakHypothesisSource->createInputData();
+		if ( typeid(*pTrainingData) != typeid(InputData) && typeid(*pTrainingData) != typeid(SortedData) )
+		{
+			cerr << "ERROR: The weak learner " << _baseLearnerName << " cannot be trained with --filterstream!" << endl;
+			exit(1);
+		}
+		pTrainingData->initOptions(args);
+
+		// get the testing input data, and load it
+		InputData* pTestData = NULL;
+		if ( !_testFileName.empty() )
+		{
+			pTestData = pWeakHypothesisSource->createInputData();
+			pTestData->initOptions(args);
+			pTestData->load(_testFileName, IT_TEST, _verbose);
+		}
+
+		// The output information object, the training data is never loaded as a 
+		// whole, so only the test data is evaluated
+		OutputInfo* pOutInfo = NULL;
+		if ( !_outputInfoFile.empty() ) 
+		{
+			pOutInfo = new OutputInfo(_outputInfoFile);
+			if (pTestData)
+				pOutInfo->initialize(pTestData);
+			pOutInfo->outputHeader(pStream->getClassMap());
+		}
+
+		Serialization ss(_shypFileName, _isShypCompressed, _isShypBinary );
+		ss.writeHeader(_baseLearnerName);
+
+		if (_verbose == 1)
+			cout << "Learning in progress..." << endl;
+
+		///////////////////////////////////////////////////////////////////////
+		// Starting the AdaBoost main loop
+		///////////////////////////////////////////////////////////////////////
+		for (int t = 0; t < _numIterations; ++t)
+		{
+			if (_verbose > 1)
+				cout << "------- WORKING ON ITERATION " << (t+1) << " -------" << endl;
+
+			filter( pStream, pTrainingData, (int)(_Cn * log(t+2.0)) );
+			if ( pTrainingData->getNumExamples() < 2 ) 
+			{
+				filter( pStream, pTrainingData, (int)(_Cn * log(t+2.0)), false );
+			}
+
+			if (_verbose > 1)
+			{
+				cout << "--> Size of training data = " << pTrainingData->getNumExamples() << endl;
+			}
+
+			BaseLearner* pWeakHypothesis = pWeakHypothesisSource->create();
+			pWeakHypothesis->initLearningOptions(args);
+			pWeakHypothesis->setTrainingData(pTrainingData);
+			AlphaReal energy = pWeakHypothesis->run();
+
+			BaseLearner* pConstantWeakHypothesis;
+			pConstantWeakHypothesis = pConstantWeakHypothesisSource->create() ;
+			pConstantWeakHypothesis->initLearningOptions(args);
+			pConstantWeakHypothesis->setTrainingData(pTrainingData);
+			pConstantWeakHypothesis->run();
+
+			//estimate edge
+			filter( pStream, pTrainingData, (int)(_Cn * log(t+2.0)), false );
+			AlphaReal edge = pWeakHypothesis->getEdge() / 2.0;
+
+			AlphaReal constantEdge = pConstantWeakHypothesis->getEdge() / 2.0;
+			if ( constantEdge > edge )
+			{
+				delete pWeakHypothesis;
+				pWeakHypothesis = pConstantWeakHypothesis;
+				edge = constantEdge;
+			} else {
+				delete pConstantWeakHypothesis;
+			}
+
+			// calculate alpha
+			AlphaReal alpha = 0.5 * log( ( 1 + edge ) / ( 1 - edge ) );
+			pWeakHypothesis->setAlpha( alpha );
+
+			if (_verbose > 1)
+				cout << "Weak learner: " << pWeakHypothesis->getName()<< endl;
+
+			// Output the step-by-step information
+			if ( pOutInfo )
+			{
+				if ( pTestData )
+					printOutputInfo(pOutInfo, t, pTestData, NULL, pWeakHypothesis);
+				else
+				{
+					pOutInfo->outputIteration(t);
+					pOutInfo->outputCurrentTime();
+					pOutInfo->endLine();
+				}
+			}
+
+			// Updates the weights of the filtered examples and returns the edge
+			AlphaReal gamma = updateWeights(pTrainingData, pWeakHypothesis);
+
+			if (_verbose > 1)
+			{
+				cout << setprecision(5)
+					<< "--> Alpha = " << pWeakHypothesis->getAlpha() << endl
+					<< "--> Edge  = " << gamma << endl
+					<< "--> Energy  = " << energy << endl;
+			}
+
+			// append the current weak learner to strong hypothesis file,
+			// that is, serialize it.
+			ss.appendHypothesis(t, pWeakHypothesis);
+
+			// Add it to the internal list of weak hypotheses, the margins of the
+			// examples are updated with it when they are visited
+			_foundHypotheses.push_back(pWeakHypothesis); 
+
+			// check if the time limit has been reached
+			if (_maxTime > 0)
+			{
+				time( &currentTime );
+				float diff = difftime(currentTime, startTime); // difftime is in seconds
+				diff /= 60; // = minutes
+
+				if (diff > _maxTime)
+				{
+					if (_verbose > 0)
+						cout << "Time limit of " << _maxTime 
+						<< " minutes has been reached!" << endl;
+					break;     
+				}
+			} // check for maxtime
+		}  // loop on iterations
+		/////////////////////////////////////////////////////////
+
+		// write the footer of the strong hypothesis file
+		ss.writeFooter();
+
+		for (vector<BaseLearner*>::iterator it = _foundHypotheses.begin(); it != _foundHypotheses.end(); ++it)
+			delete *it;
+		_foundHypotheses.clear();
+
+		delete pStream;
+		delete pTrainingData;
+		if (pTestData)
+			delete pTestData;
+
+		if (pOutInfo)
+			delete pOutInfo;
+
+		if (_verbose > 0)
+			cout << "Learning completed." << endl;
+	}
+
+	// -------------------------------------------------------------------------
+
 	void FilterBoostLearner::resumeProcess(Serialization& ss, 
 		InputData* pTrainingData, InputData* pTestData, 
 		OutputInfo* pOutInfo)
@@ -452,6 +664,137 @@ namespace MultiBoost {
 		}
 	}
 	// -------------------------------------------------------------------------
+
+	void FilterBoostLearner::filter( StreamingData* pStream, InputData* pData, int size, bool rejection )
+	{
+		vector<Example> sample;
+		vector<long long> sampleRows; // the row of the examples in the file
+		sample.reserve( size );
+		sampleRows.reserve( size );
+
+		// after five passes over the data every example is accepted
+		const long long maxVisited = 5 * pStream->getNumRows();
+		long long numVisited = 0;
+
+		while ( (int)sample.size() < size )
+		{
+			if ( numVisited > maxVisited ) rejection = false;
+			if ( _streamPos == pStream->getBlock()->getNumExamples() )
+			{
+				pStream->nextBlock();
+				_streamPos = 0;
+			}
+
+			int numBlockVisited = 0;
+
+			// the next block is read while the current one is filtered
+#pragma omp parallel sections num_threads(2)
+			{
+#pragma omp section
+				pStream->prefetch();
+#pragma omp section
+				numBlockVisited = filterBlock( pStream, sample, sampleRows, size, rejection );
+			}
+
+			numVisited += numBlockVisited;
+		}
+
+		// the weights are set after the loading, which initializes them
+		pStream->loadExamples( pData, sample );
+
+		// normalize the weights of the labels
+		AlphaReal sum = 0.0;
+		for ( int i = 0; i < pData->getNumExamples(); ++i )
+		{
+			const float* margins = pStream->getMargins( sampleRows[i] );
+			vector<Label>& labels = pData->getLabels(i);
+			vector<Label>::iterator lIt;
+
+			for (lIt = labels.begin(); lIt != labels.end(); ++lIt )
+			{
+				lIt->weight = 1 /( 1+exp( margins[lIt->idx] ) );
+				sum += lIt->weight;
+			}
+		}
+
+		for ( int i = 0; i < pData->getNumExamples(); ++i )
+		{
+			vector<Label>& labels = pData->getLabels(i);
+			vector<Label>::iterator lIt;
+
+			for (lIt = labels.begin(); lIt != labels.end(); ++lIt )
+			{
+				lIt->weight /= sum;
+			}
+		}
+	}
+
+	// -------------------------------------------------------------------------
+
+	int FilterBoostLearner::filterBlock( StreamingData* pStream, vector<Example>& sample, 
+										 vector<long long>& sampleRows, int size, bool rejection )
+	{
+		InputData* pBlock = pStream->getBlock();
+		const int numBlockExamples = pBlock->getNumExamples();
+		const int numClasses = pBlock->getNumClasses();
+		int numVisited = 0;
+
+		for ( ; _streamPos < numBlockExamples && (int)sample.size() < size; ++_streamPos, ++numVisited )
+		{
+			const long long row = pStream->getBlockFirstRow() + _streamPos;
+			updateMargins( pStream, _streamPos );
+
+			if ( rejection )
+			{
+				const float* margins = pStream->getMargins( row );
+				const vector<Label>& labels = pBlock->getLabels( _streamPos );
+				vector<Label>::const_iterator lIt;
+
+				AlphaReal scalar = 0.0;
+				for ( lIt = labels.begin(); lIt != labels.end(); ++lIt ) 
+					scalar += (1 / ( 1 + exp(margins[lIt->idx])));
+
+				AlphaReal qValue = scalar / (AlphaReal) numClasses;
+				AlphaReal randNum = (AlphaReal)rand() / RAND_MAX;
+
+				if ( randNum >= qValue ) continue;
+			}
+
+			sample.push_back( pBlock->getExample( _streamPos ) );
+			sampleRows.push_back( row );
+		}
+
+		return numVisited;
+	}
+
+	// -------------------------------------------------------------------------
+
+	void FilterBoostLearner::updateMargins( StreamingData* pStream, int blockIdx )
+	{
+		InputData* pBlock = pStream->getBlock();
+		const long long row = pStream->getBlockFirstRow() + blockIdx;
+		float* margins = pStream->getMargins( row );
+		int& numHypotheses = pStream->getNumHypotheses( row );
+
+		const vector<Label>& labels = pBlock->getLabels( blockIdx );
+		vector<Label>::const_iterator lIt;
+
+		for ( ; numHypotheses < (int)_foundHypotheses.size(); ++numHypotheses )
+		{
+			BaseLearner* pWeakHypothesis = _foundHypotheses[numHypotheses];
+
+			for (lIt = labels.begin(); lIt != labels.end(); ++lIt )
+			{
+				AlphaReal hy =  pWeakHypothesis->classify(pBlock, blockIdx, lIt->idx) * // h_l(x_i)
+					lIt->y; // y
+
+				// compute the margin
+				margins[lIt->idx] += pWeakHypothesis->getAlpha() * hy;
+			}
+		}
+	}
+
+	// -------------------------------------------------------------------------
 	
 } // end of namespace MultiBoost
 
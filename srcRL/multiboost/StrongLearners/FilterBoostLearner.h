@@ -41,6 +41,7 @@
 #include "StrongLearners/GenericStrongLearner.h"
 #include "StrongLearners/AdaBoostMHLearner.h"
 #include "Utils/Args.h"
+#include "IO/StreamingData.h"
 
 using namespace std;
 
@@ -75,7 +76,7 @@ namespace MultiBoost {
 		* using the helpers provided by class Args. The constant learner is switched on by default.
 		* \date 13/11/2005
 		*/
-		FilterBoostLearner() : AdaBoostMHLearner(), _Cn(300) {}
+		FilterBoostLearner() : AdaBoostMHLearner(), _Cn(300), _streamBlockSize(0), _streamPos(0) {}
 
 		/**
 		* Start the learning process.
@@ -103,6 +104,15 @@ namespace MultiBoost {
         void resumeProcess(Serialization& ss, InputData* pTrainingData, InputData* pTestData, 
                            OutputInfo* pOutInfo);
 		
+		/**
+		 * The learning process with --filterstream. The training file is read block by
+		 * block, and only the filtered examples are loaded, so the memory does not depend
+		 * on the size of the training file. The margins are in a MappedMargins.
+		 * \param args The arguments provided by the command line.
+		 * \see StreamingData
+		 */
+		void runStreaming(const nor_utils::Args& args);
+		
 		
 	private:
 		/**
@@ -120,10 +130,42 @@ namespace MultiBoost {
 		*/
 		void filter( InputData* pData, int size, bool rejection = true );
 		void updateMargins( InputData* pData, BaseLearner* pWeakHypothesis );
+		/**
+		 * The filter function of the streaming data. It visits the examples in the order
+		 * of the file from where the previous call stopped.
+		 * \param pStream The training examples.
+		 * \param pData The data which receives the filtered examples.
+		 * \see filter
+		 */
+		void filter( StreamingData* pStream, InputData* pData, int size, bool rejection = true );
+		/**
+		 * Filter the examples of the current block from _streamPos until the sample is full.
+		 * \param sampleRows The rows of the accepted examples in the file.
+		 * \return The number of visited examples.
+		 */
+		int filterBlock( StreamingData* pStream, vector<Example>& sample, vector<long long>& sampleRows, 
+						 int size, bool rejection );
+		/**
+		 * Add the weak hypotheses found since the last visit to the margins of an example
+		 * of the current block.
+		 */
+		void updateMargins( StreamingData* pStream, int blockIdx );
 		/**
 		* The size of subset will be used for training the base learner
 		*/
 		int _Cn;
+		/**
+		 * The number of bytes read at once with --filterstream, 0 if the training data is loaded.
+		 */
+		size_t _streamBlockSize;
+		/**
+		 * The file of the margins with --filterstream.
+		 */
+		string _marginFileName;
+		/**
+		 * The next example of the current block to filter.
+		 */
+		int _streamPos;
 	};
 
 } // end of namespace MultiBoost
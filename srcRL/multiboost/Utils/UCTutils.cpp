@@ -40,8 +40,8 @@ namespace MultiBoost {
 
 // ----------------------------------------------------------------
 
-int	NodeUCTSparse::_depth = 0;
-int	NodeUCTSparse::_branchOrder = 0;
+int	UCTTree::_depth = 0;
+int	UCTTree::_branchOrder = 0;
 
 // ----------------------------------------------------------------
 
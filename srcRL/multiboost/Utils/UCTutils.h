@@ -45,6 +45,8 @@
 #include <fstream>
 #include <cassert>
 #include <math.h>
+#include <limits>
+#include <cstdlib> // for rand
 
 using namespace std;
 
@@ -64,168 +66,110 @@ namespace MultiBoost {
 	};
 
 	
-	class NodeUCTSparse;
-	class InnerNodeUCTSparse;
-	class LeafNodeUCTSparse;
-
-	class NodeUCTSparse {
+	/**
+	 * The UCT tree over the trajectories of _depth arms, each arm out of _branchOrder.
+	 * The nodes are kept in a pool of contiguous arrays and are referred to by their
+	 * index, the root being the node 0. They are created lazily, when a trajectory
+	 * reaches them for the first time. The children of a node are chained through 
+	 * _nextSibling in the order of their arm, so a node costs the same whatever the 
+	 * branch order is.
+	 * \date 17/10/2026
+	 */
+	class UCTTree {
 	protected:
-		NodeUCTSparse*		_parent;		
-		int					_featureID;
-		int					_ni;
-		double				_Xini;
-		int					_myDepth;
+		vector<int>			_ni; //!< the number of visits of the nodes
+		vector<double>		_Xini; //!< the sum of the rewards of the nodes
+		vector<int>			_arm; //!< the arm which leads to the node from its parent
+		vector<int>			_firstChild; //!< the child with the smallest arm, -1 if none
+		vector<int>			_nextSibling; //!< the child of the parent with the next arm, -1 if none
 
 		static int			_depth;
 		static int			_branchOrder;
 
 	public:
-
-		virtual bool isLeaf() = 0;
-		bool isRoot() { 
-			if ( _parent == 0 ) return true;
-			else return false;
-		}
-
-		NodeUCTSparse() : _parent( 0 ), _ni( 1 ), _Xini( INITIAL_X ), _myDepth(0) {}
-
-		//virtual double getUpperConfidenceBound() = 0;
-
-		virtual int getNi() { return _ni; }
-		virtual double getXini() { return _Xini / ((double)_ni); }
-		virtual void incNi() { _ni++; }
-		virtual NodeUCTSparse* getParent() { return _parent; }
-		virtual void addValue( double val ) { _Xini += val; }
-
-		virtual double getUpperConfidenceBound() {
-			return getXini() + sqrt( ( 2 * log( (double) _parent->getNi() )) / _ni );
-		}
-		virtual NodeUCTSparse* getithChild( int num ) = 0;
-		virtual void clearInnerNodeChild() = 0;
-		virtual int getNumOfChild() = 0;
-
-		virtual int getChildIndWithMaxBi() = 0;
-		static void setDepth( int d ) { NodeUCTSparse::_depth = d; }
-		static int getDepth() { return NodeUCTSparse::_depth; }
-
-		static void setBranchOrder( int bo ) { NodeUCTSparse::_branchOrder = bo; }
-
-		virtual int getMyDepth() { return _myDepth; }
-		virtual void setMyDepth( int d ) { _myDepth = d; }
-	};
-
-	class LeafNodeSparse : public NodeUCTSparse {
-	public:
-		LeafNodeSparse() : NodeUCTSparse() {}
-		LeafNodeSparse( NodeUCTSparse* n) : NodeUCTSparse() {
-			_parent = n;
-			setMyDepth( n->getMyDepth() + 1 );
-		}
-
-		virtual bool isLeaf() { return true; }
-		
-		virtual NodeUCTSparse* getithChild( int num ) { return 0; }
-		virtual void clearInnerNodeChild() {}
-		virtual int getNumOfChild() {return 0;}
-		virtual int getChildIndWithMaxBi() {return -1; }
-	};
-
-	class InnerNodeUCTSparse : public NodeUCTSparse {
-	protected:
-		vector<NodeUCTSparse*>	_children;
-	public:
-		virtual bool isLeaf() { return false; }
-		
-		InnerNodeUCTSparse() : NodeUCTSparse() { 
-			_children.resize( _branchOrder );
-			for( int i = 0; i < _branchOrder; i++ ) _children[i]=0;
-			//fill( _children.begin(), _children.end(), 0 );
-			setMyDepth( 0 ); //root
-		}
-
-		InnerNodeUCTSparse( NodeUCTSparse* n) : NodeUCTSparse() {
-			_children.resize( _branchOrder );
-			for( int i = 0; i < _branchOrder; i++ ) _children[i]=0;
-			_parent = n;
-			setMyDepth( n->getMyDepth() + 1 );
-		}
-
-		virtual void createInnerNodeChild( int num ) {
-			_children.resize( num );
-			for( int i = 0; i < num; i++ ) {
-				_children[i] = new InnerNodeUCTSparse( (NodeUCTSparse*) this );
-			}
-		}
-
-		virtual void createInnerNodeOneChild( int num ) {
-			if ( _children[num] == 0 )
-				_children[num] = new InnerNodeUCTSparse( (NodeUCTSparse*) this );
-		}
-
-		virtual void createLeafNodeChild( int num ) {
-			_children.resize( num );
-			for( int i = 0; i < num; i++ ) {
-				_children[i] = new LeafNodeSparse( (NodeUCTSparse*) this );
+		UCTTree() { setChildrenNum(); }
+
+		static void setDepth( int d ) { UCTTree::_depth = d; }
+		static int getDepth() { return UCTTree::_depth; }
+
+		static void setBranchOrder( int bo ) { UCTTree::_branchOrder = bo; }
+
+		int getNumOfNodes() { return (int)_ni.size(); }
+
+		/**
+		 * Drops all the nodes but the root.
+		 */
+		void setChildrenNum() {
+			_ni.assign( 1, 1 );
+			_Xini.assign( 1, INITIAL_X );
+			_arm.assign( 1, -1 );
+			_firstChild.assign( 1, -1 );
+			_nextSibling.assign( 1, -1 );
+		}
+
+		void clearRecursiveUCTTree() { setChildrenNum(); }
+
+		/**
+		 * Returns the child of \a node reached by \a arm, -1 if it is not created yet.
+		 */
+		int getChild( int node, int arm ) {
+			int child = _firstChild[node];
+			while ( child >= 0 && _arm[child] < arm ) child = _nextSibling[child];
+			if ( child >= 0 && _arm[child] == arm ) return child;
+			else return -1;
+		}
+
+		/**
+		 * Returns the child of \a node reached by \a arm, it is created if needed.
+		 */
+		int createChild( int node, int arm ) {
+			int prev = -1;
+			int child = _firstChild[node];
+			while ( child >= 0 && _arm[child] < arm ) {
+				prev = child;
+				child = _nextSibling[child];
 			}
-		}
+			if ( child >= 0 && _arm[child] == arm ) return child;
 
-		virtual void createLeafNodeOneChild( int num ) {
-			if ( _children[num] == 0 )
-				_children[num] = new LeafNodeSparse( (NodeUCTSparse*) this );
-		}
+			const int newNode = (int)_ni.size();
+			_ni.push_back( 1 );
+			_Xini.push_back( INITIAL_X );
+			_arm.push_back( arm );
+			_firstChild.push_back( -1 );
+			_nextSibling.push_back( child );
 
+			if ( prev >= 0 ) _nextSibling[prev] = newNode;
+			else _firstChild[node] = newNode;
 
-		virtual void clearInnerNodeChild() {
-			for( int i = 0; i < (int)_children.size(); i++ ) {
-				if ( _children[i] ) delete _children[i];
-			}		
+			return newNode;
 		}
 
-		virtual bool hasIthChild( int num ) {
-			if ( _children[num] != 0 ) return true;
-			else return false;
+		/**
+		 * Builds every node of the tree at once, down to \a depth levels below the root.
+		 * \remark The nodes are created anyway when they are visited, this is only
+		 * useful to pay the allocation upfront.
+		 */
+		void createRecursiveUCTTree( int depth, int numOfChilds ) {
+			createRecursiveUCTTree( 0, depth, numOfChilds );
 		}
 
-		virtual NodeUCTSparse* getithChild( int num ) { return _children[num]; }
-		virtual int getNumOfChild() {return (int)_children.size();}
-
-		virtual void createRecursiveUCTTree( int depth, int numOfChilds ) {
-			if ( depth == 1 ) {
-				createLeafNodeChild( numOfChilds );
-				return;
-			} else {
-				createInnerNodeChild( numOfChilds );
-				for ( int i = 0; i < numOfChilds; i++ ) {
-					((InnerNodeUCTSparse* )getithChild( i ))->createRecursiveUCTTree( depth - 1, numOfChilds );
-				}
-			}
-		}
-
-		virtual void setChildrenNum() { 
-			_children.resize( _branchOrder ); 
-			for( int i = 0; i < _branchOrder; i++ ) _children[i]=0;
-			//fill( _children.begin(), _children.end(), 0 );
-		} 
-
-		virtual void clearRecursiveUCTTree( ) {
-			if ( isLeaf() ) {
-				return;
-			} else {
-				for ( int i = 0; i < getNumOfChild(); i++ ) {
-					InnerNodeUCTSparse* currNode = (InnerNodeUCTSparse* )getithChild( i );
-					if ( currNode != 0 ) currNode->clearRecursiveUCTTree( );
-				}
-				clearInnerNodeChild();
-			}
-		}
+		/**
+		 * The arm with the largest upper confidence bound under \a node. The arms
+		 * without a node get a random value, drawn in the order of the arms.
+		 */
+		int getChildIndWithMaxBi( int node ) {
+			const double twoLogNi = 2 * log( (double) _ni[node] );
+			int child = _firstChild[node];
 
-		virtual int getChildIndWithMaxBi() {
 			int retVal = 0;
 			double ucb = 0.0;
 			double maxB = numeric_limits< double >::min();
-			for( int i = 0; i < getNumOfChild(); i++ ) {
-				if ( _children[i] != 0 ) ucb = _children[i]->getUpperConfidenceBound();
-				else ucb = ((double) rand() / (double )RAND_MAX ) + sqrt( ( 2 * log( (double) getNi() )) / 1.0 );
+			for( int i = 0; i < _branchOrder; i++ ) {
+				if ( child >= 0 && _arm[child] == i ) {
+					ucb = _Xini[child] / ((double)_ni[child]) + sqrt( twoLogNi / _ni[child] );
+					child = _nextSibling[child];
+				}
+				else ucb = ((double) rand() / (double )RAND_MAX ) + sqrt( twoLogNi / 1.0 );
 				if ( maxB < ucb ) {
 					retVal = i;
 					maxB = ucb;
@@ -234,61 +178,36 @@ namespace MultiBoost {
 			return retVal;
 		}
 
-
-		virtual void getBestTrajectory( vector< int >& trajectory){
+		void getBestTrajectory( vector< int >& trajectory ) {
 			trajectory.clear();
 
-			int bInd; 
-			
-			/*
-			bInd = getChildIndWithMaxBi();
-			trajectory.push_back( bInd );
-
-			if ( hasIthChild( bInd ) ) { 
-				if ( trajectory.size() == ( _depth - 1 ) ) 
-					createLeafNodeOneChild( bInd );
-				else
-					createInnerNodeOneChild( bInd );
-			}
-				
-			InnerNodeUCTSparse* currNode = getithChild( bInd );
-			*/
-
-			InnerNodeUCTSparse* currNode = this;
-			
-
+			int currNode = 0;
 			while ( 1 ) {
-				bInd = currNode->getChildIndWithMaxBi();
+				const int bInd = getChildIndWithMaxBi( currNode );
 				trajectory.push_back( bInd );
 
-				if ( ! currNode->hasIthChild( bInd ) ) { 
-					if ( trajectory.size() == ( _depth  ) )  {
-						currNode->createLeafNodeOneChild( bInd );
-						break;
-					} else
-						currNode->createInnerNodeOneChild( bInd );
-				} else { 
-					if ( currNode->getithChild( bInd )->isLeaf() ) break;
-				}
-
-
-				currNode = ( InnerNodeUCTSparse* )currNode->getithChild( bInd );
-				
+				// the nodes at depth _depth are the leaves
+				currNode = createChild( currNode, bInd );
+				if ( trajectory.size() == ( _depth ) ) break;
 			}
 		}
 
 		void updateInnerNodes( double updateValue, vector< int >& trajectory ) {
-			NodeUCTSparse* currNode = this;
+			int currNode = 0;
 			for( int i=0; i < (int)trajectory.size(); i++ ) {
-				currNode = currNode->getithChild( trajectory[i] );
-				currNode->addValue( updateValue );
-				currNode->incNi();
-
+				currNode = createChild( currNode, trajectory[i] );
+				_Xini[currNode] += updateValue;
+				_ni[currNode]++;
 			}
-
 		}
 
-
+	protected:
+		void createRecursiveUCTTree( int node, int depth, int numOfChilds ) {
+			for ( int i = 0; i < numOfChilds; i++ ) {
+				const int child = createChild( node, i );
+				if ( depth > 1 ) createRecursiveUCTTree( child, depth - 1, numOfChilds );
+			}
+		}
 	};
 
 //////////////////////////////////////////////////////////////////////////
@@ -131,6 +131,34 @@ namespace MultiBoost {
 											   "class", _v);
 	}
 	
+	// -----------------------------------------------------------------------
+	
+	void AbstainableLearner::saveBinary(ofstream& outputStream)
+	{
+		// Calling the super-class method
+		BaseLearner::saveBinary(outputStream);
+		
+		// save the vote vector
+		const int numClasses = static_cast<int>( _v.size() );
+		Serialization::writeBinary( outputStream, numClasses );
+		for (int l = 0; l < numClasses; ++l)
+			Serialization::writeBinary( outputStream, static_cast<double>(_v[l]) );
+	}
+	
+	// -----------------------------------------------------------------------
+	
+	void AbstainableLearner::loadBinary(BinaryShypReader& reader)
+	{
+		// Calling the super-class method
+		BaseLearner::loadBinary(reader);
+		
+		// load the vote vector, the classes are in the order of the saved class map
+		const int numClasses = reader.read<int>();
+		_v.resize(numClasses);
+		for (int l = 0; l < numClasses; ++l)
+			_v[ reader.getClassIdx(l) ] = static_cast<AlphaReal>( reader.read<double>() );
+	}
+	
 	// ------------------------------------------------------------------------------
 	
 	AlphaReal AbstainableLearner::getEnergy(vector<sRates>& mu, AlphaReal& alpha, vector<AlphaReal>& v)
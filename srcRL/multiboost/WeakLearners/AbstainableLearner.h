@@ -149,6 +149,20 @@ public:
    */
    virtual void load(nor_utils::StreamTokenizer& st);
 
+   /**
+   * Save \a _v in the binary strong hypothesis format.
+   * \param outputStream The stream of the binary file
+   * \see BaseLearner::saveBinary()
+   */
+   virtual void saveBinary(ofstream& outputStream);
+
+   /**
+   * Load \a _v from the binary strong hypothesis format.
+   * \param reader The reader of the block of the hypothesis
+   * \see BaseLearner::loadBinary()
+   */
+   virtual void loadBinary(BinaryShypReader& reader);
+
    /**
    * Copy all the info we need in classify().
    * pBaseLearner was created by subCreate so it has the correct (sub) type.
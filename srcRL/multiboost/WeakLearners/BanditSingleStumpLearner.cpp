@@ -264,17 +264,7 @@ namespace MultiBoost {
 		// when theta=0.
 		setSmoothingVal( (AlphaReal) 1.0 / (AlphaReal)_pTrainingData->getNumExamples() * (AlphaReal)0.01 );
 
-		vector<sRates> mu(numClasses); // The class-wise rates. See BaseLearner::sRates for more info.
-		vector<AlphaReal> tmpV(numClasses); // The class-wise votes/abstentions
-
-		AlphaReal tmpThreshold;
-		AlphaReal tmpAlpha;
-
 		AlphaReal bestEnergy = numeric_limits<float>::max();
-		AlphaReal tmpEnergy;
-
-		StumpAlgorithm<FeatureReal> sAlgo(numClasses);
-		sAlgo.initSearchLoop(_pTrainingData);
 
 		AlphaReal halfTheta;
 		if ( _abstention == ABST_REAL || _abstention == ABST_CLASSWISE )
@@ -294,37 +284,54 @@ namespace MultiBoost {
 			cout << "error" << endl;
 		}
 
-		for( int i = 0; i < (int)_armsForPulling.size(); i++ ) {
-			//columnIndices[i] = p.second;			
+		const int numArms = (int)_armsForPulling.size();
+		SortedData* pSortedData = static_cast<SortedData*>(_pTrainingData);
 
-			const pair<vpIterator,vpIterator> dataBeginEnd = 
-				static_cast<SortedData*>(_pTrainingData)->getFileteredBeginEnd( _armsForPulling[i] );
+		// the stump of every pulled arm, filled by the threads
+		vector<FeatureReal> thresholds( numArms );
+		vector<AlphaReal> energies( numArms );
+		vector<AlphaReal> alphas( numArms );
+		vector< vector<AlphaReal> > votes( numArms );
 
+#pragma omp parallel
+		{
+			vector<sRates> mu(numClasses); // The class-wise rates. See BaseLearner::sRates for more info.
+			vector<AlphaReal> tmpV(numClasses); // The class-wise votes/abstentions
 
-			const vpIterator dataBegin = dataBeginEnd.first;
-			const vpIterator dataEnd = dataBeginEnd.second;
+			StumpAlgorithm<FeatureReal> sAlgo(numClasses);
+			sAlgo.initSearchLoop(_pTrainingData);
 
-			// also sets mu, tmpV, and bestHalfEdge
-			tmpThreshold = sAlgo.findSingleThresholdWithInit(dataBegin, dataEnd, _pTrainingData, 
-				halfTheta, &mu, &tmpV);
+#pragma omp for schedule(dynamic)
+			for( int i = 0; i < numArms; i++ ) {
+				vector< pair<int, FeatureReal> >& filteredColumn = pSortedData->getFilteredColumn( _armsForPulling[i] );
 
-			tmpEnergy = getEnergy(mu, tmpAlpha, tmpV);
-			//update the weights in the UCT tree
-			
-			AlphaReal edge = 0.0;
-			for( vector<sRates>::iterator itR = mu.begin(); itR != mu.end(); itR++ ) edge += ( itR->rPls - itR->rMin ); 
-			AlphaReal reward = this->getRewardFromEdge( edge );
-			_rewards[i] = reward;
+				const vpIterator dataBegin = filteredColumn.begin();
+				const vpIterator dataEnd = filteredColumn.end();
+
+				// also sets mu, tmpV, and bestHalfEdge
+				thresholds[i] = sAlgo.findSingleThresholdWithInit(dataBegin, dataEnd, _pTrainingData, 
+					halfTheta, &mu, &tmpV);
+
+				energies[i] = getEnergy(mu, alphas[i], tmpV);
+				votes[i] = tmpV;
+
+				AlphaReal edge = 0.0;
+				for( vector<sRates>::iterator itR = mu.begin(); itR != mu.end(); itR++ ) edge += ( itR->rPls - itR->rMin ); 
+				_rewards[i] = this->getRewardFromEdge( edge );
+			}
+		}
 
+		// the best arm is chosen in the order of the pulls, like in the sequential search
+		for( int i = 0; i < numArms; i++ ) {
 			if ( _verbose > 3 ) {
 				cout << "\tK = " <<i << endl;
-				cout << "\tTempAlpha: " << tmpAlpha << endl;
-				cout << "\tTempEnergy: " << tmpEnergy << endl;
-				cout << "\tUpdate weight: " << reward << endl;
+				cout << "\tTempAlpha: " << alphas[i] << endl;
+				cout << "\tTempEnergy: " << energies[i] << endl;
+				cout << "\tUpdate weight: " << _rewards[i] << endl;
 			}
 
 
-			if ( (i==0) || (tmpEnergy < bestEnergy && tmpAlpha > 0) )
+			if ( (i==0) || (energies[i] < bestEnergy && alphas[i] > 0) )
 			{
 			   // Store it in the current weak hypothesis.
 			   // note: I don't really like having so many temp variables
@@ -333,16 +340,17 @@ namespace MultiBoost {
 			   // make it less flexible. Therefore, I am still undecided. This
 			   // might change!
 
-			   _alpha = tmpAlpha;
-			   _v = tmpV;
+			   _alpha = alphas[i];
+			   _v = votes[i];
 			   _selectedColumn = _armsForPulling[i];
-			   _threshold = tmpThreshold;
+			   _threshold = thresholds[i];
 
-			   bestEnergy = tmpEnergy;
-			   bestReward = reward;
+			   bestEnergy = energies[i];
+			   bestReward = _rewards[i];
 			}
 		}
 
+		// the rewards are delivered in the order of the pulls too
 		if ( _banditAlgoName == BA_EXP3G2 )
 		{
 			vector<AlphaReal> ePayoffs( numColumns );			
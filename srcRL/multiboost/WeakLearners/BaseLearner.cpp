@@ -74,6 +74,12 @@ namespace MultiBoost {
 			"The shyp file will be compressed", 
 			1, "<flag 0-1>");
 
+		args.declareArgument("shypbin", 
+			"The shyp file will be saved in binary format (extension ." + string(SHYP_BINARY_EXTENSION) + "), "
+			"which loads much faster. Only some weak learners have their own binary "
+			"format, the others are embedded in xml.", 
+			1, "<flag 0-1>");
+
 		args.setGroup("Basic Algorithm Options");
 		args.declareArgument("resume", 
 			"Resumes a training process using the strong hypothesis file.", 
@@ -219,6 +225,21 @@ namespace MultiBoost {
 
 	// -----------------------------------------------------------------------
 
+	void BaseLearner::saveBinary(ofstream& outputStream)
+	{
+		// the name is in the type record of the file
+		Serialization::writeBinary( outputStream, static_cast<double>(_alpha) );
+	}
+
+	// -----------------------------------------------------------------------
+
+	void BaseLearner::loadBinary(BinaryShypReader& reader)
+	{
+		_alpha = static_cast<AlphaReal>( reader.read<double>() );
+	}
+
+	// -----------------------------------------------------------------------
+
 	BaseLearner* BaseLearner::copyState()
 	{
 		BaseLearner *pBaseLearner = subCreate();
@@ -55,6 +55,7 @@ namespace MultiBoost {
 	    
 	class InputData;
 	class GenericStrongLearner;
+	class BinaryShypReader;
 	
 	/**
 	 * Generic base learner. 
@@ -292,6 +293,19 @@ namespace MultiBoost {
 		 */
 		virtual AlphaReal classify(InputData* pData, int idx, int classIdx) = 0;
 		
+		/**
+		 * Classify all the examples of the data at once. Only the learners whose output
+		 * factorizes as h(x,l) = v_l * phi(x) and which can compute phi faster than one
+		 * classify() call per example support it, the others return false.
+		 * \param pData The pointer to the data.
+		 * \param votes Filled with v_l for every class.
+		 * \param phis Filled with phi(x_i) for every example of \a pData.
+		 * \return true if classify(pData, i, l) is votes[l] * phis[i], false if classify()
+		 * must be used instead.
+		 */
+		virtual bool classifyAll(InputData* /*pData*/, vector<AlphaReal>& /*votes*/, vector<AlphaReal>& /*phis*/)
+		{ return false; }
+		
 		/**
 		 * Get the value of alpha. This \b must be computed by the algorithm in run()!
 		 * \return The value of alpha.
@@ -350,6 +364,31 @@ namespace MultiBoost {
 		 */
 		virtual void load(nor_utils::StreamTokenizer& st);
 		
+		/**
+		 * Tell whether this learner can be saved in the binary strong hypothesis format
+		 * by saveBinary() and loadBinary(). A learner which overrides them should return 
+		 * true only for its own type, since the subclasses might save more data.
+		 * \see Serialization
+		 */
+		virtual bool hasBinaryFormat() { return false; }
+		
+		/**
+		 * Serialize the object in the binary strong hypothesis format. Like save(),
+		 * the derived classes call the superclass first and then write their data.
+		 * \param outputStream The stream of the binary file.
+		 * \remark At this level only _alpha is saved.
+		 * \see loadBinary
+		 * \see Serialization
+		 */
+		virtual void saveBinary(ofstream& outputStream);
+		
+		/**
+		 * Unserialize the object from its block of the binary strong hypothesis file.
+		 * \param reader The reader of the block.
+		 * \see saveBinary
+		 */
+		virtual void loadBinary(BinaryShypReader& reader);
+		
 		/**
 		 * Creates a copy of the learner containing all the info we need in classify()
 		 * by calling the virtual fucntions subCreate() and subCopyState()
@@ -400,6 +439,8 @@ namespace MultiBoost {
 		
 		string getId() const { return _id; }
 		
+		InputData* getTrainingData() const { return _pTrainingData; }
+		
 		/* Return the edge of the base learner. If the training data is filtered (only a subset of it is used) 
 		 * then the sum of the weights aren't equal to 1. Thus we have to normalize it, for example in the case of Bandits.
 		 * But in the case of TreeLearner we use the unormalized version, but the normalized can be used also.
@@ -47,6 +47,7 @@
 #include <vector>
 #include <fstream>
 #include <cassert>
+#include <typeinfo> // for typeid
 
 using namespace std;
 
@@ -77,6 +78,12 @@ namespace MultiBoost {
 		 */
 		virtual BaseLearner* subCreate() { return new ConstantLearner(); }
 		
+		/**
+		 * The vote vector and alpha are all that is saved, see AbstainableLearner::saveBinary().
+		 * \see BaseLearner::hasBinaryFormat()
+		 */
+		virtual bool hasBinaryFormat() { return typeid(*this) == typeid(ConstantLearner); }
+		
 		/**
 		 * Run the learner to build the classifier on the given data.
 		 * \param pData The pointer to the data.
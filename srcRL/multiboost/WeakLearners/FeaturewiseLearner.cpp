@@ -107,6 +107,38 @@ namespace MultiBoost {
 	
 	// -----------------------------------------------------------------------
 	
+	void FeaturewiseLearner::saveBinary(ofstream& outputStream)
+	{
+		// Calling the super-class method
+		AbstainableLearner::saveBinary(outputStream);
+		
+		// save selectedColumn by name, as in the xml
+		string selectedColumnName;
+		if (_selectedColumn > -1)
+			selectedColumnName = _pTrainingData->getAttributeNameMap().getNameFromIdx(_selectedColumn);
+		else
+			selectedColumnName = "unused";
+		Serialization::writeBinaryString( outputStream, selectedColumnName );
+	}
+	
+	// -----------------------------------------------------------------------
+	
+	void FeaturewiseLearner::loadBinary(BinaryShypReader& reader)
+	{
+		// Calling the super-class method
+		AbstainableLearner::loadBinary(reader);
+		
+		// load selectedColumn
+		string selectedColumnName = reader.readString();
+		if (selectedColumnName == "unused")
+			_selectedColumn = -1;
+		else 
+			_selectedColumn = _pTrainingData->getAttributeNameMap().getIdxFromName(selectedColumnName);
+		_id = selectedColumnName;
+	}
+	
+	// -----------------------------------------------------------------------
+	
 	void FeaturewiseLearner::subCopyState(BaseLearner *pBaseLearner)
 	{
 		AbstainableLearner::subCopyState(pBaseLearner);
@@ -127,6 +159,32 @@ namespace MultiBoost {
 	
 	// -----------------------------------------------------------------------
 	
+	void FeaturewiseLearner::getSparseColumnPhis(InputData* pData, vector<AlphaReal>& phis) const
+	{
+		phis.assign( pData->getNumExamples(), phi( 0, 0 ) );
+		
+		const int* rows;
+		const FeatureReal* values;
+		const int columnSize = pData->getSparseColumn( _selectedColumn, rows, values );
+		
+		if ( pData->isFiltered() )
+		{
+			for (int k = 0; k < columnSize; ++k)
+			{
+				const int idx = pData->getOrderBasedOnRawIndex( rows[k] );
+				if ( idx >= 0 )
+					phis[idx] = phi( values[k], 0 );
+			}
+		}
+		else
+		{
+			for (int k = 0; k < columnSize; ++k)
+				phis[ rows[k] ] = phi( values[k], 0 );
+		}
+	}
+	
+	// -----------------------------------------------------------------------
+	
 	AlphaReal FeaturewiseLearner::run( vector<int>& colIndices ) 
 	{ 
 		AlphaReal bestEnergy = -numeric_limits<AlphaReal>::max();
@@ -151,6 +151,20 @@ namespace MultiBoost {
 		 */
 		virtual void load(nor_utils::StreamTokenizer& st);
 		
+		/**
+		 * Save \a _selectedColumn in the binary strong hypothesis format.
+		 * \param outputStream The stream of the binary file
+		 * \see AbstainableLearner::saveBinary()
+		 */
+		virtual void saveBinary(ofstream& outputStream);
+		
+		/**
+		 * Load \a _selectedColumn from the binary strong hypothesis format.
+		 * \param reader The reader of the block of the hypothesis
+		 * \see AbstainableLearner::loadBinary()
+		 */
+		virtual void loadBinary(BinaryShypReader& reader);
+		
 		/**
 		 * Copy all the info we need in classify().
 		 * pBaseLearner was created by subCreate so it has the correct (sub) type.
@@ -186,6 +200,16 @@ namespace MultiBoost {
 		 */
 		virtual AlphaReal phi(FeatureReal val, int classIdx) const = 0;
 		
+		/**
+		 * Computes phi on the selected column for all the examples of sparse data. Only the
+		 * nonzero values of the column are visited, the implicit zeros share phi(0).
+		 * \param pData The sparse data.
+		 * \param phis Filled with phi(x_i) for every example of \a pData.
+		 * \remark Only for the learners whose phi does not depend on the class.
+		 * \see BaseLearner::classifyAll
+		 */
+		void getSparseColumnPhis(InputData* pData, vector<AlphaReal>& phis) const;
+		
 		int    _selectedColumn; //!< The column of the training data with the lowest error.
 		int    _maxNumOfDimensions; //!< limit on the number of searched dimensions in run()
 	};
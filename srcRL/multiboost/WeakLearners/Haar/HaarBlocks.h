@@ -0,0 +1,241 @@
+/*
+ *
+ *    MultiBoost - Multi-purpose boosting package
+ *
+ *    Copyright (C)        AppStat group
+ *                         Laboratoire de l'Accelerateur Lineaire
+ *                         Universite Paris-Sud, 11, CNRS
+ *
+ *    This file is part of the MultiBoost library
+ *
+ *    This library is free software; you can redistribute it 
+ *    and/or modify it under the terms of the GNU General Public
+ *    License as published by the Free Software Foundation
+ *    version 2.1 of the License.
+ *
+ *    This library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public
+ *    License along with this library; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin St, 5th Floor, Boston, MA 02110-1301 USA
+ *
+ *    Contact: multiboost@googlegroups.com 
+ * 
+ *    For more information and up-to-date version, please visit
+ *        
+ *                       http://www.multiboost.org/
+ *
+ */
+
+
+/**
+ * \file HaarBlocks.h The integral image sums used to compute the Haar-like features,
+ * for one example or for a block of examples at a time.
+ */
+
+#ifndef __HAAR_BLOCKS_H
+#define __HAAR_BLOCKS_H
+
+#include "Defaults.h" // for FeatureReal and MB_DEBUG
+#include "IO/HaarData.h" // for areaWidth() and areaHeight()
+
+#include <vector>
+
+#if defined(__AVX512F__) || defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+// The vector instructions used for a block of examples, the widest the build targets.
+// Plain scalar code is used otherwise, which the compiler is still free to vectorize.
+#ifndef FEATUREREALDOUBLE
+#  if defined(__AVX512F__)
+#    define HAAR_VEC           __m512
+#    define HAAR_VEC_WIDTH     16
+#    define HAAR_VEC_LOAD(p)   _mm512_load_ps(p)
+#    define HAAR_VEC_STORE(p, a) _mm512_store_ps(p, a)
+#    define HAAR_VEC_ADD(a, b) _mm512_add_ps(a, b)
+#    define HAAR_VEC_SUB(a, b) _mm512_sub_ps(a, b)
+#    define HAAR_VEC_ZERO()    _mm512_setzero_ps()
+#  elif defined(__AVX__)
+#    define HAAR_VEC           __m256
+#    define HAAR_VEC_WIDTH     8
+#    define HAAR_VEC_LOAD(p)   _mm256_load_ps(p)
+#    define HAAR_VEC_STORE(p, a) _mm256_store_ps(p, a)
+#    define HAAR_VEC_ADD(a, b) _mm256_add_ps(a, b)
+#    define HAAR_VEC_SUB(a, b) _mm256_sub_ps(a, b)
+#    define HAAR_VEC_ZERO()    _mm256_setzero_ps()
+#  endif
+#else //FEATUREREALDOUBLE
+#  if defined(__AVX512F__)
+#    define HAAR_VEC           __m512d
+#    define HAAR_VEC_WIDTH     8
+#    define HAAR_VEC_LOAD(p)   _mm512_load_pd(p)
+#    define HAAR_VEC_STORE(p, a) _mm512_store_pd(p, a)
+#    define HAAR_VEC_ADD(a, b) _mm512_add_pd(a, b)
+#    define HAAR_VEC_SUB(a, b) _mm512_sub_pd(a, b)
+#    define HAAR_VEC_ZERO()    _mm512_setzero_pd()
+#  elif defined(__AVX__)
+#    define HAAR_VEC           __m256d
+#    define HAAR_VEC_WIDTH     4
+#    define HAAR_VEC_LOAD(p)   _mm256_load_pd(p)
+#    define HAAR_VEC_STORE(p, a) _mm256_store_pd(p, a)
+#    define HAAR_VEC_ADD(a, b) _mm256_add_pd(a, b)
+#    define HAAR_VEC_SUB(a, b) _mm256_sub_pd(a, b)
+#    define HAAR_VEC_ZERO()    _mm256_setzero_pd()
+#  endif
+#endif //FEATUREREALDOUBLE
+
+#ifndef HAAR_VEC
+#  define HAAR_VEC           FeatureReal
+#  define HAAR_VEC_WIDTH     1
+#  define HAAR_VEC_LOAD(p)   (*(p))
+#  define HAAR_VEC_STORE(p, a) (*(p) = (a))
+#  define HAAR_VEC_ADD(a, b) ((a) + (b))
+#  define HAAR_VEC_SUB(a, b) ((a) - (b))
+#  define HAAR_VEC_ZERO()    FeatureReal(0)
+#endif
+
+namespace MultiBoost {
+	
+	/**
+	 * The integral image sums of a single example.
+	 * \see HaarFeature_2H::evaluate
+	 * \date 17/10/2026
+	 */
+	class IntImageSums
+	{
+	public:
+		IntImageSums(const vector<FeatureReal>& intImage)
+		: _intImage(intImage), _areaWidth(HaarData::areaWidth()) {}
+		
+		/**
+		 * Return the integral image sum of an area which starts at 0,0 and ends
+		 * at x,y. 
+		 * \param x The x coordinate.
+		 * \param y The y coordinate.
+		 * \date 27/12/2005
+		 */
+		FeatureReal operator()(int x, int y) const
+		{
+#if MB_DEBUG
+			if ( x >= HaarData::areaWidth() )
+				cerr << "WARNING: x out of range: " << x << " >= " << HaarData::areaWidth() << endl;
+			if ( y >= HaarData::areaHeight() )
+				cerr << "WARNING: y out of range: " << y << " >= " << HaarData::areaHeight() << endl;
+#endif 
+			if (x < 0 || y < 0)
+				return 0;
+			else
+				return _intImage[ _areaWidth * y + x ]; 
+		}
+		
+	private:
+		const vector<FeatureReal>& _intImage;
+		const int                  _areaWidth;
+	};
+	
+	// ------------------------------------------------------------------------------
+	
+	/**
+	 * The values of HaarLanes::numLanes examples, one per lane. The arithmetic is done 
+	 * lane by lane with the same single operations as the scalar code, so the results
+	 * are bit-exact with the ones of a single example.
+	 * \date 17/10/2026
+	 */
+	class HaarLanes
+	{
+	public:
+		static const int numLanes = 16; //!< The number of examples in a block.
+		static const int alignment = 64; //!< The alignment in bytes of the blocks.
+		
+		/**
+		 * Load the lanes from an aligned array of numLanes values.
+		 */
+		static HaarLanes load(const FeatureReal* pValues)
+		{
+			HaarLanes lanes;
+			for (int i = 0; i < numVecs; ++i)
+				lanes._v[i] = HAAR_VEC_LOAD(pValues + i * HAAR_VEC_WIDTH);
+			return lanes;
+		}
+		
+		static HaarLanes zero()
+		{
+			HaarLanes lanes;
+			for (int i = 0; i < numVecs; ++i)
+				lanes._v[i] = HAAR_VEC_ZERO();
+			return lanes;
+		}
+		
+		/**
+		 * Store the lanes into an aligned array of numLanes values.
+		 */
+		void store(FeatureReal* pValues) const
+		{
+			for (int i = 0; i < numVecs; ++i)
+				HAAR_VEC_STORE(pValues + i * HAAR_VEC_WIDTH, _v[i]);
+		}
+		
+		HaarLanes operator+(const HaarLanes& other) const
+		{
+			HaarLanes lanes;
+			for (int i = 0; i < numVecs; ++i)
+				lanes._v[i] = HAAR_VEC_ADD(_v[i], other._v[i]);
+			return lanes;
+		}
+		
+		HaarLanes operator-(const HaarLanes& other) const
+		{
+			HaarLanes lanes;
+			for (int i = 0; i < numVecs; ++i)
+				lanes._v[i] = HAAR_VEC_SUB(_v[i], other._v[i]);
+			return lanes;
+		}
+		
+		HaarLanes& operator+=(const HaarLanes& other)
+		{
+			for (int i = 0; i < numVecs; ++i)
+				_v[i] = HAAR_VEC_ADD(_v[i], other._v[i]);
+			return *this;
+		}
+		
+	private:
+		static const int numVecs = numLanes / HAAR_VEC_WIDTH;
+		
+		HAAR_VEC _v[numVecs];
+	};
+	
+	// ------------------------------------------------------------------------------
+	
+	/**
+	 * The integral image sums of a block of HaarLanes::numLanes examples. In a block
+	 * the values of the examples are interleaved: the pixel p of the lane l is at
+	 * p * HaarLanes::numLanes + l.
+	 * \see HaarData::getIntImageBlocks
+	 * \date 17/10/2026
+	 */
+	class IntImageBlockSums
+	{
+	public:
+		IntImageBlockSums(const FeatureReal* pBlock)
+		: _pBlock(pBlock), _areaWidth(HaarData::areaWidth()) {}
+		
+		HaarLanes operator()(int x, int y) const
+		{
+			if (x < 0 || y < 0)
+				return HaarLanes::zero();
+			else
+				return HaarLanes::load( _pBlock + (_areaWidth * y + x) * HaarLanes::numLanes );
+		}
+		
+	private:
+		const FeatureReal* _pBlock;
+		const int          _areaWidth;
+	};
+	
+} // end of namespace MultiBoost
+
+#endif // __HAAR_BLOCKS_H
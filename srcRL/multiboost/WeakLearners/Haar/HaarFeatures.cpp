@@ -34,6 +34,7 @@
 
 #include "HaarFeatures.h"
 #include "IO/HaarData.h" // for areaWidth() and areaHeight()
+#include "HaarBlocks.h"
 
 #include <algorithm>
 
@@ -96,6 +97,40 @@ namespace MultiBoost {
 	
 	// ------------------------------------------------------------------------------
 	
+	void HaarFeature::fillHaarData( const FeatureReal* pIntImageBlocks, int numExamples, // in
+								   vector< pair<int, FeatureReal> >& haarData ) // out
+	{
+		switch (_type)
+		{
+			case FEATURE_2H_RECT: //!< Two horizontal.
+				_fillHaarData<HaarFeature_2H>(pIntImageBlocks, numExamples, haarData);
+				break;
+				
+			case FEATURE_2V_RECT: //!< Two vertical. 
+				_fillHaarData<HaarFeature_2V>(pIntImageBlocks, numExamples, haarData);
+				break;
+				
+			case FEATURE_3H_RECT: //!< Three horizontal.
+				_fillHaarData<HaarFeature_3H>(pIntImageBlocks, numExamples, haarData);
+				break;
+				
+			case FEATURE_3V_RECT: //!< Three vertical.
+				_fillHaarData<HaarFeature_3V>(pIntImageBlocks, numExamples, haarData);
+				break;
+				
+			case FEATURE_4SQUARE_RECT: //!< Four square.
+				_fillHaarData<HaarFeature_4SQ>(pIntImageBlocks, numExamples, haarData);
+				break;
+				
+			case FEATURE_NO_TYPE:
+				cerr << "ERROR: fillHaarData called with no type\n";
+				exit(-1);
+				break;
+		}
+	}
+	
+	// ------------------------------------------------------------------------------
+	
 	int HaarFeature::precomputeConfigs()
 	{
 		_precomputedConfigs.clear();
@@ -141,20 +176,33 @@ namespace MultiBoost {
 	
 	// ------------------------------------------------------------------------------
 	
-	inline 
-	FeatureReal HaarFeature::getSumAt(const vector<FeatureReal>& intImage, int x, int y)
+	template <typename TDeriv>
+	void HaarFeature::_fillHaarData( const FeatureReal* pIntImageBlocks, int numExamples, // input 
+									vector< pair<int, FeatureReal> >& haarData ) // output
 	{
-#if MB_DEBUG
-		if ( x >= HaarData::areaWidth() )
-			cerr << "WARNING: x out of range: " << x << " >= " << HaarData::areaWidth() << endl;
-		if ( y >= HaarData::areaHeight() )
-			cerr << "WARNING: y out of range: " << y << " >= " << HaarData::areaHeight() << endl;
-#endif 
-		if (x < 0 || y < 0)
-			return 0;
-		else
-			return intImage[ HaarData::areaWidth() * y + x ]; 
-	}   
+		const int blockSize = HaarData::areaWidth() * HaarData::areaHeight() * HaarLanes::numLanes;
+		const nor_utils::Rect& currConfig = getCurrentConfig();
+		
+		// the outputs of a block, aligned for HaarLanes::store
+		FeatureReal laneBuffer[ HaarLanes::numLanes + HaarLanes::alignment / sizeof(FeatureReal) ];
+		FeatureReal* pLaneValues = laneBuffer;
+		while ( reinterpret_cast<size_t>(pLaneValues) % HaarLanes::alignment != 0 )
+			++pLaneValues;
+		
+		const FeatureReal* pBlock = pIntImageBlocks;
+		for (int i = 0; i < numExamples; i += HaarLanes::numLanes, pBlock += blockSize)
+		{
+			TDeriv::template evaluate<HaarLanes>( IntImageBlockSums(pBlock), currConfig ).store( pLaneValues );
+			
+			// the last block may be partially filled
+			const int numLanes = min( HaarLanes::numLanes, numExamples - i );
+			for (int l = 0; l < numLanes; ++l)
+			{
+				haarData[i + l].first = i + l;
+				haarData[i + l].second = pLaneValues[l];
+			}
+		}
+	}
 	
 	// ------------------------------------------------------------------------------
 	
@@ -239,21 +287,22 @@ namespace MultiBoost {
 	// ------------------------------------------------------------------------------
 	// ------------------------------------------------------------------------------
 	
-	FeatureReal HaarFeature_2H::getValue(const vector<FeatureReal>& intImage, const nor_utils::Rect& r)
+	template <typename T, typename TSumAt>
+	T HaarFeature_2H::evaluate(const TSumAt& sumAt, const nor_utils::Rect& r)
 	{
 		int xHalfPos = r.x + (r.width / 2);
 		int yEndPos = r.y + r.height;
 		
-		FeatureReal whiteSum = getSumAt(intImage, xHalfPos, yEndPos) + // 4
-		getSumAt(intImage, r.x-1, r.y-1) - // 1
-		(getSumAt(intImage, xHalfPos, r.y-1) + // 2
-		 getSumAt(intImage, r.x-1, yEndPos) ); // 3
+		T whiteSum = sumAt(xHalfPos, yEndPos) + // 4
+		sumAt(r.x-1, r.y-1) - // 1
+		(sumAt(xHalfPos, r.y-1) + // 2
+		 sumAt(r.x-1, yEndPos) ); // 3
 		
 		xHalfPos++;
-		FeatureReal blackSum = getSumAt(intImage, r.x+r.width, yEndPos) + // 4
-		getSumAt(intImage, xHalfPos-1, r.y-1) - // 1
-		(getSumAt(intImage, r.x+r.width, r.y-1) + // 2
-		 getSumAt(intImage, xHalfPos-1, yEndPos) ); // 3
+		T blackSum = sumAt(r.x+r.width, yEndPos) + // 4
+		sumAt(xHalfPos-1, r.y-1) - // 1
+		(sumAt(r.x+r.width, r.y-1) + // 2
+		 sumAt(xHalfPos-1, yEndPos) ); // 3
 		
 		return blackSum - whiteSum;
 	}
@@ -261,28 +310,30 @@ namespace MultiBoost {
 	// ------------------------------------------------------------------------------
 	
 	
-	FeatureReal HaarFeature_2V::getValue(const vector<FeatureReal>& intImage, const nor_utils::Rect& r)
+	template <typename T, typename TSumAt>
+	T HaarFeature_2V::evaluate(const TSumAt& sumAt, const nor_utils::Rect& r)
 	{
 		int yHalfPos = r.y + (r.height / 2);
 		int xEndPos = r.x + r.width;
 		
-		FeatureReal whiteSum = getSumAt(intImage, xEndPos, yHalfPos) + // 4
-		getSumAt(intImage, r.x-1, r.y-1) - // 1
-		(getSumAt(intImage, xEndPos, r.y-1) + // 2
-		 getSumAt(intImage, r.x-1, yHalfPos) ); // 3
+		T whiteSum = sumAt(xEndPos, yHalfPos) + // 4
+		sumAt(r.x-1, r.y-1) - // 1
+		(sumAt(xEndPos, r.y-1) + // 2
+		 sumAt(r.x-1, yHalfPos) ); // 3
 		
 		yHalfPos++;
-		FeatureReal blackSum = getSumAt(intImage, xEndPos, r.y+r.height) + // 4
-		getSumAt(intImage, r.x-1, yHalfPos-1) - // 1
-		(getSumAt(intImage, xEndPos, yHalfPos-1) + // 2
-		 getSumAt(intImage, r.x-1, r.y+r.height) ); // 3
+		T blackSum = sumAt(xEndPos, r.y+r.height) + // 4
+		sumAt(r.x-1, yHalfPos-1) - // 1
+		(sumAt(xEndPos, yHalfPos-1) + // 2
+		 sumAt(r.x-1, r.y+r.height) ); // 3
 		
 		return blackSum - whiteSum;  
 	}
 	
 	// ------------------------------------------------------------------------------
 	
-	FeatureReal HaarFeature_3H::getValue(const vector<FeatureReal>& intImage, const nor_utils::Rect& r)
+	template <typename T, typename TSumAt>
+	T HaarFeature_3H::evaluate(const TSumAt& sumAt, const nor_utils::Rect& r)
 	{
 		// xOneThirdPos correspond to this (width = 8):
 		//     x     A   B
@@ -299,63 +350,65 @@ namespace MultiBoost {
 		int  xTwoThirdPos = r.x + ( ((r.width+1) / 3) * 2 - 1);
 		
 		// Left White
-		FeatureReal whiteSum = getSumAt(intImage, xOneThirdPos, r.y+r.height) + // 4
-		getSumAt(intImage, r.x-1, r.y-1) - // 1
-		(getSumAt(intImage, xOneThirdPos, r.y-1) + // 2
-		 getSumAt(intImage, r.x-1, r.y+r.height) ); // 3
+		T whiteSum = sumAt(xOneThirdPos, r.y+r.height) + // 4
+		sumAt(r.x-1, r.y-1) - // 1
+		(sumAt(xOneThirdPos, r.y-1) + // 2
+		 sumAt(r.x-1, r.y+r.height) ); // 3
 		
 		xOneThirdPos++;
 		
-		FeatureReal blackSum = getSumAt(intImage, xTwoThirdPos, r.y+r.height) + // 4
-		getSumAt(intImage, xOneThirdPos-1, r.y-1) - // 1
-		(getSumAt(intImage, xTwoThirdPos, r.y-1 ) + // 2
-		 getSumAt(intImage, xOneThirdPos-1, r.y+r.height) ); // 3
+		T blackSum = sumAt(xTwoThirdPos, r.y+r.height) + // 4
+		sumAt(xOneThirdPos-1, r.y-1) - // 1
+		(sumAt(xTwoThirdPos, r.y-1 ) + // 2
+		 sumAt(xOneThirdPos-1, r.y+r.height) ); // 3
 		
 		xTwoThirdPos++;
 		
 		// Right White
-		whiteSum += getSumAt(intImage, r.x+r.width, r.y+r.height) + // 4
-		getSumAt(intImage, xTwoThirdPos-1, r.y-1) - // 1
-		(getSumAt(intImage, r.x+r.width, r.y-1) + // 2
-		 getSumAt(intImage, xTwoThirdPos-1, r.y+r.height) ); // 3
+		whiteSum += sumAt(r.x+r.width, r.y+r.height) + // 4
+		sumAt(xTwoThirdPos-1, r.y-1) - // 1
+		(sumAt(r.x+r.width, r.y-1) + // 2
+		 sumAt(xTwoThirdPos-1, r.y+r.height) ); // 3
 		
 		return blackSum - whiteSum;
 	}
 	
 	// ------------------------------------------------------------------------------
 	
-	FeatureReal HaarFeature_3V::getValue(const vector<FeatureReal>& intImage, const nor_utils::Rect& r)
+	template <typename T, typename TSumAt>
+	T HaarFeature_3V::evaluate(const TSumAt& sumAt, const nor_utils::Rect& r)
 	{
 		int yOneThirdPos = r.y + ( r.height / 3);
 		int yTwoThirdPos = r.y + ( ((r.height+1) / 3) * 2 - 1);
 		
 		// Top White
-		FeatureReal whiteSum = getSumAt(intImage, r.x+r.width, yOneThirdPos) + // 4
-		getSumAt(intImage, r.x-1, r.y-1) - // 1
-		(getSumAt(intImage, r.x+r.width, r.y-1) + // 2
-		 getSumAt(intImage, r.x-1, yOneThirdPos) ); // 3
+		T whiteSum = sumAt(r.x+r.width, yOneThirdPos) + // 4
+		sumAt(r.x-1, r.y-1) - // 1
+		(sumAt(r.x+r.width, r.y-1) + // 2
+		 sumAt(r.x-1, yOneThirdPos) ); // 3
 		
 		yOneThirdPos++;
 		
-		FeatureReal blackSum = getSumAt(intImage, r.x+r.width, yTwoThirdPos) + // 4
-		getSumAt(intImage, r.x-1, yOneThirdPos - 1) - // 1
-		(getSumAt(intImage, r.x+r.width, yOneThirdPos - 1 ) + // 2
-		 getSumAt(intImage, r.x-1, yTwoThirdPos) ); // 3
+		T blackSum = sumAt(r.x+r.width, yTwoThirdPos) + // 4
+		sumAt(r.x-1, yOneThirdPos - 1) - // 1
+		(sumAt(r.x+r.width, yOneThirdPos - 1 ) + // 2
+		 sumAt(r.x-1, yTwoThirdPos) ); // 3
 		
 		yTwoThirdPos++;
 		
 		// Bottom White
-		whiteSum += getSumAt(intImage, r.x+r.width, r.y+r.height) + // 4
-		getSumAt(intImage, r.x-1, yTwoThirdPos-1) - // 1
-		(getSumAt(intImage, r.x+r.width, yTwoThirdPos-1) + // 2
-		 getSumAt(intImage, r.x-1, r.y+r.height) ); // 3
+		whiteSum += sumAt(r.x+r.width, r.y+r.height) + // 4
+		sumAt(r.x-1, yTwoThirdPos-1) - // 1
+		(sumAt(r.x+r.width, yTwoThirdPos-1) + // 2
+		 sumAt(r.x-1, r.y+r.height) ); // 3
 		
 		return blackSum - whiteSum;
 	}
 	
 	// ------------------------------------------------------------------------------
 	
-	FeatureReal HaarFeature_4SQ::getValue(const vector<FeatureReal>& intImage, const nor_utils::Rect& r)
+	template <typename T, typename TSumAt>
+	T HaarFeature_4SQ::evaluate(const TSumAt& sumAt, const nor_utils::Rect& r)
 	{
 		int yHalfPos = r.y + (r.height / 2);
 		int yEndPos = r.y + r.height;
@@ -363,39 +416,74 @@ namespace MultiBoost {
 		int xEndPos = r.x + r.width;
 		
 		// Top left
-		FeatureReal whiteSum = getSumAt(intImage, xHalfPos, yHalfPos) + // 4
-		getSumAt(intImage, r.x-1, r.y-1) - // 1
-		(getSumAt(intImage, xHalfPos, r.y-1) + // 2
-		 getSumAt(intImage, r.x-1, yHalfPos) ); // 3
+		T whiteSum = sumAt(xHalfPos, yHalfPos) + // 4
+		sumAt(r.x-1, r.y-1) - // 1
+		(sumAt(xHalfPos, r.y-1) + // 2
+		 sumAt(r.x-1, yHalfPos) ); // 3
 		
 		xHalfPos++;
 		
 		// Top right
-		FeatureReal blackSum = getSumAt(intImage, xEndPos, yHalfPos) + // 4
-		getSumAt(intImage, xHalfPos-1, r.y-1) - // 1
-		(getSumAt(intImage, xEndPos, r.y-1) + // 2
-		 getSumAt(intImage, xHalfPos-1, yHalfPos) ); // 3
+		T blackSum = sumAt(xEndPos, yHalfPos) + // 4
+		sumAt(xHalfPos-1, r.y-1) - // 1
+		(sumAt(xEndPos, r.y-1) + // 2
+		 sumAt(xHalfPos-1, yHalfPos) ); // 3
 		
 		xHalfPos--;
 		yHalfPos++;
 		
 		// Adds bottom left
-		blackSum += getSumAt(intImage, xHalfPos, yEndPos) + // 4
-		getSumAt(intImage, r.x-1, yHalfPos-1) - // 1
-		(getSumAt(intImage, xHalfPos, yHalfPos-1) + // 2
-		 getSumAt(intImage, r.x-1, yEndPos) ); // 3
+		blackSum += sumAt(xHalfPos, yEndPos) + // 4
+		sumAt(r.x-1, yHalfPos-1) - // 1
+		(sumAt(xHalfPos, yHalfPos-1) + // 2
+		 sumAt(r.x-1, yEndPos) ); // 3
 		
 		xHalfPos++;
 		
 		// Adds bottom right
-		whiteSum += getSumAt(intImage, xEndPos, yEndPos) + // 4
-		getSumAt(intImage, xHalfPos-1, yHalfPos-1) - // 1
-		(getSumAt(intImage, xEndPos, yHalfPos-1) + // 2
-		 getSumAt(intImage, xHalfPos-1, yEndPos) ); // 3
+		whiteSum += sumAt(xEndPos, yEndPos) + // 4
+		sumAt(xHalfPos-1, yHalfPos-1) - // 1
+		(sumAt(xEndPos, yHalfPos-1) + // 2
+		 sumAt(xHalfPos-1, yEndPos) ); // 3
 		
 		return blackSum - whiteSum;
 	}
 	
 	// ------------------------------------------------------------------------------
 	
+	FeatureReal HaarFeature_2H::getValue(const vector<FeatureReal>& intImage, const nor_utils::Rect& r)
+	{
+		return evaluate<FeatureReal>( IntImageSums(intImage), r );
+	}
+	
+	// ------------------------------------------------------------------------------
+	
+	FeatureReal HaarFeature_2V::getValue(const vector<FeatureReal>& intImage, const nor_utils::Rect& r)
+	{
+		return evaluate<FeatureReal>( IntImageSums(intImage), r );
+	}
+	
+	// ------------------------------------------------------------------------------
+	
+	FeatureReal HaarFeature_3H::getValue(const vector<FeatureReal>& intImage, const nor_utils::Rect& r)
+	{
+		return evaluate<FeatureReal>( IntImageSums(intImage), r );
+	}
+	
+	// ------------------------------------------------------------------------------
+	
+	FeatureReal HaarFeature_3V::getValue(const vector<FeatureReal>& intImage, const nor_utils::Rect& r)
+	{
+		return evaluate<FeatureReal>( IntImageSums(intImage), r );
+	}
+	
+	// ------------------------------------------------------------------------------
+	
+	FeatureReal HaarFeature_4SQ::getValue(const vector<FeatureReal>& intImage, const nor_utils::Rect& r)
+	{
+		return evaluate<FeatureReal>( IntImageSums(intImage), r );
+	}
+	
+	// ------------------------------------------------------------------------------
+	
 } // end of namespace MultiBoost
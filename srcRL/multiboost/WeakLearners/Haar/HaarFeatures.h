@@ -340,6 +340,21 @@ namespace MultiBoost {
 		void fillHaarData( const vector<Example>& intImages, // in
 						  vector< pair<int, FeatureReal> >& haarData ); // out
 		
+		/**
+		 * The batched version of fillHaarData, on integral images stored by blocks of 
+		 * interleaved examples. The feature is computed on a whole block at a time, with
+		 * the vector instructions the build targets (AVX-512, AVX or plain scalar code).
+		 * The outputs are bit-exact with the ones of getValue, which --haarcheck verifies
+		 * on every example. \see HaarData::checkIntImageBlocks
+		 * \param pIntImageBlocks The blocks of integral images. \see HaarData::getIntImageBlocks
+		 * \param numExamples The number of examples.
+		 * \param haarData The returned vector of features outputs, with numExamples elements.
+		 * \see HaarLanes
+		 * \date 17/10/2026
+		 */
+		void fillHaarData( const FeatureReal* pIntImageBlocks, int numExamples, // in
+						  vector< pair<int, FeatureReal> >& haarData ); // out
+		
 		/**
 		 * Get the feature output given a single example (in integral image format).
 		 * It will be overridden by the derived classes. 
@@ -358,18 +373,6 @@ namespace MultiBoost {
 		
 	protected:
 		
-		/**
-		 * Return the integral image sum of an area which starts at 0,0 and ends
-		 * at x,y. 
-		 * \param pIntImage The pointer to the array of data which represent the integral
-		 * image of the example.
-		 * \param x The x coordinate.
-		 * \param y The y coordinate.
-		 * \see HaarData
-		 * \date 27/12/2005
-		 */
-		FeatureReal getSumAt(const vector<FeatureReal>& intImage, int x, int y);
-		
 		string       _shortName; //!< The short name of the Haar-like feature. 
 		
 	private:
@@ -447,6 +450,16 @@ namespace MultiBoost {
 				hIt->second = static_cast<TDeriv&>(*this).getValue(iiIt->getValues(), currConfig);
 			}
 		}
+		
+		/**
+		 * The batched version of _fillHaarData, which calls TDeriv::evaluate on the
+		 * blocks of examples.
+		 * \see fillHaarData
+		 * \date 17/10/2026
+		 */
+		template <typename TDeriv>
+		void _fillHaarData( const FeatureReal* pIntImageBlocks, int numExamples, // input 
+						   vector< pair<int, FeatureReal> >& haarData ); // output
 	};
 	
 	// ------------------------------------------------------------------------------
@@ -502,6 +515,18 @@ namespace MultiBoost {
 		 * \date 27/12/2005
 		 */
 		virtual FeatureReal getValue(const vector<FeatureReal>& intImage, const nor_utils::Rect& r);
+		
+		/**
+		 * Compute the output of the feature from the integral image sums. It is shared 
+		 * by getValue and the batched fillHaarData, so the two give the same results.
+		 * \param sumAt The integral image sum at x,y, of a single example (IntImageSums) 
+		 * or of a block of examples (IntImageBlockSums).
+		 * \param r The configuration that will be used to compute the value of the
+		 * feature.
+		 * \date 17/10/2026
+		 */
+		template <typename T, typename TSumAt>
+		static T evaluate(const TSumAt& sumAt, const nor_utils::Rect& r);
 	};
 	
 	// ------------------------------------------------------------------------------
@@ -558,6 +583,10 @@ namespace MultiBoost {
 		 * \date 27/12/2005
 		 */
 		virtual FeatureReal getValue(const vector<FeatureReal>& intImage, const nor_utils::Rect& r);
+		
+		//! \see HaarFeature_2H::evaluate
+		template <typename T, typename TSumAt>
+		static T evaluate(const TSumAt& sumAt, const nor_utils::Rect& r);
 	};
 	
 	// ------------------------------------------------------------------------------
@@ -616,6 +645,10 @@ namespace MultiBoost {
 		 * \date 27/12/2005
 		 */
 		virtual FeatureReal getValue(const vector<FeatureReal>& intImage, const nor_utils::Rect& r);
+		
+		//! \see HaarFeature_2H::evaluate
+		template <typename T, typename TSumAt>
+		static T evaluate(const TSumAt& sumAt, const nor_utils::Rect& r);
 	};
 	
 	// ------------------------------------------------------------------------------
@@ -668,6 +701,10 @@ namespace MultiBoost {
 		 * \date 27/12/2005
 		 */
 		virtual FeatureReal getValue(const vector<FeatureReal>& intImage, const nor_utils::Rect& r);
+		
+		//! \see HaarFeature_2H::evaluate
+		template <typename T, typename TSumAt>
+		static T evaluate(const TSumAt& sumAt, const nor_utils::Rect& r);
 	};
 	
 	// ------------------------------------------------------------------------------
@@ -726,6 +763,10 @@ namespace MultiBoost {
 		 * \date 27/12/2005
 		 */
 		virtual FeatureReal getValue(const vector<FeatureReal>& intImage, const nor_utils::Rect& r);
+		
+		//! \see HaarFeature_2H::evaluate
+		template <typename T, typename TSumAt>
+		static T evaluate(const TSumAt& sumAt, const nor_utils::Rect& r);
 	};
 	
 	// ------------------------------------------------------------------------------
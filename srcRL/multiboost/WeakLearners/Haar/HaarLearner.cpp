@@ -76,6 +76,19 @@ void HaarLearner::declareArguments(nor_utils::Args& args)
                         "Example: -iisize 128x64", 
                         1, "<width>x<height>");
 
+   args.declareArgument("haarcache", 
+                        "Keep the sorted responses of the visited configurations in a cache of this size,\n"
+                        "so a configuration visited again in a later iteration is not evaluated again.\n"
+                        "Example: -haarcache 512\n"
+                        "(DEFAULT: 0, no cache)", 
+                        1, "<megabytes>");
+
+   args.declareArgument("haarcheck", 
+                        "Before training, check that the batched evaluation of the features on the\n"
+                        "blocks of integral images gives exactly the values of the per-example one,\n"
+                        "for all the configurations of the selected feature types.\n"
+                        "Stops with an error at the first value that differs.");
+
 }
 
 // ------------------------------------------------------------------------------
@@ -144,10 +144,8 @@ namespace MultiBoost {
 			while ( pCurrFeature->hasConfigs() ) 
 			{
 				// transform the data from intImages to the feature's space
-				pCurrFeature->fillHaarData(_pTrainingData->getExamples(), processedHaarData);
-				// sort the examples in the new space by their coordinate
-				sort( processedHaarData.begin(), processedHaarData.end(), 
-					 nor_utils::comparePair<2, int, float, less<float> >() );
+				// and sort the examples in the new space by their coordinate
+				pHaarData->fillSortedHaarData( pCurrFeature, processedHaarData );
 				
 				// find the optimal threshold
 				sAlgo.findMultiThresholdsWithInit(processedHaarData.begin(), processedHaarData.end(), 
@@ -51,7 +51,8 @@ namespace MultiBoost {
 	{
 		// call the superclasses
 		HaarLearner::declareArguments(args);
-		SingleStumpLearner::declareArguments(args);
+		// not SingleStumpLearner, --histogram does not apply to the Haar features
+		FeaturewiseLearner::declareArguments(args);
 	}
 	
 	// ------------------------------------------------------------------------------
@@ -60,7 +61,7 @@ namespace MultiBoost {
 	{
 		// call the superclasses
 		HaarLearner::initOptions(args);
-		SingleStumpLearner::initLearningOptions(args);
+		FeaturewiseLearner::initLearningOptions(args);
 	}
 	
 	// ------------------------------------------------------------------------------
@@ -157,12 +158,8 @@ namespace MultiBoost {
 			while ( pCurrFeature->hasConfigs() ) 
 			{
 				// transform the data from intImages to the feature's space
-				pCurrFeature->fillHaarData( _pTrainingData->getExamples(), processedHaarData );
-				//pCurrFeature->fillHaarData(intImages, processedHaarData);
-				
-				// sort the examples in the new space by their coordinate
-				sort( processedHaarData.begin(), processedHaarData.end(), 
-					 nor_utils::comparePair<2, int, FeatureReal, less<FeatureReal> >() );
+				// and sort the examples in the new space by their coordinate
+				pHaarData->fillSortedHaarData( pCurrFeature, processedHaarData );
 				
 				// find the optimal threshold
 				tmpThreshold = sAlgo.findSingleThresholdWithInit(processedHaarData.begin(), 
@@ -92,18 +92,12 @@ namespace MultiBoost {
 		// when theta=0.
 		setSmoothingVal(1.0 / (AlphaReal) _pTrainingData->getNumExamples() * 0.01);
 		
-		vector<sRates> mu(numClasses); // The class-wise rates. See BaseLearner::sRates for more info.
 		vector<sRates> bestmu(numClasses);
 		
-		vector<AlphaReal> tmpV(numClasses); // The class-wise votes/abstentions
-		vector<FeatureReal> tmpThresholds(numClasses);
-		
 		AlphaReal bestEnergy = numeric_limits<float>::max();
-
-		
-		StumpAlgorithm<FeatureReal> sAlgo(numClasses);
-		sAlgo.initSearchLoop(_pTrainingData);
 		
+		// the random selection of the columns stays sequential, so rand() is called as before
+		vector<int> columns;
 		int numOfDimensions = _maxNumOfDimensions;
 		for (int j = 0; j < numColumns; ++j) {
 			// Tricky way to select numOfDimensions columns randomly out of numColumns
@@ -112,33 +106,56 @@ namespace MultiBoost {
 			
 			if (static_cast<float> (numOfDimensions) / rest > r) {
 				--numOfDimensions;
-				const pair<vpIterator, vpIterator>
-				dataBeginEnd =
-				static_cast<SortedData*> (_pTrainingData)->getFileteredBeginEnd(j);
+				columns.push_back( j );
+			}
+		}
+		
+		// the class-wise stumps of every column, filled by the threads
+		const int numSelected = columns.size();
+		vector< vector<sRates> > columnMu( numSelected );
+		vector< vector<AlphaReal> > columnV( numSelected );
+		vector< vector<FeatureReal> > columnThresholds( numSelected );
+		
+#pragma omp parallel
+		{
+			StumpAlgorithm<FeatureReal> sAlgo(numClasses);
+			sAlgo.initSearchLoop(_pTrainingData);
+			
+#pragma omp for schedule(dynamic)
+			for (int c = 0; c < numSelected; ++c) {
+				vector< pair<int, FeatureReal> >& filteredColumn =
+				static_cast<SortedData*> (_pTrainingData)->getFilteredColumn(columns[c]);
+				
+				const vpIterator dataBegin = filteredColumn.begin();
+				const vpIterator dataEnd = filteredColumn.end();
 				
-				const vpIterator dataBegin = dataBeginEnd.first;
-				const vpIterator dataEnd = dataBeginEnd.second;
+				columnMu[c].resize(numClasses); // The class-wise rates. See BaseLearner::sRates for more info.
+				columnV[c].resize(numClasses); // The class-wise votes/abstentions
+				columnThresholds[c].resize(numClasses);
 				
 				sAlgo.findMultiThresholdsWithInit(dataBegin, dataEnd,
-												  _pTrainingData, tmpThresholds, &mu, &tmpV);
+												  _pTrainingData, columnThresholds[c], &columnMu[c], &columnV[c]);
+			}
+		}
+		
+		// the reduction goes in column order, so the first column wins the ties like in the sequential search
+		for (int c = 0; c < numSelected; ++c) {
+			const vector<sRates>& mu = columnMu[c];
+			for ( vector<sRates>::const_iterator itR = mu.begin(); itR != mu.end(); ++itR )
+			{
+				float tmpEdgePerClass = ( itR->rPls - itR->rMin );
 				
-				for ( vector<sRates>::iterator itR = mu.begin(); itR != mu.end(); ++itR )
+				// in each iteration the edge will be maximized, here this is done class-wisely.
+				if ( classwiseEdge[itR->classIdx] < tmpEdgePerClass )
 				{
-					float tmpEdgePerClass = ( itR->rPls - itR->rMin );
-					
-					// in each iteration the edge will be maximized, here this is done class-wisely.
-					if ( classwiseEdge[itR->classIdx] < tmpEdgePerClass )
-					{
-						classwiseEdge[itR->classIdx] = tmpEdgePerClass;
-						bestmu[itR->classIdx] = *itR;
-						
-						_v[itR->classIdx] = tmpV[itR->classIdx];
-						_selectedColumnArray[itR->classIdx] = j;
-						_thresholds[itR->classIdx] = tmpThresholds[itR->classIdx];
-						//cout << tmpThresholds[itR->classIdx] << endl;
-					}
+					classwiseEdge[itR->classIdx] = tmpEdgePerClass;
+					bestmu[itR->classIdx] = *itR;
 					
+					_v[itR->classIdx] = columnV[c][itR->classIdx];
+					_selectedColumnArray[itR->classIdx] = columns[c];
+					_thresholds[itR->classIdx] = columnThresholds[c][itR->classIdx];
 				}
+				
 			}
 		}
 		
@@ -52,18 +52,10 @@ AlphaReal MultiThresholdStumpLearner::run() {
 	// when theta=0.
 	setSmoothingVal(1.0 / (AlphaReal) _pTrainingData->getNumExamples() * 0.01);
 
-	vector<sRates> mu(numClasses); // The class-wise rates. See BaseLearner::sRates for more info.
-
-	vector<AlphaReal> tmpV(numClasses); // The class-wise votes/abstentions
-	vector<FeatureReal> tmpThresholds(numClasses);
-	AlphaReal tmpAlpha;
-
 	AlphaReal bestEnergy = numeric_limits<AlphaReal>::max();
-	AlphaReal tmpEnergy;
-
-	StumpAlgorithm<FeatureReal> sAlgo(numClasses);
-	sAlgo.initSearchLoop(_pTrainingData);
 
+	// the random selection of the columns stays sequential, so rand() is called as before
+	vector<int> columns;
 	int numOfDimensions = _maxNumOfDimensions;
 	for (int j = 0; j < numColumns; ++j) {
 		// Tricky way to select numOfDimensions columns randomly out of numColumns
@@ -72,33 +64,53 @@ AlphaReal MultiThresholdStumpLearner::run() {
 
 		if (static_cast<float> (numOfDimensions) / rest > r) {
 			--numOfDimensions;
-			const pair<vpIterator, vpIterator>
-					dataBeginEnd =
-							static_cast<SortedData*> (_pTrainingData)->getFileteredBeginEnd(
-									j);
+			columns.push_back(j);
+		}
+	}
+
+	// the stump of every column, filled by the threads
+	const int numSelected = columns.size();
+	vector<AlphaReal> energies(numSelected);
+	vector<AlphaReal> alphas(numSelected);
+	vector< vector<AlphaReal> > columnV(numSelected);
+	vector< vector<FeatureReal> > columnThresholds(numSelected);
+
+#pragma omp parallel
+	{
+		vector<sRates> mu(numClasses); // The class-wise rates. See BaseLearner::sRates for more info.
+
+		StumpAlgorithm<FeatureReal> sAlgo(numClasses);
+		sAlgo.initSearchLoop(_pTrainingData);
 
-			const vpIterator dataBegin = dataBeginEnd.first;
-			const vpIterator dataEnd = dataBeginEnd.second;
+#pragma omp for schedule(dynamic)
+		for (int c = 0; c < numSelected; ++c) {
+			vector< pair<int, FeatureReal> >& filteredColumn =
+					static_cast<SortedData*> (_pTrainingData)->getFilteredColumn(
+							columns[c]);
+
+			const vpIterator dataBegin = filteredColumn.begin();
+			const vpIterator dataEnd = filteredColumn.end();
+
+			columnV[c].resize(numClasses); // The class-wise votes/abstentions
+			columnThresholds[c].resize(numClasses);
 
 			sAlgo.findMultiThresholdsWithInit(dataBegin, dataEnd,
-					_pTrainingData, tmpThresholds, &mu, &tmpV);
-
-			tmpEnergy = getEnergy(mu, tmpAlpha, tmpV);
-			if (tmpEnergy < bestEnergy && tmpAlpha > 0) {
-				// Store it in the current algorithm
-				// note: I don't really like having so many temp variables
-				// but the alternative would be a structure, which would need
-				// to be inheritable to make things more consistent. But this would
-				// make it less flexible. Therefore, I am still undecided. This
-				// might change!
-
-				_alpha = tmpAlpha;
-				_v = tmpV;
-				_selectedColumn = j;
-				_thresholds = tmpThresholds;
-
-				bestEnergy = tmpEnergy;
-			}
+					_pTrainingData, columnThresholds[c], &mu, &columnV[c]);
+
+			energies[c] = getEnergy(mu, alphas[c], columnV[c]);
+		}
+	}
+
+	// the reduction goes in column order, so the first column wins the ties like in the sequential search
+	for (int c = 0; c < numSelected; ++c) {
+		if (energies[c] < bestEnergy && alphas[c] > 0) {
+			// Store it in the current algorithm
+			_alpha = alphas[c];
+			_v = columnV[c];
+			_selectedColumn = columns[c];
+			_thresholds = columnThresholds[c];
+
+			bestEnergy = energies[c];
 		}
 	}
 
@@ -45,7 +45,7 @@ namespace MultiBoost {
 	//REGISTER_LEARNER_NAME(Product, ProductLearnerUCT)
 	REGISTER_LEARNER(ProductLearnerUCT)
 	int ProductLearnerUCT::_numOfCalling = 0; //number of the single stump learner have been called
-	InnerNodeUCTSparse ProductLearnerUCT::_root;
+	UCTTree ProductLearnerUCT::_root;
 	// -----------------------------------------------------------------------
 
 		void ProductLearnerUCT::declareArguments(nor_utils::Args& args)
@@ -119,8 +119,8 @@ namespace MultiBoost {
 			if (_verbose > 0) {
 				cout << "Initializing tree..." << endl;
 			}
-			InnerNodeUCTSparse::setDepth( _numBaseLearners );
-			InnerNodeUCTSparse::setBranchOrder( _pTrainingData->getNumAttributes() );
+			UCTTree::setDepth( _numBaseLearners );
+			UCTTree::setBranchOrder( _pTrainingData->getNumAttributes() );
 			_root.setChildrenNum();
 			//createUCTTree();
 		}
@@ -184,7 +184,7 @@ namespace MultiBoost {
 		vector<BaseLearner*> _baseLearners; //!< the learners of the product
 		int _numBaseLearners;
 		static int _numOfCalling; //number of the single stump learner have been called
-		static InnerNodeUCTSparse	_root;
+		static UCTTree	_root;
 		enum updateType _updateRule;
 	private:
 		vector< vector<char> > _savedLabels; //!< original labels saved before run
@@ -155,6 +155,18 @@ AlphaReal SingleSparseStump::phi(FeatureReal val) const
 
 // ------------------------------------------------------------------------------
 
+bool SingleSparseStump::classifyAll(InputData* pData, vector<AlphaReal>& votes, vector<AlphaReal>& phis)
+{
+   if ( pData->getDataRep() != DR_SPARSE )
+      return false;
+
+   votes = _v;
+   getSparseColumnPhis( pData, phis );
+   return true;
+}
+
+// ------------------------------------------------------------------------------
+
 AlphaReal SingleSparseStump::phi(InputData* pData,int pointIdx) const
 {
    return phi(pData->getValue(pointIdx,_selectedColumn),0);
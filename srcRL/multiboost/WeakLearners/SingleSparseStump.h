@@ -104,6 +104,13 @@ namespace MultiBoost {
 		 */		
 		virtual AlphaReal run( int colIdx ) { return 0.0; }
 				
+		/**
+		 * Classify all the examples of sparse data by walking the nonzero values of the
+		 * selected column instead of looking up the column in every example.
+		 * \see BaseLearner::classifyAll
+		 */
+		virtual bool classifyAll(InputData* pData, vector<AlphaReal>& votes, vector<AlphaReal>& phis);
+		
 		/**
 		 * Save the current object information needed for classification,
 		 * that is the single threshold.
@@ -197,4 +197,16 @@ namespace MultiBoost {
 	
 	// -----------------------------------------------------------------------
 	
+	bool SingleSparseStumpLearner::classifyAll(InputData* pData, vector<AlphaReal>& votes, vector<AlphaReal>& phis)
+	{
+		if ( pData->getDataRep() != DR_SPARSE )
+			return false;
+		
+		votes = _v;
+		getSparseColumnPhis( pData, phis );
+		return true;
+	}
+	
+	// -----------------------------------------------------------------------
+	
 } // end of namespace MultiBoost
@@ -91,6 +91,13 @@ namespace MultiBoost {
 		 */	
 		virtual AlphaReal run( int colIdx );
 		
+		/**
+		 * Classify all the examples of sparse data by walking the nonzero values of the
+		 * selected column instead of looking up the column in every example.
+		 * \see BaseLearner::classifyAll
+		 */
+		virtual bool classifyAll(InputData* pData, vector<AlphaReal>& votes, vector<AlphaReal>& phis);
+		
 	protected:
 	};
 	
@@ -48,82 +48,145 @@ namespace MultiBoost {
 	
 	// ------------------------------------------------------------------------------
 	
+	void SingleStumpLearner::declareArguments(nor_utils::Args& args)
+	{
+		FeaturewiseLearner::declareArguments(args);
+		
+		args.declareArgument("histogram",
+							 "Quantize every column of the training data into at most <bins> bins (max 255) "
+							 "at the first iteration, and search the thresholds on the class-wise histograms "
+							 "of the bins instead of the sorted values. Only for dense data. "
+							 "Example: -histogram 255",
+							 1, "<bins>");
+	}
+	
+	// ------------------------------------------------------------------------------
+	
+	void SingleStumpLearner::initLearningOptions(const nor_utils::Args& args)
+	{
+		FeaturewiseLearner::initLearningOptions(args);
+		
+		_numHistogramBins = 0;
+		if ( args.hasArgument("histogram") )
+			_numHistogramBins = min( args.getValue<int>("histogram", 0), static_cast<int>(SortedData::MAX_HISTOGRAM_BINS) );
+	}
+	
+	// ------------------------------------------------------------------------------
+	
 	AlphaReal SingleStumpLearner::run()
 	{
-		const int numClasses = _pTrainingData->getNumClasses();
 		const int numColumns = _pTrainingData->getNumAttributes();
 		
+		// the random selection of the columns stays sequential, so rand() is called as before
+		vector<int> columns;
+		int numOfDimensions = _maxNumOfDimensions;
+		for (int j = 0; j < numColumns; ++j)
+		{
+			// Tricky way to select numOfDimensions columns randomly out of numColumns
+			int rest = numColumns - j;
+			float r = rand()/static_cast<float>(RAND_MAX);
+			
+			if ( static_cast<float>(numOfDimensions) / rest > r ) 
+			{
+				--numOfDimensions;
+				//if ( static_cast<SortedData*>(_pTrainingData)->isAttributeEmpty( j ) ) continue;
+				columns.push_back( j );
+			}
+		}
+		
+		return findBestColumn( columns );
+	}
+	
+	// ------------------------------------------------------------------------------
+	
+	AlphaReal SingleStumpLearner::findBestColumn( const vector<int>& columns )
+	{
+		const int numClasses = _pTrainingData->getNumClasses();
+		const int numSelected = columns.size();
+		
 		// set the smoothing value to avoid numerical problem
 		// when theta=0.
 		setSmoothingVal( 1.0 / (AlphaReal)_pTrainingData->getNumExamples() * 0.01 );
 		
-		vector<sRates> mu(numClasses); // The class-wise rates. See BaseLearner::sRates for more info.
-		vector<AlphaReal> tmpV(numClasses); // The class-wise votes/abstentions
-		
-		FeatureReal tmpThreshold;
-		AlphaReal tmpAlpha;
-		
-		AlphaReal bestEnergy = numeric_limits<AlphaReal>::max();
-		AlphaReal tmpEnergy;
-		
-		StumpAlgorithm<FeatureReal> sAlgo(numClasses);
-		sAlgo.initSearchLoop(_pTrainingData);
-		
 		AlphaReal halfTheta;
 		if ( _abstention == ABST_REAL || _abstention == ABST_CLASSWISE )
 			halfTheta = _theta/2.0;
 		else
 			halfTheta = 0;
 		
-		int numOfDimensions = _maxNumOfDimensions;
-		for (int j = 0; j < numColumns; ++j)
+		// only the training data is quantized, at the first iteration
+		SortedData* pSortedData = static_cast<SortedData*>(_pTrainingData);
+		if ( _numHistogramBins > 0 && pSortedData->getNumHistogramBins() != _numHistogramBins )
+			pSortedData->quantizeColumns( _numHistogramBins, _verbose );
+		
+		const bool useHistogram = ( _numHistogramBins > 0 ) && pSortedData->hasHistogramBins();
+		
+		// the stump of every column, filled by the threads
+		vector<FeatureReal> thresholds( numSelected );
+		vector<AlphaReal> energies( numSelected );
+		vector<AlphaReal> alphas( numSelected );
+		vector< vector<AlphaReal> > votes( numSelected );
+		
+#pragma omp parallel
 		{
-			// Tricky way to select numOfDimensions columns randomly out of numColumns
-			int rest = numColumns - j;
-			float r = rand()/static_cast<float>(RAND_MAX);
+			vector<sRates> mu(numClasses); // The class-wise rates. See BaseLearner::sRates for more info.
+			vector<AlphaReal> tmpV(numClasses); // The class-wise votes/abstentions
 			
-			if ( static_cast<float>(numOfDimensions) / rest > r ) 
+			StumpAlgorithm<FeatureReal> sAlgo(numClasses);
+			sAlgo.initSearchLoop(_pTrainingData);
+			
+#pragma omp for schedule(dynamic)
+			for (int c = 0; c < numSelected; ++c)
 			{
-				--numOfDimensions;
-				//if ( static_cast<SortedData*>(_pTrainingData)->isAttributeEmpty( j ) ) continue;
-				
-				const pair<vpIterator,vpIterator> dataBeginEnd = 
-				static_cast<SortedData*>(_pTrainingData)->getFileteredBeginEnd(j);
-				
-				
-				const vpIterator dataBegin = dataBeginEnd.first;
-				const vpIterator dataEnd = dataBeginEnd.second;
-				
-				
-				
-				// also sets mu, tmpV, and bestHalfEdge
-				tmpThreshold = sAlgo.findSingleThresholdWithInit(dataBegin, dataEnd, _pTrainingData, 
-																 halfTheta, &mu, &tmpV);
+				if ( useHistogram )
+				{
+					const unsigned char* bins;
+					const FeatureReal* binMins;
+					const FeatureReal* binMaxs;
+					const int numBins = pSortedData->getHistogramColumn(columns[c], bins, binMins, binMaxs);
+					
+					// also sets mu, tmpV, and bestHalfEdge
+					thresholds[c] = sAlgo.findSingleThresholdHistogramWithInit(bins, binMins, binMaxs, numBins,
+																			   _pTrainingData, halfTheta, &mu, &tmpV);
+				}
+				else
+				{
+					vector< pair<int, FeatureReal> >& filteredColumn = pSortedData->getFilteredColumn(columns[c]);
+					
+					const vpIterator dataBegin = filteredColumn.begin();
+					const vpIterator dataEnd = filteredColumn.end();
+					
+					// also sets mu, tmpV, and bestHalfEdge
+					thresholds[c] = sAlgo.findSingleThresholdWithInit(dataBegin, dataEnd, _pTrainingData, 
+																	  halfTheta, &mu, &tmpV);
+				}
 				
-				if (tmpThreshold == tmpThreshold) // tricky way to test Nan
-				{ 
+				if (thresholds[c] == thresholds[c]) // tricky way to test Nan
+				{
 					// small inconsistency compared to the standard algo (but a good
 					// trade-off): in findThreshold we maximize the edge (suboptimal but
 					// fast) but here (among dimensions) we minimize the energy.
-					tmpEnergy = getEnergy(mu, tmpAlpha, tmpV);
-					
-					if (tmpEnergy < bestEnergy && tmpAlpha > 0)
-					{
-						// Store it in the current weak hypothesis.
-						// note: I don't really like having so many temp variables
-						// but the alternative would be a structure, which would need
-						// to be inheritable to make things more consistent. But this would
-						// make it less flexible. Therefore, I am still undecided. This
-						// might change!
-						
-						_alpha = tmpAlpha;
-						_v = tmpV;
-						_selectedColumn = j;
-						_threshold = tmpThreshold;
-						
-						bestEnergy = tmpEnergy;
-					}
-				} // tmpThreshold == tmpThreshold
+					energies[c] = getEnergy(mu, alphas[c], tmpV);
+					votes[c] = tmpV;
+				}
+			}
+		}
+		
+		// the reduction goes in column order, so the first column wins the ties like in the sequential search
+		AlphaReal bestEnergy = numeric_limits<AlphaReal>::max();
+		for (int c = 0; c < numSelected; ++c)
+		{
+			if (thresholds[c] != thresholds[c]) continue;
+			
+			if (energies[c] < bestEnergy && alphas[c] > 0)
+			{
+				// Store it in the current weak hypothesis.
+				_alpha = alphas[c];
+				_v = votes[c];
+				_selectedColumn = columns[c];
+				_threshold = thresholds[c];
+				
+				bestEnergy = energies[c];
 			}
 		}
 		
@@ -136,9 +199,7 @@ namespace MultiBoost {
 			bestEnergy = numeric_limits<AlphaReal>::signaling_NaN();
 		}
 		
-		
 		return bestEnergy;
-		
 	}
 	
 	// ------------------------------------------------------------------------------
@@ -204,83 +265,7 @@ namespace MultiBoost {
 	// ------------------------------------------------------------------------------
 	AlphaReal SingleStumpLearner::run( vector<int>& colIndexes )
 	{
-		const int numClasses = _pTrainingData->getNumClasses();
-		const int numColumns = _pTrainingData->getNumAttributes();
-		
-		// set the smoothing value to avoid numerical problem
-		// when theta=0.
-		setSmoothingVal( 1.0 / (AlphaReal)_pTrainingData->getNumExamples() * 0.01 );
-		
-		vector<sRates> mu(numClasses); // The class-wise rates. See BaseLearner::sRates for more info.
-		vector<AlphaReal> tmpV(numClasses); // The class-wise votes/abstentions
-		
-		FeatureReal tmpThreshold;
-		AlphaReal tmpAlpha;
-		
-		AlphaReal bestEnergy = numeric_limits<AlphaReal>::max();
-		AlphaReal tmpEnergy;
-		
-		StumpAlgorithm<FeatureReal> sAlgo(numClasses);
-		sAlgo.initSearchLoop(_pTrainingData);
-		
-		AlphaReal halfTheta;
-		if ( _abstention == ABST_REAL || _abstention == ABST_CLASSWISE )
-			halfTheta = _theta/2.0;
-		else
-			halfTheta = 0;
-		
-		int numOfDimensions = _maxNumOfDimensions;
-		for (int j = 0; j < (int)colIndexes.size(); ++j)
-		{
-			const pair<vpIterator,vpIterator> dataBeginEnd = 
-			static_cast<SortedData*>(_pTrainingData)->getFileteredBeginEnd(colIndexes[j]);
-			
-			
-			const vpIterator dataBegin = dataBeginEnd.first;
-			const vpIterator dataEnd = dataBeginEnd.second;
-			
-			
-			
-			// also sets mu, tmpV, and bestHalfEdge
-			tmpThreshold = sAlgo.findSingleThresholdWithInit(dataBegin, dataEnd, _pTrainingData, 
-															 halfTheta, &mu, &tmpV);
-			
-			if (tmpThreshold == tmpThreshold) // tricky way to test Nan
-			{ 
-				// small inconsistency compared to the standard algo (but a good
-				// trade-off): in findThreshold we maximize the edge (suboptimal but
-				// fast) but here (among dimensions) we minimize the energy.
-				tmpEnergy = getEnergy(mu, tmpAlpha, tmpV);
-				
-				if (tmpEnergy < bestEnergy && tmpAlpha > 0)
-				{
-					// Store it in the current weak hypothesis.
-					// note: I don't really like having so many temp variables
-					// but the alternative would be a structure, which would need
-					// to be inheritable to make things more consistent. But this would
-					// make it less flexible. Therefore, I am still undecided. This
-					// might change!
-					
-					_alpha = tmpAlpha;
-					_v = tmpV;
-					_selectedColumn = colIndexes[j];
-					_threshold = tmpThreshold;
-					
-					bestEnergy = tmpEnergy;
-				}
-			} // tmpThreshold == tmpThreshold
-		}
-		
-		if ( _selectedColumn != -1 )
-		{
-			stringstream thresholdString;
-			thresholdString << _threshold;
-			_id = _pTrainingData->getAttributeNameMap().getNameFromIdx(_selectedColumn) + thresholdString.str();
-		} else {
-			bestEnergy = numeric_limits<AlphaReal>::signaling_NaN();
-		}
-		
-		return bestEnergy;
+		return findBestColumn( colIndexes );
 	}
 	
 	
@@ -329,6 +314,30 @@ namespace MultiBoost {
 	
 	// -----------------------------------------------------------------------
 	
+	void SingleStumpLearner::saveBinary(ofstream& outputStream)
+	{
+		// Calling the super-class method
+		FeaturewiseLearner::saveBinary(outputStream);
+		
+		Serialization::writeBinary( outputStream, static_cast<double>(_threshold) );
+	}
+	
+	// -----------------------------------------------------------------------
+	
+	void SingleStumpLearner::loadBinary(BinaryShypReader& reader)
+	{
+		// Calling the super-class method
+		FeaturewiseLearner::loadBinary(reader);
+		
+		_threshold = static_cast<FeatureReal>( reader.read<double>() );
+		
+		stringstream thresholdString;
+		thresholdString << _threshold;
+		_id = _id + thresholdString.str();
+	}
+	
+	// -----------------------------------------------------------------------
+	
 	void SingleStumpLearner::subCopyState(BaseLearner *pBaseLearner)
 	{
 		FeaturewiseLearner::subCopyState(pBaseLearner);
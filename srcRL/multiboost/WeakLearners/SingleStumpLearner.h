@@ -47,6 +47,7 @@
 #include <vector>
 #include <fstream>
 #include <cassert>
+#include <typeinfo> // for typeid
 
 using namespace std;
 
@@ -63,7 +64,7 @@ namespace MultiBoost {
 	{
 	public:
 		
-		SingleStumpLearner() : _threshold(numeric_limits<FeatureReal>::signaling_NaN()) {}
+		SingleStumpLearner() : _threshold(numeric_limits<FeatureReal>::signaling_NaN()), _numHistogramBins(0) {}
 
 		/**
 		 * The destructor. Must be declared (virtual) for the proper destruction of 
@@ -90,6 +91,23 @@ namespace MultiBoost {
 		 */
 		virtual InputData* createInputData() { return new SortedData(); }
 		
+		/**
+		 * Declare weak-learner-specific arguments.
+		 * adding --histogram
+		 * \param args The Args class reference which can be used to declare
+		 * additional arguments.
+		 * \see FeaturewiseLearner::declareArguments
+		 */
+		virtual void declareArguments(nor_utils::Args& args);
+		
+		/**
+		 * Set the arguments of the algorithm using the standard interface
+		 * of the arguments. Call this to set the arguments asked by the user.
+		 * \param args The arguments defined by the user in the command line.
+		 * \see FeaturewiseLearner::initLearningOptions
+		 */
+		virtual void initLearningOptions(const nor_utils::Args& args);
+		
 		/**
 		 * Run the learner to build the classifier on the given data.
 		 * \param pData The pointer to the data.
@@ -123,6 +141,24 @@ namespace MultiBoost {
 		 */
 		virtual void load(nor_utils::StreamTokenizer& st);
 		
+		/**
+		 * The stumps have a binary format, but not the learners derived from them.
+		 * \see BaseLearner::hasBinaryFormat()
+		 */
+		virtual bool hasBinaryFormat() { return typeid(*this) == typeid(SingleStumpLearner); }
+		
+		/**
+		 * Save the threshold in the binary strong hypothesis format.
+		 * \see FeaturewiseLearner::saveBinary()
+		 */
+		virtual void saveBinary(ofstream& outputStream);
+		
+		/**
+		 * Load the threshold from the binary strong hypothesis format.
+		 * \see FeaturewiseLearner::loadBinary()
+		 */
+		virtual void loadBinary(BinaryShypReader& reader);
+		
 		/**
 		 * Copy all the info we need in classify().
 		 * pBaseLearner was created by subCreate so it has the correct (sub) type.
@@ -208,7 +244,20 @@ namespace MultiBoost {
 			return phi( pData->getValue( idx, _selectedColumn) );
 		}				
 		
+		/**
+		 * Searches the best stump over the given columns. The columns are searched in parallel
+		 * with OpenMP, every thread has its own StumpAlgorithm and buffers. The result does not
+		 * depend on the number of threads: the lowest energy wins, ties go to the first column.
+		 * With --histogram the training data is quantized at the first call and the thresholds
+		 * are searched on the bins, see StumpAlgorithm::findSingleThresholdHistogramWithInit.
+		 * \param columns The indices of the columns to search, in increasing order.
+		 * \return The energy of the best stump, NaN if no column gives a stump.
+		 * \see run
+		 */
+		AlphaReal findBestColumn( const vector<int>& columns );
+		
 		FeatureReal _threshold; //!< the single threshold of the decision stump
+		int _numHistogramBins; //!< the number of bins of the histogram based search, 0 for the search on the sorted columns
 	};
 	
 	//////////////////////////////////////////////////////////////////////////
@@ -46,7 +46,7 @@ namespace MultiBoost {
 	//REGISTER_LEARNER_NAME(Product, TreeLearnerUCT)
 	REGISTER_LEARNER(TreeLearnerUCT)
 	int TreeLearnerUCT::_numOfCalling = 0; //number of the single stump learner have been called
-	InnerNodeUCTSparse TreeLearnerUCT::_root;
+	UCTTree TreeLearnerUCT::_root;
 
 	// -----------------------------------------------------------------------
 
@@ -141,8 +141,8 @@ namespace MultiBoost {
 			if (_verbose > 0) {
 				cout << "Initializing tree..." << endl;
 			}
-			InnerNodeUCTSparse::setDepth( _numBaseLearners );
-			InnerNodeUCTSparse::setBranchOrder( _pTrainingData->getNumAttributes() );
+			UCTTree::setDepth( _numBaseLearners );
+			UCTTree::setBranchOrder( _pTrainingData->getNumAttributes() );
 			_root.setChildrenNum();
 			//createUCTTree();
 		}
@@ -232,7 +232,7 @@ namespace MultiBoost {
 		int _numBaseLearners;
 
 		static int _numOfCalling; //number of the single stump learner have been called
-		static InnerNodeUCTSparse	_root;
+		static UCTTree	_root;
 		enum updateType _updateRule;
 
 		//virtual float getEdge2( BaseLearner* learner, InputData* d );
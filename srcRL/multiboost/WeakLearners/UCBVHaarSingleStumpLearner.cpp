@@ -135,7 +135,8 @@ namespace MultiBoost {
 	{
 		// call the superclasses
 		HaarLearner::declareArguments(args);
-		SingleStumpLearner::declareArguments(args);
+		// not SingleStumpLearner, --histogram does not apply to the Haar features
+		FeaturewiseLearner::declareArguments(args);
 	}
 
 	// ------------------------------------------------------------------------------
@@ -144,7 +145,7 @@ namespace MultiBoost {
 	{
 		// call the superclasses
 		HaarLearner::initOptions(args);
-		SingleStumpLearner::initLearningOptions(args);
+		FeaturewiseLearner::initLearningOptions(args);
 	}
 
 	// ------------------------------------------------------------------------------
@@ -277,12 +278,8 @@ namespace MultiBoost {
 			cout << "Learning type " << pCurrFeature->getName() << ".." << flush;
 
 		// transform the data from intImages to the feature's space
-		pCurrFeature->fillHaarData( _pTrainingData->getExamples(), processedHaarData );
-		//pCurrFeature->fillHaarData(intImages, processedHaarData);
-
-		// sort the examples in the new space by their coordinate
-		sort( processedHaarData.begin(), processedHaarData.end(), 
-			nor_utils::comparePair<2, int, float, less<float> >() );
+		// and sort the examples in the new space by their coordinate
+		pHaarData->fillSortedHaarData( pCurrFeature, processedHaarData );
 
 		// find the optimal threshold
 		tmpThreshold = sAlgo.findSingleThresholdWithInit(processedHaarData.begin(), 